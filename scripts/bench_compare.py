@@ -0,0 +1,218 @@
+#!/usr/bin/env python
+#####################################################################################
+#      Copyright 2015 Barcelona Supercomputing Center                               #
+#                                                                                   #
+#      This file is part of the NANOS++ library.                                    #
+#                                                                                   #
+#      NANOS++ is free software: you can redistribute it and/or modify              #
+#      it under the terms of the GNU Lesser General Public License as published by  #
+#      the Free Software Foundation, either version 3 of the License, or            #
+#      (at your option) any later version.                                          #
+#                                                                                   #
+#      NANOS++ is distributed in the hope that it will be useful,                   #
+#      but WITHOUT ANY WARRANTY; without even the implied warranty of               #
+#      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                #
+#      GNU Lesser General Public License for more details.                          #
+#                                                                                   #
+#      You should have received a copy of the GNU Lesser General Public License     #
+#      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             #
+#####################################################################################
+
+# Compares the results of the benchmark suite (tests/test/07_benchmarks) against
+# a JSON baseline. Results are read from the '#BENCH {...}' lines that the
+# benchmarks print, either from their output or from a bets log. Every metric is
+# identified by its name and the runtime configuration (NX_ARGS and the other
+# NX_* variables) it ran with.
+#
+# A metric regresses when its mean is larger than the baseline one (all metrics
+# are lower-is-better) by more than the threshold and a one-sided Welch t-test
+# finds the difference significant. A metric of the baseline without results
+# (the benchmark crashed, hung or was not run) is a failure as well.
+#
+# Examples:
+#    bench_compare.py --save baseline.json bench.log
+#    bench_compare.py --baseline baseline.json bench.log
+
+import json
+import math
+import sys
+from optparse import OptionParser
+
+MARKER = '#BENCH '
+
+def parse_results(files):
+	results = {}
+	for name in files:
+		f = open(name)
+		for line in f:
+			pos = line.find(MARKER)
+			if pos < 0:
+				continue
+			entry = json.loads(line[pos + len(MARKER):])
+			key = entry['name'] + ' [' + entry['config'].strip() + ']'
+			if key in results:
+				# Several runs of the same metric and configuration are merged
+				results[key]['samples'] += entry['samples']
+			else:
+				results[key] = {'name': entry['name'], 'config': entry['config'].strip(),
+				                'unit': entry['unit'], 'samples': list(entry['samples'])}
+		f.close()
+	return results
+
+def mean_var(values):
+	n = len(values)
+	mean = sum(values) / n
+	if n < 2:
+		return mean, 0.0
+	return mean, sum([(v - mean) ** 2 for v in values]) / (n - 1)
+
+def filter_outliers(values):
+	# Same criterion as the benchmarks in common.h: drop samples beyond 3 sd
+	mean, var = mean_var(values)
+	sd = math.sqrt(var)
+	kept = [v for v in values if abs(v - mean) <= 3.0 * sd]
+	if len(kept) < 2:
+		return values
+	return kept
+
+def betacf(a, b, x):
+	# Continued fraction of the incomplete beta function (modified Lentz)
+	tiny = 1.0e-300
+	qab, qap, qam = a + b, a + 1.0, a - 1.0
+	c, d = 1.0, 1.0 - qab * x / qap
+	if abs(d) < tiny:
+		d = tiny
+	d = 1.0 / d
+	h = d
+	for m in range(1, 301):
+		m2 = 2 * m
+		aa = m * (b - m) * x / ((qam + m2) * (a + m2))
+		d = 1.0 + aa * d
+		if abs(d) < tiny:
+			d = tiny
+		c = 1.0 + aa / c
+		if abs(c) < tiny:
+			c = tiny
+		d = 1.0 / d
+		h *= d * c
+		aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2))
+		d = 1.0 + aa * d
+		if abs(d) < tiny:
+			d = tiny
+		c = 1.0 + aa / c
+		if abs(c) < tiny:
+			c = tiny
+		d = 1.0 / d
+		delta = d * c
+		h *= delta
+		if abs(delta - 1.0) < 1.0e-12:
+			break
+	return h
+
+def betainc(a, b, x):
+	# Regularized incomplete beta function I_x(a, b)
+	if x <= 0.0:
+		return 0.0
+	if x >= 1.0:
+		return 1.0
+	lbeta = math.lgamma(a + b) - math.lgamma(a) - math.lgamma(b)
+	front = math.exp(lbeta + a * math.log(x) + b * math.log(1.0 - x))
+	if x < (a + 1.0) / (a + b + 2.0):
+		return front * betacf(a, b, x) / a
+	return 1.0 - front * betacf(b, a, 1.0 - x) / b
+
+def welch_greater(current, baseline):
+	# One-sided Welch t-test: p-value of mean(current) > mean(baseline)
+	m1, v1 = mean_var(current)
+	m2, v2 = mean_var(baseline)
+	se2 = v1 / len(current) + v2 / len(baseline)
+	if se2 == 0.0:
+		if m1 > m2:
+			return 0.0
+		return 1.0
+	t = (m1 - m2) / math.sqrt(se2)
+	df = se2 ** 2 / ((v1 / len(current)) ** 2 / max(len(current) - 1, 1) +
+	                 (v2 / len(baseline)) ** 2 / max(len(baseline) - 1, 1))
+	tail = 0.5 * betainc(df / 2.0, 0.5, df / (df + t * t))
+	if t > 0:
+		return tail
+	return 1.0 - tail
+
+def compare(results, baseline, alpha, threshold):
+	regressions = 0
+	missing = 0
+	print('%-60s %12s %12s %8s %10s  %s' % ('benchmark', 'baseline', 'current', 'change', 'p-value', 'status'))
+	for key in sorted(results.keys()):
+		current = filter_outliers(results[key]['samples'])
+		cur_mean = mean_var(current)[0]
+		if key not in baseline:
+			print('%-60s %12s %12.3f %8s %10s  %s' % (key, '-', cur_mean, '-', '-', 'new'))
+			continue
+		base = filter_outliers(baseline[key]['samples'])
+		base_mean = mean_var(base)[0]
+		change = (cur_mean - base_mean) / base_mean if base_mean > 0 else 0.0
+
+		status = 'ok'
+		if change > threshold:
+			p = welch_greater(current, base)
+			if p < alpha:
+				status = 'REGRESSION'
+				regressions += 1
+		elif change < -threshold:
+			p = welch_greater(base, current)
+			if p < alpha:
+				status = 'improvement'
+		else:
+			p = welch_greater(current, base)
+		print('%-60s %12.3f %12.3f %+7.1f%% %10.2g  %s' % (key, base_mean, cur_mean, change * 100.0, p, status))
+
+	for key in sorted(baseline.keys()):
+		if key not in results:
+			base_mean = mean_var(filter_outliers(baseline[key]['samples']))[0]
+			print('%-60s %12.3f %12s %8s %10s  %s' % (key, base_mean, '-', '-', '-', 'MISSING'))
+			missing += 1
+	return regressions, missing
+
+def main():
+	parser = OptionParser(usage='usage: %prog [options] RESULTS...')
+	parser.add_option('-b', '--baseline', metavar='FILE', dest='baseline',
+	                  help='JSON baseline to compare the results against')
+	parser.add_option('-s', '--save', metavar='FILE', dest='save',
+	                  help='Save the results as a new JSON baseline')
+	parser.add_option('-a', '--alpha', type='float', default=0.01, dest='alpha',
+	                  help='Significance level of the t-test [default: %default]')
+	parser.add_option('-t', '--threshold', type='float', default=0.05, dest='threshold',
+	                  help='Minimum relative slowdown reported as a regression [default: %default]')
+	(options, args) = parser.parse_args()
+
+	if len(args) == 0:
+		parser.error('No results given')
+
+	results = parse_results(args)
+	if len(results) == 0:
+		sys.stderr.write('No benchmark results found\n')
+		return 2
+
+	if options.save:
+		f = open(options.save, 'w')
+		json.dump({'version': 1, 'benchmarks': results}, f, indent=1, sort_keys=True)
+		f.close()
+
+	if options.baseline:
+		f = open(options.baseline)
+		baseline = json.load(f)['benchmarks']
+		f.close()
+		regressions, missing = compare(results, baseline, options.alpha, options.threshold)
+		if missing > 0:
+			sys.stderr.write('%d metric(s) of the baseline without results\n' % missing)
+		if regressions > 0:
+			sys.stderr.write('%d significant regression(s)\n' % regressions)
+		if regressions > 0 or missing > 0:
+			return 1
+	elif not options.save:
+		for key in sorted(results.keys()):
+			print('%-60s %12.3f %s' % (key, mean_var(filter_outliers(results[key]['samples']))[0], results[key]['unit']))
+	return 0
+
+if __name__ == '__main__':
+	sys.exit(main())
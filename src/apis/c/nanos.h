@@ -115,11 +115,15 @@
  *   - 5025: Changed WD priority from unsigned to int.
  *   - 5029: Adding implicit parameter to work descriptor flags.
  *   - 5030: Adding instrumentation support to wrap main function.
+ *   - 5031: Submitting a batch of work descriptors at once (nanos_submit_batch).
+ *   - 5032: NUMA aware memory placement (nanos_numa_malloc, nanos_numa_first_touch, nanos_numa_free and nanos_numa_get_home).
  * - nanos interface family: worksharing
  *   - 1000: First implementation of work-sharing services (create and next-item)
  * - nanos interface family: deps_api
  *   - 1000: First implementation of dependencies plugins.
  *   - 1001: Commutative clause support.
+ * - nanos interface family: task_reduction
+ *   - 1003: Registering task reductions with a built-in operator (nanos_task_reduction_register_builtin).
  * - nanos interface family: openmp
  *   - 1: First Nanos OpenMP interface: nanos_omp_single ( b ) service
  *   - 2: Including nanos_omp_barrier() service
@@ -151,6 +155,7 @@ typedef void * nanos_sched_t;
 typedef void * nanos_slicer_t;
 typedef void * nanos_dd_t;
 typedef void * nanos_sync_cond_t;
+typedef void * nanos_taskgraph_t;
 typedef unsigned int nanos_copy_id_t;
 
 typedef struct nanos_const_wd_definition_tag {
@@ -213,6 +218,7 @@ NANOS_API_DECL(nanos_err_t, nanos_create_sliced_wd, ( nanos_wd_t *uwd, size_t nu
                                      nanos_wd_props_t *props, nanos_wd_dyn_props_t *dyn_props, size_t num_copies, nanos_copy_data_t **copies, size_t num_dimensions, nanos_region_dimension_internal_t **dimensions ));
 
 NANOS_API_DECL(nanos_err_t, nanos_submit, ( nanos_wd_t wd, size_t num_data_accesses, nanos_data_access_t *data_accesses, nanos_team_t team ));
+NANOS_API_DECL(nanos_err_t, nanos_submit_batch, ( size_t num_wds, nanos_wd_t *wds, size_t *num_data_accesses, nanos_data_access_t **data_accesses, nanos_team_t team ));
 
 NANOS_API_DECL(nanos_err_t, nanos_create_wd_and_run_compact, ( nanos_const_wd_definition_t *const_data, nanos_wd_dyn_props_t *dyn_props,
                                                                size_t data_size, void * data, size_t num_data_accesses, nanos_data_access_t *data_accesses,
@@ -268,6 +274,10 @@ NANOS_API_DECL(nanos_err_t, nanos_reduction_get, ( nanos_reduction_t **dest, voi
 NANOS_API_DECL(nanos_err_t, nanos_task_reduction_register, ( void *orig, size_t size_target, size_t size_elem,
             void (*init)( void *, void * ), void (*reducer)( void *, void * ) ) );
 
+NANOS_API_DECL(nanos_err_t, nanos_task_reduction_register_builtin, ( void *orig, size_t size_target, size_t size_elem,
+            void (*init)( void *, void * ), void (*reducer)( void *, void * ),
+            nanos_reduction_op_t op, nanos_reduction_type_t type ) );
+
 NANOS_API_DECL(nanos_err_t, nanos_task_fortran_array_reduction_register, ( void *orig, void *dep,
          size_t array_descriptor_size, void (*init)( void *, void * ), void (*reducer)( void *, void * ),
          void (*reducer_orig_var)( void *, void * ) ) );
@@ -283,6 +293,11 @@ NANOS_API_DECL(nanos_err_t, nanos_dependence_release_all, ( void ) );
 NANOS_API_DECL(nanos_err_t, nanos_dependence_pendant_writes, ( bool *res, void *addr ));
 NANOS_API_DECL(nanos_err_t, nanos_dependence_create, ( nanos_wd_t pred, nanos_wd_t succ ) );
 
+// task graph record and replay
+NANOS_API_DECL(nanos_err_t, nanos_taskgraph_begin, ( nanos_taskgraph_t *graph ));
+NANOS_API_DECL(nanos_err_t, nanos_taskgraph_end, ( nanos_taskgraph_t graph ));
+NANOS_API_DECL(nanos_err_t, nanos_taskgraph_destroy, ( nanos_taskgraph_t graph ));
+
 // worksharing
 NANOS_API_DECL(nanos_err_t, nanos_worksharing_create ,( nanos_ws_desc_t **wsd, nanos_ws_t ws, nanos_ws_info_t *info, bool *b ) );
 NANOS_API_DECL(nanos_err_t, nanos_worksharing_next_item, ( nanos_ws_desc_t *wsd, nanos_ws_item_t *wsi ) );
@@ -336,6 +351,10 @@ NANOS_API_DECL(nanos_err_t, nanos_cmalloc_2dim_distributed, ( void **p, size_t r
 NANOS_API_DECL(nanos_err_t, nanos_stick_to_producer, ( void *p, size_t size ));
 NANOS_API_DECL(nanos_err_t, nanos_free, ( void *p ));
 NANOS_API_DECL(void, nanos_free0, ( void *p )); 
+NANOS_API_DECL(nanos_err_t, nanos_numa_malloc, ( void **p, size_t size, nanos_numa_policy_t policy, int node, const char *file, int line ));
+NANOS_API_DECL(nanos_err_t, nanos_numa_first_touch, ( void *p, size_t size, nanos_wd_t wd ));
+NANOS_API_DECL(nanos_err_t, nanos_numa_free, ( void *p ));
+NANOS_API_DECL(nanos_err_t, nanos_numa_get_home, ( const void *p, size_t size, int *node ));
 
 // error handling
 NANOS_API_DECL(void, nanos_handle_error, ( nanos_err_t err ));
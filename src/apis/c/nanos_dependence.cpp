@@ -25,6 +25,7 @@
 #include "instrumentationmodule_decl.hpp"
 #include "basethread.hpp"
 #include "workdescriptor.hpp"
+#include "taskgraph_decl.hpp"
 
 /*! \defgroup capi_dependence Dependence services.
  *  \ingroup capi
@@ -83,6 +84,69 @@ NANOS_API_DEF(nanos_err_t, nanos_dependence_create, ( nanos_wd_t pred, nanos_wd_
    }
    return NANOS_OK;
 }
+
+//! \brief Starts a region of task submissions recorded in graph
+//!
+//! The first time the region is recorded while its tasks are submitted normally. Later
+//! instances replay the recorded dependences instead of looking them up, as long as the
+//! tasks are submitted in the same order and with the same data accesses. Both ends of
+//! the region wait for the children of the current WD.
+//!
+//! \param [in,out] graph is the task graph, created if it points to NULL
+NANOS_API_DEF(nanos_err_t, nanos_taskgraph_begin, ( nanos_taskgraph_t *graph ) )
+{
+   NANOS_INSTRUMENT( InstrumentStateAndBurst inst("api","taskgraph_begin", NANOS_RUNTIME) );
+   try {
+      ensure( graph != NULL, "NULL task graph received" );
+
+      WD *wd = myThread->getCurrentWD();
+      ensure( wd->getTaskGraph() == NULL, "Task graph regions cannot be nested" );
+
+      wd->waitCompletion();
+
+      if ( *graph == NULL ) *graph = ( nanos_taskgraph_t ) NEW TaskGraph();
+      TaskGraph *tg = ( TaskGraph * ) *graph;
+      tg->begin();
+      wd->setTaskGraph( tg );
+   } catch ( nanos_err_t e) {
+      return e;
+   }
+   return NANOS_OK;
+}
+
+//! \brief Ends the region started by nanos_taskgraph_begin and waits for its tasks
+//!
+//! \param [in] graph is the task graph of the region
+NANOS_API_DEF(nanos_err_t, nanos_taskgraph_end, ( nanos_taskgraph_t graph ) )
+{
+   NANOS_INSTRUMENT( InstrumentStateAndBurst inst("api","taskgraph_end", NANOS_RUNTIME) );
+   try {
+      WD *wd = myThread->getCurrentWD();
+      ensure( graph != NULL && wd->getTaskGraph() == ( TaskGraph * ) graph, "Task graph region not started" );
+
+      TaskGraph *tg = ( TaskGraph * ) graph;
+      tg->end();
+      wd->setTaskGraph( NULL );
+
+      wd->waitCompletion();
+   } catch ( nanos_err_t e) {
+      return e;
+   }
+   return NANOS_OK;
+}
+
+//! \brief Destroys a task graph, outside of its region
+//!
+//! \param [in] graph is the task graph
+NANOS_API_DEF(nanos_err_t, nanos_taskgraph_destroy, ( nanos_taskgraph_t graph ) )
+{
+   try {
+      delete ( TaskGraph * ) graph;
+   } catch ( nanos_err_t e) {
+      return e;
+   }
+   return NANOS_OK;
+}
 /*!
  * \}
  */ 
@@ -26,8 +26,12 @@
 #include "osallocator_decl.hpp"
 #include "instrumentation_decl.hpp"
 #include "instrumentationmodule_decl.hpp"
+#include "numaplacement_decl.hpp"
+#include "workdescriptor_decl.hpp"
+#include "system.hpp"
 
 #include <cstring>
+#include <algorithm>
 
 /*! \defgroup capi_mem Memory services.
  *  \ingroup capi
@@ -162,6 +166,88 @@ NANOS_API_DEF(void, nanos_free0, ( void *p ))
    nanos_free(p);
 }
 
+/*! \brief Allocates memory whose pages are placed in the NUMA nodes of the team
+ *
+ *  The memory is mapped directly from the OS and must be released with
+ *  nanos_numa_free. Pages are bound through hwloc when the runtime was built
+ *  with it, and the home node of the data is recorded so that the socket
+ *  scheduler can run the tasks that access it (through their copies) in that node.
+ *
+ *  \param [out] p Allocated memory, page aligned
+ *  \param [in] size Size in bytes
+ *  \param [in] policy NANOS_NUMA_BIND: all pages in node;
+ *                     NANOS_NUMA_INTERLEAVE: pages interleaved across the nodes;
+ *                     NANOS_NUMA_BLOCK: one contiguous block per node, in node order;
+ *                     NANOS_NUMA_FIRST_TOUCH: left to the first access, see nanos_numa_first_touch
+ *  \param [in] node Node of NANOS_NUMA_BIND, as in nanos_current_socket; ignored by the other policies
+ */
+NANOS_API_DEF(nanos_err_t, nanos_numa_malloc, ( void **p, size_t size, nanos_numa_policy_t policy, int node, const char *file, int line ))
+{
+   NANOS_INSTRUMENT( InstrumentStateAndBurst inst("api","numa_malloc",NANOS_RUNTIME ) );
+
+   if ( policy == NANOS_NUMA_BIND && ( node < 0 || node >= (int) std::max( nanos::sys.getNumNumaNodes(), 1U ) ) ) {
+      return NANOS_INVALID_PARAM;
+   }
+
+   try
+   {
+      *p = nanos::sys.getNumaPlacement().allocate( size, policy, node );
+      if ( *p == NULL ) return NANOS_ENOMEM;
+   } catch ( nanos_err_t e ) {
+      return e;
+   }
+
+   return NANOS_OK;
+}
+
+/*! \brief Makes wd the task that first touches [p, p+size)
+ *
+ *  Meant for the initialization task of memory allocated with
+ *  NANOS_NUMA_FIRST_TOUCH, before it is submitted. The node of wd becomes
+ *  the home of the data; if it has none, the nodes are given in round robin.
+ */
+NANOS_API_DEF(nanos_err_t, nanos_numa_first_touch, ( void *p, size_t size, nanos_wd_t wd ))
+{
+   NANOS_INSTRUMENT( InstrumentStateAndBurst inst("api","numa_first_touch",NANOS_RUNTIME ) );
+
+   try
+   {
+      nanos::sys.getNumaPlacement().firstTouch( p, size, *( nanos::WD * ) wd );
+   } catch ( nanos_err_t e ) {
+      return e;
+   }
+
+   return NANOS_OK;
+}
+
+NANOS_API_DEF(nanos_err_t, nanos_numa_free, ( void *p ))
+{
+   NANOS_INSTRUMENT( InstrumentStateAndBurst inst("api","numa_free",NANOS_RUNTIME ) );
+
+   try
+   {
+      if ( !nanos::sys.getNumaPlacement().free( p ) ) return NANOS_INVALID_PARAM;
+   } catch ( nanos_err_t e ) {
+      return e;
+   }
+
+   return NANOS_OK;
+}
+
+/*! \brief Home node of most of [p, p+size), or -1 if it has none
+ */
+NANOS_API_DEF(nanos_err_t, nanos_numa_get_home, ( const void *p, size_t size, int *node ))
+{
+   try
+   {
+      *node = nanos::sys.getNumaPlacement().getHomeNode( p, size );
+   } catch ( nanos_err_t e ) {
+      return e;
+   }
+
+   return NANOS_OK;
+}
+
 NANOS_API_DEF(nanos_err_t, nanos_memcpy, (void *dest, const void *src, size_t n))
 {
     std::memcpy(dest, src, n);
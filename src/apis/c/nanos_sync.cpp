@@ -28,6 +28,7 @@
 #include "synchronizedcondition.hpp"
 #include "instrumentationmodule_decl.hpp"
 #include "instrumentation.hpp"
+#include "queuelock.hpp"
 
 /*! \defgroup capi_sync Synchronization services.
  *  \ingroup capi
@@ -185,7 +186,7 @@ NANOS_API_DEF(nanos_err_t, nanos_init_lock, ( nanos_lock_t **lock ))
    NANOS_INSTRUMENT( sys.getInstrumentation()->raisePointEvents(1, &Keys, &Values); )
 
    try {
-      *lock = NEW Lock();
+      *lock = NEW TicketLock();
    } catch ( nanos_err_t e) {
       return e;
    }
@@ -204,7 +205,7 @@ NANOS_API_DEF(nanos_err_t, nanos_init_lock_at, ( nanos_lock_t *lock ))
    NANOS_INSTRUMENT( sys.getInstrumentation()->raisePointEvents(1, &Keys, &Values); )
 
    try {
-      new ( lock ) Lock();
+      new ( lock ) TicketLock();
    } catch ( nanos_err_t e) {
       return e;
    }
@@ -223,8 +224,8 @@ NANOS_API_DEF(nanos_err_t, nanos_set_lock, ( nanos_lock_t *lock ))
    NANOS_INSTRUMENT( sys.getInstrumentation()->raisePointEvents(1, &Keys, &Values); )
 
    try {
-      Lock &l = *( Lock * ) lock;
-      l++;
+      TicketLock &l = *( TicketLock * ) lock;
+      l.acquire();
    } catch ( nanos_err_t e) {
       return e;
    }
@@ -243,8 +244,8 @@ NANOS_API_DEF(nanos_err_t, nanos_unset_lock, ( nanos_lock_t *lock ))
    NANOS_INSTRUMENT( sys.getInstrumentation()->raisePointEvents(1, &Keys, &Values); )
 
    try {
-      Lock &l = *( Lock * ) lock;
-      l--;
+      TicketLock &l = *( TicketLock * ) lock;
+      l.release();
    } catch ( nanos_err_t e) {
       return e;
    }
@@ -263,7 +264,7 @@ NANOS_API_DEF(nanos_err_t, nanos_try_lock, ( nanos_lock_t *lock, bool *result ))
    NANOS_INSTRUMENT( sys.getInstrumentation()->raisePointEvents(1, &Keys, &Values); )
 
    try {
-      Lock &l = *( Lock * ) lock;
+      TicketLock &l = *( TicketLock * ) lock;
 
       *result = l.tryAcquire();
    } catch ( nanos_err_t e) {
@@ -284,7 +285,7 @@ NANOS_API_DEF(nanos_err_t, nanos_destroy_lock, ( nanos_lock_t *lock ))
    NANOS_INSTRUMENT( sys.getInstrumentation()->raisePointEvents(1, &Keys, &Values); )
 
    try {
-      delete ( Lock * )lock;
+      delete ( TicketLock * )lock;
    } catch ( nanos_err_t e) {
       return e;
    }
@@ -21,6 +21,7 @@
 //! \brief Nanos++ services related with WorkDescriptor 
 
 #include "nanos.h"
+#include "nanos_reduction.h"
 #include "basethread.hpp"
 #include "debug.hpp"
 #include "system.hpp"
@@ -241,6 +242,75 @@ NANOS_API_DEF(nanos_err_t, nanos_submit, ( nanos_wd_t uwd, size_t num_data_acces
    return NANOS_OK;
 }
 
+/*! \brief Submit a set of WorkDescriptors
+ *
+ *  Equivalent to calling nanos_submit for each WD, but the dependences of all
+ *  of them are registered at once and the ready ones are queued together.
+ *
+ *  \param num_wds Number of WDs
+ *  \param uwds WDs to submit
+ *  \param num_data_accesses Number of data accesses of each WD (NULL if none has dependences)
+ *  \param data_accesses Data accesses of each WD (NULL if none has dependences)
+ *  \param team Must be NULL
+ *  \sa nanos::WorkDescriptor
+ */
+NANOS_API_DEF(nanos_err_t, nanos_submit_batch, ( size_t num_wds, nanos_wd_t *uwds, size_t *num_data_accesses, nanos_data_access_t **data_accesses, nanos_team_t team ))
+{
+   NANOS_INSTRUMENT( InstrumentStateAndBurst inst("api","submit_batch",NANOS_SCHEDULING) );
+
+   try {
+      ensure( uwds,"NULL WD array received" );
+
+      if ( team != NULL ) {
+         warning( "Submitting to another team not implemented yet" );
+      }
+
+      WD **wds = ( WD ** ) uwds;
+      WD *current = myThread->getCurrentWD();
+
+      NANOS_INSTRUMENT ( static InstrumentationDictionary *ID = sys.getInstrumentation()->getInstrumentationDictionary(); )
+
+      NANOS_INSTRUMENT ( static nanos_event_key_t create_wd_id = ID->getEventKey("create-wd-id"); )
+      NANOS_INSTRUMENT ( static nanos_event_key_t create_wd_ptr = ID->getEventKey("create-wd-ptr"); )
+      NANOS_INSTRUMENT ( static nanos_event_key_t wd_num_deps = ID->getEventKey("wd-num-deps"); )
+      NANOS_INSTRUMENT ( static nanos_event_key_t wd_deps_ptr = ID->getEventKey("wd-deps-ptr"); )
+
+      NANOS_INSTRUMENT ( nanos_event_key_t Keys[4]; )
+      NANOS_INSTRUMENT ( nanos_event_value_t Values[4]; )
+
+      NANOS_INSTRUMENT ( Keys[0] = create_wd_id; )
+      NANOS_INSTRUMENT ( Keys[1] = create_wd_ptr; )
+      NANOS_INSTRUMENT ( Keys[2] = wd_num_deps; )
+      NANOS_INSTRUMENT ( Keys[3] = wd_deps_ptr; )
+
+      for ( size_t i = 0; i < num_wds; i++ ) {
+         ensure( wds[i],"NULL WD received" );
+         WD *wd = wds[i];
+
+         if ( sys.getVerboseCopies() ) {
+            *myThread->_file << "Submitting WD " << wd->getId() << " " << (wd->getDescription() == NULL ? "n/a" : wd->getDescription()) << std::endl;
+         }
+
+         sys.setupWD( *wd, current );
+
+         NANOS_INSTRUMENT ( Values[0] = (nanos_event_value_t) wd->getId(); )
+         NANOS_INSTRUMENT ( Values[1] = (nanos_event_value_t) wd; )
+         NANOS_INSTRUMENT ( Values[2] = (nanos_event_value_t) ( num_data_accesses == NULL ? 0 : num_data_accesses[i] ); )
+         NANOS_INSTRUMENT ( Values[3] = (nanos_event_value_t) ( data_accesses == NULL ? NULL : data_accesses[i] ); )
+
+         NANOS_INSTRUMENT( sys.getInstrumentation()->raisePointEvents(4, Keys, Values); )
+
+         NANOS_INSTRUMENT (sys.getInstrumentation()->raiseOpenPtPEvent ( NANOS_WD_DOMAIN, (nanos_event_id_t) wd->getId(), 0, 0 );)
+      }
+
+      sys.submitBatch( num_wds, wds, num_data_accesses, data_accesses );
+   } catch ( nanos_err_t e) {
+      return e;
+   }
+
+   return NANOS_OK;
+}
+
 
 /*! \brief Creates a new WorkDescriptor and execute it inmediately
  *
@@ -618,12 +688,61 @@ NANOS_API_DEF (nanos_err_t, nanos_task_fortran_array_reduction_register, ( void
 }
 
 
+//! \brief Built-in reducers of nanos_reduction.h the runtime knows the operator of
+static const struct {
+   void ( *reducer ) ( void *, void * );
+   nanos_reduction_op_t op;
+   nanos_reduction_type_t type;
+} builtinReducers[] = {
+   { nanos_reduction_bop_add_int, NANOS_REDUCTION_ADD, NANOS_REDUCTION_INT },
+   { nanos_reduction_bop_add_float, NANOS_REDUCTION_ADD, NANOS_REDUCTION_FLOAT },
+   { nanos_reduction_bop_add_double, NANOS_REDUCTION_ADD, NANOS_REDUCTION_DOUBLE },
+   { nanos_reduction_bop_prod_int, NANOS_REDUCTION_PROD, NANOS_REDUCTION_INT },
+   { nanos_reduction_bop_prod_float, NANOS_REDUCTION_PROD, NANOS_REDUCTION_FLOAT },
+   { nanos_reduction_bop_prod_double, NANOS_REDUCTION_PROD, NANOS_REDUCTION_DOUBLE },
+   { nanos_reduction_bop_min_int, NANOS_REDUCTION_MIN, NANOS_REDUCTION_INT },
+   { nanos_reduction_bop_min_float, NANOS_REDUCTION_MIN, NANOS_REDUCTION_FLOAT },
+   { nanos_reduction_bop_min_double, NANOS_REDUCTION_MIN, NANOS_REDUCTION_DOUBLE },
+   { nanos_reduction_bop_max_int, NANOS_REDUCTION_MAX, NANOS_REDUCTION_INT },
+   { nanos_reduction_bop_max_float, NANOS_REDUCTION_MAX, NANOS_REDUCTION_FLOAT },
+   { nanos_reduction_bop_max_double, NANOS_REDUCTION_MAX, NANOS_REDUCTION_DOUBLE },
+};
+
 NANOS_API_DEF (nanos_err_t, nanos_task_reduction_register, ( void *orig, size_t size_target, size_t size_elem,
          void (*init)( void *, void * ), void (*reducer)( void *, void * ) ) )
 {
    NANOS_INSTRUMENT( InstrumentStateAndBurst inst("api","task_reduction_register",NANOS_RUNTIME) );
    try {
-       myThread->getCurrentWD()->registerTaskReduction( orig, size_target, size_elem, init, reducer );
+      //! The compiler may pass one of our own reducers, then the operator is known
+      nanos_reduction_op_t op = NANOS_REDUCTION_USER_OP;
+      nanos_reduction_type_t type = NANOS_REDUCTION_INT;
+      for ( size_t i = 0; i < sizeof( builtinReducers ) / sizeof( builtinReducers[0] ); i++ ) {
+         if ( builtinReducers[i].reducer == reducer ) {
+            op = builtinReducers[i].op;
+            type = builtinReducers[i].type;
+            break;
+         }
+      }
+      myThread->getCurrentWD()->registerTaskReduction( orig, size_target, size_elem, init, reducer, op, type );
+   } catch ( nanos_err_t e) {
+      return e;
+   }
+   return NANOS_OK;
+}
+
+/*! \brief Registers a task reduction whose operator is a built-in one
+ *
+ *  Same as nanos_task_reduction_register, but the runtime may combine the private
+ *  copies with its own code for op on elements of the given type instead of
+ *  calling reducer for each element.
+ */
+NANOS_API_DEF (nanos_err_t, nanos_task_reduction_register_builtin, ( void *orig, size_t size_target, size_t size_elem,
+         void (*init)( void *, void * ), void (*reducer)( void *, void * ),
+         nanos_reduction_op_t op, nanos_reduction_type_t type ) )
+{
+   NANOS_INSTRUMENT( InstrumentStateAndBurst inst("api","task_reduction_register",NANOS_RUNTIME) );
+   try {
+      myThread->getCurrentWD()->registerTaskReduction( orig, size_target, size_elem, init, reducer, op, type );
    } catch ( nanos_err_t e) {
       return e;
    }
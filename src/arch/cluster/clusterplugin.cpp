@@ -63,7 +63,8 @@ ClusterPlugin::ClusterPlugin() : ArchPlugin( "Cluster PE Plugin", 1 ),
    _nodeMem( DEFAULT_NODE_MEM ), _allocFit( false ), _allowSharedThd( false ),
    _unalignedNodeMem( false ), _gpuPresend( 1 ), _smpPresend( 1 ),
    _cachePolicy( System::DEFAULT ), _remoteNodes( NULL ), _cpu( NULL ),
-   _clusterThread( NULL ), _gasnetSegmentSize( 0 ) {
+   _clusterThread( NULL ), _gasnetSegmentSize( 0 ), _amBatch( false ), _amBatchSize( 0 ),
+   _amBatchTimeout( 100 ) {
 }
 
 void ClusterPlugin::config( Config& cfg )
@@ -74,6 +75,7 @@ void ClusterPlugin::config( Config& cfg )
 
 void ClusterPlugin::init()
 {
+   _gasnetApi->setMessageBatching( _amBatch, _amBatchSize, _amBatchTimeout );
    _gasnetApi->initialize( sys.getNetwork() );
    //sys.getNetwork()->setAPI(_gasnetApi);
    _gasnetApi->setGASNetSegmentSize( _gasnetSegmentSize );
@@ -226,6 +228,18 @@ void ClusterPlugin::prepare( Config& cfg ) {
    cfg.registerArgOption ( "gasnet-segment", "gasnet-segment-size" );
    cfg.registerEnvOption ( "gasnet-segment", "NX_GASNET_SEGMENT_SIZE" );
 
+   cfg.registerConfigOption ( "cluster-am-batch", NEW Config::FlagOption ( _amBatch ), "Pack the WD dispatches and work-done notifications to each node in batches." );
+   cfg.registerArgOption ( "cluster-am-batch", "cluster-am-batch" );
+   cfg.registerEnvOption ( "cluster-am-batch", "NX_CLUSTER_AM_BATCH" );
+
+   cfg.registerConfigOption ( "cluster-am-batch-size", NEW Config::SizeVar ( _amBatchSize ), "Maximum bytes of a batch of messages, 0 for the largest medium message (default)." );
+   cfg.registerArgOption ( "cluster-am-batch-size", "cluster-am-batch-size" );
+   cfg.registerEnvOption ( "cluster-am-batch-size", "NX_CLUSTER_AM_BATCH_SIZE" );
+
+   cfg.registerConfigOption ( "cluster-am-batch-timeout", NEW Config::UintVar ( _amBatchTimeout ), "Microseconds a message can wait in a batch before it is sent (100 by default)." );
+   cfg.registerArgOption ( "cluster-am-batch-timeout", "cluster-am-batch-timeout" );
+   cfg.registerEnvOption ( "cluster-am-batch-timeout", "NX_CLUSTER_AM_BATCH_TIMEOUT" );
+
 }
 
 ProcessingElement * ClusterPlugin::createPE( unsigned id, unsigned uid ){
@@ -48,6 +48,9 @@ class ClusterPlugin : public ArchPlugin
       ext::SMPProcessor *_cpu;
       ext::SMPMultiThread *_clusterThread;
       std::size_t _gasnetSegmentSize;
+      bool _amBatch;
+      std::size_t _amBatchSize;
+      unsigned int _amBatchTimeout;
 
    public:
       ClusterPlugin();
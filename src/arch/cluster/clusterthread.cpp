@@ -63,7 +63,7 @@ void ClusterThread::RunningWDQueue::clearCompletedWDs( ClusterThread *self ) {
    {
       WD *completedWD = _completedWDs[pos];
       Scheduler::postOutlineWork( completedWD, false, self );
-      delete[] (char *) completedWD;
+      WD::destroy( completedWD, /* callDestructor */ false );
       _completedWDs[pos] =(WD *) 0xdeadbeef;
       pos = (pos+1) % MAX_PRESEND;
       lowval += 1;
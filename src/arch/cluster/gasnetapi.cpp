@@ -34,6 +34,7 @@
 #include "osallocator_decl.hpp"
 #include "requestqueue.hpp"
 #include "atomic.hpp"
+#include "lock.hpp"
 #include "netwd_decl.hpp"
 #include <cstddef>
 
@@ -71,6 +72,9 @@ using namespace ext;
 
 #define _emitPtPEvents 1
 
+//! Batched messages start at multiples of this, so serialized WDs keep their alignment
+#define BATCH_ALIGN 16
+#define BATCH_ROUND( _Size ) ( ( ( _Size ) + BATCH_ALIGN - 1 ) & ~( (std::size_t) BATCH_ALIGN - 1 ) )
 
 
 GASNetAPI::WorkBufferManager::WorkBufferManager() : _buffers(), _lock() {
@@ -105,6 +109,14 @@ char *GASNetAPI::WorkBufferManager::get(unsigned int wdId, std::size_t totalLen,
    return data;
 }
 
+GASNetAPI::MessageBatch::MessageBatch( std::size_t size ) : _lock(), _buffer( NEW char[ size ] ), _used( 0 ),
+   _count( 0 ), _firstTime( 0.0 ) {
+}
+
+GASNetAPI::MessageBatch::~MessageBatch() {
+   delete[] _buffer;
+}
+
 GASNetAPI *GASNetAPI::_instance = 0;
 
 GASNetAPI *GASNetAPI::getInstance() {
@@ -129,6 +141,11 @@ GASNetAPI::GASNetAPI() : _net( 0 ),
    _nodeBarrierCounter( 0 ),
    _GASNetSegmentSize( 0 ),
    _unalignedNodeMemory( false ),
+   _batchMessages( false ),
+   _batchSize( 0 ),
+   _batchTimeout( 0.0 ),
+   _workBatches(),
+   _workDoneBatches(),
    _rwgs( 0 ) {
    _instance = this;
 }
@@ -288,9 +305,18 @@ void GASNetAPI::checkForFreeBufferReqs()
 void GASNetAPI::checkWorkDoneReqs()
 {
    std::pair<void const *, unsigned int> *rwd = _workDoneReqs.tryFetch();
-   if ( rwd != NULL ) {
-      _sendWorkDoneMsg( rwd->second, rwd->first );
+   if ( !_batchMessages ) {
+      if ( rwd != NULL ) {
+         _sendWorkDoneMsg( rwd->second, rwd->first );
+         delete rwd;
+      }
+      return;
+   }
+   /* drain the queue, notifications for the same node go in one message */
+   while ( rwd != NULL ) {
+      batchWorkDoneMsg( rwd->second, rwd->first );
       delete rwd;
+      rwd = _workDoneReqs.tryFetch();
    }
 }
 
@@ -352,6 +378,39 @@ void GASNetAPI::amWork(gasnet_token_t token, void *arg, std::size_t argSize,
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " done." << std::endl; );
 }
 
+void GASNetAPI::amWorkBatch( gasnet_token_t token, void *buff, std::size_t len, gasnet_handlerarg_t count )
+{
+   DisableAM c;
+   gasnet_node_t src_node;
+   VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << std::endl; );
+   if (gasnet_AMGetMsgSource(token, &src_node) != GASNET_OK)
+   {
+      fprintf(stderr, "gasnet: Error obtaining node information.\n");
+   }
+
+   /* the message buffer is not aligned, work on an aligned copy */
+   char *batch = NEW char[ len ];
+   memcpy( batch, buff, len );
+
+   std::size_t offset = 0;
+   for ( int i = 0; i < count; i += 1 ) {
+      WorkBatchRecord *record = ( WorkBatchRecord * ) &batch[ offset ];
+      Net2WD nwd( &batch[ offset + BATCH_ROUND( sizeof( WorkBatchRecord ) ) ], record->_size, getInstance()->_rwgs[src_node] );
+
+      if ( _emitPtPEvents ) {
+         NANOS_INSTRUMENT ( static Instrumentation *instr = sys.getInstrumentation(); )
+         NANOS_INSTRUMENT ( nanos_event_id_t id = (nanos_event_id_t) ( nwd.getWD()->getRemoteAddr() ) ; )
+         NANOS_INSTRUMENT ( instr->raiseClosePtPEvent( NANOS_AM_WORK, id, 0, 0, src_node ); )
+      }
+
+      getInstance()->_net->notifyWork( record->_expectedData, nwd.getWD(), record->_seq );
+      offset += BATCH_ROUND( sizeof( WorkBatchRecord ) ) + BATCH_ROUND( record->_size );
+   }
+
+   delete[] batch;
+   VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " done." << std::endl; );
+}
+
 void GASNetAPI::amWorkData(gasnet_token_t token, void *buff, std::size_t len,
       gasnet_handlerarg_t wdId,
       gasnet_handlerarg_t msgNum,
@@ -394,6 +453,31 @@ void GASNetAPI::amWorkDone( gasnet_token_t token, gasnet_handlerarg_t addrLo, ga
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " from "<< src_node <<" host wd addr "<< (void *) addr <<" done." << std::endl; );
 }
 
+void GASNetAPI::amWorkDoneBatch( gasnet_token_t token, void *buff, std::size_t len, gasnet_handlerarg_t count )
+{
+   DisableAM c;
+   gasnet_node_t src_node;
+   VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << std::endl; );
+   if ( gasnet_AMGetMsgSource( token, &src_node ) != GASNET_OK )
+   {
+      fprintf( stderr, "gasnet: Error obtaining node information.\n" );
+   }
+
+   for ( int i = 0; i < count; i += 1 ) {
+      uint64_t addr;
+      memcpy( &addr, &( ( char * ) buff )[ i * sizeof( uint64_t ) ], sizeof( uint64_t ) );
+
+      if ( _emitPtPEvents ) {
+         NANOS_INSTRUMENT ( static Instrumentation *instr = sys.getInstrumentation(); )
+         NANOS_INSTRUMENT ( nanos_event_id_t id = (nanos_event_id_t) ( addr ) ; )
+         NANOS_INSTRUMENT ( instr->raiseClosePtPEvent( NANOS_AM_WORK_DONE, id, 0, 0, src_node ); )
+      }
+
+      sys.getNetwork()->notifyWorkDone( src_node, ( void * ) ( uintptr_t ) addr, 0 );
+   }
+   VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " done." << std::endl; );
+}
+
 void GASNetAPI::amMalloc( gasnet_token_t token, gasnet_handlerarg_t sizeLo, gasnet_handlerarg_t sizeHi,
       gasnet_handlerarg_t waitObjAddrLo, gasnet_handlerarg_t waitObjAddrHi )
 {
@@ -937,7 +1021,9 @@ void GASNetAPI::initialize ( Network *net )
       { 223, (void (*)()) amGetReplyStrided1D },
       { 224, (void (*)()) amRegionMetadata },
       { 225, (void (*)()) amSynchronizeDirectory },
-      { 226, (void (*)()) amIdle }
+      { 226, (void (*)()) amIdle },
+      { 227, (void (*)()) amWorkBatch },
+      { 228, (void (*)()) amWorkDoneBatch }
    };
 
    gasnet_init( &my_argc, &my_argv );
@@ -953,6 +1039,18 @@ void GASNetAPI::initialize ( Network *net )
    _net->setNumNodes( gasnet_nodes() );
    _net->setNodeNum( gasnet_mynode() );
 
+   if ( _batchMessages ) {
+      if ( _batchSize == 0 || _batchSize > gasnet_AMMaxMedium() ) {
+         _batchSize = gasnet_AMMaxMedium();
+      }
+      _workBatches.reserve( gasnet_nodes() );
+      _workDoneBatches.reserve( gasnet_nodes() );
+      for ( unsigned int node = 0; node < gasnet_nodes(); node += 1 ) {
+         _workBatches.push_back( NEW MessageBatch( _batchSize ) );
+         _workDoneBatches.push_back( NEW MessageBatch( _batchSize ) );
+      }
+   }
+
    nodeBarrier();
   
    {
@@ -1043,6 +1141,7 @@ void GASNetAPI::poll ()
       checkForPutReqs();
       checkForFreeBufferReqs();
       checkWorkDoneReqs();
+      if ( _batchMessages ) flushBatches( false );
    } else if ( myThread == NULL ) {
       gasnet_AMPoll();
    }
@@ -1050,6 +1149,7 @@ void GASNetAPI::poll ()
 
 void GASNetAPI::sendExitMsg ( unsigned int dest )
 {
+   if ( _batchMessages ) flushBatches( true );
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amFinalize" << std::endl; );
    if (gasnet_AMRequestShort0( dest, 203 ) != GASNET_OK)
    {
@@ -1064,6 +1164,18 @@ void GASNetAPI::sendWorkMsg ( unsigned int dest, WorkDescriptor const &wd, std::
    std::size_t sent = 0;
    unsigned int msgCount = 0;
 
+   if ( _batchMessages ) {
+      std::size_t wdSize = SerializedWDFields::getTotalSize( wd );
+      if ( BATCH_ROUND( sizeof( WorkBatchRecord ) ) + BATCH_ROUND( wdSize ) <= _batchSize ) {
+         batchWorkMsg( dest, wd, wdSize, expectedData );
+         return;
+      }
+      /* too big to be batched, send what is pending first to keep the order */
+      MessageBatch &batch = *_workBatches[ dest ];
+      LockBlock guard( batch._lock );
+      sendBatch( dest, batch, 227 );
+   }
+
    WD2Net nwd( wd );
 
    while ( (nwd.getBufferSize() - sent) > gasnet_AMMaxMedium() )
@@ -1104,6 +1216,100 @@ void GASNetAPI::sendWorkMsg ( unsigned int dest, WorkDescriptor const &wd, std::
    VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send amWork done" << std::endl; );
 }
 
+void GASNetAPI::batchWorkMsg( unsigned int dest, WorkDescriptor const &wd, std::size_t wdSize, std::size_t expectedData )
+{
+   std::size_t recordSize = BATCH_ROUND( sizeof( WorkBatchRecord ) ) + BATCH_ROUND( wdSize );
+   MessageBatch &batch = *_workBatches[ dest ];
+
+   if ( _emitPtPEvents ) {
+      NANOS_INSTRUMENT ( static Instrumentation *instr = sys.getInstrumentation(); )
+      NANOS_INSTRUMENT ( nanos_event_id_t id = (nanos_event_id_t) ( &wd ) ; )
+      NANOS_INSTRUMENT ( instr->raiseOpenPtPEvent( NANOS_AM_WORK, id, 0, 0, dest ); )
+   }
+
+   LockBlock guard( batch._lock );
+   if ( batch._used + recordSize > _batchSize ) {
+      sendBatch( dest, batch, 227 );
+   }
+   if ( batch._count == 0 ) {
+      batch._firstTime = OS::getMonotonicTime();
+   }
+
+   WorkBatchRecord *record = ( WorkBatchRecord * ) &batch._buffer[ batch._used ];
+   record->_size = wdSize;
+   record->_expectedData = expectedData;
+   /* taken with the batch lock held so sequence numbers follow the batch order */
+   record->_seq = _seqN[dest]++;
+   WD2Net::serialize( wd, &batch._buffer[ batch._used + BATCH_ROUND( sizeof( WorkBatchRecord ) ) ] );
+
+   batch._used += recordSize;
+   batch._count += 1;
+}
+
+void GASNetAPI::batchWorkDoneMsg( unsigned int dest, void const *remoteWdAddr )
+{
+   MessageBatch &batch = *_workDoneBatches[ dest ];
+   uint64_t addr = ( uint64_t ) ( uintptr_t ) remoteWdAddr;
+
+   if ( _emitPtPEvents ) {
+      NANOS_INSTRUMENT ( static Instrumentation *instr = sys.getInstrumentation(); )
+      NANOS_INSTRUMENT ( nanos_event_id_t id = (nanos_event_id_t) ( remoteWdAddr ) ; )
+      NANOS_INSTRUMENT ( instr->raiseOpenPtPEvent( NANOS_AM_WORK_DONE, id, 0, 0, dest ); )
+   }
+
+   LockBlock guard( batch._lock );
+   if ( batch._used + sizeof( uint64_t ) > _batchSize ) {
+      sendBatch( dest, batch, 228 );
+   }
+   if ( batch._count == 0 ) {
+      batch._firstTime = OS::getMonotonicTime();
+   }
+   memcpy( &batch._buffer[ batch._used ], &addr, sizeof( uint64_t ) );
+   batch._used += sizeof( uint64_t );
+   batch._count += 1;
+}
+
+//! \brief Sends the messages in batch as a single medium message, the batch lock must be held
+void GASNetAPI::sendBatch( unsigned int dest, MessageBatch &batch, gasnet_handler_t handler )
+{
+   if ( batch._count == 0 ) return;
+
+   VERBOSE_AM( (myThread != NULL ? (*myThread->_file) : std::cerr) << __FUNCTION__ << " send " << batch._count << " messages" << std::endl; );
+   if ( gasnet_AMRequestMedium1( dest, handler, batch._buffer, batch._used, batch._count ) != GASNET_OK )
+   {
+      fprintf(stderr, "gasnet: Error sending a message to node %d.\n", dest);
+   }
+   batch._used = 0;
+   batch._count = 0;
+}
+
+/*! \brief Sends the batches that should not wait any longer
+ *
+ *  With all set every non empty batch is sent. Otherwise a batch is sent once
+ *  its oldest message reached the batch timeout, busy batches are skipped.
+ */
+void GASNetAPI::flushBatches( bool all )
+{
+   double now = all ? 0.0 : OS::getMonotonicTime();
+
+   for ( unsigned int node = 0; node < _workBatches.size(); node += 1 ) {
+      for ( unsigned int kind = 0; kind < 2; kind += 1 ) {
+         MessageBatch &batch = ( kind == 0 ) ? *_workBatches[ node ] : *_workDoneBatches[ node ];
+         if ( batch._count == 0 ) continue;
+
+         if ( all ) {
+            batch._lock.acquire();
+         } else if ( !batch._lock.tryAcquire() ) {
+            continue;
+         }
+         if ( all || now - batch._firstTime >= _batchTimeout ) {
+            sendBatch( node, batch, ( kind == 0 ) ? 227 : 228 );
+         }
+         batch._lock.release();
+      }
+   }
+}
+
 void GASNetAPI::sendWorkDoneMsg ( unsigned int dest, void const *remoteWdAddr )
 {
    std::pair<void const *, unsigned int> *rwd = NEW std::pair<void const *, unsigned int> ( remoteWdAddr, dest );
@@ -1625,3 +1831,9 @@ void GASNetAPI::setGASNetSegmentSize( std::size_t segmentSize ) {
 void GASNetAPI::setUnalignedNodeMemory( bool flag ) {
    _unalignedNodeMemory = flag;
 }
+
+void GASNetAPI::setMessageBatching( bool enabled, std::size_t size, unsigned int timeoutUs ) {
+   _batchMessages = enabled;
+   _batchSize = size;
+   _batchTimeout = ( double ) timeoutUs * 1e-6;
+}
@@ -27,6 +27,7 @@
 #include "simpleallocator_decl.hpp"
 #include "requestqueue_decl.hpp"
 #include "remoteworkdescriptor_decl.hpp"
+#include "lock_decl.hpp"
 #include <vector>
 
 extern "C" {
@@ -160,10 +161,38 @@ namespace ext {
          std::size_t _txBytes;
          std::size_t _totalBytes;
 
+         /*! \brief Messages of one kind waiting to be sent to a node in a single medium message
+          *
+          *  A batch is sent when the next message does not fit in it or when its
+          *  oldest message has waited for the batch timeout.
+          */
+         struct MessageBatch {
+            Lock          _lock;
+            char         *_buffer;
+            std::size_t   _used;
+            unsigned int  _count;        //!< Messages in the batch
+            double        _firstTime;    //!< When the oldest message was added
+
+            MessageBatch( std::size_t size );
+            ~MessageBatch();
+         };
+
+         //! \brief Header of a WD in a batch, followed by the serialized WD
+         struct WorkBatchRecord {
+            std::size_t   _size;
+            std::size_t   _expectedData;
+            unsigned int  _seq;
+         };
+
          WorkBufferManager _incomingWorkBuffers;
          unsigned int _nodeBarrierCounter;
          std::size_t _GASNetSegmentSize;
          bool _unalignedNodeMemory;
+         bool _batchMessages;
+         std::size_t _batchSize;
+         double _batchTimeout;
+         std::vector< MessageBatch * > _workBatches;        //!< WD dispatches, one batch per node
+         std::vector< MessageBatch * > _workDoneBatches;    //!< Work-done notifications, one batch per node
 
       public:
          typedef RemoteWorkDescriptor *ArchRWDs[4]; //0: smp, 1: cuda, 2: opencl, 3: fpga
@@ -209,6 +238,7 @@ namespace ext {
 
          void setGASNetSegmentSize(std::size_t segmentSize);
          void setUnalignedNodeMemory(bool flag);
+         void setMessageBatching( bool enabled, std::size_t size, unsigned int timeoutUs );
 
       private:
          void _put ( unsigned int issueNode, unsigned int remoteNode, uint64_t remoteAddr, void *localAddr, std::size_t size, void *remoteTmpBuffer, unsigned int wdId, WD const *wd, void *hostObject, reg_t hostRegId, unsigned int metaSeq );
@@ -221,6 +251,10 @@ namespace ext {
          void checkForFreeBufferReqs();
          void checkWorkDoneReqs();
          unsigned int getPutRequestSequenceNumber( unsigned int dest );
+         void batchWorkMsg( unsigned int dest, WorkDescriptor const &wd, std::size_t wdSize, std::size_t expectedData );
+         void batchWorkDoneMsg( unsigned int dest, void const *remoteWdAddr );
+         void sendBatch( unsigned int dest, MessageBatch &batch, gasnet_handler_t handler );
+         void flushBatches( bool all );
 
          // Active Message handlers
          static void amFinalize( gasnet_token_t token );
@@ -239,6 +273,8 @@ namespace ext {
                gasnet_handlerarg_t totalLenHi);
                   
          static void amWorkDone( gasnet_token_t token, gasnet_handlerarg_t addrLo, gasnet_handlerarg_t addrHi, gasnet_handlerarg_t peId );
+         static void amWorkBatch( gasnet_token_t token, void *buff, std::size_t len, gasnet_handlerarg_t count );
+         static void amWorkDoneBatch( gasnet_token_t token, void *buff, std::size_t len, gasnet_handlerarg_t count );
          static void amMalloc( gasnet_token_t token, gasnet_handlerarg_t sizeLo, gasnet_handlerarg_t sizeHi,
                                 gasnet_handlerarg_t waitObjAddrLo, gasnet_handlerarg_t waitObjAddrHi );
          static void amMallocReply( gasnet_token_t token, gasnet_handlerarg_t addrLo, gasnet_handlerarg_t addrHi,
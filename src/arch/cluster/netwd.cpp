@@ -167,7 +167,11 @@ const char *SerializedWDFields::getDescriptionAddr() const {
 WD2Net::WD2Net( WD const &wd ) {
    _bufferSize = SerializedWDFields::getTotalSize( wd );
    _buffer = new char[ _bufferSize ];
-   SerializedWDFields *swd = ( SerializedWDFields * ) _buffer;
+   serialize( wd, _buffer );
+}
+
+void WD2Net::serialize( WD const &wd, char *buffer ) {
+   SerializedWDFields *swd = ( SerializedWDFields * ) buffer;
    swd->setup( wd );
 
    if ( wd.getDataSize() > 0 )
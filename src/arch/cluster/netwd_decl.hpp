@@ -44,6 +44,8 @@ namespace ext {
       ~WD2Net();
       char *getBuffer() const;
       std::size_t getBufferSize() const;
+      //! \brief Serializes wd in buffer, that must hold SerializedWDFields::getTotalSize( wd ) bytes
+      static void serialize( WD const &wd, char *buffer );
    };
 
    class Net2WD {
@@ -50,6 +50,8 @@ void SMPDD::prepareConfig ( Config &config )
    //! \note Get the stack size for this specific device
    config.registerConfigOption ( "smp-stack-size", NEW Config::SizeVar( _stackSize ), "Defines SMP::task stack size" );
    config.registerArgOption("smp-stack-size", "smp-stack-size");
+
+   SMPStackPool::config( config );
 }
 
 void SMPDD::initStack ( WD *wd )
@@ -78,8 +80,8 @@ void SMPDD::lazyInit ( WD &wd, bool isUserLevelThread, WD *previous )
    verbose0("Task " << wd.getId() << " initialization"); 
    if (isUserLevelThread) {
       if (previous == NULL) {
-         _stack = (void *) NEW char[_stackSize];
-         verbose0("   new stack created: " << _stackSize << " bytes");
+         _stack = SMPStackPool::get();
+         verbose0("   stack taken from the pool: " << _stackSize << " bytes");
       } else {
          verbose0("   reusing stacks");
          SMPDD &oldDD = (SMPDD &) previous->getActiveDevice();
@@ -24,6 +24,7 @@
 #include "smpdevice_decl.hpp"
 #include "workdescriptor_fwd.hpp"
 #include "config.hpp"
+#include "smpstackpool.hpp"
 
 namespace nanos {
 namespace ext {
@@ -51,7 +52,7 @@ namespace ext {
          //! \brief Assignment operator
          const SMPDD & operator= ( const SMPDD &wd );
          //! \brief Destructor
-         virtual ~SMPDD() { if ( _stack ) delete[] (char *) _stack; }
+         virtual ~SMPDD() { if ( _stack ) SMPStackPool::put( _stack ); }
 
          bool hasStack() { return _state != NULL; }
 
@@ -70,6 +71,7 @@ namespace ext {
          void setState ( void * newState ) { _state = newState; }
 
          static void prepareConfig( Config &config );
+         static size_t getStackSize () { return _stackSize; }
 
          virtual void lazyInit (WD &wd, bool isUserLevelThread, WD *previous);
          virtual size_t size ( void ) { return sizeof(SMPDD); }
@@ -73,6 +73,14 @@ namespace nanos {
 
          void tryExecuteTransfer();
 
+         /*! \brief Sizes the asynchronous copy queues, once and before any thread runs
+          */
+         void initTransferQueues( unsigned int numNodes, std::size_t numSpaces ) { _transferQueue.init( numNodes, numSpaces ); }
+
+         /*! \brief Sets the NUMA node whose threads serve the asynchronous copies of a memory space
+          */
+         void setMemorySpaceNode( memory_space_id_t id, unsigned int numaNode ) { _transferQueue.setMemorySpaceNode( id, numaNode ); }
+
    };
 } // namespace nanos
 
@@ -150,12 +150,14 @@ nanos::PE * smpProcessorFactory ( int id, int uid )
             "SMP sync transfers." );
       cfg.registerArgOption( "smp-sync-transfers", "smp-sync-transfers" );
       cfg.registerEnvOption( "smp-sync-transfers", "NX_SMP_SYNC_TRANSFERS" );
+      SMPTransferQueue::prepareConfig( cfg );
    }
 
    void SMPPlugin::init()
    {
       sys.setHostFactory( smpProcessorFactory );
       sys.setSMPPlugin( this );
+      SMPStackPool::init( SMPDD::getStackSize() );
 
       //! \note Set initial CPU architecture variables
       _cpuSystemMask = OS::getSystemAffinity();
@@ -231,6 +233,15 @@ nanos::PE * smpProcessorFactory ( int id, int uid )
       }
 #endif
 
+      //! \note Size the copy queues of the private memory spaces created below
+      if ( _smpPrivateMemory && !_memkindSupport ) {
+         unsigned int numNodes = 1;
+         for ( std::vector<int>::iterator it = _bindings.begin(); it != _bindings.end(); it++ ) {
+            if ( sys._hwloc.isCpuAvailable( *it ) ) numNodes = std::max( numNodes, getNodeOfPE( *it ) + 1 );
+         }
+         ext::getSMPDevice().initTransferQueues( numNodes, sys.getSeparateMemoryAddressSpacesCount() + 1 + _bindings.size() );
+      }
+
       //! \note Create the SMPProcessors in _cpus array
       int count = 0;
       for ( std::vector<int>::iterator it = _bindings.begin(); it != _bindings.end(); it++ ) {
@@ -254,6 +265,7 @@ nanos::PE * smpProcessorFactory ( int id, int uid )
             SeparateMemoryAddressSpace &numaMem = sys.getSeparateMemory( id );
             numaMem.setSpecificData( NEW SimpleAllocator( ( uintptr_t ) a.allocate(_smpPrivateMemorySize), _smpPrivateMemorySize ) );
             numaMem.setAcceleratorNumber( sys.getNewAcceleratorId() );
+            ext::getSMPDevice().setMemorySpaceNode( id, numaNode );
             cpu = NEW SMPProcessor( *it, id, active, numaNode, socket );
          } else {
 
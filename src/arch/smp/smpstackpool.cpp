@@ -0,0 +1,152 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "smpstackpool.hpp"
+#include "debug.hpp"
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+
+using namespace nanos;
+using namespace nanos::ext;
+
+size_t SMPStackPool::_stackSize = 0;
+size_t SMPStackPool::_pageSize = 0;
+bool SMPStackPool::_guard = true;
+unsigned int SMPStackPool::_maxHot = 4;
+unsigned int SMPStackPool::_maxCached = 64;
+Atomic<size_t> SMPStackPool::_inUse( 0 );
+Atomic<size_t> SMPStackPool::_peakInUse( 0 );
+Atomic<size_t> SMPStackPool::_mapped( 0 );
+Atomic<size_t> SMPStackPool::_created( 0 );
+Atomic<size_t> SMPStackPool::_trimmed( 0 );
+
+__thread SMPStackPool::ThreadCache SMPStackPool::_cache = { NULL, 0, NULL, 0, NULL, 0 };
+
+void SMPStackPool::config ( Config &cfg )
+{
+   cfg.registerConfigOption( "smp-stack-no-guard", NEW Config::FlagOption( _guard, false ),
+                             "Do not protect SMP::task stacks with a guard page" );
+   cfg.registerArgOption( "smp-stack-no-guard", "smp-stack-no-guard" );
+
+   cfg.registerConfigOption( "smp-stack-hot", NEW Config::UintVar( _maxHot ),
+                             "Free SMP::task stacks per thread kept with their memory (default = 4)" );
+   cfg.registerArgOption( "smp-stack-hot", "smp-stack-hot" );
+   cfg.registerEnvOption( "smp-stack-hot", "NX_SMP_STACK_HOT" );
+
+   cfg.registerConfigOption( "smp-stack-cached", NEW Config::UintVar( _maxCached ),
+                             "Free SMP::task stacks per thread kept mapped besides the hot ones (default = 64)" );
+   cfg.registerArgOption( "smp-stack-cached", "smp-stack-cached" );
+   cfg.registerEnvOption( "smp-stack-cached", "NX_SMP_STACK_CACHED" );
+}
+
+void SMPStackPool::init ( size_t stackSize )
+{
+   ensure0( _created.value() == 0, "Stack size changed after the first stack was created" );
+
+   _pageSize = sysconf( _SC_PAGESIZE );
+   //! Whole pages, at least two: the topmost one links free stacks
+   _stackSize = std::max( ( stackSize + _pageSize - 1 ) & ~( _pageSize - 1 ), 2 * _pageSize );
+}
+
+void * SMPStackPool::map ()
+{
+   ensure0( _stackSize > 0, "Stack pool used before its initialization" );
+
+   size_t guardSize = _guard ? _pageSize : 0;
+   int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+#ifdef MAP_STACK
+   flags |= MAP_STACK;
+#endif
+
+   char *area = (char *) mmap( NULL, guardSize + _stackSize, PROT_READ | PROT_WRITE, flags, -1, 0 );
+   if ( area == MAP_FAILED ) throw(NANOS_ENOMEM);
+
+   //! Stacks grow downwards, so the guard is the lowest page
+   if ( guardSize > 0 && mprotect( area, guardSize, PROT_NONE ) != 0 ) {
+      warning0( "Could not protect the guard page of a task stack" );
+   }
+
+   _mapped++;
+   _created++;
+   stackTaken();
+   return area + guardSize;
+}
+
+void SMPStackPool::unmap ( void *stack )
+{
+   size_t guardSize = _guard ? _pageSize : 0;
+   munmap( (char *) stack - guardSize, guardSize + _stackSize );
+   _mapped--;
+}
+
+void SMPStackPool::trim ( void *stack )
+{
+   size_t length = _stackSize - _pageSize;
+#ifdef MADV_FREE
+   //! Pages are only reclaimed under memory pressure, and cheaply reused otherwise
+   if ( madvise( stack, length, MADV_FREE ) == 0 ) {
+      _trimmed++;
+      return;
+   }
+#endif
+   if ( madvise( stack, length, MADV_DONTNEED ) == 0 ) _trimmed++;
+}
+
+void SMPStackPool::trimPending ()
+{
+   ThreadCache &cache = _cache;
+
+   while ( cache._pending != NULL ) {
+      FreeStack *node = cache._pending;
+      cache._pending = node->_next;
+      trim( getStack( node ) );
+      node->_next = cache._cold;
+      cache._cold = node;
+      cache._numCold++;
+   }
+   cache._numPending = 0;
+}
+
+void SMPStackPool::releaseThread ()
+{
+   ThreadCache &cache = _cache;
+   FreeStack *lists[] = { cache._hot, cache._pending, cache._cold };
+
+   for ( unsigned int i = 0; i < sizeof( lists ) / sizeof( lists[0] ); i++ ) {
+      while ( lists[i] != NULL ) {
+         FreeStack *node = lists[i];
+         lists[i] = node->_next;
+         unmap( getStack( node ) );
+      }
+   }
+   cache._hot = cache._pending = cache._cold = NULL;
+   cache._numHot = cache._numPending = cache._numCold = 0;
+}
+
+SMPStackPool::Stats SMPStackPool::getStats ()
+{
+   Stats stats;
+   stats._inUse = _inUse.value();
+   stats._peakInUse = _peakInUse.value();
+   stats._mapped = _mapped.value();
+   stats._created = _created.value();
+   stats._trimmed = _trimmed.value();
+   return stats;
+}
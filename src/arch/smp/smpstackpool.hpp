@@ -0,0 +1,94 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_SMP_STACK_POOL
+#define _NANOS_SMP_STACK_POOL
+
+#include "smpstackpool_decl.hpp"
+#include "atomic.hpp"
+
+namespace nanos {
+namespace ext {
+
+inline SMPStackPool::FreeStack * SMPStackPool::getNode ( void *stack )
+{
+   return (FreeStack *) ( (char *) stack + _stackSize - _pageSize );
+}
+
+inline void * SMPStackPool::getStack ( FreeStack *node )
+{
+   return (char *) node - _stackSize + _pageSize;
+}
+
+inline void SMPStackPool::stackTaken ()
+{
+   size_t inUse = ++_inUse;
+   size_t peak;
+   while ( inUse > ( peak = _peakInUse.value() ) && !_peakInUse.cswap( peak, inUse ) );
+}
+
+inline void * SMPStackPool::get ()
+{
+   ThreadCache &cache = _cache;
+   FreeStack *node;
+
+   if ( cache._hot != NULL ) {
+      node = cache._hot;
+      cache._hot = node->_next;
+      cache._numHot--;
+   } else if ( cache._pending != NULL ) {
+      node = cache._pending;
+      cache._pending = node->_next;
+      cache._numPending--;
+   } else if ( cache._cold != NULL ) {
+      //! Trimmed pages are committed again as the task touches them
+      node = cache._cold;
+      cache._cold = node->_next;
+      cache._numCold--;
+   } else {
+      return map();
+   }
+
+   stackTaken();
+   return getStack( node );
+}
+
+inline void SMPStackPool::put ( void *stack )
+{
+   ThreadCache &cache = _cache;
+   _inUse--;
+
+   FreeStack *node = getNode( stack );
+   if ( cache._numHot < _maxHot ) {
+      node->_next = cache._hot;
+      cache._hot = node;
+      cache._numHot++;
+   } else if ( cache._numPending + cache._numCold < _maxCached ) {
+      node->_next = cache._pending;
+      cache._pending = node;
+      if ( ++cache._numPending == TRIM_BATCH ) trimPending();
+   } else {
+      unmap( stack );
+   }
+}
+
+} // namespace ext
+} // namespace nanos
+
+#endif
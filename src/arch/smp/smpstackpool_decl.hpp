@@ -0,0 +1,127 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_SMP_STACK_POOL_DECL
+#define _NANOS_SMP_STACK_POOL_DECL
+
+#include <cstddef>
+#include "atomic_decl.hpp"
+#include "config.hpp"
+
+namespace nanos {
+namespace ext {
+
+   /*! \class SMPStackPool
+    *  \brief Per-thread pool of user level thread stacks
+    *
+    *  Stacks are mmap'd, so their memory is only committed as it is touched, and
+    *  have an inaccessible guard page below them that turns an overflow into a
+    *  segmentation fault instead of a silent corruption of the heap.
+    *
+    *  Every thread keeps the stacks it frees in three lists. Up to _maxHot of them
+    *  are kept as they are and handed out first. The others wait in the pending
+    *  list until the thread is idle, or until TRIM_BATCH of them are pending, and
+    *  are then trimmed together with MADV_FREE (MADV_DONTNEED where not
+    *  available) and moved to the cold list. So an idle pool only keeps the
+    *  memory of the hot stacks, without freeing a task paying for a madvise.
+    *  Stacks are unmapped once the thread holds more than _maxCached pending
+    *  and cold ones, and when the thread exits. Free stacks are linked through
+    *  their topmost page, which is never trimmed.
+    */
+   class SMPStackPool
+   {
+      public:
+         struct Stats {
+            size_t         _inUse;           /**< Stacks currently given to tasks */
+            size_t         _peakInUse;       /**< Maximum of _inUse */
+            size_t         _mapped;          /**< Stacks currently mapped, in use or pooled */
+            size_t         _created;         /**< Stacks mapped so far */
+            size_t         _trimmed;         /**< Stacks whose memory was given back when pooled */
+         };
+      private:
+         struct FreeStack {
+            FreeStack     *_next;
+         };
+
+         struct ThreadCache {
+            FreeStack     *_hot;             /**< Pooled stacks with their memory */
+            unsigned int   _numHot;
+            FreeStack     *_pending;         /**< Pooled stacks waiting to be trimmed */
+            unsigned int   _numPending;
+            FreeStack     *_cold;            /**< Trimmed pooled stacks */
+            unsigned int   _numCold;
+         };
+
+         enum { TRIM_BATCH = 16 };
+
+         static size_t                 _stackSize;       /**< Usable size of a stack, whole pages */
+         static size_t                 _pageSize;
+         static bool                   _guard;           /**< Whether stacks have a guard page */
+         static unsigned int           _maxHot;
+         static unsigned int           _maxCached;
+         static Atomic<size_t>         _inUse;
+         static Atomic<size_t>         _peakInUse;
+         static Atomic<size_t>         _mapped;
+         static Atomic<size_t>         _created;
+         static Atomic<size_t>         _trimmed;
+         static __thread ThreadCache   _cache;
+
+      private:
+         /*! \brief SMPStackPool default constructor (disabled), only static members
+          */
+         SMPStackPool ();
+
+         static FreeStack * getNode ( void *stack );
+         static void * getStack ( FreeStack *node );
+
+         /*! \brief Maps a new stack, when the current thread has none pooled */
+         static void * map ();
+         /*! \brief Unmaps a stack that does not fit in the current thread's pool */
+         static void unmap ( void *stack );
+         /*! \brief Gives back the memory of a stack, but its topmost page */
+         static void trim ( void *stack );
+         static void stackTaken ();
+
+      public:
+         static void config ( Config &cfg );
+         /*! \brief Sets the size of the stacks, before the first one is requested */
+         static void init ( size_t stackSize );
+
+         /*! \brief Returns a stack of at least the size given to init
+          */
+         static void * get ();
+         /*! \brief Returns a stack given by get to the pool of the current thread
+          */
+         static void put ( void *stack );
+
+         /*! \brief Trims the pending stacks of the current thread, when it is idle
+          */
+         static void trimPending ();
+
+         /*! \brief Unmaps the stacks pooled by the current thread, when it exits
+          */
+         static void releaseThread ();
+
+         static Stats getStats ();
+   };
+
+} // namespace ext
+} // namespace nanos
+
+#endif
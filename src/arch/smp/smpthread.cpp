@@ -34,6 +34,7 @@
 
 #include "smp_ult.hpp"
 #include "smpprocessor.hpp"
+#include "smpstackpool.hpp"
 
 #include "system.hpp"
 
@@ -56,6 +57,9 @@ void SMPThread::runDependent ()
    SMPDD &dd = ( SMPDD & ) work.activateDevice( getSMPDevice() );
 
    dd.execute( work );
+
+   //! The thread is exiting, nobody else can reuse the stacks it pooled
+   SMPStackPool::releaseThread();
 }
 
 void SMPThread::idle( bool debug )
@@ -82,6 +86,7 @@ void SMPThread::idle( bool debug )
       }
    }
    getSMPDevice().tryExecuteTransfer();
+   SMPStackPool::trimPending();
 }
 
 void SMPThread::wait()
@@ -2,131 +2,185 @@
 #define SMPTRANSFERQUEUE
 #include "smptransferqueue_decl.hpp"
 #include "atomic.hpp"
+#include "lock.hpp"
 #include "deviceops.hpp"
+#include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace nanos {
 
-SMPTransfer::SMPTransfer() :
-   _ops((DeviceOps *) NULL),
-   _dst((char *)0xdeadbeef),
-   _src((char *)0xbeefdead),
-   _len(133),
-   _count(0),
-   _ld(0),
-   _in( false ) {
+SMPTransfer::SMPTransfer( DeviceOps *ops, char *dst, char *src, std::size_t len, std::size_t count, std::size_t ld, bool in,
+      std::size_t chunkSize, bool nonTemporal ) : _ops(ops), _dst(dst), _src(src), _len(len), _count(count), _ld(ld), _in( in ),
+      _nonTemporal( nonTemporal ), _watch( sys._watchAddr != NULL ), _chunkSize( std::max( chunkSize, (std::size_t) 1 ) ),
+      _piecesPerRow( 1 ), _rowsPerChunk( 1 ), _numChunks( 1 ), _nextChunk( 0 ), _doneChunks( 0 ), _next( NULL ) {
+   if ( _len > _chunkSize ) {
+      _piecesPerRow = ( _len + _chunkSize - 1 ) / _chunkSize;
+      _numChunks = _count * _piecesPerRow;
+   } else if ( _len > 0 ) {
+      _rowsPerChunk = _chunkSize / _len;
+      _numChunks = ( _count + _rowsPerChunk - 1 ) / _rowsPerChunk;
+   }
+   //! Even an empty copy needs a chunk to complete it
+   if ( _numChunks == 0 ) _numChunks = 1;
+   ops->addOp();
 }
+SMPTransfer::~SMPTransfer() {}
 
-SMPTransfer::SMPTransfer( DeviceOps *ops, char *dst, char *src, std::size_t len, std::size_t count, std::size_t ld, bool in ) : _ops(ops), _dst(dst), _src(src), _len(len), _count(count), _ld(ld), _in( in ) {
-   ops->addOp();
+void SMPTransfer::copy( char *dst, char const *src, std::size_t len ) const {
+#ifdef __SSE2__
+   if ( _nonTemporal && len >= 128 ) {
+      //! Streaming stores need an aligned destination
+      std::size_t head = ( 16 - ( (uintptr_t) dst & 15 ) ) & 15;
+      ::memcpy( dst, src, head );
+      dst += head;
+      src += head;
+      len -= head;
+
+      std::size_t i;
+      for ( i = 0; i + 64 <= len; i += 64 ) {
+         __m128i a = _mm_loadu_si128( (__m128i const *) ( src + i ) );
+         __m128i b = _mm_loadu_si128( (__m128i const *) ( src + i + 16 ) );
+         __m128i c = _mm_loadu_si128( (__m128i const *) ( src + i + 32 ) );
+         __m128i d = _mm_loadu_si128( (__m128i const *) ( src + i + 48 ) );
+         _mm_stream_si128( (__m128i *) ( dst + i ), a );
+         _mm_stream_si128( (__m128i *) ( dst + i + 16 ), b );
+         _mm_stream_si128( (__m128i *) ( dst + i + 32 ), c );
+         _mm_stream_si128( (__m128i *) ( dst + i + 48 ), d );
+      }
+      ::memcpy( dst + i, src + i, len - i );
+      return;
+   }
+#endif
+   ::memcpy( dst, src, len );
 }
-SMPTransfer::SMPTransfer( SMPTransfer const &s ) : _ops(s._ops), _dst(s._dst), _src(s._src), _len(s._len), _count(s._count), _ld(s._ld), _in(s._in) {
+
+void SMPTransfer::watch( std::size_t row, std::size_t offset, std::size_t len, bool copied ) const {
+   uint64_t watchAddr = (uint64_t) sys._watchAddr;
+   uint64_t dst = (uint64_t) ( _dst + row * _ld + offset );
+   uint64_t src = (uint64_t) ( _src + row * _ld + offset );
+   char buff[256];
+
+   if ( watchAddr >= dst && watchAddr < dst + len ) {
+      snprintf(buff, 256, "WATCH update: %s value %a", copied ? "new" : "old", *((double *) sys._watchAddr ) );
+      *myThread->_file << buff << std::endl;
+   }
+   if ( !copied && watchAddr >= src && watchAddr < src + len ) {
+      snprintf(buff, 256, "WATCH read: value %a", *((double *) sys._watchAddr ) );
+      *myThread->_file << buff << std::endl;
+   }
 }
-SMPTransfer &SMPTransfer::operator=( SMPTransfer const &s ) {
-   _ops = s._ops;
-   _dst = s._dst;
-   _src = s._src;
-   _len = s._len;
-   _count = s._count;
-   _ld = s._ld;
-   _in = s._in;
-   return *this;
+
+bool SMPTransfer::takeChunk( std::size_t &chunk ) {
+   chunk = _nextChunk++;
+   return _nextChunk == _numChunks;
 }
-SMPTransfer::~SMPTransfer() {}
 
-void SMPTransfer::execute() {
+bool SMPTransfer::execute( std::size_t chunk ) {
    NANOS_INSTRUMENT ( static InstrumentationDictionary *ID = sys.getInstrumentation()->getInstrumentationDictionary(); )
    NANOS_INSTRUMENT ( static nanos_event_key_t key_in = ID->getEventKey("cache-copy-in"); )
    NANOS_INSTRUMENT ( static nanos_event_key_t key_out = ID->getEventKey("cache-copy-out"); )
-   NANOS_INSTRUMENT( sys.getInstrumentation()->raiseOpenBurstEvent( _in ? key_in : key_out , (nanos_event_value_t) _count * _len ); )
-   for ( std::size_t count = 0; count < _count; count += 1) {
-      //if ( sys.getVerboseDevOps()){ 
-      //   std::cerr << "memcpy( " << (void*)(_dst + count) << ", " << (void*)(_src + count *_ld) << ", " << _len << " ) [ld= " << _ld << " count= " << _count << " _dst= " << (void*)_dst << " _src= " << (void*)_src << " ]" << std::endl;
-      //}
-      if (sys._watchAddr != NULL ) {
-         if ((uint64_t )sys._watchAddr >= (uint64_t)(_dst + count *_ld ) && (uint64_t )sys._watchAddr < (uint64_t)(_dst + count *_ld + _len)) {
-            char buff[256];
-            snprintf(buff, 256, "WATCH update: old value %a", *((double *) sys._watchAddr ) );
-            *myThread->_file << buff << std::endl;
-         }
-         if ((uint64_t )sys._watchAddr >= (uint64_t)(_src + count *_ld ) && (uint64_t )sys._watchAddr < (uint64_t)(_dst + count * _ld + _len)) {
-            char buff[256];
-            snprintf(buff, 256, "WATCH read: value %a", *((double *) sys._watchAddr ) );
-            *myThread->_file << buff << std::endl;
-         }
-      }
-      ::memcpy( _dst + count * _ld, _src + count * _ld, _len );
-      if (sys._watchAddr != NULL ) {
-         if ((uint64_t )sys._watchAddr >= (uint64_t)(_dst + count *_ld ) && (uint64_t )sys._watchAddr < (uint64_t)(_dst + count * _ld + _len)) {
-            char buff[256];
-            snprintf(buff, 256, "WATCH update: new value %a", *((double *) sys._watchAddr ) );
-            *myThread->_file << buff << std::endl;
-         }
-      }
+
+   std::size_t firstRow, lastRow, offset, len;
+   if ( _piecesPerRow > 1 ) {
+      firstRow = chunk / _piecesPerRow;
+      lastRow = firstRow + 1;
+      offset = ( chunk % _piecesPerRow ) * _chunkSize;
+      len = std::min( _chunkSize, _len - offset );
+   } else {
+      firstRow = chunk * _rowsPerChunk;
+      lastRow = std::min( firstRow + _rowsPerChunk, _count );
+      offset = 0;
+      len = _len;
    }
-   //*myThread->_file << "Execueted op " << (void *) _dst  << " ops: " << (void *) _ops << " is in " << _in << " content (dst): [" << ((double *)_dst)[0] << " " << ((double *)_dst)[1] << "]" << std::endl; 
-   _ops->completeOp();
+
+   NANOS_INSTRUMENT( sys.getInstrumentation()->raiseOpenBurstEvent( _in ? key_in : key_out , (nanos_event_value_t) ( lastRow - firstRow ) * len ); )
+   for ( std::size_t row = firstRow; row < lastRow; row += 1 ) {
+      if ( _watch ) watch( row, offset, len, false );
+      copy( _dst + row * _ld + offset, _src + row * _ld + offset, len );
+      if ( _watch ) watch( row, offset, len, true );
+   }
+#ifdef __SSE2__
+   //! Streamed data must be visible before the copy is reported as done
+   if ( _nonTemporal ) _mm_sfence();
+#endif
    NANOS_INSTRUMENT( sys.getInstrumentation()->raiseCloseBurstEvent( _in ? key_in : key_out, (nanos_event_value_t) 0 ); )
+
+   if ( ++_doneChunks < _numChunks ) return false;
+   _ops->completeOp();
+   return true;
+}
+
+std::size_t SMPTransferQueue::_chunkSize = 64 * 1024;
+std::size_t SMPTransferQueue::_nonTemporalThreshold = 4 * 1024 * 1024;
+
+SMPTransferQueue::SMPTransferQueue() : _queues( 1, NEW NodeQueue() ), _nodeOfSpace() {}
+
+SMPTransferQueue::~SMPTransferQueue() {
+   for ( std::vector<NodeQueue *>::iterator it = _queues.begin(); it != _queues.end(); it++ ) delete *it;
+}
+
+void SMPTransferQueue::prepareConfig( Config &config ) {
+   config.registerConfigOption( "smp-copy-chunk", NEW Config::SizeVar( _chunkSize ),
+                                "Bytes of the chunks asynchronous SMP copies are split in (default = 64K)" );
+   config.registerArgOption( "smp-copy-chunk", "smp-copy-chunk" );
+   config.registerEnvOption( "smp-copy-chunk", "NX_SMP_COPY_CHUNK" );
+
+   config.registerConfigOption( "smp-copy-nt-threshold", NEW Config::SizeVar( _nonTemporalThreshold ),
+                                "Bytes from which asynchronous SMP copies use non-temporal stores, 0 never (default = 4M)" );
+   config.registerArgOption( "smp-copy-nt-threshold", "smp-copy-nt-threshold" );
+   config.registerEnvOption( "smp-copy-nt-threshold", "NX_SMP_COPY_NT_THRESHOLD" );
+}
+
+void SMPTransferQueue::init( unsigned int numNodes, std::size_t numSpaces ) {
+   ensure( _nodeOfSpace.empty(), "SMP transfer queues initialized twice" );
+   while ( _queues.size() < numNodes ) _queues.push_back( NEW NodeQueue() );
+   _nodeOfSpace.resize( numSpaces, 0 );
 }
 
-#define CHUNK_SIZE 4096
-
-SMPTransferQueue::SMPTransferQueue() : _lock(), _transfers() {}
-void SMPTransferQueue::addTransfer( DeviceOps *ops, char *dst, char *src, std::size_t len, std::size_t count, std::size_t ld, bool in ) {
-   _lock.acquire();
-   // NANOS_INSTRUMENT ( static InstrumentationDictionary *ID = sys.getInstrumentation()->getInstrumentationDictionary(); )
-   // NANOS_INSTRUMENT ( static nanos_event_key_t key = ID->getEventKey("cache-copy-out"); )
-   // NANOS_INSTRUMENT( sys.getInstrumentation()->raiseOpenBurstEvent( key, (nanos_event_value_t) 4 ); )
-   if ( len * count > CHUNK_SIZE*2 && ( true /* FRAGMENT FLAG */ ) ) {
-      if ( count == 1 ) {
-         std::size_t current_chunk = CHUNK_SIZE;
-         std::size_t total_processed = 0;
-         while ( total_processed < len ) {
-            _transfers.push_back( SMPTransfer(ops, dst+total_processed, src+total_processed, current_chunk, 1, ld, in) );
-            total_processed += current_chunk;
-            current_chunk = total_processed + (CHUNK_SIZE*2) > len ? CHUNK_SIZE : len - total_processed;
-         }
-      } else {
-         if ( len > CHUNK_SIZE*2 ) {
-            for ( std::size_t count_idx = 0; count_idx < count; count_idx += 1 ) {
-               std::size_t current_line_chunk = CHUNK_SIZE;
-               std::size_t total_line = 0;
-               while ( total_line < len ) {
-                  _transfers.push_back( SMPTransfer(ops, dst+(ld*count_idx)+total_line, src+(ld*count_idx)+total_line, current_line_chunk, 1, ld, in) );
-                  total_line += current_line_chunk;
-                  current_line_chunk = total_line + (CHUNK_SIZE*2) > len ?  len - total_line : CHUNK_SIZE;
-               }
-            }
-         } else {
-            std::size_t current_count_chunk = CHUNK_SIZE / len;
-            std::size_t total_count = 0;
-            while ( total_count < count ) {
-               _transfers.push_back( SMPTransfer(ops, dst+(ld*total_count), src+(ld*total_count), len, current_count_chunk, ld, in) );
-               total_count += current_count_chunk;
-               current_count_chunk = total_count + (CHUNK_SIZE/len)*2 > count ? count - total_count : (CHUNK_SIZE/len);
-            }
-         }
+void SMPTransferQueue::setMemorySpaceNode( memory_space_id_t id, unsigned int numaNode ) {
+   ensure( id < _nodeOfSpace.size() && numaNode < _queues.size(), "SMP transfer queues not initialized for this memory space" );
+   _nodeOfSpace[id] = numaNode;
+}
+
+void SMPTransferQueue::addTransfer( DeviceOps *ops, char *dst, char *src, std::size_t len, std::size_t count, std::size_t ld, bool in, memory_space_id_t space ) {
+   std::size_t bytes = len * count;
+   SMPTransfer *t = NEW SMPTransfer( ops, dst, src, len, count, ld, in, _chunkSize,
+                                     _nonTemporalThreshold > 0 && bytes >= _nonTemporalThreshold );
+   NodeQueue &queue = *_queues[ space < _nodeOfSpace.size() ? _nodeOfSpace[space] : 0 ];
+
+   LockBlock lock( queue._lock );
+   if ( queue._tail == NULL ) queue._head = t;
+   else queue._tail->setNext( t );
+   queue._tail = t;
+}
+
+bool SMPTransferQueue::tryExecuteFrom( NodeQueue &queue ) {
+   if ( queue._head == NULL ) return false;
+
+   SMPTransfer *t;
+   std::size_t chunk;
+   {
+      LockBlock lock( queue._lock );
+      t = queue._head;
+      if ( t == NULL ) return false;
+      if ( t->takeChunk( chunk ) ) {
+         queue._head = t->getNext();
+         if ( queue._head == NULL ) queue._tail = NULL;
       }
-   } else {
-      _transfers.push_back( SMPTransfer(ops, dst, src, len, count, ld, in) );
    }
-   // NANOS_INSTRUMENT( sys.getInstrumentation()->raiseCloseBurstEvent( key, (nanos_event_value_t) 0 ); )
-   _lock.release();
+
+   if ( t->execute( chunk ) ) delete t;
+   return true;
 }
+
 void SMPTransferQueue::tryExecuteOne() {
-   if ( !_transfers.empty() ) {
-      if ( true /*_lock.tryAcquire()*/ ) {
-         _lock.acquire();
-         bool found = false;
-         SMPTransfer t;
-         if ( !_transfers.empty() ) {
-            found = true;
-            t = _transfers.front();
-            _transfers.pop_front();
-         }
-         _lock.release();
-         if ( found ) 
-            t.execute();
-      }
+   unsigned int mine = myThread->runningOn()->getNumaNode();
+   if ( mine < _queues.size() && tryExecuteFrom( *_queues[mine] ) ) return;
+
+   for ( unsigned int node = 0; node < _queues.size(); node++ ) {
+      if ( node != mine && tryExecuteFrom( *_queues[node] ) ) return;
    }
 }
 
@@ -1,35 +1,101 @@
 #ifndef SMPTRANSFERQUEUE_DECL
 #define SMPTRANSFERQUEUE_DECL
 
-#include <list>
+#include <vector>
 #include "atomic_decl.hpp"
+#include "lock_decl.hpp"
+#include "config.hpp"
+#include "nanos-int.h"
 #include "deviceops_fwd.hpp"
 
 namespace nanos {
 
+/*! \brief Asynchronous SMP copy of count rows of len bytes, ld bytes apart
+ *
+ *  The copy is split in chunks of about the configured chunk size that idle
+ *  threads take one at a time: long rows are split in pieces and short ones are
+ *  grouped. The thread that copies the last chunk completes the operation.
+ */
 class SMPTransfer {
-   DeviceOps   *_ops;
-   char        *_dst;
-   char        *_src;
-   std::size_t  _len;
-   std::size_t  _count;
-   std::size_t  _ld;
-   bool         _in;
-   public:
-   SMPTransfer();
-   SMPTransfer( DeviceOps *ops, char *dst, char *src, std::size_t len, std::size_t count, std::size_t ld, bool in );
+   DeviceOps           *_ops;
+   char                *_dst;
+   char                *_src;
+   std::size_t          _len;
+   std::size_t          _count;
+   std::size_t          _ld;
+   bool                 _in;
+   bool                 _nonTemporal;       //!< Copy with non-temporal stores
+   bool                 _watch;             //!< Check sys._watchAddr on every chunk
+   std::size_t          _chunkSize;         //!< Bytes of a piece of a row
+   std::size_t          _piecesPerRow;
+   std::size_t          _rowsPerChunk;
+   std::size_t          _numChunks;
+   std::size_t          _nextChunk;         //!< First chunk not taken yet, protected by the queue lock
+   Atomic<std::size_t>  _doneChunks;
+   SMPTransfer         *_next;              //!< Next transfer in the queue
+
    SMPTransfer( SMPTransfer const &s );
    SMPTransfer &operator=( SMPTransfer const &s );
+
+   void copy( char *dst, char const *src, std::size_t len ) const;
+   void watch( std::size_t row, std::size_t offset, std::size_t len, bool copied ) const;
+   public:
+   SMPTransfer( DeviceOps *ops, char *dst, char *src, std::size_t len, std::size_t count, std::size_t ld, bool in,
+                std::size_t chunkSize, bool nonTemporal );
    ~SMPTransfer();
-   void execute();
+
+   SMPTransfer *getNext() const { return _next; }
+   void setNext( SMPTransfer *next ) { _next = next; }
+
+   //! \brief Takes the next chunk, returns whether it was the last one to take
+   bool takeChunk( std::size_t &chunk );
+   //! \brief Copies a chunk, returns whether the whole transfer is done
+   bool execute( std::size_t chunk );
 };
 
+/*! \brief Pending asynchronous SMP copies
+ *
+ *  There is a queue per NUMA node, a copy goes to the one of the node of the
+ *  SMP memory space it involves. Idle threads serve the queue of their own node
+ *  first, so copies are split among the threads close to the copied memory,
+ *  and only then help with the other nodes.
+ */
 class SMPTransferQueue {
-   Lock _lock;
-   std::list< SMPTransfer > _transfers;
+   struct NodeQueue {
+      Lock                    _lock;
+      SMPTransfer * volatile  _head;
+      SMPTransfer            *_tail;
+
+      NodeQueue() : _lock(), _head( NULL ), _tail( NULL ) {}
+   };
+
+   std::vector<NodeQueue *>   _queues;          //!< One per NUMA node
+   std::vector<unsigned int>  _nodeOfSpace;     //!< NUMA node of each memory space
+
+   static std::size_t         _chunkSize;
+   static std::size_t         _nonTemporalThreshold;
+
+   SMPTransferQueue( SMPTransferQueue const &q );
+   SMPTransferQueue &operator=( SMPTransferQueue const &q );
+
+   bool tryExecuteFrom( NodeQueue &queue );
    public:
    SMPTransferQueue();
-   void addTransfer( DeviceOps *ops, char *dst, char *src, std::size_t len, std::size_t count, std::size_t ld, bool in );
+   ~SMPTransferQueue();
+
+   static void prepareConfig( Config &config );
+
+   /*! \brief Creates the queues of numNodes NUMA nodes and room for numSpaces memory spaces
+    *
+    *  Called once before any thread runs: the vectors are never resized
+    *  afterwards, so adding and serving copies reads them without locking.
+    */
+   void init( unsigned int numNodes, std::size_t numSpaces );
+
+   //! \brief Sets the NUMA node of a memory space, before any copy is added
+   void setMemorySpaceNode( memory_space_id_t id, unsigned int numaNode );
+
+   void addTransfer( DeviceOps *ops, char *dst, char *src, std::size_t len, std::size_t count, std::size_t ld, bool in, memory_space_id_t space );
    void tryExecuteOne();
 };
 
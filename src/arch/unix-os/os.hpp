@@ -111,6 +111,13 @@ namespace nanos {
          static double getMonotonicTimeResolution ();
 
          static int nanosleep ( unsigned long long nanoseconds );
+
+         /*! \brief Sleeps while *addr is value, for at most timeout nanoseconds
+          *  Spurious returns are possible, callers must check their condition again.
+          */
+         static void futexWait ( volatile int *addr, int value, unsigned long long timeout );
+         /*! \brief Wakes up to count threads waiting on addr */
+         static void futexWake ( volatile int *addr, int count );
          
          static const InitList & getInitializationFunctions ( ) { return *_initList;}
          static const InitList & getPostInitializationFunctions ( ) { return *_postInitList;}
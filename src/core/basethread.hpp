@@ -33,6 +33,7 @@
 #include "basethread_decl.hpp"
 #include "wddeque.hpp"
 #include "smpthread.hpp"
+#include "latencystats.hpp"
 #include <stdio.h>
 
 #include "system.hpp"
@@ -112,7 +113,8 @@ namespace nanos {
    inline BaseThread::BaseThread ( unsigned int osId, WD &wd, ProcessingElement *creator, ext::SMPMultiThread *parent ) :
       _id( sys.nextThreadId() ), _osId( osId ), _maxPrefetch( 1 ), _status( ), _parent( parent ), _pe( creator ), _mlock( ),
       _threadWD( wd ), _currentWD( NULL ), _heldWD( NULL ), _nextWDs( /* enableDeviceCounter */ false ), _teamData( NULL ), _nextTeamData( NULL ),
-      _name( "Thread" ), _description( "" ), _allocator( ), _steps(0), _bpCallBack( NULL ), _nextTeam( NULL ), _gasnetAllowAM( true ), _pendingRequests()
+      _name( "Thread" ), _description( "" ), _allocator( ), _steps(0), _bpCallBack( NULL ), _nextTeam( NULL ), _latencyStats( LatencyStats::isEnabled() ? NEW LatencyStats() : NULL ),
+      _gasnetAllowAM( true ), _pendingRequests()
    {
          if ( sys.getSplitOutputForThreads() ) {
             if ( _parent != NULL ) {
@@ -264,6 +266,8 @@ namespace nanos {
 
    inline Allocator & BaseThread::getAllocator() { return _allocator; }
 
+   inline LatencyStats * BaseThread::getLatencyStats() { return _latencyStats; }
+
    inline void BaseThread::rename ( const char *name ) { _name = name; }
  
    inline const std::string & BaseThread::getName ( void ) const { return _name; }
@@ -34,6 +34,7 @@
 #include "workdescriptor_decl.hpp"
 #include "allocator_decl.hpp"
 #include "wddeque_decl.hpp"
+#include "latencystats_decl.hpp"
 
 namespace nanos {
 
@@ -200,6 +201,7 @@ namespace nanos {
          unsigned short          _steps;         //!< Number of scheduler steps (zero means infinite)
          callback_t              _bpCallBack;    //!< Break point callback. We call it after _steps scheduler ops
          ThreadTeam             *_nextTeam;      //!< If thread has no team, which team should it join
+         LatencyStats           *_latencyStats;  //!< Per thread latency statistics (NULL if they are disabled)
 
       private:
          virtual void initializeDependent () = 0;
@@ -232,6 +234,8 @@ namespace nanos {
             finish();
             ensure0( ( !_status.has_team ), "Destroying thread inside a team!" );
             ensure0( ( _status.has_joined || _status.is_main_thread ), "Trying to destroy running thread" );
+            delete _latencyStats;
+            _latencyStats = NULL;
          }
 
          // atomic access
@@ -367,6 +371,10 @@ namespace nanos {
           */
          Allocator & getAllocator();
 
+         /*! \brief Get latency statistics of current thread (NULL if they are disabled)
+          */
+         LatencyStats * getLatencyStats();
+
          /*! \brief Rename the basethread
           */
          void rename ( const char *name );
@@ -35,13 +35,7 @@ void DependableObject::finished ( )
       TargetVector const &outs = depObj.getWrittenTargets();
       DependenciesDomain *domain = depObj.getDependenciesDomain();
       if ( domain != 0 && outs.size() > 0 ) {
-         SyncRecursiveLockBlock lock1( domain->getInstanceLock() ); // This is needed here to avoid a dead-lock
-         SyncLockBlock lock2( depObj.getLock() );
-         for ( unsigned int i = 0; i < outs.size(); i++ ) {
-            BaseDependency const &target = *outs[i];
-            
-            domain->deleteLastWriter ( depObj, target );
-         }
+         domain->deleteLastWriters ( depObj, outs );
       }
       
       //  Delete depObj from all trackableObjects it reads 
@@ -170,7 +164,7 @@ void DependableObject::releaseReadDependencies ()
          //DependenciesDomain::decreaseTasksInGraph();
          NANOS_INSTRUMENT ( instrument ( *currSucessorIt->second ); ) 
          currSucessorIt->second->decreasePredecessors( NULL, this, false, false );
-         succ.erase(currSucessorIt++);
+         currSucessorIt = succ.erase(currSucessorIt);
       }
       else 
       {
@@ -202,7 +196,7 @@ DependableObject * DependableObject::releaseImmediateSuccessor ( DependableObjec
                // remove it
                found = it->second;
                unsigned int wdId = it->first;
-               succ.erase(it++);
+               it = succ.erase(it);
                if ( found->numPredecessors() != 1 ) {
                   incorrectlyErased.insert( std::make_pair( wdId, found ) );
                   found = NULL;
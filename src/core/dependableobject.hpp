@@ -26,6 +26,7 @@
 
 #include "atomic.hpp"
 #include "lock.hpp"
+#include "smallvector.hpp"
 
 #include "dependableobject_decl.hpp"
 #include "basedependency_decl.hpp"
@@ -105,14 +106,19 @@ inline int DependableObject::increasePredecessors ( )
 inline int DependableObject::decreasePredecessors ( std::list<uint64_t> const * flushDeps, DependableObject * finishedPred,
       bool batchRelease, bool blocking )
 {
-   int  numPred = --_numPredecessors;
+   int  numPred;
 //   DependableObject &depObj = *this;
 //   sys.getDefaultSchedulePolicy()->atSuccessor( depObj, finishedPred );
    if(sys.getPredecessorLists())
    {
+      // Decreased inside the lock: otherwise the last predecessor could release this
+      // object, which may run and be deleted before the lock is taken here
       SyncLockBlock lock( this->getLock() );
 
+      numPred = --_numPredecessors;
       decreasePredecessorsInLock( finishedPred, numPred );
+   } else {
+      numPred = --_numPredecessors;
    }
 
    if ( numPred == 0 && !batchRelease ) {
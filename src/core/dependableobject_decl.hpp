@@ -27,6 +27,7 @@
 
 #include "atomic_decl.hpp"
 #include "lock_decl.hpp"
+#include "smallvector_decl.hpp"
 
 #include "dependenciesdomain_fwd.hpp"
 #include "basedependency_fwd.hpp"
@@ -87,7 +88,7 @@ namespace nanos {
    {
       public:
          typedef std::pair< unsigned int, DependableObject * > DependableObjectVectorKey;
-         typedef std::set<DependableObjectVectorKey> DependableObjectVector; /**< Type vector of successors  */
+         typedef SmallSet<DependableObjectVectorKey, 3> DependableObjectVector; /**< Type vector of successors, ordered by WD id  */
          typedef std::vector<BaseDependency*> TargetVector; /**< Type vector of output objects */
          
       private:
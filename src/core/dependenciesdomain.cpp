@@ -34,6 +34,15 @@ Lock DependenciesDomain::_lock;
 
 using namespace dependencies_domain_internal;
 
+void DependenciesDomain::deleteLastWriters ( DependableObject &depObj, std::vector<BaseDependency *> const &targets )
+{
+   InstanceLockBlock lock1( getInstanceLock() ); // This is needed here to avoid a dead-lock
+   SyncLockBlock lock2( depObj.getLock() );
+   for ( unsigned int i = 0; i < targets.size(); i++ ) {
+      deleteLastWriter ( depObj, *targets[i] );
+   }
+}
+
 void DependenciesDomain::increaseTasksInGraph( size_t num )
 {
    NANOS_INSTRUMENT(lock();)
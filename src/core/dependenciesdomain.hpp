@@ -27,6 +27,7 @@
 #include "atomic.hpp"
 #include "recursivelock_decl.hpp"
 #include "lock.hpp"
+#include "latencystats.hpp"
 #include "dependableobject.hpp"
 #include "trackableobject.hpp"
 #include "dataaccess_decl.hpp"
@@ -52,6 +52,7 @@
 #include "atomic_decl.hpp"
 #include "recursivelock_decl.hpp"
 #include "lock_decl.hpp"
+#include "latencystats_decl.hpp"
 #include "dataaccess_decl.hpp"
 #include "basedependency_decl.hpp"
 
@@ -131,6 +132,15 @@ using namespace dependencies_domain_internal;
           *  \param target Address/region that must be affected
           */
          virtual void deleteLastWriter ( DependableObject &depObj, BaseDependency const &target ) = 0;
+
+         /*! \brief Removes the DependableObject from the role of last writer of all the regions it wrote.
+          *
+          *  Called when depObj finishes. The default implementation holds the instance lock during the
+          *  whole operation, domains with finer grained locking may override it.
+          *  \param depObj DependableObject to be stripped of the last writer role
+          *  \param targets Addresses/regions written by depObj
+          */
+         virtual void deleteLastWriters ( DependableObject &depObj, std::vector<BaseDependency *> const &targets );
          
          /*! \brief Removes the DependableObject from the reader list of a region.
           *  \param depObj DependableObject to be removed as a reader
@@ -168,6 +178,10 @@ using namespace dependencies_domain_internal;
 
          static void decreaseTasksInGraph( size_t num = 1 );
 
+        /*! \brief Lock block of the instance lock, accounted in the latency statistics
+         */
+         typedef LatencyLockBlock<SyncRecursiveLockBlock, RecursiveLock, LatencyStats::DEPS_LOCK_WAIT> InstanceLockBlock;
+
         /*! \brief Returns a reference to the instance lock
          */
          RecursiveLock& getInstanceLock();
@@ -413,6 +413,7 @@ namespace nanos {
             registerEventValue("api","get_wd_id","nanos_get_wd_id()");
             registerEventValue("api","*_create_wd","nanos_create_xxx_wd()");
             registerEventValue("api","submit","nanos_submit()");
+            registerEventValue("api","submit_batch","nanos_submit_batch()");
             registerEventValue("api","create_wd_and_run","nanos_create_wd_and_run()");
             registerEventValue("api","set_internal_wd_data","nanos_set_internal_wd_data()");
             registerEventValue("api","get_internal_wd_data","nanos_get_internal_wd_data()");
@@ -439,9 +440,14 @@ namespace nanos {
             registerEventValue("api","in_final","nanos_in_final()");
             registerEventValue("api","set_final","nanos_set_final()");
             registerEventValue("api","dependence_release_all","nanos_dependence_release_all()");
+            registerEventValue("api","taskgraph_begin","nanos_taskgraph_begin()");
+            registerEventValue("api","taskgraph_end","nanos_taskgraph_end()");
             registerEventValue("api","set_translate_function","nanos_set_translate_function()");
             registerEventValue("api","memalign","nanos_memalign()");
             registerEventValue("api","cmalloc","nanos_cmalloc()");
+            registerEventValue("api","numa_malloc","nanos_numa_malloc()");
+            registerEventValue("api","numa_first_touch","nanos_numa_first_touch()");
+            registerEventValue("api","numa_free","nanos_numa_free()");
             registerEventValue("api","stick_to_producer","nanos_stick_to_producer()");
             registerEventValue("api","task_reduction_register","nanos_task_reduction_register()");
             registerEventValue("api","task_reduction_get_thread_storage","nanos_task_reduction_get_thread_storage()");
@@ -675,6 +681,11 @@ namespace nanos {
             /* 71 */ registerEventKey("cache-evict", "Cache eviction", false, EVENT_ADVANCED);
             /* 72 */ registerEventKey("copy-data-alloc","Cache allocation", false, EVENT_ADVANCED);
 
+            /* 73 */ registerEventKey("sched-steals-core","Tasks stolen from SMT siblings", true, EVENT_DEVELOPER );
+            /* 74 */ registerEventKey("sched-steals-cache","Tasks stolen from cores sharing the cache", true, EVENT_DEVELOPER );
+            /* 75 */ registerEventKey("sched-steals-numa","Tasks stolen within the NUMA node", true, EVENT_DEVELOPER );
+            /* 76 */ registerEventKey("sched-steals-remote","Tasks stolen from remote NUMA nodes", true, EVENT_DEVELOPER );
+
             /* ** */ registerEventKey("debug","Debug Key", true, EVENT_ADVANCED ); /* Keep this key as the last one */
          }
 
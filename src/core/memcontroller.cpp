@@ -358,6 +358,8 @@ void MemController::copyDataIn() {
       sys.allocLock();
    //if( sys.getNetwork()->getNodeNum()== 0)std::cerr << "MemController::copyDataIn for wd " << _wd->getId() << std::endl;
    for ( unsigned int index = 0; index < _wd->getNumCopies(); index++ ) {
+      //! Private copies travel with the WD arguments, their address is relative to them
+      if ( _wd->getCopies()[index].isPrivate() ) continue;
       _memCacheCopies[ index ].generateInOps( *_inOps, _wd->getCopies()[index].isInput(), _wd->getCopies()[index].isOutput(), *_wd, index );
    }
       sys.allocUnlock();
@@ -418,6 +420,7 @@ void MemController::copyDataOut( MemControllerPolicy policy ) {
       _outOps = NEW SeparateAddressSpaceOutOps( _pe, false, true );
 
       for ( unsigned int index = 0; index < _wd->getNumCopies(); index++ ) {
+         if ( _wd->getCopies()[index].isPrivate() ) continue;
          _memCacheCopies[ index ].generateOutOps( &sys.getSeparateMemory( _pe->getMemorySpaceId() ), *_outOps, _wd->getCopies()[index].isInput(), _wd->getCopies()[index].isOutput(), *_wd, index );
       }
 
@@ -432,7 +435,9 @@ uint64_t MemController::getAddress( unsigned int index ) const {
    ensure( _initialized == true, "MemController not initialized!");
    uint64_t addr = 0;
    //std::cerr << " _getAddress, reg: " << index << " key: " << (void *)_memCacheCopies[ index ]._reg.key << " id: " << _memCacheCopies[ index ]._reg.id << std::endl;
-   if ( _pe->getMemorySpaceId() == 0 ) {
+   if ( _wd->getCopies()[ index ].isPrivate() ) {
+      addr = ((uint64_t) _wd->getData()) + ((uint64_t) _wd->getCopies()[ index ].getBaseAddress());
+   } else if ( _pe->getMemorySpaceId() == 0 ) {
       addr = ((uint64_t) _wd->getCopies()[ index ].getBaseAddress());
    } else {
       addr = sys.getSeparateMemory( _pe->getMemorySpaceId() ).getDeviceAddress( _memCacheCopies[ index ]._reg, (uint64_t) _wd->getCopies()[ index ].getBaseAddress(), _memCacheCopies[ index ]._chunk );
@@ -122,6 +122,30 @@ typedef struct {
    void (*cleanup)(void *);
 } nanos_reduction_t;
 
+/* Built-in operators of task reductions, they let the runtime combine private
+ * copies without calling the reducer function element by element */
+typedef enum {
+   NANOS_REDUCTION_USER_OP = 0,
+   NANOS_REDUCTION_ADD,
+   NANOS_REDUCTION_PROD,
+   NANOS_REDUCTION_MIN,
+   NANOS_REDUCTION_MAX
+} nanos_reduction_op_t;
+
+typedef enum {
+   NANOS_REDUCTION_INT = 0,
+   NANOS_REDUCTION_FLOAT,
+   NANOS_REDUCTION_DOUBLE
+} nanos_reduction_type_t;
+
+/* Placement of the memory allocated with nanos_numa_malloc */
+typedef enum {
+   NANOS_NUMA_BIND = 0,          /* All the pages in one NUMA node */
+   NANOS_NUMA_INTERLEAVE,        /* Pages interleaved across the NUMA nodes */
+   NANOS_NUMA_BLOCK,             /* One contiguous block of pages per NUMA node */
+   NANOS_NUMA_FIRST_TOUCH        /* Pages where they are first touched, see nanos_numa_first_touch */
+} nanos_numa_policy_t;
+
 typedef unsigned int reg_t;
 typedef unsigned int memory_space_id_t;
 
@@ -0,0 +1,251 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "numaplacement_decl.hpp"
+#include "workdescriptor.hpp"
+#include "system.hpp"
+#include "lock.hpp"
+#include "atomic.hpp"
+#include <vector>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/mman.h>
+
+using namespace nanos;
+
+NumaPlacement::~NumaPlacement ()
+{
+   delete _table;
+   for ( std::vector<AreaTable *>::iterator it = _retired.begin(); it != _retired.end(); ++it ) {
+      delete *it;
+   }
+}
+
+unsigned int NumaPlacement::getPhysicalNode ( int node )
+{
+   const std::vector<int> &numaNodeMap = sys.getNumaNodeMap();
+   for ( unsigned int pNode = 0; pNode < numaNodeMap.size(); pNode++ ) {
+      if ( numaNodeMap[pNode] == node ) return pNode;
+   }
+   return 0;
+}
+
+void NumaPlacement::place ( uintptr_t start, size_t size, int node )
+{
+   if ( !sys._hwloc.bindMemory( (void *) start, size, getPhysicalNode( node ) ) && sys._hwloc.isHwlocAvailable() ) {
+      warning0( "Could not bind " << size << " bytes at " << (void *) start << " to NUMA node " << node );
+   }
+
+   record( start, size, node );
+}
+
+void NumaPlacement::record ( uintptr_t start, size_t size, int node )
+{
+   forget( start, size );
+
+   AreaTable *table = _table;
+   size_t count = table == NULL ? 0 : table->_count;
+   size_t pos = table == NULL ? 0 : findArea( *table, count, start );
+
+   _version++;
+   memoryFence();
+
+   if ( table == NULL || count == table->_capacity ) {
+      //! Lookups may still be reading the old table, it is only retired
+      AreaTable *grown = NEW AreaTable( table == NULL ? (size_t) MIN_AREAS : table->_capacity * 2 );
+      if ( table != NULL ) {
+         std::copy( table->_areas, table->_areas + count, grown->_areas );
+         grown->_count = count;
+         _retired.push_back( table );
+      }
+      table = grown;
+      memoryFence();
+      _table = table;
+   }
+
+   std::copy_backward( table->_areas + pos, table->_areas + count, table->_areas + count + 1 );
+   table->_areas[pos]._start = start;
+   table->_areas[pos]._size = size;
+   table->_areas[pos]._node = node;
+   table->_count = count + 1;
+
+   memoryFence();
+   _version++;
+}
+
+void NumaPlacement::forget ( uintptr_t start, size_t size )
+{
+   AreaTable *table = _table;
+   if ( table == NULL ) return;
+
+   size_t count = table->_count;
+   size_t first = findArea( *table, count, start );
+   //! Areas do not overlap, the one that ends after start may begin before it
+   if ( first < count && table->_areas[first]._start < start ) first++;
+
+   size_t last = first;
+   while ( last < count && table->_areas[last]._start < start + size ) last++;
+   if ( last == first ) return;
+
+   _version++;
+   memoryFence();
+
+   std::copy( table->_areas + last, table->_areas + count, table->_areas + first );
+   table->_count = count - ( last - first );
+
+   memoryFence();
+   _version++;
+}
+
+size_t NumaPlacement::findArea ( const AreaTable &table, size_t count, uintptr_t addr )
+{
+   size_t low = 0, high = std::min( count, table._capacity );
+   while ( low < high ) {
+      size_t mid = ( low + high ) / 2;
+      if ( table._areas[mid]._start + table._areas[mid]._size <= addr ) low = mid + 1;
+      else high = mid;
+   }
+   return low;
+}
+
+void * NumaPlacement::allocate ( size_t size, nanos_numa_policy_t policy, int node )
+{
+   size_t pageSize = sysconf( _SC_PAGESIZE );
+   size_t len = std::max( ( size + pageSize - 1 ) / pageSize, (size_t) 1 ) * pageSize;
+
+   //! Pages are not backed until they are touched, so they can still be placed
+   void *p = mmap( NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+   if ( p == MAP_FAILED ) return NULL;
+
+   uintptr_t start = (uintptr_t) p;
+   unsigned int numNodes = std::max( sys.getNumNumaNodes(), 1U );
+
+   LockBlock lock( _lock );
+   _allocations[start] = len;
+
+   switch ( policy ) {
+      case NANOS_NUMA_BIND:
+         place( start, len, node );
+         break;
+      case NANOS_NUMA_INTERLEAVE:
+      {
+         //! Spread across all the nodes, there is no single home
+         std::vector<unsigned int> nodes;
+         for ( unsigned int n = 0; n < numNodes; n++ ) nodes.push_back( getPhysicalNode( n ) );
+         sys._hwloc.interleaveMemory( p, len, nodes );
+         break;
+      }
+      case NANOS_NUMA_BLOCK:
+      {
+         //! One contiguous block of whole pages per node, the last one may be smaller
+         size_t block = ( ( len / pageSize + numNodes - 1 ) / numNodes ) * pageSize;
+         for ( unsigned int n = 0; n < numNodes && n * block < len; n++ ) {
+            place( start + n * block, std::min( block, len - n * block ), n );
+         }
+         break;
+      }
+      case NANOS_NUMA_FIRST_TOUCH:
+         //! Left to the OS, see firstTouch()
+         break;
+   }
+
+   return p;
+}
+
+bool NumaPlacement::free ( void *p )
+{
+   uintptr_t start = (uintptr_t) p;
+   size_t len;
+
+   {
+      LockBlock lock( _lock );
+      AllocationMap::iterator it = _allocations.find( start );
+      if ( it == _allocations.end() ) return false;
+
+      len = it->second;
+      forget( start, len );
+      _allocations.erase( it );
+   }
+
+   munmap( p, len );
+   return true;
+}
+
+void NumaPlacement::firstTouch ( void *p, size_t size, WD &wd )
+{
+   int node = wd.getNUMANode();
+   if ( node < 0 ) {
+      node = _nextNode++ % std::max( sys.getNumNumaNodes(), 1U );
+      wd.setNUMANode( node );
+   }
+
+   //! Not bound, the pages will be wherever wd touches them
+   LockBlock lock( _lock );
+   record( (uintptr_t) p, size, node );
+}
+
+bool NumaPlacement::addHomeBytes ( const void *addr, size_t size, size_t *bytes )
+{
+   uintptr_t start = (uintptr_t) addr;
+   uintptr_t end = start + size;
+   bool found = false;
+
+   //! Overlapping areas are copied LOOKUP_AREAS at a time, and only used if the table did not change meanwhile
+   Area areas[LOOKUP_AREAS];
+   size_t numAreas;
+   do {
+      unsigned int version;
+      do {
+         version = _version;
+         memoryFence();
+
+         AreaTable *table = _table;
+         if ( table == NULL ) return found;
+
+         size_t count = std::min( (size_t) table->_count, table->_capacity );
+         numAreas = 0;
+         for ( size_t i = findArea( *table, count, start ); i < count && numAreas < LOOKUP_AREAS; i++ ) {
+            if ( table->_areas[i]._start >= end ) break;
+            areas[numAreas++] = table->_areas[i];
+         }
+
+         memoryFence();
+      } while ( ( version & 1 ) != 0 || version != _version );
+
+      for ( size_t i = 0; i < numAreas; i++ ) {
+         uintptr_t first = std::max( start, areas[i]._start );
+         uintptr_t last = std::min( end, areas[i]._start + areas[i]._size );
+         if ( first < last && areas[i]._node >= 0 ) {
+            bytes[areas[i]._node] += last - first;
+            found = true;
+         }
+      }
+      if ( numAreas > 0 ) start = std::max( start, areas[numAreas - 1]._start + areas[numAreas - 1]._size );
+   } while ( numAreas == LOOKUP_AREAS && start < end );
+
+   return found;
+}
+
+int NumaPlacement::getHomeNode ( const void *addr, size_t size )
+{
+   std::vector<size_t> bytes( std::max( sys.getNumNumaNodes(), 1U ), 0 );
+   if ( !addHomeBytes( addr, size, &bytes[0] ) ) return -1;
+
+   return std::max_element( bytes.begin(), bytes.end() ) - bytes.begin();
+}
@@ -0,0 +1,152 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_NUMA_PLACEMENT_DECL
+#define _NANOS_NUMA_PLACEMENT_DECL
+
+#include <map>
+#include <vector>
+#include <stdint.h>
+#include "nanos-int.h"
+#include "lock_decl.hpp"
+#include "atomic_decl.hpp"
+#include "workdescriptor_fwd.hpp"
+#include "numaplacement_fwd.hpp"
+
+namespace nanos {
+
+   /*! \class NumaPlacement
+    *  \brief Placement of the memory allocated with nanos_numa_malloc and home NUMA node of its areas
+    *
+    *  Memory is mapped directly from the OS, so no page is backed until it is first
+    *  touched, and the requested policy is applied to the pages through Hwloc (mbind,
+    *  or move_pages for pages already touched). Nodes are the virtual NUMA nodes seen by
+    *  the user (nanos_current_socket) and the schedulers, they are translated to the OS
+    *  ones only to bind the pages.
+    *
+    *  Every area that lives in a single node is recorded with its home node, so that
+    *  the socket scheduler can send the tasks that access it to that node. Without
+    *  Hwloc the pages cannot be bound, but homes are still recorded: they are where
+    *  the tasks of the home node will touch the pages first.
+    *
+    *  Areas are kept sorted in an array that is only changed under the lock and
+    *  looked up without it: a lookup is retried when the version of the array
+    *  changed while it was reading. Arrays replaced when they grow are kept
+    *  until the placement is destroyed, so a lookup never reads freed memory.
+    */
+   class NumaPlacement
+   {
+      private:
+         enum { MIN_AREAS = 64, LOOKUP_AREAS = 16 };
+
+         struct Area {
+            uintptr_t   _start;
+            size_t      _size;
+            int         _node;     /**< Home node, or -1 when the pages are spread across nodes */
+         };
+
+         struct AreaTable {
+            Area                *_areas;         /**< Sorted by start address */
+            size_t               _capacity;
+            volatile size_t      _count;
+
+            AreaTable ( size_t capacity ) : _areas( NEW Area[capacity] ), _capacity( capacity ), _count( 0 ) {}
+            ~AreaTable () { delete[] _areas; }
+         };
+
+         typedef std::map<uintptr_t, size_t>    AllocationMap;   /**< Allocation sizes by address */
+
+         AreaTable * volatile       _table;         /**< Allocated when the first area is recorded */
+         std::vector<AreaTable *>   _retired;       /**< Tables replaced by a bigger one */
+         volatile unsigned int      _version;       /**< Odd while _table is being changed */
+         AllocationMap              _allocations;
+         Lock                       _lock;
+         Atomic<unsigned int>       _nextNode;      /**< Round robin node for first touch tasks without one */
+
+      private:
+         /*! \brief NumaPlacement copy constructor (disabled)
+          */
+         NumaPlacement ( const NumaPlacement &np );
+         /*! \brief NumaPlacement copy assignment operator (disabled)
+          */
+         const NumaPlacement & operator= ( const NumaPlacement &np );
+
+         /*! \brief OS index of a virtual NUMA node
+          */
+         static unsigned int getPhysicalNode ( int node );
+
+         /*! \brief Binds [start, start+size) to node and records it as its home, _lock must be held
+          */
+         void place ( uintptr_t start, size_t size, int node );
+
+         /*! \brief Records node as the home of [start, start+size), _lock must be held
+          */
+         void record ( uintptr_t start, size_t size, int node );
+
+         /*! \brief Forgets the areas that start in [start, start+size), _lock must be held
+          */
+         void forget ( uintptr_t start, size_t size );
+
+         /*! \brief Index of the first area of table that ends after addr
+          */
+         static size_t findArea ( const AreaTable &table, size_t count, uintptr_t addr );
+
+      public:
+         /*! \brief NumaPlacement default constructor
+          */
+         NumaPlacement () : _table( NULL ), _retired(), _version( 0 ), _allocations(), _lock(), _nextNode( 0 ) {}
+
+         /*! \brief NumaPlacement destructor
+          */
+         ~NumaPlacement ();
+
+         /*! \brief Allocates size bytes placed with policy
+          *
+          *  node is the node of NANOS_NUMA_BIND and ignored by the other policies.
+          *  \return NULL if the memory could not be mapped
+          */
+         void * allocate ( size_t size, nanos_numa_policy_t policy, int node );
+
+         /*! \brief Releases memory returned by allocate
+          *  \return false if p was not returned by allocate
+          */
+         bool free ( void *p );
+
+         /*! \brief The pages of [p, p+size) will be first touched by wd, before it is submitted
+          *
+          *  The area gets the NUMA node of wd as its home. If wd has no node yet, it is
+          *  given one in round robin, like the initialization tasks of the socket scheduler.
+          */
+         void firstTouch ( void *p, size_t size, WorkDescriptor &wd );
+
+         /*! \brief Adds to bytes[node] how much of [addr, addr+size) has node as its home
+          *
+          *  bytes must have room for all the virtual NUMA nodes. It does not take the lock.
+          *  \return true if part of the range has a home
+          */
+         bool addHomeBytes ( const void *addr, size_t size, size_t *bytes );
+
+         /*! \brief Home node of most of [addr, addr+size), or -1 if it has none
+          */
+         int getHomeNode ( const void *addr, size_t size );
+   };
+
+} // namespace nanos
+
+#endif
@@ -94,6 +94,7 @@ AllocatedChunk::AllocatedChunk( RegionCache &owner, uint64_t addr, uint64_t host
 }
 
 AllocatedChunk::~AllocatedChunk() {
+   _owner.removeFromEvictionIndex( *this );
    //*myThread->_file << "Im being released! "<< (void *) _newRegions << std::endl;
    for ( CacheRegionDictionary::citerator it = _newRegions->begin(); it != _newRegions->end(); it++ ) {
       CachedRegionStatus *entry = (CachedRegionStatus *) it->second.getData();
@@ -754,99 +755,143 @@ bool AllocatedChunk::invalidate( RegionCache *targetCache, LockedObjects &srcReg
 
 }
 
-AllocatedChunk **RegionCache::selectChunkToInvalidate( std::size_t allocSize ) {
-   AllocatedChunk **allocChunkPtrPtr = NULL;
-   MemoryMap<AllocatedChunk>::iterator it;
-   bool done = false;
-   int count = 0;
-   //for ( it = _chunks.begin(); it != _chunks.end() && !done; it++ ) {
-   //   *myThread->_file << "["<< count << "] this chunk: " << ((void *) it->second) << " refs: " << (int)( (it->second != NULL) ? it->second->getReferenceCount() : -1 ) << " dirty? " << (int)( (it->second != NULL) ? it->second->isDirty() : -1 )<< std::endl;
-   //   count++;
-   //}
-   //count = 0;
-   AllocatedChunk **chunkToReuseNoLruPtr = NULL;
-   MemoryMap<AllocatedChunk>::iterator itNoLru;
-   AllocatedChunk **chunkToReusePtr = NULL;
-   AllocatedChunk **chunkToReuseDirtyNoLruPtr = NULL;
-   MemoryMap<AllocatedChunk>::iterator itDirtyNoLru;
-   AllocatedChunk **chunkToReuseDirtyPtr = NULL;
-   MemoryMap<AllocatedChunk>::iterator itDirty;
-   for ( it = _chunks.begin(); it != _chunks.end() && !done; it++ ) {
-      // if ( it->second != NULL ) {
-      //    global_reg_t reg = it->second->getAllocatedRegion();
-      //    *myThread->_file << "["<< count << "] mmm this chunk: " << ((void *) it->second) << " refs " <<  it->second->getReferenceCount() << " size is " << it->second->getSize() << " vs " << allocSize << " ";
-      //    reg.key->printRegion( reg.id );
-      //    *myThread->_file << std::endl;
-      // }
-      if ( it->second != NULL && (it->second != (AllocatedChunk *) -1)
-            && (it->second != (AllocatedChunk *) -2)
-            && it->second->getReferenceCount() == 0
-            && !(it->second->isRooted())
-            && it->second->getSize() == allocSize ) {
-         if ( !it->second->isDirty() ) {
-            if ( _lruTime == it->second->getLruStamp() ) {
-               //*myThread->_file << "["<< count << "] this chunk: " << ((void *) it->second) << std::endl;
-               chunkToReusePtr = &(it->second);
-               done = true;
-               break;
-            } else if ( chunkToReuseNoLruPtr == NULL ) {
-               chunkToReuseNoLruPtr = &(it->second);
-               itNoLru = it;
-            }
-         } else {
-            if ( _lruTime == it->second->getLruStamp() ) {
-               //*myThread->_file << "["<< count << "] this chunk: " << ((void *) it->second) << std::endl;
-               chunkToReuseDirtyPtr = &(it->second);
-               itDirty = it;
-            } else if ( chunkToReuseDirtyNoLruPtr == NULL ) {
-               chunkToReuseDirtyNoLruPtr = &(it->second);
-               itDirtyNoLru = it;
-            }
-         }
-      }
-      count++;
-   }
-   if ( chunkToReusePtr == NULL ) {
-      if ( chunkToReuseNoLruPtr != NULL ) {
-         //*myThread->_file << "LRU clean chunk"<< std::endl;
-         chunkToReusePtr = chunkToReuseNoLruPtr;
-         done = true;
-         it = itNoLru;
-         increaseLruTime();
-      } else if ( chunkToReuseDirtyPtr != NULL ) {
-         //*myThread->_file << "Dirty chunk"<< std::endl;
-         chunkToReusePtr = chunkToReuseDirtyPtr;
-         it = itDirty;
-         done = true;
-      } else if ( chunkToReuseDirtyNoLruPtr != NULL ) {
-         //*myThread->_file << "LRU Dirty chunk"<< std::endl;
-         chunkToReusePtr = chunkToReuseDirtyNoLruPtr;
-         it = itDirtyNoLru;
-         done = true;
-         increaseLruTime();
-      }
+//! \brief Drops the entries of a chunk from both eviction indexes. Needs the eviction lock.
+void RegionCache::eraseFromEvictionIndex( AllocatedChunk const &chunk ) {
+   //! A chunk may still have an entry from before it became dirty
+   _evictionIndex.erase( EvictionEntry( chunk.getSize(), false, chunk.getLruStamp(), chunk.getHostAddress(), (AllocatedChunk *) &chunk ) );
+   _evictionIndex.erase( EvictionEntry( chunk.getSize(), true, chunk.getLruStamp(), chunk.getHostAddress(), (AllocatedChunk *) &chunk ) );
+   EvictionAddressIndex::iterator it = _evictionAddressIndex.find( chunk.getAddress() );
+   if ( it != _evictionAddressIndex.end() && it->second == &chunk ) _evictionAddressIndex.erase( it );
+}
+
+/*! \brief Indexes a chunk that lost its last reference, drops one that got its first one
+ *
+ *  The reference count is read under the eviction lock, so when a release and
+ *  a new reference race the last update leaves the index right.
+ */
+void RegionCache::updateEvictionIndex( AllocatedChunk const &chunk ) {
+   if ( chunk.isRooted() ) return;
+   LockBlock guard( _evictionLock );
+   if ( chunk.getReferenceCount() == 0 ) {
+      _evictionIndex.insert( EvictionEntry( chunk.getSize(), chunk.isDirty(), chunk.getLruStamp(), chunk.getHostAddress(), (AllocatedChunk *) &chunk ) );
+      _evictionAddressIndex[ chunk.getAddress() ] = (AllocatedChunk *) &chunk;
    } else {
-      //*myThread->_file << "clean chunk"<< std::endl;
+      eraseFromEvictionIndex( chunk );
    }
-   if ( done ) {
-      allocChunkPtrPtr = chunkToReusePtr;
-      if ( _VERBOSE_CACHE ) { fprintf(stderr, "[%s] Thd %d Im cache with id %d, I've found a chunk to free, %p (locked? %d) region %d addr=%p size=%zu\n",  __FUNCTION__, myThread->getId(), _memorySpaceId, *allocChunkPtrPtr, ((*allocChunkPtrPtr)->locked()?1:0), (*allocChunkPtrPtr)->getAllocatedRegion().id, (void*)it->first.getAddress(), it->first.getLength()); }
-      //(*allocChunkPtrPtr)->lock();
-   } else {
-      // if ( VERBOSE_INVAL ) {
-      //    count = 0;
-      //    for ( it = _chunks.begin(); it != _chunks.end() && !done; it++ ) {
-      //       if ( it->second == NULL ) *myThread->_file << "["<< count << "] this chunk: null chunk" << std::endl;
-      //       else *myThread->_file << "["<< count << "] this chunk: " << ((void *) it->second) << " refs " <<  it->second->getReferenceCount() << " size is " << it->second->getSize() << " vs " << allocSize << " " << " dirty? " << it->second->isDirty() << std::endl;
-      //       count++;
-      //    }
-      // }
-      //fatal("IVE _not_ FOUND A CHUNK TO FREE");
-      allocChunkPtrPtr = NULL;
+}
+
+void RegionCache::removeFromEvictionIndex( AllocatedChunk const &chunk ) {
+   LockBlock guard( _evictionLock );
+   eraseFromEvictionIndex( chunk );
+}
+
+//! \brief Map entry of the chunk of an index entry, NULL if the entry is stale. Needs the eviction lock.
+AllocatedChunk **RegionCache::getEvictableSlot( EvictionEntry const &entry ) {
+   MemoryMap<AllocatedChunk>::iterator it = _chunks.find( MemoryChunk( entry._hostAddress, entry._size ) );
+   if ( it == _chunks.end() || it->second != entry._chunk ) return NULL;
+
+   AllocatedChunk const &chunk = *entry._chunk;
+   if ( chunk.getReferenceCount() != 0 || chunk.isDirty() != entry._dirty ||
+        chunk.getLruStamp() != entry._lruStamp || chunk.getHostAddress() != entry._hostAddress ) return NULL;
+
+   return &(it->second);
+}
+
+/*! \brief First unreferenced chunk of the given size and dirtiness
+ *
+ *  With currentLru only chunks stamped with the current LRU time are
+ *  considered, otherwise only the other ones, the oldest stamp first. Stale
+ *  entries found on the way are dropped. Needs the eviction lock.
+ */
+AllocatedChunk **RegionCache::findEvictableChunk( std::size_t size, bool dirty, bool currentLru ) {
+   EvictionIndex::iterator it = _evictionIndex.lower_bound( EvictionEntry( size, dirty, currentLru ? _lruTime : 0, 0, NULL ) );
+   while ( it != _evictionIndex.end() && it->_size == size && it->_dirty == dirty ) {
+      if ( it->_lruStamp == _lruTime && !currentLru ) {
+         //! Skip the chunks stamped with the current LRU time
+         if ( _lruTime == std::numeric_limits<unsigned int>::max() ) break;
+         it = _evictionIndex.lower_bound( EvictionEntry( size, dirty, _lruTime + 1, 0, NULL ) );
+         continue;
+      }
+      if ( it->_lruStamp != _lruTime && currentLru ) break;
+
+      AllocatedChunk **slot = getEvictableSlot( *it );
+      if ( slot != NULL ) return slot;
+      _evictionIndex.erase( it++ );
+   }
+   return NULL;
+}
+
+AllocatedChunk **RegionCache::selectChunkToInvalidate( std::size_t allocSize ) {
+   LockBlock guard( _evictionLock );
+
+   //! Clean chunks before dirty ones, chunks of the current LRU time first
+   AllocatedChunk **allocChunkPtrPtr = findEvictableChunk( allocSize, false, true );
+   if ( allocChunkPtrPtr == NULL ) {
+      allocChunkPtrPtr = findEvictableChunk( allocSize, false, false );
+      if ( allocChunkPtrPtr != NULL ) increaseLruTime();
+   }
+   if ( allocChunkPtrPtr == NULL ) {
+      allocChunkPtrPtr = findEvictableChunk( allocSize, true, true );
+   }
+   if ( allocChunkPtrPtr == NULL ) {
+      allocChunkPtrPtr = findEvictableChunk( allocSize, true, false );
+      if ( allocChunkPtrPtr != NULL ) increaseLruTime();
+   }
+
+   if ( allocChunkPtrPtr != NULL ) {
+      AllocatedChunk *chunk = *allocChunkPtrPtr;
+      //! The caller takes a reference on it, it comes back when it is released
+      eraseFromEvictionIndex( *chunk );
+      if ( _VERBOSE_CACHE ) { fprintf(stderr, "[%s] Thd %d Im cache with id %d, I've found a chunk to free, %p (locked? %d) region %d addr=%p size=%zu\n",  __FUNCTION__, myThread->getId(), _memorySpaceId, chunk, (chunk->locked()?1:0), chunk->getAllocatedRegion().id, (void*)chunk->getHostAddress(), chunk->getSize()); }
    }
    return allocChunkPtrPtr;
 }
 
+/*! \brief Walks the device memory that can be reused, in address order
+ *
+ *  Merges the unreferenced chunks of the address index with the free chunks
+ *  of the device allocator, both already sorted by address. A chunk that got
+ *  a reference before its entry was dropped is skipped. Needs the eviction lock.
+ */
+class RegionCache::DeviceMemoryCursor {
+   private:
+      EvictionAddressIndex::const_iterator       _chunkIt;
+      EvictionAddressIndex::const_iterator       _chunkEnd;
+      SimpleAllocator::ChunkList::const_iterator _freeIt;
+      SimpleAllocator::ChunkList::const_iterator _freeEnd;
+
+      bool atChunk() const {
+         return _freeIt == _freeEnd || ( _chunkIt != _chunkEnd && _chunkIt->first < _freeIt->first );
+      }
+      void skipReferenced() {
+         while ( _chunkIt != _chunkEnd && _chunkIt->second->getReferenceCount() != 0 ) _chunkIt++;
+      }
+
+   public:
+      DeviceMemoryCursor( EvictionAddressIndex const &chunks, SimpleAllocator::ChunkList const &freeChunks ) :
+         _chunkIt( chunks.begin() ), _chunkEnd( chunks.end() ), _freeIt( freeChunks.begin() ), _freeEnd( freeChunks.end() ) {
+         skipReferenced();
+      }
+
+      bool atEnd() const { return _chunkIt == _chunkEnd && _freeIt == _freeEnd; }
+      uint64_t getAddress() const { return atChunk() ? _chunkIt->first : _freeIt->first; }
+      std::size_t getLength() const { return atChunk() ? _chunkIt->second->getSize() : _freeIt->second; }
+      //! NULL for free device memory
+      AllocatedChunk *getChunk() const { return atChunk() ? _chunkIt->second : NULL; }
+      std::size_t getDirtyBytes() const {
+         AllocatedChunk *chunk = getChunk();
+         return ( chunk != NULL && chunk->isDirty() ) ? chunk->getSize() : 0;
+      }
+      void advance() {
+         if ( atChunk() ) {
+            _chunkIt++;
+            skipReferenced();
+         } else {
+            _freeIt++;
+         }
+      }
+};
+
 void RegionCache::selectChunksToInvalidate( std::size_t allocSize, std::set< std::pair< AllocatedChunk **, AllocatedChunk * > > &chunksToInvalidate, WD const &wd, unsigned int &otherReferencedChunks ) {
    //for ( it = _chunks.begin(); it != _chunks.end() && !done; it++ ) {
    //   *myThread->_file << "["<< count << "] this chunk: " << ((void *) it->second) << " refs: " << (int)( (it->second != NULL) ? it->second->getReferenceCount() : -1 ) << " dirty? " << (int)( (it->second != NULL) ? it->second->isDirty() : -1 )<< std::endl;
@@ -859,93 +904,83 @@ void RegionCache::selectChunksToInvalidate( std::size_t allocSize, std::set< std
    }
    if ( /*_device.supportsFreeSpaceInfo() */ true ) {
       MemoryMap<AllocatedChunk>::iterator it;
-      bool done = false;
-      MemoryMap< uint64_t > device_mem;
-
-      for ( it = _chunks.begin(); it != _chunks.end() && !done; it++ ) {
-         // if ( it->second != NULL ) {
-         //    global_reg_t reg = it->second->getAllocatedRegion();
-         //    *myThread->_file << "### this chunk: " << ((void *) it->second) << " refs " <<  it->second->getReferenceCount() << " size is " << it->second->getSize() << " vs " << allocSize << " ";
-         //    reg.key->printRegion( *myThread->_file, reg.id );
-         //    *myThread->_file << std::endl;
-         // }
-         if ( it->second != NULL && it->second != (AllocatedChunk *) -1 && (it->second != (AllocatedChunk *) -2) ) {
-            AllocatedChunk &c = *(it->second);
-            AllocatedChunk **chunk_at_map_ptr = &(it->second);
-            if ( it->second->getReferenceCount() == 0 && !(it->second->isRooted()) ) {
-               device_mem.addChunk( c.getAddress(), c.getSize(), (uint64_t) chunk_at_map_ptr );
-            } else {
-               bool mine = false;
-               for (unsigned int idx = 0; idx < wd.getNumCopies() && !mine ; idx += 1) {
-                  mine = ( wd._mcontrol._memCacheCopies[ idx ]._chunk == &c );
-               }
-               otherReferencedChunks += mine ? 0 : 1;
-            }
-         } else if ( it->second == (AllocatedChunk *) -1 ) {
-            otherReferencedChunks += 1;
-         }
-      }
-      
-      /* add the device free chunks */
+
+      /* the device free chunks, the unreferenced ones come from the address index */
       SimpleAllocator::ChunkList free_device_chunks;
       _device._getFreeMemoryChunksList( sys.getSeparateMemory( _memorySpaceId ), free_device_chunks );
-      for ( SimpleAllocator::ChunkList::iterator lit = free_device_chunks.begin(); lit != free_device_chunks.end(); lit++ ) {
-         device_mem.addChunk( lit->first, lit->second, (uint64_t) 0 );
-      }
 
-      MemoryMap< uint64_t >::iterator devIt, devItAhead;
+      _evictionLock.acquire();
       if ( VERBOSE_INVAL ) {
          *myThread->_file << "I can invalidate a set of these:" << std::endl;
-         for ( devIt = device_mem.begin(); devIt != device_mem.end(); devIt++ ) {
-            *myThread->_file << "Addr: " << (void *) devIt->first.getAddress() << " size: " << devIt->first.getLength() ;
-            if ( devIt->second == 0 ) {
+         for ( DeviceMemoryCursor cursor( _evictionAddressIndex, free_device_chunks ); !cursor.atEnd(); cursor.advance() ) {
+            *myThread->_file << "Addr: " << (void *) cursor.getAddress() << " size: " << cursor.getLength() ;
+            if ( cursor.getChunk() == NULL ) {
                *myThread->_file << " [free chunk] "<< std::endl;
             } else {
-               *myThread->_file << " " << (void *) *((AllocatedChunk **) devIt->second) << std::endl;
+               *myThread->_file << " " << (void *) cursor.getChunk() << std::endl;
             }
          }
       }
-      std::map< std::size_t, std::list< MemoryMap< uint64_t >::iterator > > candidates;
-
-      for ( devIt = device_mem.begin(); devIt != device_mem.end(); devIt++ ) {
-         std::size_t len = devIt->first.getLength();
-         uint64_t addr = devIt->first.getAddress();
-         std::size_t num_chunks = 0;
-         if ( devIt->second != 0 ) {
-            num_chunks += (*((AllocatedChunk **)(devIt->second)))->isDirty() ? devIt->first.getLength() : 0;
+      /* slide a window of contiguous chunks over the device memory, keep the
+       * first one covering allocSize with the least dirty bytes, stop at the
+       * first clean one */
+      DeviceMemoryCursor first( _evictionAddressIndex, free_device_chunks );
+      DeviceMemoryCursor last( first );
+      DeviceMemoryCursor selected( first );
+      bool found = false;
+      std::size_t selectedDirty = 0;
+      std::size_t len = 0;
+      std::size_t dirty = 0;
+      unsigned int count = 0;
+      for ( ; !first.atEnd() && !( found && selectedDirty == 0 ); first.advance() ) {
+         while ( len < allocSize && !last.atEnd() &&
+               ( count == 0 || first.getAddress() + len == last.getAddress() ) ) {
+            len += last.getLength();
+            dirty += last.getDirtyBytes();
+            count++;
+            last.advance();
          }
-         devItAhead = devIt;
-         devItAhead++;
-         bool fail = false;
-         while ( len < allocSize && !fail && devItAhead != device_mem.end() ) {
-            if ( addr + len == devItAhead->first.getAddress() ) {
-               len += devItAhead->first.getLength();
-               if ( devItAhead->second != 0 ) {
-                  num_chunks += (*((AllocatedChunk **)(devItAhead->second)))->isDirty() ? devItAhead->first.getLength() : 0;
-               }
-               devItAhead++;
-            } else {
-               fail = true;
-            }
+         if ( len >= allocSize && ( !found || dirty < selectedDirty ) ) {
+            selected = first;
+            selectedDirty = dirty;
+            found = true;
          }
-         if ( len >= allocSize && !fail ) {
-            candidates[ num_chunks ].push_back( devIt );
-         } 
-      } 
-      if ( !candidates.empty() ) {
-         MemoryMap< uint64_t >::iterator selectedIt = candidates.begin()->second.front();
+         len -= first.getLength();
+         dirty -= first.getDirtyBytes();
+         count--;
+      }
+      if ( found ) {
          if ( VERBOSE_INVAL ) {
-            *myThread->_file << "Im going to invalidaet from " << (void *) selectedIt->first.getAddress() << std::endl;
+            *myThread->_file << "Im going to invalidaet from " << (void *) selected.getAddress() << std::endl;
          }
          
-         for ( std::size_t len = selectedIt->first.getLength(); len < allocSize; selectedIt++ ) {
-            if ( selectedIt->second != 0 ) {
-               AllocatedChunk **this_chunk = (AllocatedChunk **) selectedIt->second;
-               chunksToInvalidate.insert( std::make_pair( this_chunk, *this_chunk ) );
+         for ( len = 0; len < allocSize; selected.advance() ) {
+            AllocatedChunk *this_chunk = selected.getChunk();
+            if ( this_chunk != NULL ) {
+               it = _chunks.find( MemoryChunk( this_chunk->getHostAddress(), this_chunk->getSize() ) );
+               ensure( it != _chunks.end() && it->second == this_chunk, "Evictable chunk not found in the cache map" );
+               chunksToInvalidate.insert( std::make_pair( &(it->second), this_chunk ) );
+            }
+            len += selected.getLength();
+         }
+      }
+      _evictionLock.release();
+      if ( !found ) {
+         /* count the chunks held by other WDs, without them the allocation can never succeed */
+         for ( it = _chunks.begin(); it != _chunks.end(); it++ ) {
+            if ( it->second != NULL && it->second != (AllocatedChunk *) -1 && (it->second != (AllocatedChunk *) -2) ) {
+               AllocatedChunk &c = *(it->second);
+               if ( c.getReferenceCount() != 0 || c.isRooted() ) {
+                  bool mine = false;
+                  for (unsigned int idx = 0; idx < wd.getNumCopies() && !mine ; idx += 1) {
+                     mine = ( wd._mcontrol._memCacheCopies[ idx ]._chunk == &c );
+                  }
+                  otherReferencedChunks += mine ? 0 : 1;
+               }
+            } else if ( it->second == (AllocatedChunk *) -1 ) {
+               otherReferencedChunks += 1;
             }
-            len += selectedIt->first.getLength();
          }
-      } else {
          // *myThread->_file << " failed to invalidate " << std::endl;
          // printReferencedChunksAndWDs();
       }
@@ -1367,6 +1402,9 @@ RegionCache::RegionCache( memory_space_id_t memSpaceId, Device &cacheArch, enum
    _mapVersionRequested( 0 ),
    _currentAllocations( 0 ),
    _allocatedBytes( 0 ),
+   _evictionIndex(),
+   _evictionAddressIndex(),
+   _evictionLock(),
     _copyInObj( *this ), _copyOutObj( *this ) 
    {
    // FIXME : improve flags propagation from system/plugins to cache.
@@ -44,7 +44,9 @@ inline std::size_t AllocatedChunk::getSize() const {
 }
 
 inline void AllocatedChunk::addReference( WD const &wd, unsigned int loc ) {
-   _refs++;
+   if ( ++_refs == 1 ) {
+      _owner.updateEvictionIndex( *this );
+   }
    _refWdId[&wd]++;
    _refLoc[wd.getId()].insert(loc);
    //std::cerr << "add ref to chunk "<< (void*)this << " " << _refs.value() << std::endl;
@@ -55,11 +57,14 @@ inline void AllocatedChunk::removeReference( WD const &wd ) {
    if ( _refs == 0 ) {
       *myThread->_file << " removeReference ON A CHUNK WITH 0 REFS!!!" << std::endl;
    }
-   _refs--;
+   unsigned int refs = --_refs;
    _refWdId[&wd]--;
    if ( _refWdId[&wd] == 0 ) {
       _refLoc[wd.getId()].clear();
    }
+   if ( refs == 0 ) {
+      _owner.updateEvictionIndex( *this );
+   }
    
    //std::cerr << "del ref to chunk "<< (void*)this << " " << _refs.value() << std::endl;
    //if ( _refs == (unsigned int) -1 ) {
@@ -100,6 +105,14 @@ inline bool RegionCache::canCopyFrom( RegionCache const &from ) const {
    return _device == from._device;
 }
 
+inline bool RegionCache::EvictionEntry::operator<( EvictionEntry const &entry ) const {
+   if ( _size != entry._size ) return _size < entry._size;
+   if ( _dirty != entry._dirty ) return !_dirty;
+   if ( _lruStamp != entry._lruStamp ) return _lruStamp < entry._lruStamp;
+   if ( _hostAddress != entry._hostAddress ) return _hostAddress < entry._hostAddress;
+   return _chunk < entry._chunk;
+}
+
 inline unsigned int RegionCache::getLruTime() const {
    return _lruTime;
 }
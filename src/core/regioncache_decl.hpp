@@ -143,6 +143,34 @@ namespace nanos {
          Atomic<unsigned int>       _currentAllocations;
          std::size_t                _allocatedBytes;
 
+         /*! \brief Entry of the eviction index
+          *
+          *  Unreferenced chunks are kept ordered by size, clean before dirty,
+          *  LRU stamp and host address, so eviction candidates are found with a
+          *  lookup instead of a walk over all the chunks. Entries are added when
+          *  a chunk loses its last reference and removed when it gets one again,
+          *  is destroyed or is chosen for eviction.
+          */
+         struct EvictionEntry {
+            std::size_t     _size;
+            bool            _dirty;
+            unsigned int    _lruStamp;
+            uint64_t        _hostAddress;
+            AllocatedChunk *_chunk;
+
+            EvictionEntry( std::size_t size, bool dirty, unsigned int lruStamp, uint64_t hostAddress, AllocatedChunk *chunk ) :
+               _size( size ), _dirty( dirty ), _lruStamp( lruStamp ), _hostAddress( hostAddress ), _chunk( chunk ) { }
+            bool operator<( EvictionEntry const &entry ) const;
+         };
+         typedef std::set< EvictionEntry > EvictionIndex;
+         //! The same unreferenced chunks by device address, to find runs of contiguous ones
+         typedef std::map< uint64_t, AllocatedChunk * > EvictionAddressIndex;
+         class DeviceMemoryCursor;
+
+         EvictionIndex              _evictionIndex;
+         EvictionAddressIndex       _evictionAddressIndex;
+         Lock                       _evictionLock;
+
          typedef MemoryMap<AllocatedChunk>::MemChunkList ChunkList;
          typedef MemoryMap<AllocatedChunk>::ConstMemChunkList ConstChunkList;
 
@@ -172,6 +200,9 @@ namespace nanos {
          } _copyOutObj;
 
          void doOp( Op *opObj, global_reg_t const &hostMem, uint64_t devBaseAddr, unsigned int location, DeviceOps *ops, AllocatedChunk *destinationChunk, AllocatedChunk *sourceChunk, WD const *wd ); 
+         AllocatedChunk **getEvictableSlot( EvictionEntry const &entry );
+         AllocatedChunk **findEvictableChunk( std::size_t size, bool dirty, bool currentLru );
+         void eraseFromEvictionIndex( AllocatedChunk const &chunk );
 
       public:
          RegionCache( memory_space_id_t memorySpaceId, Device &cacheArch, enum CacheOptions flags, std::size_t slabSize );
@@ -243,6 +274,8 @@ namespace nanos {
          size_t getTransferredReplacedOutData() const;
          bool shouldWriteThrough() const;
          void freeChunk( AllocatedChunk *chunk, WD const &wd );
+         void updateEvictionIndex( AllocatedChunk const &chunk );
+         void removeFromEvictionIndex( AllocatedChunk const &chunk );
          void removeFromAllocatedRegionMap( global_reg_t const& reg );
          void addToAllocatedRegionMap( global_reg_t const& reg );
          unsigned int getCurrentAllocations() const;
@@ -28,6 +28,7 @@
 #include "instrumentationmodule_decl.hpp"
 #include "os.hpp"
 #include "wddeque.hpp"
+#include "latencystats.hpp"
 #include "smpthread.hpp"
 #include "nanos-int.h"
 
@@ -35,6 +36,8 @@
 
 using namespace nanos;
 
+__thread unsigned int Scheduler::_successorChain = 0;
+
 void SchedulerConf::config (Config &cfg)
 {
    cfg.setOptionsSection ( "Core [Scheduler]", "Policy independent scheduler options"  );
@@ -50,6 +53,10 @@ void SchedulerConf::config (Config &cfg)
 
    cfg.registerConfigOption ( "hold-tasks", NEW Config::FlagOption( _holdTasks ), "Do not submit tasks until a taskwait is reached." );
    cfg.registerArgOption ( "hold-tasks", "hold-tasks" );
+
+   cfg.registerConfigOption ( "immediate-successor-depth", NEW Config::UintVar( _successorDepth ),
+                              "Set number of immediate successors run in a row before queueing one, 0 disables them (default = 64)" );
+   cfg.registerArgOption ( "immediate-successor-depth", "immediate-successor-depth" );
 }
 
 void Scheduler::submit ( WD &wd, bool force_queue )
@@ -81,6 +88,7 @@ void Scheduler::_submit ( WD &wd, bool force_queue )
          wd_tiedto->addNextWD( &wd );
       } else {
          wd_tiedto->getTeam()->getSchedulePolicy().queue( wd_tiedto, wd );
+         sys.getThreadManager()->notifyReadyTasks( 1 );
       }
       return;
    }
@@ -91,6 +99,7 @@ void Scheduler::_submit ( WD &wd, bool force_queue )
       * it in our scheduler system. Global ready task queue will take care about task/thread
       * architecture, while local ready task queue will wait until stealing. */
       mythread->getTeam()->getSchedulePolicy().queue( mythread, wd );
+      sys.getThreadManager()->notifyReadyTasks( 1 );
 
       return;
    }
@@ -109,6 +118,9 @@ void Scheduler::_submit ( WD &wd, bool force_queue )
    // And go on
    WD *next = getMyThreadSafe()->getTeam()->getSchedulePolicy().atSubmit( myThread, wd );
 
+   // Unless the policy kept it for this thread, the task is now waiting in a queue
+   if ( !next ) sys.getThreadManager()->notifyReadyTasks( 1 );
+
    /* If SchedulePolicy have returned a 'next' value, we have to context switch to
       that WorkDescriptor */
    if ( next ) {
@@ -142,35 +154,43 @@ void Scheduler::_submit ( WD ** wds, size_t numElems )
    
    BaseThread *mythread = myThread;
    
-   // create a vector of threads for each wd
+   // create a vector of threads for each wd, the ones submitted on their own are left out
    BaseThread ** threadList = NEW BaseThread*[numElems];
+   WD ** batch = NEW WD*[numElems];
+   size_t numBatched = 0;
    for( size_t i = 0; i < numElems; ++i )
    {
       WD* wd = wds[i];
       wd->_mcontrol.preInit();
-      
-      // If the wd is tied to anyone
+
+      // If the wd is tied to a thread out of any team, there is no policy to
+      // queue it in: submit it on its own, which hands it to that thread
       BaseThread *wd_tiedto = wd->isTiedTo();
-      if ( wd->isTied() && wd_tiedto != mythread ) {
-         if ( wd_tiedto->getTeam() == NULL ) {
-            //wd_tiedto->addNextWD( &wd );
-            // WHAT HERE???
-            fatal( "Uncontrolled batch path");
-         } else {
-            //wd_tiedto->getTeam()->getSchedulePolicy().queue( wd_tiedto, wd );
-            threadList[i] = wd_tiedto;
-         }
+      if ( wd->isTied() && wd_tiedto != mythread && wd_tiedto->getTeam() == NULL ) {
+         _submit( *wd );
          continue;
       }
-      // Otherwise, use mythread
-      threadList[i] = mythread;
+
+      // As in the single wd path, mark it submitted and ready before the
+      // policy publishes it. Held tasks and batch released successors used
+      // to reach the queues without either mark.
+      wd->submitted();
+      wd->setReady();
+
+      // If the wd is tied to anyone, queue it for that thread, otherwise use mythread
+      threadList[numBatched] = ( wd->isTied() && wd_tiedto != mythread ) ? wd_tiedto : mythread;
+      batch[numBatched++] = wd;
    }
    
    // Call the scheduling policy
-   mythread->getTeam()->getSchedulePolicy().queue( threadList, wds, numElems );
+   if ( numBatched > 0 ) {
+      mythread->getTeam()->getSchedulePolicy().queue( threadList, batch, numBatched );
+      sys.getThreadManager()->notifyReadyTasks( (int) numBatched );
+   }
    
    // Release
    delete[] threadList;
+   delete[] batch;
 }
 
 void Scheduler::updateCreateStats ( WD &wd )
@@ -321,7 +341,7 @@ inline void Scheduler::idleLoop ()
 
       if ( !next && thread->getTeam() != NULL ) {
          memoryFence();
-         if ( sys.getSchedulerStats()._readyTasks > 0 ) {
+         if ( sys.getSchedulerStats()._readyTasks.value() > 0 ) {
             NANOS_INSTRUMENT ( total_scheds++; )
             NANOS_INSTRUMENT ( unsigned long long begin_sched = (unsigned long long) ( OS::getMonotonicTime() * 1.0e9  ); )
             
@@ -331,6 +351,7 @@ inline void Scheduler::idleLoop ()
             if ( steal ) ++num_steals;
             
             next = behaviour::getWD(thread,current,steal*num_steals);
+            if ( steal ) LatencyStats::increment( next ? LatencyStats::STEAL_SUCCESS : LatencyStats::STEAL_FAILURE );
 
             NANOS_INSTRUMENT ( unsigned long long end_sched = (unsigned long long) ( OS::getMonotonicTime() * 1.0e9  ); )
             NANOS_INSTRUMENT (time_scheds += ( end_sched - begin_sched ); )
@@ -450,7 +471,7 @@ void Scheduler::waitOnCondition (GenericSyncCond *condition)
                //! Second calling scheduler policy at block
                if ( !next ) {
                   memoryFence();
-                  if ( sys.getSchedulerStats()._readyTasks > 0 ) {
+                  if ( sys.getSchedulerStats()._readyTasks.value() > 0 ) {
                      if ( sys.getSchedulerConf().getSchedulerEnabled() )
                         next = thread->getTeam()->getSchedulePolicy().atBlock( thread, current );
             if ( next != NULL ) {
@@ -517,6 +538,7 @@ void Scheduler::wakeUp ( WD *wd )
          ensure( myTeam, "Trying to wake up a WD from a thread without team." );
          myTeam = (myTeam)? myTeam : sys.getMainTeam();
          next = myTeam->getSchedulePolicy().atWakeUp( myThread, *wd );
+         if ( !next ) sys.getThreadManager()->notifyReadyTasks( 1 );
       }
 
       /* If SchedulePolicy have returned a 'next' value, we have to context switch to
@@ -580,8 +602,7 @@ struct AsyncWorkerBehaviour
          // Since this is the async behavior, set schedule to false:
          // do not prefetch at this point, as the thread will be always prefetching
          if ( Scheduler::inlineWorkAsync ( next, /* schedule */ false ) ) {
-            next->~WorkDescriptor();
-            delete[] ( char * ) next;
+            WD::destroy( next );
          }
       }
    }
@@ -757,7 +778,11 @@ void Scheduler::finishWork( WD * wd, bool schedule )
       BaseThread *thread = getMyThreadSafe();
       ThreadTeam *thread_team = thread->getTeam();
       if ( thread_team ) {
-         WD *prefetchedWD = thread_team->getSchedulePolicy().atBeforeExit( thread, *wd, schedule );
+         SchedulePolicy &policy = thread_team->getSchedulePolicy();
+         WD *prefetchedWD = policy.atBeforeExit( thread, *wd, schedule );
+         if ( !prefetchedWD && policy.usesImmediateSuccessor() ) {
+            prefetchedWD = getImmediateSuccessor( thread, *wd );
+         }
          if ( prefetchedWD ) {
             prefetchedWD->_mcontrol.preInit();
             thread->addNextWD( prefetchedWD );
@@ -770,6 +795,30 @@ void Scheduler::finishWork( WD * wd, bool schedule )
    wd->clear();
 }
 
+WD * Scheduler::getImmediateSuccessor ( BaseThread *thread, WD &wd )
+{
+   // Bound the chain so that a long sequence of successors does not keep
+   // growing the stack nor starve the tasks waiting in the queues
+   if ( _successorChain >= sys.getSchedulerConf().getImmediateSuccessorDepth() ) {
+      _successorChain = 0;
+      return NULL;
+   }
+
+   WD *successor = wd.getImmediateSuccessor( *thread );
+   if ( successor == NULL ) {
+      _successorChain = 0;
+      return NULL;
+   }
+
+   if ( !thread->getTeam()->getSchedulePolicy().atImmediateSuccessor( thread, wd, *successor ) ) {
+      _successorChain = 0;
+      return NULL;
+   }
+
+   _successorChain++;
+   return successor;
+}
+
 bool Scheduler::inlineWork ( WD *wd, bool schedule )
 {
    // Getting current thread and WD
@@ -947,8 +996,7 @@ void Scheduler::switchTo ( WD *to )
 
    } else {
       if (inlineWork(to, /*schedule*/ true)) {
-         to->~WorkDescriptor();
-         delete[] (char *)to;
+         WD::destroy( to );
       }
    }
 }
@@ -984,8 +1032,7 @@ void Scheduler::exitHelper (WD *oldWD, WD *newWD, void *arg)
 {
     myThread->exitHelperDependent(oldWD, newWD, arg);
     myThread->setCurrentWD( *newWD );
-    oldWD->~WorkDescriptor();
-    delete[] (char *)oldWD;
+    WD::destroy( oldWD );
 }
 
 struct ExitBehaviour
@@ -1002,8 +1049,7 @@ struct ExitBehaviour
       }
       else {
         if ( Scheduler::inlineWork ( next /*jb merge */, /*schedule*/ true ) ) {
-          next->~WorkDescriptor();
-          delete[] (char *)next;
+          WD::destroy( next );
         }
       }
    }
@@ -25,6 +25,7 @@
 #include <algorithm>
 
 #include "atomic.hpp"
+#include "shardedcounter.hpp"
 #include "synchronizedcondition_fwd.hpp"
 
 #include "schedule_decl.hpp"
@@ -79,6 +80,11 @@ inline bool SchedulerConf::getHoldTasksEnabled ( void ) const
    return _holdTasks;
 }
 
+inline unsigned int SchedulerConf::getImmediateSuccessorDepth ( void ) const
+{
+   return _successorDepth;
+}
+
 inline const std::string & SchedulePolicy::getName () const
 {
    return _name;
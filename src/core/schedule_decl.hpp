@@ -30,6 +30,7 @@
 
 #include "workdescriptor_decl.hpp"
 #include "atomic_decl.hpp"
+#include "shardedcounter_decl.hpp"
 #include "functors_decl.hpp"
 #include "basethread_decl.hpp"
 
@@ -50,6 +51,8 @@ namespace nanos {
          template<class behaviour>
          static void idleLoop (void);
 
+         static __thread unsigned int _successorChain; //!< Immediate successors run in a row by this thread
+
       public:
          static bool tryPreOutlineWork ( WD *work );
          static void preOutlineWork ( WD *work );
@@ -64,6 +67,10 @@ namespace nanos {
          static void _submit ( WD &wd, bool force_queue = false );
          /*! \brief Submits a set of wds. It only calls the policy's queue()
           *  method!
+          *
+          *  Each wd is marked submitted and ready, as the single wd submit
+          *  does. Tied wds whose thread is out of any team go through the
+          *  single wd submit instead.
           */
          static void submit ( WD ** wds, size_t numElems );
          static void _submit ( WD ** wds, size_t numElems );
@@ -83,6 +90,13 @@ namespace nanos {
 
          static WD * prefetch ( BaseThread *thread, WD &wd );
 
+         /*! \brief Releases a successor of wd that only waits for it and can run in thread,
+          *  so that it runs next without going through the ready queues.
+          *  Returns NULL when there is none, when the policy takes it or when
+          *  the chain of successors run in a row reached its limit.
+          */
+         static WD * getImmediateSuccessor ( BaseThread *thread, WD &wd );
+
          static void updateExitStats ( WD &wd );
          static void updateCreateStats ( WD &wd );
 
@@ -99,13 +113,14 @@ namespace nanos {
          bool                          _schedulerEnabled;  //!< Scheduler is enabled
          int                           _numStealAfterSpins;//!< Steal every so spins
          bool                          _holdTasks;         //!< Submit tasks when a taskwait is reached
+         unsigned int                  _successorDepth;    //!< Immediate successors run in a row before queueing one
       private: /* PRIVATE METHODS */
         //! \brief SchedulerConf default constructor (private)
         SchedulerConf() : _numSpins(1), _numChecks(1), _schedulerEnabled(true),
-        _numStealAfterSpins(1), _holdTasks(false) {}
+        _numStealAfterSpins(1), _holdTasks(false), _successorDepth(64) {}
         //! \brief SchedulerConf copy constructor (private)
         SchedulerConf ( SchedulerConf &sc ) : _numSpins(), _numChecks(),
-        _schedulerEnabled(), _holdTasks()
+        _schedulerEnabled(), _holdTasks(), _successorDepth()
         {
            fatal("SchedulerConf: Illegal use of class");
         }
@@ -128,6 +143,8 @@ namespace nanos {
          bool getSchedulerEnabled () const;
          //! \brief Returns if holding tasks is enabled 
          bool getHoldTasksEnabled () const;
+         //! \brief Returns the number of immediate successors run in a row before queueing one
+         unsigned int getImmediateSuccessorDepth () const;
 
          //! \brief Configure scheduler runtime options
          void config ( Config &cfg );
@@ -137,8 +154,10 @@ namespace nanos {
    {
          friend class WDDeque;
          friend class WDLFQueue;
+         friend class WDChaseLevDeque;
          friend class WDPriorityQueue<WD::PriorityType>;
          friend class WDPriorityQueue<double>;
+         friend class WDMultiPriorityQueue;
          friend class Scheduler;
          friend class System;
 
@@ -148,10 +167,10 @@ namespace nanos {
          friend class SlicerRepeatN;
          friend class SlicerCompoundWD;
       private:
-         Atomic<int>          _createdTasks;
-         Atomic<int>          _readyTasks;
+         ShardedCounter       _createdTasks;
+         ShardedCounter       _readyTasks;
          Atomic<int>          _idleThreads;
-         Atomic<int>          _totalTasks;
+         ShardedCounter       _totalTasks;
       private:
          /*! \brief SchedulerStats copy constructor (private)
           */
@@ -167,19 +186,14 @@ namespace nanos {
           */
          ~SchedulerStats () {}
 
+         /*! \brief Exact values, they add up the per-thread slots of the counters */
          int getCreatedTasks();
          int getReadyTasks();
-#ifdef HAVE_NEW_GCC_ATOMIC_OPS
-         int * getReadyTasksAddr( void ) { return &_readyTasks.override(); }
-#else
-         volatile int * getReadyTasksAddr( void ) { return &_readyTasks.override(); }
-#endif
          int getTotalTasks();
-#ifdef HAVE_NEW_GCC_ATOMIC_OPS
-         int * getTotalTasksAddr( void ) { return &_totalTasks.override(); }
-#else
-         volatile int * getTotalTasksAddr( void ) { return &_totalTasks.override(); }
-#endif
+
+         /*! \brief Counters, for conditions that need to poll them (e.g. throttling) */
+         ShardedCounter & getReadyTasksCounter( void ) { return _readyTasks; }
+         ShardedCounter & getTotalTasksCounter( void ) { return _totalTasks; }
    };
 
    class ScheduleTeamData {
@@ -303,6 +317,17 @@ namespace nanos {
          virtual void atShutdown    ( void );
          virtual void atSuccessor   ( DependableObject &depObj, DependableObject &pred );
 
+         /*! \brief Checks if the core scheduler runs the immediate successor of a
+          *  finished WD on the same thread, when atBeforeExit returns nothing.
+          *  \sa Scheduler::getImmediateSuccessor
+          */
+         virtual bool usesImmediateSuccessor () const { return false; }
+         /*! \brief Called when the core scheduler releases successor as the
+          *  immediate successor of current. Returns false if the policy does not
+          *  want it to run next, the policy must then have queued it.
+          */
+         virtual bool atImmediateSuccessor ( BaseThread *thread, WD &current, WD &successor ) { return true; }
+
          virtual void queue ( BaseThread *thread, WD &wd )  = 0;
          /*! \brief Batch processing version.
           *  The default behaviour calls queue() individually.
@@ -22,6 +22,7 @@
 
 #include "synchronizedcondition_decl.hpp"
 #include "atomic.hpp"
+#include "shardedcounter.hpp"
 #include "basethread_decl.hpp"
 #include "schedule_decl.hpp"
 
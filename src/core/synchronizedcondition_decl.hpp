@@ -24,6 +24,7 @@
 #include <list>
 #include <vector>
 #include "atomic_decl.hpp"
+#include "shardedcounter_decl.hpp"
 #include "lock_decl.hpp"
 #include "debug.hpp"
 #include "workdescriptor_fwd.hpp"
@@ -163,6 +164,47 @@ namespace nanos {
          }
    };
 
+  /*! \brief Checks a sharded counter for being less or equal than a condition.
+   *  The counter has no single address to poll, its exact value is read instead.
+   */
+   class CounterLessOrEqualConditionChecker : public ConditionChecker
+   {
+      protected:
+         ShardedCounter *_counter;   /**< counter wich value has to be checked. */
+         int             _condition; /**< counter value to ckeck for. */
+      public:
+         /*! \brief CounterLessOrEqualConditionChecker default constructor
+          */
+         CounterLessOrEqualConditionChecker() : ConditionChecker(), _counter( NULL ), _condition() {}
+         /*! \brief CounterLessOrEqualConditionChecker copy constructor
+          */
+         CounterLessOrEqualConditionChecker ( const CounterLessOrEqualConditionChecker & cc ) : ConditionChecker( cc )
+         {
+            this->_counter = cc._counter;
+            this->_condition = cc._condition;
+         }
+         /*! \brief CounterLessOrEqualConditionChecker copy assignment operator
+          */
+         CounterLessOrEqualConditionChecker& operator=( const CounterLessOrEqualConditionChecker & cc )
+         {
+            this->_counter = cc._counter;
+            this->_condition = cc._condition;
+            return *this;
+         }
+         /*! \brief CounterLessOrEqualConditionChecker constructor - 1
+          */
+         CounterLessOrEqualConditionChecker( ShardedCounter *counter, int condition )
+            : ConditionChecker(), _counter( counter ), _condition( condition ) {}
+         /*! \brief CounterLessOrEqualConditionChecker destructor
+          */
+         virtual ~CounterLessOrEqualConditionChecker() {}
+         /*! \brief Checks the counter against the condition.
+          */
+         virtual bool checkCondition() {
+            return ( this->_counter->value() <= this->_condition );
+         }
+   };
+
   /*! \brief Abstract synchronization class.
    */
    class GenericSyncCond
@@ -37,10 +37,14 @@
 #include "processingelement.hpp"
 #include "basethread.hpp"
 #include "allocator.hpp"
+#include "slaballocator.hpp"
+#include "latencystats.hpp"
+#include "queuelock.hpp"
 #include "debug.hpp"
 #include "smpthread.hpp"
 #include "regiondict.hpp"
 #include "smpprocessor.hpp"
+#include "smpstackpool.hpp"
 #include "location.hpp"
 #include "router.hpp"
 #include "addressspace.hpp"
@@ -111,7 +115,7 @@ namespace PMInterfaceType
 System::System () :
       _atomicWDSeed( 1 ), _threadIdSeed( 0 ), _peIdSeed( 0 ), _SMP("SMP"),
       /*jb _numPEs( INT_MAX ), _numThreads( 0 ),*/ _deviceStackSize( 0 ), _profile( false ),
-      _instrument( false ), _verboseMode( false ), _summary( false ), _executionMode( DEDICATED ), _initialMode( POOL ),
+      _instrument( false ), _verboseMode( false ), _summary( false ), _wdSlab( true ), _executionMode( DEDICATED ), _initialMode( POOL ),
       _untieMaster( true ), _delayedStart( false ), _synchronizedStart( true ), _alreadyFinished( false ),
       _predecessorLists( true ), _throttlePolicy ( NULL ),
       _schedStats(), _schedConf(), _defSchedule( "bf" ), _defThrottlePolicy( "hysteresis" ), 
@@ -129,12 +133,13 @@ System::System () :
 #ifdef NANOS_INSTRUMENTATION_ENABLED
       , _enableEvents(), _disableEvents(), _instrumentDefault("default"), _enableCpuidEvent( false )
 #endif
-      , _lockPoolSize(37), _lockPool( NULL ), _mainTeam (NULL), _simulator(false),  _task_max_retries(1), _affinityFailureCount( 0 )
+      , _lockPool(), _mainTeam (NULL), _simulator(false),  _task_max_retries(1), _affinityFailureCount( 0 )
       , _createLocalTasks( false )
       , _verboseDevOps( false )
       , _verboseCopies( false )
       , _splitOutputForThreads( false )
       , _userDefinedNUMANode( -1 )
+      , _numaPlacement()
       , _router()
       , _hwloc()
       , _immediateSuccessorDisabled( false )
@@ -143,6 +148,7 @@ System::System () :
       , _cgAlloc( true )
       , _inIdle( false )
 	   , _lazyPrivatizationEnabled (false)
+      , _reductionBlockSize( 64 * 1024 )
 	   , _preSchedule (false)
       , _slots()
 	   , _watchAddr (NULL)
@@ -154,8 +160,6 @@ System::System () :
    OS::init();
    config();
 
-   _lockPool = NEW Lock[_lockPoolSize];
-
    if ( !_delayedStart ) {
       //std::cerr << "NX_ARGS is:" << (char *)(OS::getEnvironmentVariable( "NX_ARGS" ) != NULL ? OS::getEnvironmentVariable( "NX_ARGS" ) : "NO NX_ARGS: GG!") << std::endl;
       start();
@@ -331,6 +335,11 @@ void System::config ()
                              "Activates summary mode" );
    cfg.registerArgOption( "summary", "summary" );
 
+   cfg.registerConfigOption( "wd-slab", NEW Config::FlagOption( _wdSlab ),
+                             "Allocates WD chunks from per-thread slab caches (enabled by default)" );
+   cfg.registerArgOption( "wd-slab", "wd-slab" );
+   cfg.registerEnvOption( "wd-slab", "NX_WD_SLAB" );
+
 //! \bug implement execution modes (#146) */
 #if 0
    cfg::MapVar<ExecutionMode> map( _executionMode );
@@ -459,6 +468,11 @@ void System::config ()
 		   "Enable lazy reduction privatization" );
    cfg.registerArgOption ( "enable-lazy-privatization", "enable-lazy-privatization" );
 
+   cfg.registerConfigOption ( "reduction-block-size", NEW Config::SizeVar ( _reductionBlockSize ),
+                              "Bytes of each block of the task reduction arrays that are reduced in parallel (0 reduces them serially)" );
+   cfg.registerArgOption ( "reduction-block-size", "reduction-block-size" );
+   cfg.registerEnvOption ( "reduction-block-size", "NX_REDUCTION_BLOCK_SIZE" );
+
    cfg.registerConfigOption( "preschedule", NEW Config::FlagOption( _preSchedule ),
                              "Enables pre scheduling" );
    cfg.registerArgOption( "preschedule", "preschedule" );
@@ -467,6 +481,8 @@ void System::config ()
 
    _hwloc.config( cfg );
    _threadManagerConf.config( cfg );
+   LatencyStats::config( cfg );
+   LockWaiter::config( cfg );
 
    verbose0 ( "Reading Configuration" );
 
@@ -612,6 +628,7 @@ void System::start ()
    //}   
 
    _targetThreads = _smpPlugin->getNumThreads();
+   _lockPool.init( _targetThreads );
 
    // Set up internal data for each worker
    for ( ThreadList::const_iterator it = _workers.begin(); it != _workers.end(); it++ ) {
@@ -763,7 +780,7 @@ void System::finish ()
    verbose ( "...thread has been joined" );
 
 
-   ensure( _schedStats._readyTasks == 0, "Ready task counter has an invalid value!");
+   ensure( _schedStats._readyTasks.value() == 0, "Ready task counter has an invalid value!");
 
    verbose ( "NANOS++ statistics");
    verbose ( std::dec << (unsigned int) getCreatedTasks() << " tasks has been executed" );
@@ -822,9 +839,6 @@ void System::finish ()
    _pmInterface->finish();
    delete _pmInterface;
 
-   //! \note deleting pool of locks
-   delete[] _lockPool;
-
    //! \note deleting main work descriptor
    delete ( WorkDescriptor * ) ( mythread->getCurrentWD() );
    delete ( WorkDescriptor * ) &( mythread->getThreadWD() );
@@ -866,11 +880,16 @@ void System::finish ()
    delete _pes[mythread->runningOn()->getId() ];
 
    //! \note deleting allocator (if any)
-   if ( allocator != NULL ) free (allocator);
+   if ( allocator != NULL ) {
+      allocator->~Allocator();
+      free (allocator);
+      allocator = NULL;
+   }
 
    verbose0 ( "NANOS++ shutting down.... end" );
    //! \note printing execution summary
    if ( _summary ) executionSummary();
+   LatencyStats::dumpJSON();
 
    _net.finalize(); //this can call exit (because of GASNet)
 }
@@ -936,6 +955,8 @@ void System::createWD ( WD **uwd, size_t num_devices, nanos_device_t *devices, s
 {
    ensure( num_devices > 0, "WorkDescriptor has no devices" );
 
+   LatencyScope latency( LatencyStats::TASK_CREATION );
+
    unsigned int i;
    char *chunk = 0;
 
@@ -994,7 +1015,10 @@ void System::createWD ( WD **uwd, size_t num_devices, nanos_device_t *devices, s
       total_size = NANOS_ALIGNED_MEMORY_OFFSET(offset_PMD,size_PMD,1);
    }
 
-   chunk = NEW char[total_size];
+   // WD chunks are freed through WD::destroy, only those holding the WD can come from the slab
+   bool inSlab = _wdSlab && *uwd == NULL;
+   if ( inSlab ) chunk = (char *) SlabAllocator::allocate( total_size );
+   else chunk = NEW char[total_size];
    if ( props != NULL ) {
       if (props->clear_chunk)
           memset(chunk, 0, sizeof(char) * total_size);
@@ -1024,6 +1048,8 @@ void System::createWD ( WD **uwd, size_t num_devices, nanos_device_t *devices, s
    wd =  new (*uwd) WD( num_devices, dev_ptrs, data_size, data_align, data != NULL ? *data : NULL,
                         num_copies, (copies != NULL)? *copies : NULL, translate_args, description );
 
+   if ( inSlab ) wd->setSlabAllocated();
+
    if ( slicer ) wd->setSlicer(slicer);
 
    // Set WD's socket
@@ -1179,7 +1205,9 @@ void System::duplicateWD ( WD **uwd, WD *wd)
       total_size = NANOS_ALIGNED_MEMORY_OFFSET(offset_PMD,size_PMD,1);
    }
 
-   chunk = NEW char[total_size];
+   bool inSlab = _wdSlab && *uwd == NULL;
+   if ( inSlab ) chunk = (char *) SlabAllocator::allocate( total_size );
+   else chunk = NEW char[total_size];
 
    // allocating WD and DATA; if size_Data == 0 data keep the NULL value
    if ( *uwd == NULL ) *uwd = (WD *) chunk;
@@ -1211,6 +1239,8 @@ void System::duplicateWD ( WD **uwd, WD *wd)
    //FIXME jbueno (#758) should we have to take into account dimensions?
    new (*uwd) WD( *wd, dev_ptrs, wdCopies, data );
 
+   if ( inSlab ) (*uwd)->setSlabAllocated();
+
    // Set total size
    (*uwd)->setTotalSize(total_size );
    
@@ -1309,6 +1339,39 @@ void System::submitWithDependencies (WD& work, size_t numDataAccesses, DataAcces
    current->submitWithDependencies( work, numDataAccesses , dataAccesses);
 }
 
+/*! \brief Submit a set of WorkDescriptors at once
+ */
+void System::submitBatch ( size_t numWDs, WD **wds, size_t *numDataAccesses, DataAccess **dataAccesses )
+{
+   SchedulePolicy* policy = getDefaultSchedulePolicy();
+
+   WD **ready = NEW WD*[numWDs];
+   size_t numReady = 0;
+   bool withDependencies = false;
+
+   for ( size_t i = 0; i < numWDs; i++ ) {
+      WD &work = *wds[i];
+      if ( numDataAccesses != NULL && dataAccesses != NULL && numDataAccesses[i] != 0 && dataAccesses[i] != NULL ) {
+         policy->onSystemSubmit( work, SchedulePolicy::SYS_SUBMIT_WITH_DEPENDENCIES );
+         withDependencies = true;
+         continue;
+      }
+
+      policy->onSystemSubmit( work, SchedulePolicy::SYS_SUBMIT );
+      if ( work.getSlicer() == NULL && policy->isValidForBatch( &work ) ) ready[numReady++] = &work;
+      else work.submit();
+   }
+
+   if ( withDependencies ) {
+      WD *current = myThread->getCurrentWD();
+      numReady += current->submitBatchWithDependencies( numWDs, wds, numDataAccesses, dataAccesses, ready + numReady );
+   }
+
+   if ( numReady > 0 ) Scheduler::submit( ready, numReady );
+
+   delete[] ready;
+}
+
 /*! \brief Wait on the current WorkDescriptor's domain for some dependenices to be satisfied
  */
 void System::waitOn( size_t numDataAccesses, DataAccess* dataAccesses )
@@ -1570,6 +1633,22 @@ void System::executionSummary( void )
    message0( "============ Nanos++ Final Execution Summary ============" );
    message0( "=== Application ended in " << seconds << " seconds" );
    message0( "=== " << getCreatedTasks() << " tasks have been executed" );
+
+   Allocator::Stats allocStats = Allocator::getRetiredStats();
+   if ( allocStats._arenas > 0 ) {
+      size_t frees = allocStats._localFrees + allocStats._remoteFrees;
+      message0( "=== Allocator: " << allocStats._arenas << " arenas, " << allocStats._peakBytesInUse << " bytes at the per-thread peaks (added up), "
+                << allocStats._bytesInUse << " bytes in use at exit" );
+      message0( "=== Allocator: " << allocStats._remoteFrees << " of " << frees << " frees done by a remote thread ("
+                << ( frees > 0 ? ( 100 * allocStats._remoteFrees ) / frees : 0 ) << "%)" );
+   }
+
+   ext::SMPStackPool::Stats stackStats = ext::SMPStackPool::getStats();
+   if ( stackStats._created > 0 ) {
+      message0( "=== Task stacks: " << stackStats._peakInUse << " peak in use, " << stackStats._created << " created, "
+                << stackStats._mapped << " mapped at exit, " << stackStats._trimmed << " trimmed" );
+   }
+   LatencyStats::summary();
    message0( "=========================================================" );
 }
 
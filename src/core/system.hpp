@@ -25,6 +25,7 @@
 #include <vector>
 #include <string>
 #include "schedule_decl.hpp"
+#include "shardedcounter.hpp"
 #include "threadteam.hpp"
 #include "slicer.hpp"
 #include "nanos-int.h"
@@ -77,6 +78,10 @@ inline int System::getTaskNum() const { return _schedStats._totalTasks.value();
 
 inline int System::getReadyNum() const { return _schedStats._readyTasks.value(); }
 
+inline int System::getApproxTaskNum() const { return _schedStats._totalTasks.approximate(); }
+
+inline int System::getApproxReadyNum() const { return _schedStats._readyTasks.approximate(); }
+
 inline int System::getIdleNum() const { return _schedStats._idleThreads.value(); }
 
 inline int System::getRunningTasks() const { return _workers.size() - _schedStats._idleThreads.value(); }
@@ -507,7 +512,7 @@ inline int System::nextThreadId () { return _threadIdSeed++; }
 
 inline unsigned int System::nextPEId () { return _peIdSeed++; }
 
-inline Lock * System::getLockAddress ( void *addr ) const { return &_lockPool[((((uintptr_t)addr)>>8)%_lockPoolSize)];} ;
+inline nanos_lock_t * System::getLockAddress ( void *addr ) { return _lockPool.getLock( addr ); }
 
 inline bool System::haveDependencePendantWrites ( void *addr ) const
 {
@@ -606,6 +611,10 @@ inline void System::setUserDefinedNUMANode( int nodeId ) {
    _userDefinedNUMANode = nodeId;
 }
 
+inline NumaPlacement & System::getNumaPlacement() {
+   return _numaPlacement;
+}
+
 inline unsigned int System::getNumAccelerators() const {
    return _acceleratorCount;
 }
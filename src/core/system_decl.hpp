@@ -41,6 +41,8 @@
 #include "addressspace_decl.hpp"
 #include "smpbaseplugin_decl.hpp"
 #include "hwloc_decl.hpp"
+#include "numaplacement_decl.hpp"
+#include "lockpool_decl.hpp"
 #include "threadmanager_decl.hpp"
 #include "router_decl.hpp"
 
@@ -116,6 +118,7 @@ namespace nanos {
          bool                 _verboseMode;
          bool                 _summary;               //!< \brief Flag to enable the summary
          time_t               _summaryStartTime;      //!< \brief Track time to show duration in summary
+         bool                 _wdSlab;                //!< \brief Allocate WD chunks from the SlabAllocator
          ExecutionMode        _executionMode;
          InitialMode          _initialMode;
          bool                 _untieMaster;
@@ -227,8 +230,7 @@ namespace nanos {
          bool                      _enableCpuidEvent;
 #endif
 
-         const int                 _lockPoolSize;
-         Lock *                    _lockPool;
+         LockPool                  _lockPool;          /**< Locks of nanos_get_lock_address */
          ThreadTeam               *_mainTeam;
          bool                      _simulator;
 
@@ -252,6 +254,7 @@ namespace nanos {
          bool _verboseCopies;
          bool _splitOutputForThreads;
          int _userDefinedNUMANode;
+         NumaPlacement _numaPlacement;
          Router _router;
          Lock _allocLock;
       public:
@@ -262,6 +265,7 @@ namespace nanos {
          bool _cgAlloc;
          bool _inIdle;
          bool _lazyPrivatizationEnabled;
+         size_t _reductionBlockSize;
          bool _preSchedule;
          std::map<int, std::set<WD *> > _slots;
          void *_watchAddr;
@@ -302,6 +306,15 @@ namespace nanos {
 
          void submit ( WD &work );
          void submitWithDependencies (WD& work, size_t numDataAccesses, DataAccess* dataAccesses);
+         /*! \brief Submits several WDs at once
+          *
+          *  Dependences of the whole batch are registered in a single domain
+          *  critical section and the WDs that are ready are handed to the
+          *  scheduling policy in one queue call.
+          *  \param numDataAccesses Number of dependences of each WD (may be NULL)
+          *  \param dataAccesses Dependences of each WD (may be NULL)
+          */
+         void submitBatch ( size_t numWDs, WD **wds, size_t *numDataAccesses, DataAccess **dataAccesses );
          void waitOn ( size_t numDataAccesses, DataAccess* dataAccesses);
          void inlineWork ( WD &work );
 
@@ -348,6 +361,13 @@ namespace nanos {
 
          int getReadyNum() const;
 
+         /*! \brief Cheap reads of the task counters, they may be off by up to
+          *  ShardedCounter::skew() tasks. Meant for throttling decisions.
+          */
+         int getApproxTaskNum() const;
+
+         int getApproxReadyNum() const;
+
          int getRunningTasks() const;
 
          int getNumWorkers() const;
@@ -618,9 +638,9 @@ namespace nanos {
           */
          void registerPluginOption ( const std::string &option, const std::string &module, std::string &var, const std::string &helpMessage, Config &cfg );
 
-         /*! \brief Returns one of the system lock (belonging to the pool of locks)
+         /*! \brief Returns the lock associated to addr (belonging to the pool of locks)
           */
-         Lock * getLockAddress(void *addr ) const;
+         nanos_lock_t * getLockAddress( void *addr );
 
          /*! \brief Returns if there are pendant writes for a given memory address
           *
@@ -698,6 +718,8 @@ namespace nanos {
          memory_space_id_t getMemorySpaceIdOfClusterNode( unsigned int node ) const;
          int getUserDefinedNUMANode() const;
          void setUserDefinedNUMANode( int nodeId );
+         //! Placement of the memory allocated with nanos_numa_malloc
+         NumaPlacement & getNumaPlacement();
          void registerObject( int numObjects, nanos_copy_data_internal_t *obj );
          void unregisterObject( int numObjects, void *base_addresses );
 
@@ -0,0 +1,229 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "system.hpp"
+#include "task_reduction.hpp"
+#include "basethread.hpp"
+#include "threadteam.hpp"
+#include "instrumentation.hpp"
+#include "atomic.hpp"
+#include "smpdd.hpp"
+#include <string.h>
+#include <alloca.h>
+#include <algorithm>
+
+namespace nanos {
+
+/*! \class TaskReductionJob
+ *  \brief Blocks of a task reduction shared by the calling thread and its helper tasks
+ *
+ *  Blocks are handed out in order from a shared counter. Helper tasks that start
+ *  after all of them have been taken just drop their reference, so the calling
+ *  thread only waits for the blocks being reduced and never for helpers that are
+ *  still queued.
+ */
+class TaskReductionJob
+{
+   private:
+      TaskReduction    &_reduction;
+      size_t           *_ids;           /**< Private copies to reduce */
+      size_t            _numIds;
+      size_t            _blockElements;
+      size_t            _numBlocks;
+      Atomic<size_t>    _next;          /**< Next block to reduce */
+      Atomic<size_t>    _done;          /**< Blocks already reduced */
+      Atomic<int>       _references;    /**< Helper tasks still to run, plus the calling thread */
+
+      TaskReductionJob ( const TaskReductionJob & );
+      const TaskReductionJob & operator= ( const TaskReductionJob & );
+
+   public:
+      TaskReductionJob ( TaskReduction &reduction, const size_t *ids, size_t numIds, size_t blockElements,
+                         size_t numBlocks, int references )
+         : _reduction( reduction ), _ids( NEW size_t[numIds] ), _numIds( numIds ), _blockElements( blockElements ),
+           _numBlocks( numBlocks ), _next( 0 ), _done( 0 ), _references( references )
+      {
+         memcpy( _ids, ids, numIds * sizeof( size_t ) );
+      }
+
+      ~TaskReductionJob () { delete[] _ids; }
+
+      //! \brief Reduces blocks until all of them have been taken
+      void run ()
+      {
+         size_t block;
+         while ( ( block = _next.fetchAndAdd() ) < _numBlocks ) {
+            size_t first = block * _blockElements;
+            size_t last = std::min( first + _blockElements, _reduction._num_elements );
+            _reduction.reduceBlock( _ids, _numIds, first, last );
+            _done++;
+         }
+      }
+
+      bool finished () { return _done.value() == _numBlocks; }
+
+      //! \brief Drops a reference, the last one deletes the job
+      void release () { if ( --_references == 0 ) delete this; }
+};
+
+} // namespace nanos
+
+using namespace nanos;
+
+template <typename T> struct ReductionAdd { static T apply ( T a, T b ) { return a + b; } };
+template <typename T> struct ReductionProd { static T apply ( T a, T b ) { return a * b; } };
+template <typename T> struct ReductionMin { static T apply ( T a, T b ) { return a < b ? a : b; } };
+template <typename T> struct ReductionMax { static T apply ( T a, T b ) { return a > b ? a : b; } };
+
+//! \brief Built-in combiner, a plain loop over contiguous elements the compiler can vectorize
+template <typename T, class Op>
+static void combineArray ( void *dst, const void *src, size_t first, size_t last )
+{
+   T * __restrict__ d = ( T * ) dst + first;
+   const T * __restrict__ s = ( const T * ) src + first;
+   size_t n = last - first;
+
+   for ( size_t j = 0; j < n; j++ ) d[j] = Op::apply( d[j], s[j] );
+}
+
+template <typename T>
+static TaskReduction::combiner_t findTypedCombiner ( nanos_reduction_op_t op )
+{
+   switch ( op ) {
+      case NANOS_REDUCTION_ADD: return combineArray<T, ReductionAdd<T> >;
+      case NANOS_REDUCTION_PROD: return combineArray<T, ReductionProd<T> >;
+      case NANOS_REDUCTION_MIN: return combineArray<T, ReductionMin<T> >;
+      case NANOS_REDUCTION_MAX: return combineArray<T, ReductionMax<T> >;
+      default: return NULL;
+   }
+}
+
+static void reductionHelper ( void *arg )
+{
+   TaskReductionJob *job = *( TaskReductionJob ** ) arg;
+   job->run();
+   job->release();
+}
+
+static void * reductionHelperFactory ( void * )
+{
+   return ( void * ) NEW ext::SMPDD( reductionHelper );
+}
+
+TaskReduction::combiner_t TaskReduction::findCombiner ( nanos_reduction_op_t op, nanos_reduction_type_t type, size_t size_elem )
+{
+   //! Elements that do not match the type are left to the user reducer
+   switch ( type ) {
+      case NANOS_REDUCTION_INT:
+         return size_elem == sizeof( int ) ? findTypedCombiner<int>( op ) : NULL;
+      case NANOS_REDUCTION_FLOAT:
+         return size_elem == sizeof( float ) ? findTypedCombiner<float>( op ) : NULL;
+      case NANOS_REDUCTION_DOUBLE:
+         return size_elem == sizeof( double ) ? findTypedCombiner<double>( op ) : NULL;
+      default:
+         return NULL;
+   }
+}
+
+void TaskReduction::combine ( void *dst, const void *src, size_t first, size_t last, reducer_t reducer )
+{
+   if ( _combiner != NULL ) return _combiner( dst, src, first, last );
+
+   for ( size_t j = first; j < last; j++ ) {
+      reducer( &( (char *) dst )[j * _size_element], &( (char *) src )[j * _size_element] );
+   }
+}
+
+void TaskReduction::reduceBlock ( const size_t *ids, size_t num_ids, size_t first, size_t last )
+{
+   for ( size_t stride = 1; stride < num_ids; stride *= 2 ) {
+      for ( size_t i = 0; i + stride < num_ids; i += 2 * stride ) {
+         combine( _storage[ids[i]].data, _storage[ids[i + stride]].data, first, last, _reducer );
+      }
+   }
+   combine( _original, _storage[ids[0]].data, first, last, _reducer_orig_var );
+}
+
+void TaskReduction::reduceInParallel ( const size_t *ids, size_t num_ids, size_t block_elements, size_t num_blocks )
+{
+   ThreadTeam *team = myThread->getTeam();
+   size_t helpers = std::min( (size_t) team->getFinalSize() - 1, num_blocks - 1 );
+
+   TaskReductionJob *job = NEW TaskReductionJob( *this, ids, num_ids, block_elements, num_blocks, helpers + 1 );
+
+   nanos_device_t device = { reductionHelperFactory, NULL };
+   nanos_wd_props_t props;
+   nanos_wd_dyn_props_t dyn_props;
+   memset( &props, 0, sizeof( props ) );
+   memset( &dyn_props, 0, sizeof( dyn_props ) );
+   props.mandatory_creation = true;
+
+   WD *parent = myThread->getCurrentWD();
+   for ( size_t i = 0; i < helpers; i++ ) {
+      WD *wd = NULL;
+      TaskReductionJob **data = NULL;
+      sys.createWD( &wd, 1, &device, sizeof( TaskReductionJob * ), __alignof__( TaskReductionJob * ), (void **) &data,
+                    parent, &props, &dyn_props, 0, NULL, 0, NULL, NULL, "task reduction", NULL );
+      *data = job;
+      sys.setupWD( *wd, parent );
+      sys.submit( *wd );
+   }
+
+   job->run();
+   while ( !job->finished() ) myThread->yield();
+   job->release();
+}
+
+void TaskReduction::reduce()
+{
+   NANOS_INSTRUMENT( sys.getInstrumentation()->raiseOpenBurstEvent ( sys.getInstrumentation()->getInstrumentationDictionary()->getEventKey( "reduction" ), 2) );
+
+   //find the private copies that were initialized during execution
+   size_t *ids = (size_t *) alloca( sizeof( size_t ) * _num_threads );
+   size_t num_ids = 0;
+   for ( size_t i = 0; i < _num_threads; i++ ) {
+      if ( _storage[i].isInitialized ) ids[num_ids++] = i;
+   }
+
+   if ( num_ids > 0 ) {
+      if( _isFortranArrayReduction ) {
+         //reduce all to the first one and then to the global variable
+         for ( size_t i = 1; i < num_ids; i++ ) {
+            _reducer( _storage[ids[0]].data, _storage[ids[i]].data );
+         }
+         _reducer_orig_var( _original, _storage[ids[0]].data );
+      } else {
+         size_t block_elements = std::max( sys._reductionBlockSize / _size_element, (size_t) 1 );
+         size_t num_blocks = ( _num_elements + block_elements - 1 ) / block_elements;
+
+         if ( sys._reductionBlockSize > 0 && num_blocks > 1 && myThread->getTeam() != NULL &&
+              myThread->getTeam()->getFinalSize() > 1 ) {
+            reduceInParallel( ids, num_ids, block_elements, num_blocks );
+         } else {
+            reduceBlock( ids, num_ids, 0, _num_elements );
+         }
+      }
+
+      for ( size_t i = 0; i < num_ids; i++ ) {
+         _storage[ids[i]].isInitialized = false;
+      }
+   }
+
+   NANOS_INSTRUMENT( sys.getInstrumentation()->raiseCloseBurstEvent ( sys.getInstrumentation()->getInstrumentationDictionary()->getEventKey( "reduction" ), 0 ) );
+}
@@ -50,49 +50,6 @@ inline unsigned TaskReduction::getDepth( void ) const
    return _depth;
 }
 
-inline void TaskReduction::reduce()
-{
-   NANOS_INSTRUMENT( sys.getInstrumentation()->raiseOpenBurstEvent ( sys.getInstrumentation()->getInstrumentationDictionary()->getEventKey( "reduction" ), 2) );
-
-   //find first private copy that was allocated during execution
-   size_t masterId = 0;
-   for ( size_t i=0; i<_num_threads; i++) {
-      if ( _storage[i].isInitialized ){
-         masterId = i;
-         break;
-      }
-   }
-
-   //reduce all to masterId
-   for ( size_t i = masterId + 1; i<_num_threads; i++) {
-      if ( _storage[i].isInitialized ) {
-
-         if( _isFortranArrayReduction ) {
-            _reducer((char*)_storage[masterId].data ,(_storage[i].data));
-         } else {
-            for( size_t j=0; j<_num_elements; j++ ) {
-               _reducer( &((char*)_storage[masterId].data)[j*_size_element] ,& ((char*)(_storage[i].data))[j*_size_element]);
-            }
-         }
-         _storage[i].isInitialized = false;
-      }
-   }
-
-   //reduce masterId to global
-   if( _storage[masterId].isInitialized ) {
-      if( _isFortranArrayReduction ) {
-         _reducer_orig_var(_original ,_storage[masterId].data);
-      } else {
-         for( size_t j=0; j<_num_elements; j++ ){
-            _reducer_orig_var( &((char*)_original)[j*_size_element] ,& ((char*)(_storage[masterId].data))[j*_size_element]);
-         }
-      }
-      _storage[masterId].isInitialized = false;
-   }
-
-   NANOS_INSTRUMENT( sys.getInstrumentation()->raiseCloseBurstEvent ( sys.getInstrumentation()->getInstrumentationDictionary()->getEventKey( "reduction" ), 0 ) );
-}
-
 inline void TaskReduction::initialize( size_t id )
 {
 	NANOS_INSTRUMENT( sys.getInstrumentation()->raiseOpenBurstEvent ( sys.getInstrumentation()->getInstrumentationDictionary()->getEventKey( "reduction" ), 1 ) );
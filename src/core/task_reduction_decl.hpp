@@ -37,6 +37,8 @@ class TaskReduction {
 
       typedef void ( *initializer_t ) ( void *omp_priv,  void* omp_orig );
       typedef void ( *reducer_t ) ( void *obj1, void *obj2 );
+      //! \brief Combines elements [first, last) of the array src into dst
+      typedef void ( *combiner_t ) ( void *dst, const void *src, size_t first, size_t last );
       typedef struct {void * data; bool isInitialized;} field_t;
       typedef std::vector<field_t> storage_t;
 
@@ -67,20 +69,40 @@ class TaskReduction {
       void           *_max;              //!< Pointer to last private copy
       bool            _isLazyPriv;       //!< Is lazy privatization enabled
       bool            _isFortranArrayReduction;//!< whether this is a Fortran array reudction
+      combiner_t      _combiner;         //!< Built-in operator code, NULL for user defined reducers
 
       //! \brief TaskReduction copy constructor (disabled)
       TaskReduction( const TaskReduction &tr ) {}
 
+      //! \brief Returns the code of a built-in operator for elements of size_elem bytes, or NULL
+      static combiner_t findCombiner( nanos_reduction_op_t op, nanos_reduction_type_t type, size_t size_elem );
+
+      //! \brief Combines elements [first, last) of src into dst, with reducer unless the operator is a built-in one
+      void combine( void *dst, const void *src, size_t first, size_t last, reducer_t reducer );
+
+      //! \brief Combines elements [first, last) of the private copies in ids into the original variable
+      //!
+      //! Copies are combined pairwise in a tree, so that each partial result takes
+      //! part in log2(num_ids) operations.
+      void reduceBlock( const size_t *ids, size_t num_ids, size_t first, size_t last );
+
+      //! \brief Reduces in parallel with helper tasks of the current team, see reduce()
+      void reduceInParallel( const size_t *ids, size_t num_ids, size_t block_elements, size_t num_blocks );
+
+      friend class TaskReductionJob;
+
    public:
 
       //! \brief TaskReduction constructor only used when we are performing a Reduction
       TaskReduction( void *orig, initializer_t f_init, reducer_t f_red,
     		  	  size_t size, size_t size_elem, size_t
-				  threads, unsigned depth, bool lazy )
+				  threads, unsigned depth, bool lazy,
+				  nanos_reduction_op_t op = NANOS_REDUCTION_USER_OP, nanos_reduction_type_t type = NANOS_REDUCTION_INT )
                	   : _original(orig), _dependence(orig), _depth(depth), _initializer(f_init),
 					 _reducer(f_red), _reducer_orig_var(f_red), _storage(threads),
 					 _size(size), _size_element(size_elem),_num_elements(size/size_elem),
-					 _num_threads(threads), _min(NULL), _max(NULL), _isLazyPriv (lazy), _isFortranArrayReduction(false)
+					 _num_threads(threads), _min(NULL), _max(NULL), _isLazyPriv (lazy), _isFortranArrayReduction(false),
+					 _combiner( findCombiner( op, type, size_elem ) )
    {
       if(_isLazyPriv) {
          //Note that renaming tracking for nested reductions is not supported
@@ -111,7 +133,8 @@ class TaskReduction {
          : _original(orig), _dependence(dep), _depth(depth),
          _initializer(f_init), _reducer(f_red), _reducer_orig_var(f_red_orig_var), _storage(threads),
          _size(array_descriptor_size), _size_element(0),_num_elements(0),
-         _num_threads(threads), _min(NULL), _max(NULL), _isLazyPriv(lazy), _isFortranArrayReduction(true)
+         _num_threads(threads), _min(NULL), _max(NULL), _isLazyPriv(lazy), _isFortranArrayReduction(true),
+         _combiner(NULL)
    {
 
       if(_isLazyPriv) {
@@ -160,6 +183,10 @@ class TaskReduction {
       //original one. Currently, it also re-initializes to the neutral element
       //these private copies because we cannot guarantee that the reduction has
       //been finalized
+      //!
+      //! Arrays bigger than the reduction block size (--reduction-block-size) are
+      //! split in blocks that helper tasks of the current team reduce in parallel
+      //! with the calling thread.
       void reduce();
 
       //! \brief It allocates the private copy associated with the 'id' thread
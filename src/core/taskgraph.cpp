@@ -0,0 +1,281 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "taskgraph_decl.hpp"
+#include "dependableobject.hpp"
+#include "dependenciesdomain.hpp"
+#include "dataaccess.hpp"
+#include "workdescriptor.hpp"
+#include "schedule.hpp"
+#include "system.hpp"
+#include <algorithm>
+
+using namespace nanos;
+
+TaskGraph::~TaskGraph ()
+{
+   delete[] _slots;
+}
+
+unsigned char TaskGraph::getFlags ( DataAccess const &access )
+{
+   return ( access.isInput() ? 0x1 : 0 ) | ( access.isOutput() ? 0x2 : 0 ) | ( access.canRename() ? 0x4 : 0 ) |
+          ( access.isConcurrent() ? 0x8 : 0 ) | ( access.isCommutative() ? 0x10 : 0 );
+}
+
+bool TaskGraph::matches ( Node const &node, size_t numDeps, DataAccess *deps ) const
+{
+   if ( node._numAccesses != numDeps ) return false;
+
+   for ( size_t i = 0; i < numDeps; i++ ) {
+      Access const &access = _accesses[node._firstAccess + i];
+      DataAccess const &dep = deps[i];
+
+      if ( access._address != dep.getAddress() || access._offset != dep.getOffset() ||
+           access._flags != getFlags( dep ) || access._numDimensions != dep.getNumDimensions() ) return false;
+
+      nanos_region_dimension_internal_t const *dims = dep.getDimensions();
+      for ( short d = 0; d < access._numDimensions; d++ ) {
+         nanos_region_dimension_internal_t const &recorded = _dimensions[access._firstDimension + d];
+         if ( recorded.size != dims[d].size || recorded.lower_bound != dims[d].lower_bound ||
+              recorded.accessed_length != dims[d].accessed_length ) return false;
+      }
+   }
+   return true;
+}
+
+TaskGraph::Span TaskGraph::getSpan ( DataAccess const &access )
+{
+   // Plain dependences only compare the dependence address, regions the bytes accessed
+   uintptr_t address = ( uintptr_t ) access.getDepAddress();
+   uintptr_t first = ( uintptr_t ) access.getAddress() + access.getOffset();
+   uintptr_t last = first;
+   uintptr_t stride = 1;
+
+   nanos_region_dimension_internal_t const *dims = access.getDimensions();
+   for ( short d = 0; d < access.getNumDimensions(); d++ ) {
+      first += dims[d].lower_bound * stride;
+      last += ( dims[d].lower_bound + ( dims[d].accessed_length > 0 ? dims[d].accessed_length - 1 : 0 ) ) * stride;
+      stride *= dims[d].size;
+   }
+   return Span( std::min( address, first ), std::max( address, last ) + 1 );
+}
+
+void TaskGraph::clear ( )
+{
+   _nodes.clear();
+   _accesses.clear();
+   _dimensions.clear();
+   _spans.clear();
+   _maxSpan = 0;
+   delete[] _slots;
+   _slots = NULL;
+   _next = 0;
+}
+
+void TaskGraph::drain ( )
+{
+   _drainedSyncCond.waitConditionAndSignalers();
+}
+
+void TaskGraph::begin ( )
+{
+   switch ( _state ) {
+      case DIVERGED:
+         clear();
+         // fall through
+      case EMPTY:
+         _state = RECORDING;
+         break;
+      case RECORDED:
+         // Objects of the previous instance finished after the region ended, without clearing their slots
+         for ( unsigned int i = 0; i < _nodes.size(); i++ ) {
+            _slots[i]._live = NULL;
+         }
+         _next = 0;
+         _pending = 0;
+         _state = REPLAYING;
+         break;
+      default:
+         break;
+   }
+}
+
+void TaskGraph::end ( )
+{
+   switch ( _state ) {
+      case RECORDING:
+         _spans.clear();
+         _maxSpan = 0;
+         _slots = NEW Slot[_nodes.size()];
+         _state = RECORDED;
+         break;
+      case REPLAYING:
+         // Replayed objects may still be running, the graph is recorded again on the next begin
+         _state = ( _next == _nodes.size() ) ? RECORDED : DIVERGED;
+         break;
+      default:
+         break;
+   }
+}
+
+bool TaskGraph::replay ( DependableObject &depObj, size_t numDeps, DataAccess *deps,
+                         SchedulePolicySuccessorFunctor *callback )
+{
+   if ( _state != REPLAYING ) return false;
+
+   if ( _next == _nodes.size() || !matches( _nodes[_next], numDeps, deps ) ) {
+      // Tasks replayed so far are unknown to the domain, wait for them before using it
+      interrupt();
+      return false;
+   }
+
+   unsigned int id = _next++;
+   Node const &node = _nodes[id];
+
+   depObj.setId( id );
+   depObj.init();
+
+   // Not ready until every predecessor has been linked, as in the domain
+   depObj.increasePredecessors();
+
+   for ( std::vector<unsigned int>::const_iterator it = node._predecessors.begin(); it != node._predecessors.end(); it++ ) {
+      Slot &slot = _slots[*it];
+      LockBlock lock( slot._lock );
+
+      DependableObject *pred = slot._live;
+      if ( pred == NULL ) continue;
+
+      SyncLockBlock predLock( pred->getLock() );
+      if ( pred->addSuccessor( depObj ) ) {
+         depObj.increasePredecessors();
+         if ( callback != NULL ) {
+            ( *callback )( pred, &depObj );
+         }
+      }
+   }
+
+   {
+      LockBlock lock( _slots[id]._lock );
+      _slots[id]._live = &depObj;
+   }
+   _pending++;
+
+   sys.getDefaultSchedulePolicy()->atCreate( depObj );
+
+   DependenciesDomain::increaseTasksInGraph();
+
+   depObj.submitted();
+
+   depObj.decreasePredecessors( NULL, NULL, false );
+
+   return true;
+}
+
+void TaskGraph::record ( size_t numDeps, DataAccess *deps )
+{
+   if ( _state != RECORDING ) return;
+
+   unsigned int id = _nodes.size();
+   Node node;
+   node._firstAccess = _accesses.size();
+   node._numAccesses = numDeps;
+
+   for ( size_t i = 0; i < numDeps; i++ ) {
+      DataAccess const &dep = deps[i];
+
+      // Commutation objects and reductions live in the domain, outside the graph
+      if ( dep.isConcurrent() || dep.isCommutative() ) {
+         interrupt();
+         return;
+      }
+
+      Access access;
+      access._address = dep.getAddress();
+      access._offset = dep.getOffset();
+      access._firstDimension = _dimensions.size();
+      access._numDimensions = dep.getNumDimensions();
+      access._flags = getFlags( dep );
+      _accesses.push_back( access );
+
+      _dimensions.insert( _dimensions.end(), dep.getDimensions(), dep.getDimensions() + dep.getNumDimensions() );
+
+      // Depend on every overlapping span, no span starts before span.first - _maxSpan and overlaps it
+      Span span = getSpan( dep );
+      Span from( span.first > _maxSpan ? span.first - _maxSpan : 0, 0 );
+      for ( SpanMap::const_iterator it = _spans.lower_bound( from ); it != _spans.end() && it->first.first < span.second; it++ ) {
+         if ( it->first.second <= span.first ) continue;
+
+         SpanState const &state = it->second;
+         if ( state._lastWriter >= 0 ) node._predecessors.push_back( state._lastWriter );
+         if ( dep.isOutput() ) node._predecessors.insert( node._predecessors.end(), state._readers.begin(), state._readers.end() );
+      }
+
+      SpanState &state = _spans[span];
+      if ( dep.isOutput() ) {
+         state._lastWriter = id;
+         state._readers.clear();
+      } else {
+         state._readers.push_back( id );
+      }
+      _maxSpan = std::max( _maxSpan, span.second - span.first );
+   }
+
+   // Several accesses of the node may overlap the same span, or each other
+   std::sort( node._predecessors.begin(), node._predecessors.end() );
+   node._predecessors.erase( std::unique( node._predecessors.begin(), node._predecessors.end() ), node._predecessors.end() );
+   if ( !node._predecessors.empty() && node._predecessors.back() == id ) node._predecessors.pop_back();
+
+   _nodes.push_back( node );
+}
+
+void TaskGraph::interrupt ( )
+{
+   switch ( _state ) {
+      case RECORDING:
+         clear();
+         _state = DISABLED;
+         break;
+      case REPLAYING:
+         _state = DIVERGED;
+         drain();
+         break;
+      default:
+         break;
+   }
+}
+
+void TaskGraph::finished ( DependableObject &depObj )
+{
+   // Objects submitted through the domain have no slot, even if their id is a node index
+   unsigned int id = depObj.getId();
+   if ( _slots == NULL || id >= _nodes.size() ) return;
+
+   Slot &slot = _slots[id];
+   {
+      LockBlock lock( slot._lock );
+      if ( slot._live != &depObj ) return;
+      slot._live = NULL;
+   }
+
+   _drainedSyncCond.reference();
+   if ( --_pending == 0 ) _drainedSyncCond.signal();
+   _drainedSyncCond.unreference();
+}
+
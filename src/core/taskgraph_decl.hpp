@@ -0,0 +1,178 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_TASK_GRAPH_DECL
+#define _NANOS_TASK_GRAPH_DECL
+
+#include <vector>
+#include <map>
+#include <stdint.h>
+#include "nanos-int.h"
+#include "lock_decl.hpp"
+#include "atomic_decl.hpp"
+#include "synchronizedcondition_decl.hpp"
+#include "dataaccess_decl.hpp"
+#include "dependableobject_fwd.hpp"
+#include "schedule_fwd.hpp"
+#include "taskgraph_fwd.hpp"
+
+namespace nanos {
+
+  /*! \class TaskGraph
+   *  \brief Dependence graph of a region of task submissions, recorded once and replayed afterwards
+   *
+   *  The first instance of a region (nanos_taskgraph_begin ... nanos_taskgraph_end) is
+   *  submitted through the parent's DependenciesDomain as usual, and its tasks run as soon
+   *  as the domain releases them. The edges of the graph are not taken from the domain,
+   *  which does not link a task to predecessors that already finished: each submission is
+   *  compared with the accesses recorded before it, and depends on every earlier node with
+   *  an overlapping access (the bytes it spans, or the same dependence address) where one
+   *  of them writes. The graph may have more edges than the domain would create, but never
+   *  fewer.
+   *
+   *  Later instances skip the DependenciesDomain. The n-th submission is checked against
+   *  the data accesses of the n-th node and linked directly to the objects of its recorded
+   *  predecessors that have not finished yet. A different submission, more or less tasks,
+   *  or a taskwait in the middle of the region drain the tasks replayed so far and fall
+   *  back to the domain; the region is recorded again on its next instance. Regions with
+   *  commutative or concurrent accesses, or with a taskwait inside, are never replayed.
+   *
+   *  Both ends of a region wait for the children of the parent, so no task outside the
+   *  region can depend on a replayed one (replayed tasks are unknown to the domain).
+   */
+   class TaskGraph
+   {
+      private:
+         typedef enum { EMPTY, RECORDING, RECORDED, REPLAYING, DIVERGED, DISABLED } State;
+
+         /*! \brief Copy of a data access of a recorded task */
+         struct Access {
+            void               *_address;
+            ptrdiff_t           _offset;
+            unsigned int        _firstDimension;   /**< Index of the first dimension in _dimensions */
+            short               _numDimensions;
+            unsigned char       _flags;
+         };
+
+         struct Node {
+            unsigned int                 _firstAccess;     /**< Index of the first access in _accesses */
+            unsigned int                 _numAccesses;
+            std::vector<unsigned int>    _predecessors;    /**< Recorded predecessors, always lower node indices */
+         };
+
+         /*! \brief DependableObject of a node in the current instance, until it finishes */
+         struct Slot {
+            Lock                         _lock;
+            DependableObject            *_live;
+         };
+
+         typedef std::vector<Node>                                 NodeList;
+         typedef std::vector<Access>                               AccessList;
+         typedef std::vector<nanos_region_dimension_internal_t>    DimensionList;
+         typedef SingleSyncCond<EqualConditionChecker<int> >       drained_sync_cond_t;
+
+         /*! \brief Recorded accesses to the same span of memory */
+         struct SpanState {
+            int                          _lastWriter;      /**< Node index, -1 if none */
+            std::vector<unsigned int>    _readers;         /**< Nodes reading it since the last writer */
+
+            SpanState () : _lastWriter( -1 ), _readers() {}
+         };
+
+         typedef std::pair<uintptr_t, uintptr_t>                   Span;      /**< First and past-the-end bytes of an access */
+         typedef std::map<Span, SpanState>                         SpanMap;
+
+         volatile State          _state;
+         NodeList                _nodes;
+         AccessList              _accesses;
+         DimensionList           _dimensions;
+         SpanMap                 _spans;        /**< Accesses of the instance being recorded */
+         uintptr_t               _maxSpan;      /**< Length of the longest span in _spans */
+         Slot                   *_slots;        /**< One per node, allocated when the recording is complete */
+         unsigned int            _next;         /**< Next node to replay */
+         Atomic<int>             _pending;      /**< Replayed objects of the current instance not finished yet */
+         drained_sync_cond_t     _drainedSyncCond;
+
+      private:
+         /*! \brief TaskGraph copy constructor (disabled)
+          */
+         TaskGraph ( const TaskGraph &tg );
+         /*! \brief TaskGraph copy assignment operator (disabled)
+          */
+         const TaskGraph & operator= ( const TaskGraph &tg );
+
+         static unsigned char getFlags ( DataAccess const &access );
+
+         /*! \brief Whether deps are the data accesses recorded for node */
+         bool matches ( Node const &node, size_t numDeps, DataAccess *deps ) const;
+
+         /*! \brief Bytes spanned by access, including its dependence address */
+         static Span getSpan ( DataAccess const &access );
+
+         /*! \brief Forgets the recorded graph */
+         void clear ( );
+
+         /*! \brief Waits for the replayed objects of the current instance
+          *
+          *  The submitting task is already a child of the parent, waiting for all the
+          *  children of the parent would never return.
+          */
+         void drain ( );
+
+      public:
+         /*! \brief TaskGraph default constructor
+          */
+         TaskGraph () : _state( EMPTY ), _nodes(), _accesses(), _dimensions(), _spans(), _maxSpan( 0 ), _slots( NULL ), _next( 0 ),
+                       _pending( 0 ), _drainedSyncCond( EqualConditionChecker<int>( &_pending.override(), 0 ) ) {}
+         /*! \brief TaskGraph destructor
+          */
+         ~TaskGraph ();
+
+         /*! \brief Starts an instance of the region, the parent has no pending children
+          */
+         void begin ( );
+
+         /*! \brief Ends the instance of the region, before the parent waits for its children
+          */
+         void end ( );
+
+         /*! \brief Submits depObj as the next node of the graph
+          *  \return false if depObj must be submitted to the DependenciesDomain instead
+          */
+         bool replay ( DependableObject &depObj, size_t numDeps, DataAccess *deps, SchedulePolicySuccessorFunctor *callback );
+
+         /*! \brief Records the next node, about to be submitted to the DependenciesDomain
+          */
+         void record ( size_t numDeps, DataAccess *deps );
+
+         /*! \brief The parent is about to wait for some or all of its children, the instance is not replayable
+          *
+          *  Replayed tasks are unknown to the DependenciesDomain, they are waited for here.
+          */
+         void interrupt ( );
+
+         /*! \brief depObj is finishing, successors can no longer be added to it
+          */
+         void finished ( DependableObject &depObj );
+   };
+
+} // namespace nanos
+
+#endif
+
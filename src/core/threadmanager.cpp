@@ -23,6 +23,7 @@
 #include "system.hpp"
 #include "config.hpp"
 #include "os.hpp"
+#include <limits.h>
 
 #ifdef DLB
 #include <DLB_interface.h>
@@ -63,6 +64,8 @@ using namespace nanos;
 
 const unsigned int ThreadManagerConf::DEFAULT_SLEEP_NS = 20000;
 const unsigned int ThreadManagerConf::DEFAULT_YIELDS = 10;
+const unsigned int ThreadManagerConf::DEFAULT_PARK_MAX_SPIN_US = 50;
+const unsigned int ThreadManagerConf::DEFAULT_PARK_TIMEOUT_US = 1000;
 
 /**********************************/
 /****** Thread Manager Conf *******/
@@ -71,7 +74,8 @@ const unsigned int ThreadManagerConf::DEFAULT_YIELDS = 10;
 ThreadManagerConf::ThreadManagerConf()
    : _tm(TM_UNDEFINED), _numYields(DEFAULT_YIELDS), _sleepTime(DEFAULT_SLEEP_NS),
    _useYield(false), _useBlock(false), _useDLB(false),
-   _forceTieMaster(false), _warmupThreads(false)
+   _forceTieMaster(false), _warmupThreads(false),
+   _parkMaxSpin(DEFAULT_PARK_MAX_SPIN_US), _parkTimeout(DEFAULT_PARK_TIMEOUT_US)
 {
 }
 
@@ -83,6 +87,7 @@ void ThreadManagerConf::config( Config &cfg )
    tm_options->addOption( "none", TM_NONE );
    tm_options->addOption( "nanos", TM_NANOS );
    tm_options->addOption( "dlb", TM_DLB );
+   tm_options->addOption( "park", TM_PARK );
    cfg.registerConfigOption ( "thread-manager", tm_options, "Select which Thread Manager will be used" );
    cfg.registerArgOption( "thread-manager", "thread-manager" );
 
@@ -119,6 +124,18 @@ void ThreadManagerConf::config( Config &cfg )
    cfg.registerConfigOption( "warmup-threads", NEW Config::FlagOption( _warmupThreads, true ),
          "Force the creation of as many threads as available CPUs at initialization time, then block them immediately if needed" );
    cfg.registerArgOption( "warmup-threads", "warmup-threads" );
+
+   std::ostringstream park_spin_sstream;
+   park_spin_sstream << "Set the longest spin (in usec) on idle before parking, with --thread-manager=park (default = "
+      << DEFAULT_PARK_MAX_SPIN_US << ")";
+   cfg.registerConfigOption ( "park-max-spin", NEW Config::UintVar( _parkMaxSpin ), park_spin_sstream.str() );
+   cfg.registerArgOption ( "park-max-spin", "park-max-spin" );
+
+   std::ostringstream park_timeout_sstream;
+   park_timeout_sstream << "Set the longest time (in usec) a parked thread waits before checking for work (default = "
+      << DEFAULT_PARK_TIMEOUT_US << ")";
+   cfg.registerConfigOption ( "park-timeout", NEW Config::UintVar( _parkTimeout ), park_timeout_sstream.str() );
+   cfg.registerArgOption ( "park-timeout", "park-timeout" );
 }
 
 ThreadManager* ThreadManagerConf::create()
@@ -140,6 +157,13 @@ ThreadManager* ThreadManagerConf::create()
    if ( _tm == TM_NONE && (_useYield || _useBlock || _useSleep || _useDLB) ) {
       warning0( "Thread Manager: Block, sleep, yield or dlb options are ignored when you explicitly choose --thread-manager=none" );
    }
+   if ( _tm == TM_PARK && (_useBlock || _useSleep || _useDLB) ) {
+      warning0( "Thread Manager: Block, sleep or dlb options are ignored when you explicitly choose --thread-manager=park" );
+   }
+   if ( _tm == TM_PARK && _parkTimeout == 0 ) {
+      warning0( "Thread Manager: --park-timeout must be greater than 0, using the default value" );
+      _parkTimeout = DEFAULT_PARK_TIMEOUT_US;
+   }
 #ifndef DLB
    if ( _useDLB  || _tm == TM_DLB ) {
       fatal_cond0( !DLB_SYMBOLS_DEFINED,
@@ -158,6 +182,8 @@ ThreadManager* ThreadManagerConf::create()
       }
    } else if ( _tm == TM_DLB ) {
       return NEW DlbThreadManager( _numYields, _warmupThreads );
+   } else if ( _tm == TM_PARK ) {
+      return NEW ParkingThreadManager( _parkMaxSpin, _parkTimeout, _warmupThreads );
    }
 
    fatal0( "Unknown Thread Manager" );
@@ -775,3 +801,178 @@ void DlbThreadManager::processMaskChanged()
 {
    DLB_NotifyProcessMaskChangeTo(_cpuProcessMask->get_cpu_set_pointer());
 }
+
+/**********************************/
+/***** Parking Thread Manager *****/
+/**********************************/
+
+// Idle calls further apart than this belong to different idle phases (usec)
+#define PARK_PHASE_GAP_US 100.0
+
+__thread ParkingThreadManager::IdleState ParkingThreadManager::_idleState = { 0.0, 0.0, -1.0 };
+
+ParkingThreadManager::ParkingThreadManager( unsigned int max_spin, unsigned int timeout, bool warmup )
+   : ThreadManager(warmup), _maxCPUs(OS::getMaxProcessors()), _maxSpin(max_spin), _timeout(timeout),
+   _slots(NULL), _wakeOrder(NULL), _parked(0)
+{
+   _slots = NEW ParkingSlot[_maxCPUs];
+   for ( int i = 0; i < _maxCPUs; i++ ) {
+      _slots[i]._seq = 0;
+      _slots[i]._waiters = 0;
+      _slots[i]._notified = 0;
+   }
+   _wakeOrder = NEW std::vector<int>[_maxCPUs];
+}
+
+ParkingThreadManager::~ParkingThreadManager()
+{
+   delete[] _slots;
+   delete[] _wakeOrder;
+}
+
+void ParkingThreadManager::init()
+{
+   ThreadManager::init();
+
+   // Group the CPUs by core, shared cache and NUMA node
+   bool use_hwloc = sys._hwloc.isHwlocAvailable();
+   std::vector<unsigned int> core( _maxCPUs ), cache( _maxCPUs ), node( _maxCPUs, 0 );
+   for ( int cpu = 0; cpu < _maxCPUs; cpu++ ) {
+      sys._hwloc.getCpuLocality( cpu, core[cpu], cache[cpu] );
+      if ( use_hwloc && sys._hwloc.isCpuAvailable( cpu ) ) {
+         node[cpu] = sys._hwloc.getNumaNodeOfCpu( cpu );
+      }
+   }
+
+   // Wake up order of every CPU: same core, same cache, same NUMA node, rest;
+   // each group sorted by distance in the CPU numbering
+   for ( int cpu = 0; cpu < _maxCPUs; cpu++ ) {
+      std::vector<int> &order = _wakeOrder[cpu];
+      order.clear();
+      for ( int level = 0; level < 4; level++ ) {
+         for ( int dist = 0; dist < _maxCPUs; dist++ ) {
+            for ( int sign = -1; sign <= 1; sign += 2 ) {
+               int other = cpu + sign * dist;
+               if ( dist == 0 && sign > 0 ) continue;
+               if ( other < 0 || other >= _maxCPUs ) continue;
+               if ( !_cpuProcessMask->isSet( other ) ) continue;
+
+               int other_level;
+               if ( core[other] == core[cpu] ) other_level = 0;
+               else if ( cache[other] == cache[cpu] ) other_level = 1;
+               else if ( node[other] == node[cpu] ) other_level = 2;
+               else other_level = 3;
+
+               if ( other_level == level ) order.push_back( other );
+            }
+         }
+      }
+   }
+}
+
+void ParkingThreadManager::idle( int& yields
+#ifdef NANOS_INSTRUMENTATION_ENABLED
+   , unsigned long long& total_yields, unsigned long long& total_blocks
+   , unsigned long long& time_yields, unsigned long long& time_blocks
+#endif
+   )
+{
+   if ( !_initialized ) return;
+
+   BaseThread *thread = getMyThreadSafe();
+
+   // The master WD may come back to the main thread at any time
+   if ( thread->isMainThread() && !sys.getUntieMaster() ) return;
+
+   // Track the length of the idle phase, a long gap since the last call
+   // means the thread has been running tasks in between
+   IdleState &state = _idleState;
+   double now = OS::getMonotonicTimeUs();
+   if ( state._meanIdle < 0.0 ) {
+      state._meanIdle = (double) _maxSpin / 2;
+      state._phaseStart = now;
+   } else if ( now - state._lastCall > PARK_PHASE_GAP_US ) {
+      double length = state._lastCall - state._phaseStart;
+      state._meanIdle = ( 7.0 * state._meanIdle + length ) / 8.0;
+      state._phaseStart = now;
+   }
+   state._lastCall = now;
+
+   // Keep spinning while this phase is still shorter than the usual ones
+   double budget = 2.0 * state._meanIdle;
+   if ( budget <= (double) _maxSpin && now - state._phaseStart < budget ) return;
+
+   NANOS_INSTRUMENT ( total_blocks++; )
+   NANOS_INSTRUMENT ( unsigned long long begin_block = (unsigned long long) ( OS::getMonotonicTime() * 1.0e9  ); )
+   park( thread );
+   NANOS_INSTRUMENT ( unsigned long long end_block = (unsigned long long) ( OS::getMonotonicTime() * 1.0e9  ); )
+   NANOS_INSTRUMENT ( time_blocks += ( end_block - begin_block ); )
+
+   // Parking time does not count as idle phase length
+   state._lastCall = OS::getMonotonicTimeUs();
+}
+
+void ParkingThreadManager::park( BaseThread *thread )
+{
+   int cpu = thread->getCpuId();
+   if ( cpu < 0 || cpu >= _maxCPUs ) return;
+   ParkingSlot &slot = _slots[cpu];
+
+   int seq = slot._seq.value();
+   slot._waiters++;
+   _parked++;
+   memoryFence();
+
+   // Check again after announcing ourselves, submitters look at _parked after queueing
+   if ( sys.getSchedulerStats().getReadyTasks() == 0 && !thread->hasNextWD() && thread->isRunning() ) {
+      OS::futexWait( &slot._seq.override(), seq, (unsigned long long) _timeout * 1000ULL );
+   }
+
+   _parked--;
+   if ( --slot._waiters == 0 ) slot._notified = 0;
+}
+
+void ParkingThreadManager::wakeUp( int cpu )
+{
+   ParkingSlot &slot = _slots[cpu];
+   slot._seq++;
+   OS::futexWake( &slot._seq.override(), INT_MAX );
+}
+
+void ParkingThreadManager::unblockThread( BaseThread* thread )
+{
+   int cpu = thread->getCpuId();
+   if ( cpu < 0 || cpu >= _maxCPUs ) return;
+   memoryFence();
+   if ( _slots[cpu]._waiters.value() > 0 ) wakeUp( cpu );
+}
+
+void ParkingThreadManager::unblockThreads( std::vector<BaseThread*> threads )
+{
+   for ( std::vector<BaseThread*>::iterator it = threads.begin(); it != threads.end(); ++it ) {
+      unblockThread( *it );
+   }
+}
+
+void ParkingThreadManager::notifyReadyTasks( int numTasks )
+{
+   if ( !_initialized || numTasks <= 0 ) return;
+   memoryFence();
+   if ( _parked.value() == 0 ) return;
+
+   BaseThread *thread = getMyThreadSafe();
+   int my_cpu = thread->getCpuId();
+   if ( my_cpu < 0 || my_cpu >= _maxCPUs ) my_cpu = 0;
+
+   // Wake up the closest parked threads, one slot per ready task
+   std::vector<int> &order = _wakeOrder[my_cpu];
+   for ( std::vector<int>::iterator it = order.begin(); it != order.end() && numTasks > 0; ++it ) {
+      ParkingSlot &slot = _slots[*it];
+      if ( slot._waiters.value() == 0 ) continue;
+      Atomic<int> expected = 0;
+      Atomic<int> notified = 1;
+      if ( !slot._notified.cswap( expected, notified ) ) continue;
+      wakeUp( *it );
+      numTasks--;
+   }
+}
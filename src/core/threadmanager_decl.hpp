@@ -68,6 +68,8 @@ namespace nanos {
          virtual void unblockThread(BaseThread*) {}
          virtual void unblockThreads(std::vector<BaseThread*>) {}
          virtual void processMaskChanged() {}
+         //! \brief Called after numTasks tasks have been queued as ready
+         virtual void notifyReadyTasks( int numTasks ) {}
    };
 
    //! BlockingThreadManager class
@@ -181,6 +183,63 @@ namespace nanos {
          virtual void processMaskChanged();
    };
 
+   //! ParkingThreadManager class
+   /*!
+    * This derived class parks idle threads on a futex word of their CPU instead
+    * of blocking them through the CPU active mask.
+    *
+    * Every thread keeps a moving average of how long its idle phases last and
+    * spins for about twice that time before parking, or parks right away when
+    * that is longer than the maximum spin time. Submitters wake as many parked
+    * threads as tasks they have made ready, starting by the CPUs closest to
+    * their own. Parked threads also check for work after a timeout, so tasks
+    * that reach the ready queues without a notification are eventually found.
+    *
+    * Used when --thread-manager=park
+    */
+   class ParkingThreadManager : public ThreadManager
+   {
+      private:
+         struct ParkingSlot {
+            Atomic<int>       _seq;         /**< Futex word, increased to wake up the waiters */
+            Atomic<int>       _waiters;     /**< Threads parked on this CPU */
+            Atomic<int>       _notified;    /**< A wake up is on its way, do not target this slot again */
+            char              _pad[NANOS_CACHELINE - 3 * sizeof(Atomic<int>)];
+         };
+
+         struct IdleState {
+            double            _phaseStart;  /**< Beginning of the current idle phase (us) */
+            double            _lastCall;    /**< Last call to idle (us) */
+            double            _meanIdle;    /**< Moving average of the idle phase length (us) */
+         };
+
+         int                  _maxCPUs;
+         unsigned int         _maxSpin;     /**< Longest spin before parking (us) */
+         unsigned int         _timeout;     /**< Longest park before checking for work (us) */
+         ParkingSlot         *_slots;       /**< One per CPU */
+         std::vector<int>    *_wakeOrder;   /**< Per CPU, the other CPUs from the closest to the furthest */
+         Atomic<int>          _parked;      /**< Threads parked in any slot */
+
+         static __thread IdleState _idleState;
+
+         void park( BaseThread *thread );
+         void wakeUp( int cpu );
+
+      public:
+         ParkingThreadManager( unsigned int max_spin, unsigned int timeout, bool warmup );
+         virtual ~ParkingThreadManager();
+         virtual void init();
+         virtual void idle( int& yields
+#ifdef NANOS_INSTRUMENTATION_ENABLED
+                     , unsigned long long& total_yields, unsigned long long& total_blocks
+                     , unsigned long long& time_yields, unsigned long long& time_blocks
+#endif
+                     );
+         virtual void unblockThread(BaseThread*);
+         virtual void unblockThreads(std::vector<BaseThread*>);
+         virtual void notifyReadyTasks( int numTasks );
+   };
+
    //! ThreadManagerConf class
    /*!
     * This class is used to construct the right Thread Manager object.
@@ -193,7 +252,7 @@ namespace nanos {
    class ThreadManagerConf
    {
       private:
-         typedef enum { TM_UNDEFINED = 0, TM_NONE, TM_NANOS, TM_DLB } ThreadManagerOption;
+         typedef enum { TM_UNDEFINED = 0, TM_NONE, TM_NANOS, TM_DLB, TM_PARK } ThreadManagerOption;
 
          ThreadManagerOption  _tm;              //!< Thread Manager name option
          unsigned int         _numYields;       //!< Number of yields before block
@@ -204,10 +263,14 @@ namespace nanos {
          bool                 _useDLB;          //!< DLB library will be used
          bool                 _forceTieMaster;  //!< Force Master WD (user code) to run on Master Thread
          bool                 _warmupThreads;   //!< Force the initialization of as many threads as number of CPUs, then block them if needed
+         unsigned int         _parkMaxSpin;     //!< Longest spin (in usec) before parking
+         unsigned int         _parkTimeout;     //!< Longest park (in usec) before checking for work
 
       public:
          static const unsigned int DEFAULT_SLEEP_NS;
          static const unsigned int DEFAULT_YIELDS;
+         static const unsigned int DEFAULT_PARK_MAX_SPIN_US;
+         static const unsigned int DEFAULT_PARK_TIMEOUT_US;
 
          ThreadManagerConf();
 
@@ -25,6 +25,7 @@
 #include "debug.hpp"
 #include "system.hpp"
 #include "task_reduction.hpp"
+#include "latencystats.hpp"
 
 namespace nanos {
 
@@ -165,6 +166,7 @@ inline nanos_ws_desc_t **ThreadTeam::getWorkSharingDescriptorAddr( void ) { retu
 
 inline void ThreadTeam::barrier()
 {
+   LatencyScope latency( LatencyStats::BARRIER_WAIT );
    _barrier.barrier( myThread->getTeamId() );
 }
 
@@ -240,6 +242,8 @@ inline unsigned ThreadTeam::getSupportingThreads( BaseThread **list_of_threads )
 
 inline void ThreadTeam::createReduction( nanos_reduction_t *red ) { _redList.push_front( red ); }
 
+inline ThreadTeam::ReductionList & ThreadTeam::getReductionList ( void ) { return _redList; }
+
 inline void ThreadTeam::computeVectorReductions ( void )
 {
    nanos_reduction_t *red;
@@ -52,8 +52,9 @@ namespace nanos {
 
    class ThreadTeam
    {
-      private:
+      public:
          typedef std::list<nanos_reduction_t*>     ReductionList;  /**< List of Reduction op's (Bursts) */
+      private:
          typedef std::map<unsigned, BaseThread *>  ThreadTeamList; /**< List of team members */
          typedef std::map<unsigned, bool>          ThreadTeamIdList; /**< List of team members */
          typedef std::list<TaskReduction *>        task_reduction_list_t;  //< List of task reductions type
@@ -205,6 +206,10 @@ namespace nanos {
          */
          nanos_reduction_t *getReduction ( void* s );
 
+        /*! \brief Returns the reductions to execute at next barrier
+         */
+         ReductionList & getReductionList ( void );
+
         /*! \brief Clean readuction list
          */
          void cleanUpReductionList ( void );
@@ -34,3 +34,69 @@ void WDDeque::initDeviceList()
    }
 }
 
+
+void WDChaseLevDeque::initDeviceList()
+{
+   DeviceList devs = sys.getSupportedDevices();
+
+   for ( DeviceList::iterator it = devs.begin(); it != devs.end(); it++ ) {
+      const Device * dev = *it;
+      Atomic<unsigned int> num = 0;
+      _ndevs.insert( std::make_pair( dev, num ) );
+   }
+}
+
+WDChaseLevDeque::Buffer::Buffer ( long capacity, Buffer *prev ) : _mask( capacity - 1 ), _elems( NULL ), _prev( prev )
+{
+   ensure( ( capacity & _mask ) == 0, "Chase-Lev deque capacity must be a power of two" );
+   _elems = NEW Slot[capacity];
+}
+
+WDChaseLevDeque::Buffer::~Buffer ()
+{
+   delete[] _elems;
+   delete _prev;
+}
+
+WDChaseLevDeque::Buffer * WDChaseLevDeque::Buffer::grow ( long top, long bottom )
+{
+   Buffer *buffer = NEW Buffer( capacity() * 2, this );
+   for ( long i = top; i < bottom; i++ ) {
+      buffer->put( i, get( i ) );
+   }
+   return buffer;
+}
+
+__thread unsigned int WDMultiPriorityQueue::_seed = 0;
+
+WDMultiPriorityQueue::WDMultiPriorityQueue( unsigned int numQueues ) : _queues( NULL ), _numQueues( numQueues ), _batchLock()
+{
+   if ( _numQueues == 0 ) _numQueues = 2 * std::max( sys.getNumThreads(), 1 );
+   _queues = NEW SubQueue[_numQueues];
+}
+
+WDMultiPriorityQueue::~WDMultiPriorityQueue()
+{
+   delete[] _queues;
+}
+
+int WDMultiPriorityQueue::getNumConcurrentWDs()
+{
+   // Cumulative wd counter
+   int num_wds = 0;
+   // Auxiliary map to count successful commutative accesses
+   std::map<WD**, WD*> comm_accesses;
+
+   for ( unsigned int i = 0; i < _numQueues; i++ ) {
+      SubQueue &q = _queues[i];
+      LockBlock lock( q._lock );
+      for ( BucketMap::iterator bucket = q._buckets.begin(); bucket != q._buckets.end(); bucket++ ) {
+         for ( Bucket::iterator it = bucket->second.begin(); it != bucket->second.end(); it++ ) {
+            WD &wd = *(WD *)*it;
+            num_wds += wd.getConcurrencyLevel( comm_accesses );
+         }
+      }
+   }
+
+   return num_wds;
+}
@@ -25,6 +25,7 @@
 #include "instrumentation.hpp"
 #include "atomic.hpp"
 #include "lock.hpp"
+#include "latencystats.hpp"
 #include "basethread.hpp"
 #include "workdescriptor.hpp"
 
@@ -50,7 +51,7 @@ inline void WDDeque::push_front ( WorkDescriptor *wd )
 {
    wd->setMyQueue( this );
    {
-      LockBlock lock( _lock );
+      QueueLockBlock lock( _lock );
       _dq.push_front( wd );
 
       if ( _deviceCounter ) {
@@ -69,7 +70,7 @@ inline void WDDeque::push_back ( WorkDescriptor *wd )
 {
    wd->setMyQueue( this );
    {
-      LockBlock lock( _lock );
+      QueueLockBlock lock( _lock );
       _dq.push_back( wd );
 
       if ( _deviceCounter ) {
@@ -172,7 +173,7 @@ inline WorkDescriptor * WDDeque::popFrontWithConstraints ( BaseThread const *thr
    }
 
    {
-      LockBlock lock( _lock );
+      QueueLockBlock lock( _lock );
 
       memoryFence();
 
@@ -250,7 +251,7 @@ inline WorkDescriptor * WDDeque::popBackWithConstraints ( BaseThread const *thre
    }
 
    {
-      LockBlock lock( _lock );
+      QueueLockBlock lock( _lock );
 
       memoryFence();
 
@@ -295,7 +296,7 @@ inline bool WDDeque::removeWDWithConstraints( BaseThread *thread, WorkDescriptor
    WDDeque::BaseContainer::iterator it;
 
    {
-      LockBlock lock( _lock );
+      QueueLockBlock lock( _lock );
 
       memoryFence();
 
@@ -514,6 +515,363 @@ inline bool WDLFQueue::removeWD( BaseThread *thread, WorkDescriptor *toRem, Work
    return false;
 }
 
+/*******************
+ * WDChaseLevDeque *
+ *******************/
+
+inline WDChaseLevDeque::WDChaseLevDeque( bool enableDeviceCounter, int logCapacity, int logMaxCapacity )
+   : _top( 0 ), _bottom( 0 ), _buffer( NEW Buffer( 1L << logCapacity, NULL ) ), _owner( NULL ),
+     _overflow(), _overflowSize( 0 ), _lock(), _maxCapacity( 1L << logMaxCapacity ), _ndevs(),
+     _deviceCounter( enableDeviceCounter )
+{
+   if ( _deviceCounter ) {
+      initDeviceList();
+   }
+}
+
+inline WDChaseLevDeque::~WDChaseLevDeque()
+{
+   delete _buffer;
+}
+
+inline void WDChaseLevDeque::setOwner ( BaseThread *owner )
+{
+   if ( _owner != owner ) _owner = owner;
+}
+
+inline BaseThread * WDChaseLevDeque::getOwner () const
+{
+   return _owner;
+}
+
+inline bool WDChaseLevDeque::isOwner () const
+{
+   return _owner != NULL && _owner == myThread;
+}
+
+inline bool WDChaseLevDeque::empty ( void ) const
+{
+   return _bottom.value() <= _top.value() && _overflowSize == 0;
+}
+
+inline size_t WDChaseLevDeque::size() const
+{
+   long size = _bottom.value() - _top.value();
+   return ( size > 0 ? (size_t) size : 0 ) + _overflowSize;
+}
+
+inline bool WDChaseLevDeque::pushBottom ( WorkDescriptor *wd )
+{
+   long b = _bottom.value();
+   long t = _top.value();
+   Buffer *buffer = _buffer;
+
+   if ( b - t > buffer->capacity() - 1 ) {
+      if ( buffer->capacity() >= _maxCapacity ) return false;
+      buffer = buffer->grow( t, b );
+      memoryFence();
+      _buffer = buffer;
+   }
+
+   buffer->put( b, wd );
+   // The element must be visible before the new bottom
+   memoryFence();
+   _bottom = b + 1;
+
+   return true;
+}
+
+inline WorkDescriptor * WDChaseLevDeque::takeBottom ()
+{
+   long b = _bottom.value() - 1;
+   Buffer *buffer = _buffer;
+   _bottom = b;
+   // Store-load fence: memoryFence() only orders acquire/release with the new gcc builtins
+   __sync_synchronize();
+   long t = _top.value();
+
+   if ( t > b ) {
+      // Empty deque
+      _bottom = b + 1;
+      return NULL;
+   }
+
+   WorkDescriptor *wd = buffer->get( b );
+   if ( t == b ) {
+      // Last element, race against the thieves for it
+      if ( !compareAndSwap( &_top.override(), t, t + 1 ) ) wd = NULL;
+      _bottom = b + 1;
+   }
+
+   return wd;
+}
+
+inline WorkDescriptor * WDChaseLevDeque::stealTop ()
+{
+   while ( true ) {
+      long t = _top.value();
+      __sync_synchronize();
+      long b = _bottom.value();
+
+      if ( t >= b ) return NULL;
+
+      WorkDescriptor *wd = _buffer->get( t );
+      if ( compareAndSwap( &_top.override(), t, t + 1 ) ) return wd;
+   }
+}
+
+inline void WDChaseLevDeque::pushOverflow ( WorkDescriptor *wd, bool front )
+{
+   LockBlock lock( _lock );
+   if ( front ) _overflow.push_front( wd );
+   else _overflow.push_back( wd );
+   _overflowSize++;
+}
+
+inline void WDChaseLevDeque::push_front ( WorkDescriptor *wd )
+{
+   wd->setMyQueue( this );
+
+   if ( _deviceCounter ) {
+      for ( unsigned int i = 0; i < wd->getNumDevices(); i++ ) {
+         _ndevs[( wd->getDevices()[i]->getDevice() )]++;
+      }
+   }
+
+   if ( !isOwner() || !pushBottom( wd ) ) pushOverflow( wd, true );
+
+   int tasks = ++( sys.getSchedulerStats()._readyTasks );
+   increaseTasksInQueues(tasks);
+}
+
+inline void WDChaseLevDeque::push_back ( WorkDescriptor *wd )
+{
+   wd->setMyQueue( this );
+
+   if ( _deviceCounter ) {
+      for ( unsigned int i = 0; i < wd->getNumDevices(); i++ ) {
+         _ndevs[( wd->getDevices()[i]->getDevice() )]++;
+      }
+   }
+
+   pushOverflow( wd, false );
+
+   int tasks = ++( sys.getSchedulerStats()._readyTasks );
+   increaseTasksInQueues(tasks);
+}
+
+inline Lock& WDChaseLevDeque::getLock()
+{
+   return _lock;
+}
+
+inline void WDChaseLevDeque::push_front( WD** wds, size_t numElems )
+{
+   for( size_t i = 0; i < numElems; ++i )
+   {
+      WD* wd = wds[i];
+      wd->setMyQueue( this );
+      _overflow.push_front( wd );
+
+      if ( _deviceCounter ) {
+         for ( unsigned int j = 0; j < wd->getNumDevices(); j++ ) {
+            _ndevs[( wd->getDevices()[j]->getDevice() )]++;
+         }
+      }
+   }
+   _overflowSize += numElems;
+   int tasks = sys.getSchedulerStats()._readyTasks += numElems;
+   increaseTasksInQueues(tasks,numElems);
+}
+
+inline void WDChaseLevDeque::push_back( WD** wds, size_t numElems )
+{
+   for( size_t i = 0; i < numElems; ++i )
+   {
+      WD* wd = wds[i];
+      wd->setMyQueue( this );
+      _overflow.push_back( wd );
+
+      if ( _deviceCounter ) {
+         for ( unsigned int j = 0; j < wd->getNumDevices(); j++ ) {
+            _ndevs[( wd->getDevices()[j]->getDevice() )]++;
+         }
+      }
+   }
+   _overflowSize += numElems;
+   int tasks = sys.getSchedulerStats()._readyTasks += numElems;
+   increaseTasksInQueues(tasks,numElems);
+}
+
+inline WorkDescriptor * WDChaseLevDeque::pop_front ( BaseThread *thread )
+{
+   return popFrontWithConstraints<NoConstraints>(thread);
+}
+
+inline WorkDescriptor * WDChaseLevDeque::pop_back ( BaseThread *thread )
+{
+   return popBackWithConstraints<NoConstraints>(thread);
+}
+
+inline bool WDChaseLevDeque::removeWD( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next )
+{
+   return removeWDWithConstraints<NoConstraints>(thread,toRem,next);
+}
+
+inline bool WDChaseLevDeque::hasTasksFor ( BaseThread const *thread )
+{
+   if ( !_deviceCounter ) return true;
+
+   std::vector<const Device *> const &pe_devices = thread->runningOn()->getDeviceTypes();
+   for ( std::vector<const Device *>::const_iterator it = pe_devices.begin();
+         it != pe_devices.end(); it++ ) {
+      if ( _ndevs[ *it ].value() > 0 ) return true;
+   }
+   return false;
+}
+
+inline void WDChaseLevDeque::taken ( WorkDescriptor *wd )
+{
+   if ( _deviceCounter ) {
+      for ( unsigned int i = 0; i < wd->getNumDevices(); i++ ) {
+         _ndevs[( wd->getDevices()[i]->getDevice() )]--;
+      }
+   }
+
+   int tasks = --(sys.getSchedulerStats()._readyTasks);
+   decreaseTasksInQueues(tasks);
+}
+
+template <typename Constraints>
+inline WorkDescriptor * WDChaseLevDeque::popBufferWithConstraints ( BaseThread const *thread, bool fromBottom )
+{
+   WorkDescriptor *wd;
+
+   while ( ( wd = ( fromBottom ? takeBottom() : stealTop() ) ) != NULL ) {
+      if ( Scheduler::checkBasicConstraints( *wd, *thread ) && Constraints::check( *wd, *thread ) ) {
+         WorkDescriptor *found = NULL;
+         if ( wd->dequeue( &found ) ) taken( wd );
+         // The slicer keeps the WD in the queue, put it back where it was
+         else if ( !fromBottom || !pushBottom( wd ) ) pushOverflow( wd, true );
+         return found;
+      }
+      // Not for us, but it stays in the pool
+      pushOverflow( wd, false );
+   }
+
+   return NULL;
+}
+
+template <typename Constraints>
+inline WorkDescriptor * WDChaseLevDeque::popOverflowWithConstraints ( BaseThread const *thread, bool fromFront )
+{
+   WorkDescriptor *found = NULL;
+
+   if ( _overflowSize == 0 ) return NULL;
+
+   LockBlock lock( _lock );
+
+   if ( fromFront ) {
+      for ( OverflowContainer::iterator it = _overflow.begin(); it != _overflow.end(); it++ ) {
+         WD &wd = *(WD *)*it;
+         if ( Scheduler::checkBasicConstraints( wd, *thread ) && Constraints::check( wd, *thread ) ) {
+            if ( wd.dequeue( &found ) ) {
+               _overflow.erase( it );
+               _overflowSize--;
+               taken( &wd );
+            }
+            break;
+         }
+      }
+   } else {
+      for ( OverflowContainer::reverse_iterator rit = _overflow.rbegin(); rit != _overflow.rend(); rit++ ) {
+         WD &wd = *(WD *)*rit;
+         if ( Scheduler::checkBasicConstraints( wd, *thread ) && Constraints::check( wd, *thread ) ) {
+            if ( wd.dequeue( &found ) ) {
+               _overflow.erase( ( ++rit ).base() );
+               _overflowSize--;
+               taken( &wd );
+            }
+            break;
+         }
+      }
+   }
+
+   return found;
+}
+
+template <typename Constraints>
+inline WorkDescriptor * WDChaseLevDeque::popFrontWithConstraints ( BaseThread const *thread )
+{
+   if ( empty() || !hasTasksFor( thread ) ) return NULL;
+
+   WorkDescriptor *found = popBufferWithConstraints<Constraints>( thread, isOwner() );
+   if ( found == NULL ) found = popOverflowWithConstraints<Constraints>( thread, true );
+
+   if ( found != NULL ) found->setMyQueue( NULL );
+
+   ensure( !found || !found->isTied() || found->isTiedTo() == thread, "" );
+
+   return found;
+}
+
+template <typename Constraints>
+inline WorkDescriptor * WDChaseLevDeque::popBackWithConstraints ( BaseThread const *thread )
+{
+   if ( empty() || !hasTasksFor( thread ) ) return NULL;
+
+   WorkDescriptor *found = popBufferWithConstraints<Constraints>( thread, false );
+   if ( found == NULL ) found = popOverflowWithConstraints<Constraints>( thread, false );
+
+   if ( found != NULL ) found->setMyQueue( NULL );
+
+   ensure( !found || !found->isTied() || found->isTiedTo() == thread, "" );
+
+   return found;
+}
+
+template <typename Constraints>
+inline bool WDChaseLevDeque::removeWDWithConstraints( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next )
+{
+   if ( _overflowSize == 0 ) return false;
+
+   if ( !Scheduler::checkBasicConstraints( *toRem, *thread) || !Constraints::check(*toRem, *thread) ) return false;
+
+   *next = NULL;
+
+   LockBlock lock( _lock );
+
+   if ( toRem->getMyQueue() != this ) return false;
+
+   for ( OverflowContainer::iterator it = _overflow.begin(); it != _overflow.end(); it++ ) {
+      if ( *it == toRem ) {
+         if ( toRem->dequeue( next ) ) {
+            _overflow.erase( it );
+            _overflowSize--;
+            taken( toRem );
+         }
+         (*next)->setMyQueue( NULL );
+         return true;
+      }
+   }
+
+   return false;
+}
+
+inline void WDChaseLevDeque::increaseTasksInQueues( int tasks, int increment )
+{
+   NANOS_INSTRUMENT(static nanos_event_key_t key = sys.getInstrumentation()->getInstrumentationDictionary()->getEventKey("num-ready");)
+   NANOS_INSTRUMENT( nanos_event_value_t nb =  (nanos_event_value_t ) tasks );
+   NANOS_INSTRUMENT(sys.getInstrumentation()->raisePointEvents(1, &key, &nb );)
+}
+
+inline void WDChaseLevDeque::decreaseTasksInQueues( int tasks, int decrement )
+{
+   NANOS_INSTRUMENT(static nanos_event_key_t key = sys.getInstrumentation()->getInstrumentationDictionary()->getEventKey("num-ready");)
+   NANOS_INSTRUMENT( nanos_event_value_t nb =  (nanos_event_value_t ) tasks );
+   NANOS_INSTRUMENT(sys.getInstrumentation()->raisePointEvents(1, &key, &nb );)
+}
+
 template <typename T>
 inline WDPriorityQueue<T>::WDPriorityQueue( bool enableDeviceCounter, bool optimise, bool reverse, PriorityValueFun getter )
    : _dq(), _lock(), _nelems(0), _optimise( optimise ), _reverse( reverse ), _ndevs(), _deviceCounter( enableDeviceCounter ),
@@ -994,6 +1352,293 @@ inline int WDPriorityQueue<T>::getNumConcurrentWDs()
    return num_wds;
 }
 
+inline unsigned int WDMultiPriorityQueue::randomQueue () const
+{
+   unsigned int x = _seed;
+   if ( x == 0 ) x = (unsigned int) (uintptr_t) &_seed | 1;
+   x ^= x << 13;
+   x ^= x >> 17;
+   x ^= x << 5;
+   _seed = x;
+   return x % _numQueues;
+}
+
+inline void WDMultiPriorityQueue::randomPair ( unsigned int &first, unsigned int &second ) const
+{
+   first = randomQueue();
+   second = first;
+   if ( _numQueues > 1 ) second = ( first + 1 + randomQueue() % ( _numQueues - 1 ) ) % _numQueues;
+
+   // Best one first
+   if ( _queues[first]._size == 0 || ( _queues[second]._size != 0 && _queues[second]._top > _queues[first]._top ) ) {
+      std::swap( first, second );
+   }
+}
+
+inline void WDMultiPriorityQueue::insert ( SubQueue &q, WorkDescriptor *wd, bool fifo )
+{
+   WD::PriorityType priority = wd->getPriority();
+   Bucket &bucket = q._buckets[priority];
+
+   Position pos;
+   pos._priority = priority;
+   pos._it = bucket.insert( fifo ? bucket.end() : bucket.begin(), wd );
+   q._positions[wd] = pos;
+
+   q._size++;
+   q._top = q._buckets.begin()->first;
+   q._bottom = q._buckets.rbegin()->first;
+}
+
+inline void WDMultiPriorityQueue::remove ( SubQueue &q, PositionMap::iterator pos )
+{
+   BucketMap::iterator bucket = q._buckets.find( pos->second._priority );
+   bucket->second.erase( pos->second._it );
+   if ( bucket->second.empty() ) q._buckets.erase( bucket );
+   q._positions.erase( pos );
+
+   q._size--;
+   if ( q._size != 0 ) {
+      q._top = q._buckets.begin()->first;
+      q._bottom = q._buckets.rbegin()->first;
+   }
+}
+
+inline void WDMultiPriorityQueue::push ( WorkDescriptor *wd, bool fifo )
+{
+   wd->setMyQueue( this );
+
+   SubQueue &q = _queues[randomQueue()];
+   {
+      LockBlock lock( q._lock );
+      insert( q, wd, fifo );
+
+      int tasks = ++( sys.getSchedulerStats()._readyTasks );
+      increaseTasksInQueues(tasks);
+   }
+}
+
+inline void WDMultiPriorityQueue::push ( WorkDescriptor **wds, size_t numElems, bool fifo )
+{
+   SubQueue &q = _queues[randomQueue()];
+   {
+      LockBlock lock( q._lock );
+      for ( size_t i = 0; i < numElems; i++ ) {
+         wds[i]->setMyQueue( this );
+         insert( q, wds[i], fifo );
+      }
+
+      int tasks = sys.getSchedulerStats()._readyTasks += numElems;
+      increaseTasksInQueues(tasks,numElems);
+   }
+}
+
+inline bool WDMultiPriorityQueue::empty ( void ) const
+{
+   for ( unsigned int i = 0; i < _numQueues; i++ ) {
+      if ( _queues[i]._size != 0 ) return false;
+   }
+   return true;
+}
+
+inline size_t WDMultiPriorityQueue::size() const
+{
+   size_t total = 0;
+   for ( unsigned int i = 0; i < _numQueues; i++ ) {
+      total += _queues[i]._size;
+   }
+   return total;
+}
+
+inline void WDMultiPriorityQueue::push_back ( WorkDescriptor *wd )
+{
+   push( wd, true );
+}
+
+inline void WDMultiPriorityQueue::push_front ( WorkDescriptor *wd )
+{
+   push( wd, false );
+}
+
+inline Lock& WDMultiPriorityQueue::getLock()
+{
+   return _batchLock;
+}
+
+inline void WDMultiPriorityQueue::push_front( WD** wds, size_t numElems )
+{
+   push( wds, numElems, false );
+}
+
+inline void WDMultiPriorityQueue::push_back( WD** wds, size_t numElems )
+{
+   fatal_cond( numElems == 0, "No reason to call push_back for 0 elements" );
+   push( wds, numElems, true );
+}
+
+inline WorkDescriptor * WDMultiPriorityQueue::pop_front ( BaseThread *thread )
+{
+   return popFrontWithConstraints<NoConstraints>(thread);
+}
+
+inline WorkDescriptor * WDMultiPriorityQueue::pop_back ( BaseThread *thread )
+{
+   return popBackWithConstraints<NoConstraints>(thread);
+}
+
+inline bool WDMultiPriorityQueue::removeWD( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next )
+{
+   return removeWDWithConstraints<NoConstraints>(thread,toRem,next);
+}
+
+template <typename Constraints>
+inline WorkDescriptor * WDMultiPriorityQueue::popWithConstraints ( SubQueue &q, BaseThread *thread )
+{
+   if ( q._size == 0 ) return NULL;
+
+   WorkDescriptor *found = NULL;
+   {
+      LockBlock lock( q._lock );
+
+      for ( BucketMap::iterator bucket = q._buckets.begin(); bucket != q._buckets.end(); bucket++ ) {
+         Bucket::iterator it;
+         for ( it = bucket->second.begin(); it != bucket->second.end(); it++ ) {
+            WD &wd = *(WD *)*it;
+            if ( Scheduler::checkBasicConstraints( wd, *thread) && Constraints::check(wd,*thread) ) break;
+         }
+         if ( it == bucket->second.end() ) continue;
+
+         // Removing the WD may remove its bucket too, stop iterating
+         WD &wd = *(WD *)*it;
+         if ( wd.dequeue( &found ) ) {
+            remove( q, q._positions.find( &wd ) );
+            int tasks = --(sys.getSchedulerStats()._readyTasks);
+            decreaseTasksInQueues(tasks);
+         }
+         break;
+      }
+
+      if ( found != NULL ) found->setMyQueue( NULL );
+   }
+
+   ensure( !found || !found->isTied() || found->isTiedTo() == thread, "" );
+
+   return found;
+}
+
+template <typename Constraints>
+inline WorkDescriptor * WDMultiPriorityQueue::popFrontWithConstraints ( BaseThread *thread )
+{
+   unsigned int first, second;
+   randomPair( first, second );
+
+   WorkDescriptor *found = popWithConstraints<Constraints>( _queues[first], thread );
+   if ( found == NULL && second != first ) found = popWithConstraints<Constraints>( _queues[second], thread );
+
+   for ( unsigned int i = 0; i < _numQueues && found == NULL; i++ ) {
+      if ( i == first || i == second ) continue;
+      found = popWithConstraints<Constraints>( _queues[i], thread );
+   }
+
+   return found;
+}
+
+template <typename Constraints>
+inline WorkDescriptor * WDMultiPriorityQueue::popBackWithConstraints ( BaseThread *thread )
+{
+   // As in WDPriorityQueue, the highest priority is always taken
+   return popFrontWithConstraints<Constraints>( thread );
+}
+
+template <typename Constraints>
+inline bool WDMultiPriorityQueue::removeWDWithConstraints( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next )
+{
+   if ( toRem->getMyQueue() != this ) return false;
+
+   if ( !Scheduler::checkBasicConstraints( *toRem, *thread) || !Constraints::check(*toRem, *thread) ) return false;
+
+   *next = NULL;
+
+   for ( unsigned int i = 0; i < _numQueues; i++ ) {
+      SubQueue &q = _queues[i];
+      if ( q._size == 0 ) continue;
+
+      LockBlock lock( q._lock );
+
+      PositionMap::iterator pos = q._positions.find( toRem );
+      if ( pos == q._positions.end() ) continue;
+
+      if ( toRem->dequeue( next ) ) {
+         remove( q, pos );
+         int tasks = --(sys.getSchedulerStats()._readyTasks);
+         decreaseTasksInQueues(tasks);
+      }
+      (*next)->setMyQueue( NULL );
+      return true;
+   }
+
+   return false;
+}
+
+inline bool WDMultiPriorityQueue::reorderWD( WorkDescriptor *wd )
+{
+   // Most WDs whose priority changes are not ready yet
+   if ( wd->getMyQueue() != this ) return false;
+
+   for ( unsigned int i = 0; i < _numQueues; i++ ) {
+      SubQueue &q = _queues[i];
+      if ( q._size == 0 ) continue;
+
+      LockBlock lock( q._lock );
+
+      PositionMap::iterator pos = q._positions.find( wd );
+      if ( pos == q._positions.end() ) continue;
+
+      if ( pos->second._priority != wd->getPriority() ) {
+         remove( q, pos );
+         insert( q, wd, true );
+      }
+      return true;
+   }
+
+   return false;
+}
+
+inline WD::PriorityType WDMultiPriorityQueue::maxPriority() const
+{
+   // Relaxed as the pops are: the priority a pop would now compare against,
+   // without touching every sub-queue on each task completion
+   unsigned int first, second;
+   randomPair( first, second );
+   return _queues[first]._size != 0 ? _queues[first]._top : 0;
+}
+
+inline WD::PriorityType WDMultiPriorityQueue::minPriority() const
+{
+   WD::PriorityType priority = 0;
+   bool first = true;
+   for ( unsigned int i = 0; i < _numQueues; i++ ) {
+      if ( _queues[i]._size == 0 ) continue;
+      if ( first || _queues[i]._bottom < priority ) priority = _queues[i]._bottom;
+      first = false;
+   }
+   return priority;
+}
+
+inline void WDMultiPriorityQueue::increaseTasksInQueues( int tasks, int increment )
+{
+   NANOS_INSTRUMENT(static nanos_event_key_t key = sys.getInstrumentation()->getInstrumentationDictionary()->getEventKey("num-ready");)
+   NANOS_INSTRUMENT( nanos_event_value_t nb =  (nanos_event_value_t ) tasks );
+   NANOS_INSTRUMENT(sys.getInstrumentation()->raisePointEvents(1, &key, &nb );)
+}
+
+inline void WDMultiPriorityQueue::decreaseTasksInQueues( int tasks, int decrement )
+{
+   NANOS_INSTRUMENT(static nanos_event_key_t key = sys.getInstrumentation()->getInstrumentationDictionary()->getEventKey("num-ready");)
+   NANOS_INSTRUMENT( nanos_event_value_t nb =  (nanos_event_value_t ) tasks );
+   NANOS_INSTRUMENT(sys.getInstrumentation()->raisePointEvents(1, &key, &nb );)
+}
+
 } // namespace nanos
 
 #endif
@@ -27,6 +27,8 @@
 #include "debug.hpp"
 #include "atomic_decl.hpp"
 #include "lock_decl.hpp"
+#include "latencystats_decl.hpp"
+#include "compatibility.hpp"
 
 #include "basethread_fwd.hpp"
 
@@ -110,6 +112,7 @@ namespace nanos {
       private:
          typedef std::list<WorkDescriptor *> BaseContainer;
          typedef std::map< const Device *, Atomic<unsigned int> > WDDeviceCounter;
+         typedef LatencyLockBlock<LockBlock, Lock, LatencyStats::WDDEQUE_LOCK_WAIT> QueueLockBlock;
 
          BaseContainer     _dq;
          Lock              _lock;
@@ -244,7 +247,154 @@ namespace nanos {
          bool removeWD( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next );
 
    };
-   
+
+   /*! \brief Lock-free work-stealing deque (Chase-Lev).
+    *
+    *  The owner thread pushes and pops at the front (the bottom of the deque)
+    *  without locking; any other thread steals from the back (the top) with a
+    *  CAS. The circular buffer grows on demand up to a maximum capacity.
+    *
+    *  Operations that do not fit the single-owner model go to a locked
+    *  overflow list: pushes from non-owner threads, push_back, batch pushes,
+    *  WDs that no longer fit in the buffer and WDs that were taken from the
+    *  buffer but do not satisfy the constraints of the thread that took them.
+    *  The overflow list is checked after the buffer by every pop.
+    */
+   class WDChaseLevDeque : public WDPool
+   {
+      private:
+         class Buffer
+         {
+            private:
+               typedef WorkDescriptor * volatile Slot;
+
+               long      _mask;   /**< capacity - 1 */
+               Slot     *_elems;  /**< circular storage */
+               Buffer   *_prev;   /**< retired (smaller) buffer */
+            private:
+               /*! \brief Buffer copy constructor (private)
+                */
+               Buffer ( const Buffer & );
+               /*! \brief Buffer copy assignment operator (private)
+                */
+               const Buffer & operator= ( const Buffer & );
+            public:
+               /*! \brief Buffer constructor, capacity must be a power of two
+                */
+               Buffer ( long capacity, Buffer *prev );
+               /*! \brief Buffer destructor, frees the retired buffers too
+                */
+               ~Buffer ();
+
+               long capacity () const { return _mask + 1; }
+               WorkDescriptor * get ( long i ) const { return _elems[i & _mask]; }
+               void put ( long i, WorkDescriptor *wd ) { _elems[i & _mask] = wd; }
+
+               /*! \brief Returns a buffer twice as big holding the elements in [top, bottom)
+                *  The current buffer is retired, not freed: thieves may still read it.
+                */
+               Buffer * grow ( long top, long bottom );
+         };
+
+         typedef std::list<WorkDescriptor *> OverflowContainer;
+         typedef std::map< const Device *, Atomic<unsigned int> > WDDeviceCounter;
+
+         Atomic<long>         _top;                                     /**< Steal end, advanced by CAS */
+         char                 _topPad[NANOS_CACHELINE - sizeof(Atomic<long>)];
+         Atomic<long>         _bottom;                                  /**< Owner end */
+         Buffer * volatile    _buffer;                                  /**< Current circular buffer */
+         BaseThread          *_owner;                                   /**< Only thread allowed to touch the bottom */
+         char                 _bottomPad[NANOS_CACHELINE - sizeof(Atomic<long>) - sizeof(Buffer *) - sizeof(BaseThread *)];
+         OverflowContainer    _overflow;                                /**< Slow path, protected by _lock */
+         volatile size_t      _overflowSize;
+         Lock                 _lock;
+         long                 _maxCapacity;
+         WDDeviceCounter      _ndevs;
+         bool                 _deviceCounter;
+
+      private:
+         /*! \brief WDChaseLevDeque copy constructor (private)
+          */
+         WDChaseLevDeque ( const WDChaseLevDeque & );
+         /*! \brief WDChaseLevDeque copy assignment operator (private)
+          */
+         const WDChaseLevDeque & operator= ( const WDChaseLevDeque & );
+
+         /*! \brief Initialization function for WD device counter
+          */
+         void initDeviceList();
+
+         bool isOwner () const;
+         bool hasTasksFor ( BaseThread const *thread );
+
+         /*! \brief Owner push at the bottom, returns false if the buffer is full */
+         bool pushBottom ( WorkDescriptor *wd );
+         /*! \brief Owner pop from the bottom */
+         WorkDescriptor * takeBottom ();
+         /*! \brief Steal from the top, any thread */
+         WorkDescriptor * stealTop ();
+
+         void pushOverflow ( WorkDescriptor *wd, bool front );
+
+         /*! \brief Updates the counters when a WD leaves the deque */
+         void taken ( WorkDescriptor *wd );
+
+         template <typename Constraints>
+         WorkDescriptor * popBufferWithConstraints ( BaseThread const *thread, bool fromBottom );
+         template <typename Constraints>
+         WorkDescriptor * popOverflowWithConstraints ( BaseThread const *thread, bool fromFront );
+
+      public:
+         /*! \brief WDChaseLevDeque default constructor
+          *  \param enableDeviceCounter keep a per device count of queued WDs
+          *  \param logCapacity log2 of the initial buffer capacity
+          *  \param logMaxCapacity log2 of the maximum buffer capacity
+          */
+         WDChaseLevDeque( bool enableDeviceCounter = true, int logCapacity = 8, int logMaxCapacity = 20 );
+         /*! \brief WDChaseLevDeque destructor
+          */
+         ~WDChaseLevDeque();
+
+         /*! \brief Binds the deque to the thread that will use its bottom end
+          */
+         void setOwner ( BaseThread *owner );
+         BaseThread * getOwner () const;
+
+         bool empty ( void ) const;
+         size_t size() const;
+
+         void push_front ( WorkDescriptor *wd );
+         void push_back( WorkDescriptor *wd );
+
+         /*! \brief Returns the lock of the overflow list, for batch operations. */
+         Lock& getLock();
+         /*! \brief Batch operations always use the overflow list.
+          *  \note The lock must be acquired and released externally!
+          */
+         void push_front( WD** wds, size_t numElems );
+         void push_back( WD** wds, size_t numElems );
+
+         template <typename Constraints>
+         WorkDescriptor * popFrontWithConstraints ( BaseThread const *thread );
+         template <typename Constraints>
+         WorkDescriptor * popBackWithConstraints ( BaseThread const *thread );
+         template <typename Constraints>
+         bool removeWDWithConstraints( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next );
+
+         /*! \brief The owner pops its most recent WD, other threads steal the oldest one */
+         WorkDescriptor * pop_front ( BaseThread *thread );
+         /*! \brief Steals the oldest WD, also when called by the owner */
+         WorkDescriptor * pop_back ( BaseThread *thread );
+
+         /*! \brief Only WDs in the overflow list can be removed, WDs in the
+          *  buffer are reported as not found.
+          */
+         bool removeWD( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next );
+
+         void increaseTasksInQueues( int tasks, int increment = 1 );
+         void decreaseTasksInQueues( int tasks, int decrement = 1 );
+   };
+
    /*! \brief Class used to compare WDs by priority.
     *  \see WDPriorityQueue::push
     */
@@ -297,8 +447,31 @@ namespace nanos {
        typedef std::list<WorkDescriptor *> BaseContainer;
    }
 
+   /*! \brief Ready queues that keep their WDs ordered by priority
+    */
+   class WDPriorityPool : public WDPool
+   {
+      public:
+         /*! \brief Moves a WD of this queue to the position of its current priority.
+          *  \return If the WD was found or not.
+          */
+         virtual bool reorderWD( WorkDescriptor *wd ) = 0;
+
+         /*! \brief Returns the highest priority, without blocking.
+          */
+         virtual WD::PriorityType maxPriority() const = 0;
+
+         /*! \brief Returns the lowest priority, without blocking.
+          */
+         virtual WD::PriorityType minPriority() const = 0;
+
+         /*! \brief Returns the number of ready tasks that could be ran simultaneously
+          */
+         virtual int getNumConcurrentWDs() = 0;
+   };
+
    template<typename T = WD::PriorityType>
-   class WDPriorityQueue : public WDPool
+   class WDPriorityQueue : public WDPriorityPool
    {
       public:
          typedef T         type;
@@ -411,6 +584,123 @@ namespace nanos {
          int getNumConcurrentWDs();
    };
 
+   /*! \brief Relaxed concurrent priority queue (MultiQueue).
+    *
+    *  WDs are spread over several sub-queues, each one with its own lock. A
+    *  sub-queue keeps a FIFO bucket per priority value, so a push costs a
+    *  lookup among the distinct priorities of the sub-queue instead of a
+    *  search among its WDs, and a pop takes the first WD of the highest bucket.
+    *
+    *  Pushes go to a random sub-queue. Pops look at the highest priority of two
+    *  distinct random sub-queues and take from the best one, so the WD returned
+    *  has one of the highest priorities of the pool but not necessarily the
+    *  highest (exact with one or two sub-queues). If both are empty, or hold no
+    *  WD satisfying the constraints, the rest of the sub-queues are visited.
+    *  maxPriority() samples two sub-queues the same way.
+    *
+    *  Every sub-queue also indexes the position of its WDs, so reorderWD and
+    *  removeWD do not search the buckets.
+    */
+   class WDMultiPriorityQueue : public WDPriorityPool
+   {
+      private:
+         typedef std::list<WorkDescriptor *>                                                   Bucket;
+         typedef std::map< WD::PriorityType, Bucket, std::greater<WD::PriorityType> >          BucketMap;
+
+         struct Position {
+            WD::PriorityType     _priority;     /**< Bucket of the WD */
+            Bucket::iterator     _it;
+         };
+
+         typedef TR1::unordered_map< WorkDescriptor *, Position >                              PositionMap;
+
+         struct SubQueue {
+            Lock                          _lock;
+            BucketMap                     _buckets;
+            PositionMap                   _positions;
+            volatile size_t               _size;
+            volatile WD::PriorityType     _top;        /**< Highest priority, read without locking */
+            volatile WD::PriorityType     _bottom;     /**< Lowest priority, read without locking */
+            char                          _pad[NANOS_CACHELINE];
+
+            SubQueue() : _lock(), _buckets(), _positions(), _size( 0 ), _top( 0 ), _bottom( 0 ) {}
+         };
+
+         SubQueue                  *_queues;
+         unsigned int               _numQueues;
+         Lock                       _batchLock;      /**< Only serializes batch pushes */
+
+         static __thread unsigned int _seed;
+
+      private:
+         /*! \brief WDMultiPriorityQueue copy constructor (private)
+          */
+         WDMultiPriorityQueue ( const WDMultiPriorityQueue & );
+         /*! \brief WDMultiPriorityQueue copy assignment operator (private)
+          */
+         const WDMultiPriorityQueue & operator= ( const WDMultiPriorityQueue & );
+
+         /*! \brief Random sub-queue index, from a per thread xorshift generator */
+         unsigned int randomQueue () const;
+         /*! \brief Two distinct random sub-queues, unless there is only one, the best one first */
+         void randomPair ( unsigned int &first, unsigned int &second ) const;
+
+         /*! \brief Inserts wd in q, which must be locked */
+         void insert ( SubQueue &q, WorkDescriptor *wd, bool fifo );
+         /*! \brief Removes the WD at pos from q, which must be locked */
+         void remove ( SubQueue &q, PositionMap::iterator pos );
+
+         void push ( WorkDescriptor *wd, bool fifo );
+         void push ( WorkDescriptor **wds, size_t numElems, bool fifo );
+
+         template <typename Constraints>
+         WorkDescriptor * popWithConstraints ( SubQueue &q, BaseThread *thread );
+
+      public:
+         /*! \brief WDMultiPriorityQueue default constructor
+          *  \param numQueues number of sub-queues, twice the number of threads if 0
+          */
+         WDMultiPriorityQueue( unsigned int numQueues = 0 );
+         /*! \brief WDMultiPriorityQueue destructor
+          */
+         ~WDMultiPriorityQueue();
+
+         bool empty ( void ) const;
+         size_t size() const;
+
+         /*! \brief FIFO insertion among the WDs with the same priority */
+         void push_back( WorkDescriptor *wd );
+         /*! \brief LIFO insertion among the WDs with the same priority */
+         void push_front( WorkDescriptor *wd );
+
+         /*! \brief Returns a lock for batch operations, sub-queues are locked internally */
+         Lock& getLock();
+         void push_front( WD** wds, size_t numElems );
+         void push_back( WD** wds, size_t numElems );
+
+         template <typename Constraints>
+         WorkDescriptor * popFrontWithConstraints ( BaseThread *thread );
+         template <typename Constraints>
+         WorkDescriptor * popBackWithConstraints ( BaseThread *thread );
+         template <typename Constraints>
+         bool removeWDWithConstraints( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next );
+
+         WorkDescriptor * pop_back ( BaseThread *thread );
+         WorkDescriptor * pop_front ( BaseThread *thread );
+
+         bool removeWD( BaseThread *thread, WorkDescriptor *toRem, WorkDescriptor **next );
+
+         bool reorderWD( WorkDescriptor *wd );
+
+         WD::PriorityType maxPriority() const;
+         WD::PriorityType minPriority() const;
+
+         void increaseTasksInQueues( int tasks, int increment = 1 );
+         void decreaseTasksInQueues( int tasks, int decrement = 1 );
+
+         int getNumConcurrentWDs();
+   };
+
 
 } // namespace nanos
 
@@ -26,7 +26,10 @@ namespace nanos {
    class WDPool;
    class WDDeque;
    class WDLFQueue;
+   class WDChaseLevDeque;
+   class WDPriorityPool;
    template<typename T> class WDPriorityQueue;
+   class WDMultiPriorityQueue;
 
 } // namespace nanos
 
@@ -133,6 +133,7 @@ void WorkDescriptor::start (ULTFlag isUserLevelThread, WorkDescriptor *previous)
    // Getting run time
    _runTime = ( sys.getDefaultSchedulePolicy()->isCheckingWDRunTime() ? OS::getMonotonicTimeUs() : 0.0 );
 
+   LatencyStats::stop( LatencyStats::SUBMIT_TO_START, _submitTime );
 }
 
 
@@ -177,6 +178,7 @@ bool WorkDescriptor::isInputDataReady() {
       // Getting run time
       _runTime = ( sys.getDefaultSchedulePolicy()->isCheckingWDRunTime() ? OS::getMonotonicTimeUs() : 0.0 );
 
+      LatencyStats::stop( LatencyStats::SUBMIT_TO_START, _submitTime );
    }
    return result;
 }
@@ -268,7 +270,60 @@ void WorkDescriptor::submit( bool force_queue )
    } else {
       Scheduler::submit(*this, force_queue );
    }
-} 
+}
+
+size_t WorkDescriptor::submitBatchWithDependencies( size_t numWDs, WorkDescriptor **wds, size_t *numDeps, DataAccess **deps, WorkDescriptor **ready )
+{
+   // Defining call back (cb)
+   SchedulePolicySuccessorFunctor cb( *sys.getDefaultSchedulePolicy() );
+
+   {
+      // Every access below takes this lock again, now as a nested acquisition
+      DependenciesDomain::InstanceLockBlock lock( _depsDomain->getInstanceLock() );
+
+      for ( size_t i = 0; i < numWDs; i++ ) {
+         if ( numDeps[i] == 0 || deps[i] == NULL ) continue;
+
+         WorkDescriptor &wd = *wds[i];
+         wd._doSubmit = NEW DOSubmit();
+         wd._doSubmit->setWD(&wd);
+
+         // Fake predecessor, no WD of the batch is submitted on its own while registering
+         wd._doSubmit->increasePredecessors();
+
+         if ( _taskGraph == NULL || !_taskGraph->replay( *(wd._doSubmit), numDeps[i], deps[i], &cb ) ) {
+            initCommutativeAccesses( wd, numDeps[i], deps[i] );
+
+            if ( _taskGraph != NULL ) _taskGraph->record( numDeps[i], deps[i] );
+
+            _depsDomain->submitDependableObject( *(wd._doSubmit), numDeps[i], deps[i], &cb );
+         }
+         if ( sys._preSchedule ) {
+            sys._slots[wd._doSubmit->getNum()].insert(&wd);
+         }
+      }
+   }
+
+   // Release the fake predecessors. When it is the only one left nobody else can
+   // release the WD, so it is kept for the caller instead of being submitted
+   size_t numReady = 0;
+   for ( size_t i = 0; i < numWDs; i++ ) {
+      if ( numDeps[i] == 0 || deps[i] == NULL ) continue;
+
+      DOSubmit &depObj = *(wds[i]->_doSubmit);
+      if ( wds[i]->_slicer == NULL && depObj.canBeBatchReleased() ) {
+         depObj.decreasePredecessors( NULL, NULL, true, false );
+         depObj.dependenciesSatisfiedNoSubmit();
+         ready[numReady++] = wds[i];
+      } else {
+         depObj.decreasePredecessors( NULL, NULL, false, false );
+      }
+   }
+
+   if ( numReady > 0 ) DependenciesDomain::decreaseTasksInGraph( numReady );
+
+   return numReady;
+}
 
 void WorkDescriptor::submitOutputCopies ()
 {
@@ -531,6 +586,9 @@ void WorkDescriptor::setCopies(size_t numCopies, CopyData * copies)
 
 void WorkDescriptor::waitCompletion( bool avoidFlush )
 {
+   // Recorded tasks are held until the end of the region, a taskwait inside it cannot be replayed
+   if ( _taskGraph != NULL ) _taskGraph->interrupt();
+
    sys.preSchedule();
    _reachedTaskwait = true;
    if ( _submittedWDs != NULL && _submittedWDs->size() > 0 ) {
@@ -566,7 +624,8 @@ void WorkDescriptor::exitWork ( WorkDescriptor &work )
 }
 
 void WorkDescriptor::registerTaskReduction( void *p_orig, size_t p_size, size_t p_el_size,
-      void (*p_init)( void *, void * ), void (*p_reducer)( void *, void * ) )
+      void (*p_init)( void *, void * ), void (*p_reducer)( void *, void * ),
+      nanos_reduction_op_t op, nanos_reduction_type_t type )
 {
    //! Check if we have registered a reduction with this address
    task_reduction_vector_t::reverse_iterator it;
@@ -588,7 +647,9 @@ void WorkDescriptor::registerTaskReduction( void *p_orig, size_t p_size, size_t
 					   p_el_size,
 					   myThread->getTeam()->getFinalSize(),
 					   myThread->getCurrentWD()->getDepth(),
-					   sys._lazyPrivatizationEnabled
+					   sys._lazyPrivatizationEnabled,
+					   op,
+					   type
 					   )
        );
    }
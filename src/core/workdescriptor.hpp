@@ -32,9 +32,12 @@
 #include "instrumentationcontext.hpp"
 #include "schedule.hpp"
 #include "dependenciesdomain.hpp"
+#include "taskgraph_decl.hpp"
 #include "allocator_decl.hpp"
+#include "slaballocator.hpp"
 #include "system.hpp"
 #include "slicer_decl.hpp"
+#include "latencystats.hpp"
 
 namespace nanos {
 
@@ -51,8 +54,8 @@ inline WorkDescriptor::WorkDescriptor ( int ndevices, DeviceData **devs, size_t
                                  _cudaStreamIdx( -1 ),
 #endif
                                  _numCopies( numCopies ), _copies( copies ), _paramsSize( 0 ),
-                                 _versionGroupId( 0 ), _executionTime( 0.0 ), _estimatedExecTime( 0.0 ), _runTime( 0.0 ), _estimatedRunTime( 0.0 ),
-                                 _doSubmit(NULL), _doWait(), _depsDomain( sys.getDependenciesManager()->createDependenciesDomain() ), 
+                                 _versionGroupId( 0 ), _executionTime( 0.0 ), _estimatedExecTime( 0.0 ), _runTime( 0.0 ), _estimatedRunTime( 0.0 ), _submitTime( 0 ),
+                                 _doSubmit(NULL), _doWait(), _depsDomain( sys.getDependenciesManager()->createDependenciesDomain() ), _taskGraph( NULL ), 
                                  _translateArgs( translate_args ),
                                  _priority( 0 ), _commutativeOwnerMap(NULL), _commutativeOwners(NULL),
                                  _copiesNotInChunk(false), _description(description), _instrumentationContextData(), _slicer(NULL),
@@ -65,6 +68,7 @@ inline WorkDescriptor::WorkDescriptor ( int ndevices, DeviceData **devs, size_t
                                     _flags.is_submitted = false;
                                     _flags.is_recoverable = false;
                                     _flags.is_invalid = false;
+                                    _flags.is_slab = false;
                                     if ( copies != NULL ) {
                                        for ( unsigned int i = 0; i < numCopies; i += 1 ) {
                                           copies[i].setHostBaseAddress( 0 );
@@ -89,8 +93,8 @@ inline WorkDescriptor::WorkDescriptor ( DeviceData *device, size_t data_size, si
                                  _cudaStreamIdx( -1 ),
 #endif
                                  _numCopies( numCopies ), _copies( copies ), _paramsSize( 0 ),
-                                 _versionGroupId( 0 ), _executionTime( 0.0 ), _estimatedExecTime( 0.0 ),  _runTime( 0.0 ), _estimatedRunTime( 0.0 ),
-                                 _doSubmit(NULL), _doWait(), _depsDomain( sys.getDependenciesManager()->createDependenciesDomain() ),
+                                 _versionGroupId( 0 ), _executionTime( 0.0 ), _estimatedExecTime( 0.0 ),  _runTime( 0.0 ), _estimatedRunTime( 0.0 ), _submitTime( 0 ),
+                                 _doSubmit(NULL), _doWait(), _depsDomain( sys.getDependenciesManager()->createDependenciesDomain() ), _taskGraph( NULL ),
                                  _translateArgs( translate_args ),
                                  _priority( 0 ),  _commutativeOwnerMap(NULL), _commutativeOwners(NULL),
                                  _copiesNotInChunk(false), _description(description), _instrumentationContextData(), _slicer(NULL), _taskReductions(),
@@ -104,6 +108,7 @@ inline WorkDescriptor::WorkDescriptor ( DeviceData *device, size_t data_size, si
                                     _flags.is_submitted = false;
                                     _flags.is_recoverable = false;
                                     _flags.is_invalid = false;
+                                    _flags.is_slab = false;
                                     if ( copies != NULL ) {
                                        for ( unsigned int i = 0; i < numCopies; i += 1 ) {
                                           copies[i].setHostBaseAddress( 0 );
@@ -128,9 +133,9 @@ inline WorkDescriptor::WorkDescriptor ( const WorkDescriptor &wd, DeviceData **d
 #endif
                                  _numCopies( wd._numCopies ), _copies( wd._numCopies == 0 ? NULL : copies ), _paramsSize( wd._paramsSize ),
                                  _versionGroupId( wd._versionGroupId ), _executionTime( wd._executionTime ),
-                                 _estimatedExecTime( wd._estimatedExecTime ), _runTime( wd._runTime ), _estimatedRunTime( wd._estimatedRunTime ),
+                                 _estimatedExecTime( wd._estimatedExecTime ), _runTime( wd._runTime ), _estimatedRunTime( wd._estimatedRunTime ), _submitTime( 0 ),
                                  _doSubmit(NULL), _doWait(),
-                                 _depsDomain( sys.getDependenciesManager()->createDependenciesDomain() ),
+                                 _depsDomain( sys.getDependenciesManager()->createDependenciesDomain() ), _taskGraph( NULL ),
                                  _translateArgs( wd._translateArgs ),
                                  _priority( wd._priority ), _commutativeOwnerMap(NULL), _commutativeOwners(NULL),
                                  _copiesNotInChunk( wd._copiesNotInChunk), _description(description), _instrumentationContextData(), _slicer(wd._slicer), _taskReductions(),
@@ -146,6 +151,7 @@ inline WorkDescriptor::WorkDescriptor ( const WorkDescriptor &wd, DeviceData **d
                                     _flags.is_implicit = wd._flags.is_implicit;
                                     _flags.is_recoverable = wd._flags.is_recoverable;
                                     _flags.is_invalid = false;
+                                    _flags.is_slab = false;
 
                                     _mcontrol.preInit();
                                     for (unsigned int __i=0; __i<8;__i+=1) {
@@ -379,9 +385,13 @@ inline void WorkDescriptor::submitWithDependencies( WorkDescriptor &wd, size_t n
    // Defining call back (cb)
    SchedulePolicySuccessorFunctor cb( *sys.getDefaultSchedulePolicy() );
    
-   initCommutativeAccesses( wd, numDeps, deps );
-   
-   _depsDomain->submitDependableObject( *(wd._doSubmit), numDeps, deps, &cb );
+   if ( _taskGraph == NULL || !_taskGraph->replay( *(wd._doSubmit), numDeps, deps, &cb ) ) {
+      initCommutativeAccesses( wd, numDeps, deps );
+
+      if ( _taskGraph != NULL ) _taskGraph->record( numDeps, deps );
+
+      _depsDomain->submitDependableObject( *(wd._doSubmit), numDeps, deps, &cb );
+   }
    if ( sys._preSchedule ) {
       sys._slots[wd._doSubmit->getNum()].insert(&wd);
    }
@@ -390,6 +400,8 @@ inline void WorkDescriptor::submitWithDependencies( WorkDescriptor &wd, size_t n
 
 inline void WorkDescriptor::waitOn( size_t numDeps, DataAccess* deps )
 {
+   if ( _taskGraph != NULL ) _taskGraph->interrupt();
+
    _doWait->setWD(this);
    _depsDomain->submitDependableObject( *_doWait, numDeps, deps );
    _mcontrol.synchronize( numDeps, deps );
@@ -432,7 +444,11 @@ inline WorkDescriptor * WorkDescriptor::getImmediateSuccessor ( BaseThread &thre
 inline void WorkDescriptor::workFinished(WorkDescriptor &wd)
 {
    if ( wd._doSubmit != NULL ){
-      wd._doSubmit->finished();
+      if ( _taskGraph != NULL ) _taskGraph->finished( *(wd._doSubmit) );
+      {
+         LatencyScope latency( LatencyStats::DEPENDENCE_RELEASE );
+         wd._doSubmit->finished();
+      }
       delete wd._doSubmit;
       wd._doSubmit = NULL;
    }
@@ -450,11 +466,19 @@ inline DependenciesDomain & WorkDescriptor::getDependenciesDomain()
    return *_depsDomain;
 }
 
+inline void WorkDescriptor::setTaskGraph( TaskGraph *graph ) { _taskGraph = graph; }
+
+inline TaskGraph * WorkDescriptor::getTaskGraph() const { return _taskGraph; }
+
 
 inline InstrumentationContextData * WorkDescriptor::getInstrumentationContextData( void ) { return &_instrumentationContextData; }
 
 inline bool WorkDescriptor::isSubmitted() const { return _flags.is_submitted; }
-inline void WorkDescriptor::submitted()  { _flags.is_submitted = true; }
+inline void WorkDescriptor::submitted()
+{
+   _flags.is_submitted = true;
+   _submitTime = LatencyStats::start();
+}
 
 inline bool WorkDescriptor::isConfigured ( void ) const { return _flags.is_configured; }
 inline void WorkDescriptor::setConfigured ( bool value ) { _flags.is_configured = value; }
@@ -488,6 +512,18 @@ inline void WorkDescriptor::setImplicit( bool b )
 
 inline bool WorkDescriptor::isImplicit( void ) { return _flags.is_implicit; } 
 
+inline void WorkDescriptor::setSlabAllocated ( void ) { _flags.is_slab = true; }
+
+inline bool WorkDescriptor::isSlabAllocated ( void ) const { return _flags.is_slab; }
+
+inline void WorkDescriptor::destroy ( WorkDescriptor *wd, bool callDestructor )
+{
+   bool slab = wd->_flags.is_slab;
+   if ( callDestructor ) wd->~WorkDescriptor();
+   if ( slab ) SlabAllocator::deallocate( (void *) wd );
+   else delete[] (char *) wd;
+}
+
 inline const char * WorkDescriptor::getDescription ( void ) const  { return _description; }
 
 inline void WorkDescriptor::addWork ( WorkDescriptor &work )
@@ -21,6 +21,7 @@
 #define _NANOS_WORK_DESCRIPTOR_DECL_H
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <utility>
 #include <vector>
 
@@ -42,6 +43,7 @@
 #include "memcontroller_decl.hpp"
 
 #include "dependenciesdomain_decl.hpp"
+#include "taskgraph_fwd.hpp"
 #include "task_reduction_decl.hpp"
 #include "simpleallocator_decl.hpp"
 #include "schedule_fwd.hpp"   // ScheduleWDData
@@ -214,6 +216,7 @@ typedef std::set<const Device *>  DeviceList;
             bool is_implicit;        //!< Is the WD an implicit task (in a team)?
             bool is_recoverable;   //!< Flags a task as recoverable, that is, it can be re-executed if it finished with errors.
             bool is_invalid;       //!< Flags an invalid workdescriptor. Used in resiliency when a task fails.
+            bool is_slab;          //!< WD chunk was obtained from the SlabAllocator
          } WDFlags;
          typedef enum { INIT, START, READY, BLOCKED } State;
          typedef int PriorityType;
@@ -253,9 +256,11 @@ typedef std::set<const Device *>  DeviceList;
          double                        _estimatedExecTime;      //!< FIXME:scheduler data. WD estimated execution time, accounting data transfers
          double                        _runTime;          //!< FIXME:scheduler data. WD starting wall-clock time, without data transfers
          double                        _estimatedRunTime;      //!< FIXME:scheduler data. WD estimated execution time, without data transfers
+         uint64_t                      _submitTime;             //!< When the WD was submitted, for the latency statistics (0 if they are disabled)
          DOSubmit                     *_doSubmit;               //!< DependableObject representing this WD in its parent's depsendencies domain
          LazyInit<DOWait>              _doWait;                 //!< DependableObject used by this task to wait on dependencies
          DependenciesDomain           *_depsDomain;             //!< Dependences domain. Each WD has one where DependableObjects can be submitted            //!< Directory to mantain cache coherence
+         TaskGraph                    *_taskGraph;              //!< Task graph being recorded or replayed by the children of this WD (if any)
          nanos_translate_args_t        _translateArgs;          //!< Translates the addresses in _data to the ones obtained by get_address()
          PriorityType                  _priority;               //!< Task priority
          CommutativeOwnerMap          *_commutativeOwnerMap;    //!< Map from commutative target address to owner pointer
@@ -604,6 +609,18 @@ typedef std::set<const Device *>  DeviceList;
           */
          void submitWithDependencies( WorkDescriptor &wd, size_t numDeps, DataAccess* deps );
 
+         /*! \brief Add a batch of WDs to the domain of this WD.
+          *  Dependences of all the WDs are registered holding the domain lock.
+          *  The WDs that are ready afterwards and can be batch queued by the
+          *  scheduling policy are not submitted but stored in ready, the rest
+          *  behave as in submitWithDependencies.
+          *  \param numDeps Number of dependencies of each wd, WDs without dependencies are skipped.
+          *  \param deps Dependencies of each wd.
+          *  \param ready [out] Array of at least numWDs elements.
+          *  \return Number of WDs stored in ready.
+          */
+         size_t submitBatchWithDependencies( size_t numWDs, WorkDescriptor **wds, size_t *numDeps, DataAccess **deps, WorkDescriptor **ready );
+
          /*! \brief Waits untill all (input) dependencies passed are satisfied for the _doWait object.
           *  \param numDeps Number of de dependencies.
           *  \param deps dependencies to wait on, should be input dependencies.
@@ -627,6 +644,14 @@ typedef std::set<const Device *>  DeviceList;
           */
          DependenciesDomain & getDependenciesDomain();
 
+         /*! \brief Sets the TaskGraph recorded or replayed by the next submissions (NULL to stop)
+          */
+         void setTaskGraph( TaskGraph *graph );
+
+         /*! \brief Returns the TaskGraph recorded or replayed by the next submissions (if any)
+          */
+         TaskGraph * getTaskGraph() const;
+
          /*! \brief Returns embeded instrumentation context data.
           */
          InstrumentationContextData *getInstrumentationContextData( void );
@@ -675,6 +700,18 @@ typedef std::set<const Device *>  DeviceList;
          void setImplicit( bool b = true );
          bool isImplicit( void );
 
+         /*! \brief Marks the WD chunk as allocated by the SlabAllocator
+          */
+         void setSlabAllocated ( void );
+         bool isSlabAllocated ( void ) const;
+
+         /*! \brief Frees the chunk holding a WD
+          *
+          *  Chunks come either from the SlabAllocator or from NEW char[], the
+          *  origin is checked before running the destructor.
+          */
+         static void destroy ( WorkDescriptor *wd, bool callDestructor = true );
+
          /*! \brief Set copies for a given WD
           * We call this when copies cannot be set at creation time of the work descriptor
           * Note that this should only be done between creation and submit.
@@ -707,9 +744,11 @@ typedef std::set<const Device *>  DeviceList;
          void convertToRegularWD();
 
          //! \brief This function registers a new task reduction over a
-         //variable if it is not already registered.
+         //variable if it is not already registered. A built-in op lets the
+         //runtime combine the private copies without calling p_reducer.
          void registerTaskReduction( void *p_orig, size_t p_size, size_t elem_size,
-                 void (*p_init)( void *, void * ), void (*p_reducer)( void *, void * ) );
+                 void (*p_init)( void *, void * ), void (*p_reducer)( void *, void * ),
+                 nanos_reduction_op_t op = NANOS_REDUCTION_USER_OP, nanos_reduction_type_t type = NANOS_REDUCTION_INT );
 
          //! \brief This function registers a new fortran task reduction over an
          //array if it is not already registered.
@@ -0,0 +1,265 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "barrier.hpp"
+#include "system.hpp"
+#include "atomic.hpp"
+#include "schedule.hpp"
+#include "plugin.hpp"
+#include "synchronizedcondition.hpp"
+#include "threadteam.hpp"
+#include "smpbaseplugin_decl.hpp"
+
+namespace nanos {
+   namespace ext {
+
+      /*! \class CombiningTreeBarrier
+       *  \brief implements a combining tree barrier that also folds the team reductions
+       *
+       *  Participants are grouped in blocks of _radix consecutive ids, the first
+       *  one of every block being its leader; leaders are grouped again with
+       *  stride _radix, and so on up to participant 0. Consecutive ids are usually
+       *  bound to neighbouring cpus, so the default radix is the number of cpus
+       *  sharing a cache and the first level of the tree combines inside caches.
+       *
+       *  Every leader waits for its children, folds their reduction partials into
+       *  its own private copy and then arrives at its parent. The root folds the
+       *  result into the original variables and releases everybody flipping a
+       *  sense-reversing flag. Arrival counters live in separate cache lines.
+       */
+      class CombiningTreeBarrier: public Barrier
+      {
+         private:
+            typedef SingleSyncCond<EqualConditionChecker<int> > arrival_sync_cond_t;
+
+            struct Node {
+               Atomic<int>          _arrived;      /**< Children arrived in the current episode */
+               int                  _parent;       /**< -1 for the root */
+               int                  _numChildren;
+               arrival_sync_cond_t  _allArrived;
+               char                 _pad[NANOS_CACHELINE];
+            };
+
+            Node           *_nodes;
+            int             _numParticipants;
+#ifdef HAVE_NEW_GCC_ATOMIC_OPS
+            bool            _flag;
+#else
+            volatile bool   _flag;
+#endif
+            MultipleSyncCond<EqualConditionChecker<bool> > _syncCondTrue;
+            MultipleSyncCond<EqualConditionChecker<bool> > _syncCondFalse;
+
+         public:
+            static int      _radix;        /**< Children per node, 0 selects it from the topology */
+
+         private:
+            static int defaultRadix ( void );
+
+            /*! \brief Returns whether 'participant' leads the groups of children at distance 'stride' */
+            bool leads ( int participant, int stride ) const
+            {
+               return stride < _numParticipants && participant % ( stride * _radix ) == 0;
+            }
+
+            /*! \brief Folds the reductions of participant 'child' into the ones of 'participant' */
+            void foldReductions ( int participant, int child );
+
+         public:
+            CombiningTreeBarrier () : Barrier(), _nodes( NULL ), _numParticipants( 0 ), _flag( false ),
+               _syncCondTrue( EqualConditionChecker<bool>( &_flag, true ), 1 ),
+               _syncCondFalse( EqualConditionChecker<bool>( &_flag, false ), 1 ) {}
+            CombiningTreeBarrier ( const CombiningTreeBarrier& orig ) : Barrier(orig), _nodes( NULL ), _numParticipants( 0 ),
+               _flag( false ),
+               _syncCondTrue( EqualConditionChecker<bool>( &_flag, true ), orig._numParticipants ),
+               _syncCondFalse( EqualConditionChecker<bool>( &_flag, false ), orig._numParticipants )
+               { init( orig._numParticipants ); }
+
+            const CombiningTreeBarrier & operator= ( const CombiningTreeBarrier & barrier );
+
+            virtual ~CombiningTreeBarrier() { delete[] _nodes; }
+
+            void init ( int numParticipants );
+            void resize ( int numThreads );
+
+            void barrier ( int participant );
+            void computeVectorReductions ( void );
+      };
+
+      int CombiningTreeBarrier::_radix = 0;
+
+      const CombiningTreeBarrier & CombiningTreeBarrier::operator= ( const CombiningTreeBarrier & orig )
+      {
+         // self-assignment
+         if ( &orig == this ) return *this;
+
+         Barrier::operator=(orig);
+         _flag = false;
+
+         if ( orig._numParticipants != _numParticipants )
+            resize(orig._numParticipants);
+
+         return *this;
+      }
+
+      int CombiningTreeBarrier::defaultRadix ( void )
+      {
+         // Number of cpus sharing the cache of the first one
+         int cpus = sys.getSMPPlugin()->getCpuCount();
+         unsigned int core, cache, first;
+         sys._hwloc.getCpuLocality( 0, core, first );
+
+         int radix = 0;
+         for ( int cpu = 0; cpu < cpus; cpu++ ) {
+            sys._hwloc.getCpuLocality( cpu, core, cache );
+            if ( cache == first ) radix++;
+         }
+
+         // Without topology information every cpu is its own cache
+         if ( radix < 2 ) return 4;
+         return radix > 16 ? 16 : radix;
+      }
+
+      void CombiningTreeBarrier::init( int numParticipants )
+      {
+         if ( _radix < 2 ) _radix = defaultRadix();
+
+         delete[] _nodes;
+         _numParticipants = numParticipants;
+         _nodes = NEW Node[numParticipants];
+         _syncCondTrue.resize( numParticipants );
+         _syncCondFalse.resize( numParticipants );
+
+         for ( int i = 0; i < numParticipants; i++ ) {
+            Node &node = _nodes[i];
+
+            // The parent is the leader of the first group this participant does not lead
+            int stride = 1;
+            while ( i != 0 && leads( i, stride ) ) stride *= _radix;
+            node._parent = i == 0 ? -1 : i - i % ( stride * _radix );
+
+            node._numChildren = 0;
+            for ( stride = 1; leads( i, stride ); stride *= _radix ) {
+               for ( int c = 1; c < _radix && i + c * stride < numParticipants; c++ ) node._numChildren++;
+            }
+
+            node._arrived = 0;
+            node._allArrived.setConditionChecker( EqualConditionChecker<int>( &node._arrived.override(), node._numChildren ) );
+         }
+      }
+
+      void CombiningTreeBarrier::resize( int numParticipants )
+      {
+         init( numParticipants );
+      }
+
+      void CombiningTreeBarrier::foldReductions ( int participant, int child )
+      {
+         ThreadTeam::ReductionList &reductions = myThread->getTeam()->getReductionList();
+         ThreadTeam::ReductionList::iterator it;
+         for ( it = reductions.begin(); it != reductions.end(); it++ ) {
+            nanos_reduction_t *red = *it;
+            // Vector reductions are only known as a whole, the root computes them
+            if ( red->vop ) continue;
+            char *privates = reinterpret_cast<char *>( red->privates );
+            red->bop( privates + participant * red->element_size, privates + child * red->element_size, red->num_scalars );
+         }
+      }
+
+      void CombiningTreeBarrier::computeVectorReductions ( void )
+      {
+         // The partial results of the whole team are in the private copy of participant 0
+         ThreadTeam *team = myThread->getTeam();
+         ThreadTeam::ReductionList &reductions = team->getReductionList();
+         ThreadTeam::ReductionList::iterator it;
+         for ( it = reductions.begin(); it != reductions.end(); it++ ) {
+            nanos_reduction_t *red = *it;
+            if ( red->vop ) red->vop( team->size(), red->original, red->privates );
+            else red->bop( red->original, red->privates, red->num_scalars );
+         }
+         team->cleanUpReductionList();
+      }
+
+      void CombiningTreeBarrier::barrier( int participant )
+      {
+         Node &node = _nodes[participant];
+         bool sense = !_flag;
+
+         if ( node._numChildren > 0 ) {
+            node._allArrived.waitConditionAndSignalers();
+            node._arrived = 0;
+
+            // Partials are folded level by level, nearest children first
+            for ( int stride = 1; leads( participant, stride ); stride *= _radix ) {
+               for ( int c = 1; c < _radix && participant + c * stride < _numParticipants; c++ )
+                  foldReductions( participant, participant + c * stride );
+            }
+         }
+
+         if ( node._parent >= 0 ) {
+            Node &parent = _nodes[node._parent];
+            parent._allArrived.reference();
+            if ( ++parent._arrived == parent._numChildren ) parent._allArrived.signal();
+            parent._allArrived.unreference();
+
+            if ( sense ) _syncCondTrue.wait();
+            else _syncCondFalse.wait();
+         } else {
+            computeVectorReductions();
+
+            _flag = sense;
+            if ( sense ) _syncCondTrue.signal();
+            else _syncCondFalse.signal();
+         }
+      }
+
+
+      static Barrier * createCombiningTreeBarrier()
+      {
+          return NEW CombiningTreeBarrier();
+      }
+
+
+      /*! \class CombiningTreeBarrierPlugin
+       *  \brief plugin of the related CombiningTreeBarrier class
+       *  \see CombiningTreeBarrier
+       */
+      class CombiningTreeBarrierPlugin : public Plugin
+      {
+
+         public:
+            CombiningTreeBarrierPlugin() : Plugin( "Combining Tree Barrier Plugin",1 ) {}
+
+            virtual void config( Config &cfg )
+            {
+               cfg.setOptionsSection( "Combining barrier", "Combining tree barrier module" );
+               cfg.registerConfigOption( "barrier-combining-radix", NEW Config::PositiveVar( CombiningTreeBarrier::_radix ),
+                                         "Children of every node of the combining tree (default: cpus sharing a cache)" );
+               cfg.registerArgOption( "barrier-combining-radix", "barrier-combining-radix" );
+            }
+
+            virtual void init() {
+               sys.setDefaultBarrFactory( createCombiningTreeBarrier );
+            }
+      };
+
+   }
+}
+
+DECLARE_PLUGIN("barr-combining",nanos::ext::CombiningTreeBarrierPlugin);
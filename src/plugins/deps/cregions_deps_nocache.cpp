@@ -251,7 +251,7 @@ namespace nanos {
              */
             void submitDependableObjectDataAccess( DependableObject &depObj, DepsRegion &target, AccessType const &accessType, SchedulePolicySuccessorFunctor* callback, TR1::unordered_map<TrackableObject*, bool>& statusMap )
             {
-               SyncRecursiveLockBlock lock1( getInstanceLock() );
+               InstanceLockBlock lock1( getInstanceLock() );
                
                if ( accessType.concurrent || accessType.commutative ) {
                   if ( !( accessType.input && accessType.output ) || depObj.waits() ) {
@@ -394,7 +394,7 @@ namespace nanos {
 
             bool haveDependencePendantWrites ( void *addr )
             {
-               SyncRecursiveLockBlock lock1( getInstanceLock() );                
+               InstanceLockBlock lock1( getInstanceLock() );                
                DepsRegion address( addr, addr );
                DepsVector::iterator it = findAddrInAddressDependencyMap( address );
                if ( it == _addressDependencyVector.end() ) {
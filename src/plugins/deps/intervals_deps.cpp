@@ -0,0 +1,697 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "baseregionsdependenciesdomain.hpp"
+#include "plugin.hpp"
+#include "system.hpp"
+#include "config.hpp"
+#include "compatibility.hpp"
+#include "depsregion.hpp"
+#include "intervaltree.hpp"
+#include "trackableobject.hpp"
+#include <pthread.h>
+#include <algorithm>
+#include <vector>
+
+namespace nanos {
+   namespace ext {
+
+      /*! \brief Overlapping regions dependencies domain backed by an interval tree.
+       *
+       *  Every access is tracked as one or more contiguous address intervals. The
+       *  statuses of the domain are kept as non-overlapping intervals in an
+       *  IntervalTree, so finding the ones an access covers is O(log n + k), and
+       *  query results are stored in buffers owned by the caller instead of being
+       *  allocated per lookup.
+       *
+       *  The tree is protected by a reader-writer lock: submissions, which change
+       *  the tree, are exclusive while finishing objects, which only update the
+       *  statuses through their own locks, share it. Statuses that become empty
+       *  while finishing are not removed until a later submission either finds
+       *  them or sweeps the tree.
+       *
+       *  A strided access is split in one interval per non-contiguous row, so it
+       *  is not a replacement for the regions domain in general: it is only worth
+       *  using when the accesses are mostly contiguous. Task reductions are not
+       *  supported.
+       */
+      class IntervalDependenciesDomain : public BaseRegionsDependenciesDomain
+      {
+         private:
+            typedef IntervalTree<TrackableObject> IntervalMap; /**< Maps intervals to \a TrackableObject objects */
+            typedef IntervalMap::Node IntervalNode;
+
+            //! \brief Contiguous interval access of a DependableObject
+            struct IntervalAccess {
+               uintptr_t      _start;
+               uintptr_t      _end;
+               AccessType     _type;
+
+               bool operator< ( IntervalAccess const &other ) const
+               {
+                  return _start < other._start || ( _start == other._start && _end < other._end );
+               }
+            };
+
+            /*! \brief Interval accesses of a DependableObject.
+             *
+             *  Stored in the object itself unless there are more than LocalEntries of
+             *  them, so submitting a task with a few dependences does not allocate.
+             */
+            class AccessList {
+               public:
+                  typedef IntervalAccess * iterator;
+               private:
+                  static const size_t           LocalEntries = 16;
+
+                  IntervalAccess                _local[LocalEntries];
+                  std::vector<IntervalAccess>   _extra;
+                  IntervalAccess               *_accesses;
+                  size_t                        _size;
+
+                  AccessList ( const AccessList & );
+                  const AccessList & operator= ( const AccessList & );
+               public:
+                  AccessList () : _extra(), _accesses( _local ), _size( 0 ) {}
+
+                  void push_back ( IntervalAccess const &access )
+                  {
+                     if ( _size == LocalEntries && _accesses == _local ) {
+                        _extra.assign( _local, _local + LocalEntries );
+                     }
+                     if ( _size >= LocalEntries ) {
+                        _extra.push_back( access );
+                        _accesses = &_extra[0];
+                     } else {
+                        _local[_size] = access;
+                     }
+                     _size++;
+                  }
+
+                  //! \brief Sorts the accesses by address and merges the identical ones
+                  void coalesce ()
+                  {
+                     if ( _size < 2 ) return;
+                     std::sort( _accesses, _accesses + _size );
+                     size_t last = 0;
+                     for ( size_t i = 1; i < _size; i++ ) {
+                        if ( _accesses[i]._start == _accesses[last]._start && _accesses[i]._end == _accesses[last]._end ) {
+                           _accesses[last]._type |= _accesses[i]._type;
+                        } else {
+                           _accesses[++last] = _accesses[i];
+                        }
+                     }
+                     _size = last + 1;
+                  }
+
+                  size_t size () const { return _size; }
+                  iterator begin () { return _accesses; }
+                  iterator end () { return _accesses + _size; }
+            };
+
+            /*! \brief Statuses overlapping an interval.
+             *
+             *  Results are stored in the object itself unless there are more than
+             *  LocalEntries of them. It can be used as the source container of
+             *  BaseRegionsDependenciesDomain methods.
+             */
+            class StatusQuery {
+               public:
+                  typedef TrackableObject ** iterator;
+               private:
+                  static const size_t           LocalEntries = 32;
+
+                  IntervalNode                 *_localNodes[LocalEntries];
+                  TrackableObject              *_localStatuses[LocalEntries];
+                  std::vector<IntervalNode *>   _extraNodes;
+                  std::vector<TrackableObject *> _extraStatuses;
+                  IntervalNode                **_nodes;
+                  TrackableObject             **_statuses;
+                  size_t                        _size;
+
+                  StatusQuery ( const StatusQuery & );
+                  const StatusQuery & operator= ( const StatusQuery & );
+               public:
+                  StatusQuery ( IntervalMap const &map, uintptr_t start, uintptr_t end )
+                     : _extraNodes(), _extraStatuses(), _nodes( _localNodes ), _statuses( _localStatuses ), _size( 0 )
+                  {
+                     _size = map.findOverlapping( start, end, _nodes, LocalEntries );
+                     if ( _size > LocalEntries ) {
+                        _extraNodes.resize( _size );
+                        _extraStatuses.resize( _size );
+                        _nodes = &_extraNodes[0];
+                        _statuses = &_extraStatuses[0];
+                        map.findOverlapping( start, end, _nodes, _size );
+                     }
+                     for ( size_t i = 0; i < _size; i++ ) {
+                        _statuses[i] = &_nodes[i]->getValue();
+                     }
+                  }
+
+                  size_t size () const { return _size; }
+                  IntervalNode * getNode ( size_t i ) const { return _nodes[i]; }
+                  iterator begin () { return _statuses; }
+                  iterator end () { return _statuses + _size; }
+            };
+
+            //! \brief Container of a single status, for BaseRegionsDependenciesDomain methods
+            class SingleStatus {
+               public:
+                  typedef TrackableObject ** iterator;
+               private:
+                  TrackableObject              *_status;
+               public:
+                  SingleStatus ( TrackableObject &status ) : _status( &status ) {}
+
+                  iterator begin () { return &_status; }
+                  iterator end () { return &_status + 1; }
+            };
+
+            /*! \brief Holds the tree lock exclusively during its lifetime
+             *  Does nothing if the current thread already holds it.
+             */
+            class ExclusiveAccess {
+               private:
+                  IntervalDependenciesDomain   &_domain;
+                  bool                          _locked;
+                  uint64_t                      _lockTime;    /**< When the lock was taken, for the latency statistics */
+
+                  ExclusiveAccess ( const ExclusiveAccess & );
+                  const ExclusiveAccess & operator= ( const ExclusiveAccess & );
+               public:
+                  ExclusiveAccess ( IntervalDependenciesDomain &domain ) : _domain( domain ), _locked( _owner != &domain ), _lockTime( 0 )
+                  {
+                     if ( _locked ) {
+                        _lockTime = LatencyStats::start();
+                        if ( pthread_rwlock_wrlock( &_domain._mapLock ) ) fatal( "Interval dependencies domain: lock error" );
+                        _lockTime = LatencyStats::stop( LatencyStats::DEPS_LOCK_WAIT, _lockTime );
+                        _owner = &_domain;
+                     }
+                  }
+                  ~ExclusiveAccess ()
+                  {
+                     if ( _locked ) {
+                        LatencyStats::stop( LatencyStats::DEPS_LOCK_HOLD, _lockTime );
+                        _owner = NULL;
+                        pthread_rwlock_unlock( &_domain._mapLock );
+                     }
+                  }
+            };
+
+            /*! \brief Holds the tree lock in shared mode during its lifetime
+             *  Does nothing if the current thread already holds it exclusively, which
+             *  happens when a submission triggers the release of a CommutationDO.
+             */
+            class SharedAccess {
+               private:
+                  IntervalDependenciesDomain   &_domain;
+                  bool                          _locked;
+
+                  SharedAccess ( const SharedAccess & );
+                  const SharedAccess & operator= ( const SharedAccess & );
+               public:
+                  SharedAccess ( IntervalDependenciesDomain &domain ) : _domain( domain ), _locked( _owner != &domain )
+                  {
+                     if ( _locked && pthread_rwlock_rdlock( &_domain._mapLock ) ) fatal( "Interval dependencies domain: lock error" );
+                  }
+                  ~SharedAccess ()
+                  {
+                     if ( _locked ) pthread_rwlock_unlock( &_domain._mapLock );
+                  }
+            };
+
+         private:
+            IntervalMap                   _intervalMap;  /**< Used to track dependencies between DependableObject */
+            pthread_rwlock_t              _mapLock;      /**< Protects the structure of _intervalMap */
+            Atomic<size_t>                _emptied;      /**< Statuses that have become empty since the last sweep (approx.) */
+
+            static __thread IntervalDependenciesDomain *_owner; /**< Domain whose lock the thread holds exclusively */
+            static const size_t           SweepThreshold = 1024;
+
+         public:
+            static int                    _maxRows;      /**< Rows a multidimensional access is split into at most */
+
+         private:
+            IntervalDependenciesDomain ( const IntervalDependenciesDomain &depDomain );
+            const IntervalDependenciesDomain & operator= ( const IntervalDependenciesDomain &depDomain );
+
+            /*! \brief Appends the intervals accessed by a DataAccess to accesses.
+             *
+             *  Multidimensional accesses are split into their contiguous rows, unless
+             *  there are more than _maxRows of them. In that case their bounding
+             *  interval is used, which may create false dependences but never misses one.
+             */
+            void buildIntervals ( DataAccess const &dataAccess, AccessList &accesses )
+            {
+               uintptr_t address = (uintptr_t) dataAccess.getDepAddress();
+               short dimensions = dataAccess.dimension_count;
+               nanos_region_dimension_internal_t const *dims = dataAccess.dimensions;
+
+               // First dimension is base 1
+               size_t rowLength = dims[0].accessed_length;
+               size_t rows = 1;
+               for ( short d = 1; d < dimensions; d++ ) {
+                  rows *= dims[d].accessed_length;
+               }
+
+               IntervalAccess interval;
+               interval._type = dataAccess.flags;
+
+               if ( rows == 1 || rows > (size_t) _maxRows ) {
+                  size_t span = rowLength;
+                  size_t stride = dims[0].size;
+                  for ( short d = 1; d < dimensions; d++ ) {
+                     span += ( dims[d].accessed_length - 1 ) * stride;
+                     stride *= dims[d].size;
+                  }
+                  interval._start = address;
+                  interval._end = address + span;
+                  addInterval( interval, accesses );
+                  return;
+               }
+
+               interval._start = interval._end = address;
+               for ( size_t row = 0; row < rows; row++ ) {
+                  // The row index, decomposed in the indexes of dimensions 1 and up, gives its start
+                  uintptr_t start = address;
+                  size_t rest = row;
+                  size_t stride = dims[0].size;
+                  for ( short d = 1; d < dimensions; d++ ) {
+                     start += ( rest % dims[d].accessed_length ) * stride;
+                     rest /= dims[d].accessed_length;
+                     stride *= dims[d].size;
+                  }
+
+                  // Adjacent rows are merged
+                  if ( start != interval._end ) {
+                     if ( interval._end != interval._start ) addInterval( interval, accesses );
+                     interval._start = start;
+                  }
+                  interval._end = start + rowLength;
+               }
+               addInterval( interval, accesses );
+            }
+
+            /*! \brief Appends interval to accesses, identical ones are merged by AccessList::coalesce */
+            void addInterval ( IntervalAccess const &interval, AccessList &accesses )
+            {
+               if ( interval._start != interval._end ) accesses.push_back( interval );
+            }
+
+            /*! \brief Removes all the empty statuses of the tree
+             *  \pre The tree is held exclusively
+             */
+            void sweep ()
+            {
+               std::vector<IntervalNode *> nodes( _intervalMap.size() );
+               size_t size = _intervalMap.findOverlapping( 0, UINTPTR_MAX, nodes.empty() ? NULL : &nodes[0], nodes.size() );
+               ensure( size == nodes.size(), "Interval dependencies domain: inconsistent tree size" );
+
+               for ( size_t i = 0; i < size; i++ ) {
+                  if ( nodes[i]->getValue().isEmpty() ) _intervalMap.erase( nodes[i] );
+               }
+               _emptied = 0;
+            }
+
+         protected:
+            /*! \brief Assigns the DependableObject depObj an id in this domain and adds it to the domains dependency system.
+             *  \param depObj DependableObject to be added to the domain.
+             *  \param begin Iterator to the start of the list of dependencies to be associated to the Dependable Object.
+             *  \param end Iterator to the end of the mentioned list.
+             *  \param callback A function to call when a WD has a successor [Optional].
+             *  \sa Dependency DependableObject TrackableObject
+             */
+            template<typename const_iterator>
+            void submitDependableObjectInternal ( DependableObject &depObj, const_iterator begin, const_iterator end, SchedulePolicySuccessorFunctor* callback )
+            {
+               depObj.setId ( _lastDepObjId++ );
+               depObj.init();
+               depObj.setDependenciesDomain( this );
+
+               // Object is not ready to get its dependencies satisfied
+               // so we increase the number of predecessors to permit other dependableObjects to free some of
+               // its dependencies without triggering the "dependenciesSatisfied" method
+               depObj.increasePredecessors();
+
+               AccessList accesses;
+               for ( const_iterator it = begin; it != end; it++ ) {
+                  DataAccess const &dataAccess = *it;
+
+                  // if address == NULL, just ignore it
+                  if ( dataAccess.getDepAddress() == NULL ) continue;
+
+                  buildIntervals( dataAccess, accesses );
+               }
+               // Coalesce identical intervals to avoid duplicates
+               accesses.coalesce();
+
+               // This list is only needed for waiting, tasks do not fill it
+               std::list<uint64_t> flushDeps;
+
+               {
+                  ExclusiveAccess lock( *this );
+
+                  if ( _emptied.value() >= SweepThreshold && _emptied.value() * 2 >= _intervalMap.size() ) {
+                     sweep();
+                  }
+
+                  for ( AccessList::iterator it = accesses.begin(); it != accesses.end(); it++ ) {
+                     submitDependableObjectDataAccess( depObj, *it, callback );
+                     if ( depObj.waits() ) flushDeps.push_back( (uint64_t) it->_start );
+                  }
+               }
+               sys.getDefaultSchedulePolicy()->atCreate( depObj );
+
+               // To keep the count consistent we have to increase the number of tasks in the graph before releasing the fake dependency
+               increaseTasksInGraph();
+
+               depObj.submitted();
+
+               // now everything is ready
+               depObj.decreasePredecessors( &flushDeps, NULL, false, true );
+            }
+
+            /*! \brief Copies the last writer, readers and CommutationDO of a status
+             *  \pre The tree is held exclusively
+             */
+            void copyStatus ( TrackableObject &source, TrackableObject &destination )
+            {
+               if ( source.getLastWriter() != NULL ) {
+                  destination.setLastWriter( *source.getLastWriter() );
+               }
+               TrackableObject::DependableObjectList &readers = source.getReaders();
+               for ( TrackableObject::DependableObjectList::iterator it = readers.begin(); it != readers.end(); it++ ) {
+                  destination.setReader( **it );
+               }
+               destination.setCommDO( source.getCommDO() );
+            }
+
+            /*! \brief Splits the interval that contains address, if any, so that none crosses it
+             *
+             *  Both halves inherit the status of the original interval. A pending
+             *  commutation is finalized first, so that the same CommutationDO is never
+             *  shared by two intervals.
+             *  \pre The tree is held exclusively
+             */
+            void splitAt ( uintptr_t address )
+            {
+               IntervalNode *node;
+               if ( _intervalMap.findOverlapping( address, address + 1, &node, 1 ) == 0 || node->getStart() == address ) return;
+
+               if ( node->getValue().getCommDO() != NULL ) {
+                  SingleStatus status( node->getValue() );
+                  finalizeReduction( status, DepsRegion( (void *) node->getStart(), (void *) ( node->getEnd() - 1 ) ) );
+               }
+
+               bool inserted;
+               IntervalNode *left = _intervalMap.findOrInsert( node->getStart(), address, inserted );
+               IntervalNode *right = _intervalMap.findOrInsert( address, node->getEnd(), inserted );
+               copyStatus( node->getValue(), left->getValue() );
+               copyStatus( node->getValue(), right->getValue() );
+               _intervalMap.erase( node );
+            }
+
+            /*! \brief Covers the holes of [start, end) with new empty intervals
+             *  \pre The tree is held exclusively and no interval crosses start or end
+             */
+            void fillGaps ( uintptr_t start, uintptr_t end )
+            {
+               StatusQuery fragments( _intervalMap, start, end );
+               uintptr_t covered = start;
+               bool inserted;
+               for ( size_t i = 0; i < fragments.size(); i++ ) {
+                  IntervalNode *node = fragments.getNode( i );
+                  if ( node->getStart() > covered ) _intervalMap.findOrInsert( covered, node->getStart(), inserted );
+                  covered = node->getEnd();
+               }
+               if ( covered < end ) _intervalMap.findOrInsert( covered, end, inserted );
+            }
+
+            /*! \brief Adds an interval access of a DependableObject to the domains dependency system.
+             *
+             *  Intervals in the tree never overlap. Accessing [start, end) first splits the
+             *  intervals that cross its bounds. Reads then add the object as a reader of every
+             *  interval inside the access. Writes make it depend on all of them and replace
+             *  them by a single interval.
+             *
+             *  \param depObj target DependableObject
+             *  \param access accessed interval and kind of access
+             *  \param callback Function to call if an immediate predecessor is found.
+             *  \pre The tree is held exclusively
+             */
+            void submitDependableObjectDataAccess( DependableObject &depObj, IntervalAccess const &access, SchedulePolicySuccessorFunctor* callback )
+            {
+               AccessType const &accessType = access._type;
+
+               if ( accessType.concurrent || accessType.commutative ) {
+                  if ( !( accessType.input && accessType.output ) || depObj.waits() ) {
+                     fatal( "Commutation/concurrent task must be inout" );
+                  }
+               }
+
+               if ( accessType.concurrent && accessType.commutative ) {
+                  fatal( "Task cannot be concurrent AND commutative" );
+               }
+
+               // Task reductions are finalized by finalizeAllReductions, which this domain lacks
+               if ( accessType.concurrent && myThread->getCurrentWD()->getTaskReduction( (const void *) access._start ) != NULL ) {
+                  fatal( "Task reductions are not supported by the intervals dependencies plugin, use --deps=plain" );
+               }
+
+               DepsRegion target( (void *) access._start, (void *) ( access._end - 1 ) );
+
+               splitAt( access._start );
+               splitAt( access._end );
+
+               if ( accessType.output ) {
+                  bool inserted;
+                  IntervalNode *targetNode = _intervalMap.findOrInsert( access._start, access._end, inserted );
+                  TrackableObject &targetStatus = targetNode->getValue();
+
+                  // Includes the target status itself
+                  StatusQuery sources( _intervalMap, access._start, access._end );
+
+                  if ( accessType.concurrent || accessType.commutative ) {
+                     submitDependableObjectCommutativeDataAccess( depObj, target, accessType, sources, targetStatus, callback );
+                  } else if ( accessType.input ) {
+                     submitDependableObjectInoutDataAccess( depObj, target, accessType, sources, targetStatus, callback );
+                  } else {
+                     submitDependableObjectOutputDataAccess( depObj, target, accessType, sources, targetStatus, callback );
+                  }
+
+                  // The target interval replaces the ones it covers
+                  for ( size_t i = 0; i < sources.size(); i++ ) {
+                     IntervalNode *node = sources.getNode( i );
+                     if ( node != targetNode || node->getValue().isEmpty() ) _intervalMap.erase( node );
+                  }
+               } else if ( accessType.input ) {
+                  fillGaps( access._start, access._end );
+
+                  StatusQuery sources( _intervalMap, access._start, access._end );
+
+                  finalizeReduction( sources, target );
+                  dependOnLastWriter( depObj, sources, target, callback, accessType );
+
+                  for ( size_t i = 0; i < sources.size(); i++ ) {
+                     IntervalNode *node = sources.getNode( i );
+                     if ( !depObj.waits() ) {
+                        addAsReader( depObj, node->getValue() );
+                     } else if ( node->getValue().isEmpty() ) {
+                        _intervalMap.erase( node );
+                     }
+                  }
+               } else {
+                  fatal( "Invalid data access" );
+               }
+
+               if ( !depObj.waits() && !accessType.concurrent && !accessType.commutative ) {
+                  if ( accessType.output ) {
+                     depObj.addWriteTarget( target );
+                  } else if (accessType.input /* && !accessType.output && !accessType.concurrent */ ) {
+                     depObj.addReadTarget( target );
+                  }
+               }
+            }
+
+            /*! \brief Notes that status may have become empty */
+            void checkEmptied ( TrackableObject &status )
+            {
+               if ( status.isEmpty() ) _emptied++;
+            }
+
+            /*! \brief Removes the DependableObject from the role of last writer of a region.
+             *  \pre The tree is held, either shared or exclusively
+             */
+            void releaseLastWriter ( DependableObject &depObj, BaseDependency const &target )
+            {
+               const DepsRegion& region( static_cast<const DepsRegion&>( target ) );
+
+               StatusQuery statuses( _intervalMap, (uintptr_t) region.getAddress(), (uintptr_t) region.getEndAddress() + 1 );
+               for ( StatusQuery::iterator it = statuses.begin(); it != statuses.end(); it++ ) {
+                  TrackableObject &status = **it;
+                  status.deleteLastWriter( depObj );
+                  checkEmptied( status );
+               }
+            }
+
+            void deleteLastWriter ( DependableObject &depObj, BaseDependency const &target )
+            {
+               SharedAccess lock1( *this );
+               releaseLastWriter( depObj, target );
+            }
+
+            void deleteReader ( DependableObject &depObj, BaseDependency const &target )
+            {
+               const DepsRegion& region( static_cast<const DepsRegion&>( target ) );
+
+               SharedAccess lock1( *this );
+               StatusQuery statuses( _intervalMap, (uintptr_t) region.getAddress(), (uintptr_t) region.getEndAddress() + 1 );
+               for ( StatusQuery::iterator it = statuses.begin(); it != statuses.end(); it++ ) {
+                  TrackableObject &status = **it;
+                  {
+                     SyncLockBlock lock2( status.getReadersLock() );
+                     status.deleteReader( depObj );
+                  }
+                  checkEmptied( status );
+               }
+            }
+
+            void removeCommDO ( CommutationDO *commDO, BaseDependency const &target )
+            {
+               const DepsRegion& region( static_cast<const DepsRegion&>( target ) );
+
+               SharedAccess lock1( *this );
+               StatusQuery statuses( _intervalMap, (uintptr_t) region.getAddress(), (uintptr_t) region.getEndAddress() + 1 );
+               for ( StatusQuery::iterator it = statuses.begin(); it != statuses.end(); it++ ) {
+                  TrackableObject &status = **it;
+                  if ( status.getCommDO ( ) == commDO ) {
+                     status.setCommDO ( 0 );
+                  }
+                  checkEmptied( status );
+               }
+            }
+
+         public:
+            IntervalDependenciesDomain() : BaseRegionsDependenciesDomain(), _intervalMap(), _emptied( 0 )
+            {
+               if ( pthread_rwlock_init( &_mapLock, NULL ) ) fatal( "Interval dependencies domain: lock initialization error" );
+            }
+
+            ~IntervalDependenciesDomain()
+            {
+               pthread_rwlock_destroy( &_mapLock );
+            }
+
+            /*! \brief Removes the DependableObject from the role of last writer of all the regions it wrote.
+             *  Unlike the default implementation, finishing objects of the same domain do not exclude each other.
+             */
+            void deleteLastWriters ( DependableObject &depObj, std::vector<BaseDependency *> const &targets )
+            {
+               SharedAccess lock1( *this );
+               SyncLockBlock lock2( depObj.getLock() );
+               for ( unsigned int i = 0; i < targets.size(); i++ ) {
+                  releaseLastWriter ( depObj, *targets[i] );
+               }
+            }
+
+            /*!
+             *  \note This function cannot be implemented in
+             *  BaseRegionsDependenciesDomain since it calls a template function,
+             *  and they cannot be virtual.
+             */
+            inline void submitDependableObject ( DependableObject &depObj, std::vector<DataAccess> &deps, SchedulePolicySuccessorFunctor* callback )
+            {
+               submitDependableObjectInternal ( depObj, deps.begin(), deps.end(), callback );
+            }
+
+            /*!
+             *  \note This function cannot be implemented in
+             *  BaseRegionsDependenciesDomain since it calls a template function,
+             *  and they cannot be virtual.
+             */
+            inline void submitDependableObject ( DependableObject &depObj, size_t numDeps, DataAccess* deps, SchedulePolicySuccessorFunctor* callback )
+            {
+               submitDependableObjectInternal ( depObj, deps, deps+numDeps, callback );
+            }
+
+            void finalizeAllReductions ( void )
+            {
+               // As in the regions domain, there is no reduction finalizer: task reductions are rejected at submission
+            }
+
+            bool haveDependencePendantWrites ( void *addr )
+            {
+               SharedAccess lock1( *this );
+               StatusQuery statuses( _intervalMap, (uintptr_t) addr, (uintptr_t) addr + 1 );
+               for ( StatusQuery::iterator it = statuses.begin(); it != statuses.end(); it++ ) {
+                  TrackableObject &status = **it;
+                  if ( status.getLastWriter() != NULL ) return true;
+               }
+               return false;
+            }
+      };
+
+      __thread IntervalDependenciesDomain * IntervalDependenciesDomain::_owner = NULL;
+      int IntervalDependenciesDomain::_maxRows = 32;
+
+      template void IntervalDependenciesDomain::submitDependableObjectInternal ( DependableObject &depObj, DataAccess* begin, DataAccess* end, SchedulePolicySuccessorFunctor* callback );
+      template void IntervalDependenciesDomain::submitDependableObjectInternal ( DependableObject &depObj, std::vector<DataAccess>::iterator begin, std::vector<DataAccess>::iterator end, SchedulePolicySuccessorFunctor* callback );
+
+      class IntervalDependenciesManager : public DependenciesManager
+      {
+         public:
+            IntervalDependenciesManager() : DependenciesManager("Nanos interval regions dependencies domain") {}
+            virtual ~IntervalDependenciesManager () {}
+
+            /*! \brief Creates an interval dependencies domain.
+             */
+            DependenciesDomain* createDependenciesDomain () const
+            {
+               return NEW IntervalDependenciesDomain();
+            }
+      };
+
+      class IntervalDepsPlugin : public Plugin
+      {
+
+         public:
+            IntervalDepsPlugin() : Plugin( "Nanos++ interval tree regions dependency management plugin",1 )
+            {
+            }
+
+            virtual void config ( Config &cfg )
+            {
+               cfg.setOptionsSection( "Interval deps", "Interval tree regions dependencies plugin" );
+               cfg.registerConfigOption( "deps-max-rows", NEW Config::PositiveVar( IntervalDependenciesDomain::_maxRows ),
+                                         "Largest number of contiguous rows a multidimensional dependence is split into, "
+                                         "bigger ones are tracked as their bounding interval" );
+               cfg.registerArgOption( "deps-max-rows", "deps-max-rows" );
+               cfg.registerEnvOption( "deps-max-rows", "NX_DEPS_MAX_ROWS" );
+            }
+
+            virtual void init()
+            {
+               sys.setDependenciesManager(NEW IntervalDependenciesManager());
+            }
+      };
+
+   }
+}
+
+DECLARE_PLUGIN("deps-intervals",nanos::ext::IntervalDepsPlugin);
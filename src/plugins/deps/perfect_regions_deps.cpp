@@ -151,7 +151,7 @@ namespace nanos {
                   fatal( "Task cannot be concurrent AND commutative" );
                }
                
-               SyncRecursiveLockBlock lock1( getInstanceLock() );
+               InstanceLockBlock lock1( getInstanceLock() );
                //typedef std::set<RegionMap::iterator> subregion_set_t;
                typedef RegionMap::iterator_list_t subregion_set_t;
                subregion_set_t subregions;
@@ -212,7 +212,7 @@ namespace nanos {
             {
                const Region& region( dynamic_cast<const Region&>( target ) );
                
-               SyncRecursiveLockBlock lock1( getInstanceLock() );
+               InstanceLockBlock lock1( getInstanceLock() );
                RegionMap::iterator_list_t subregions;
                _regionMap.find( region, /* out */subregions );
                
@@ -237,7 +237,7 @@ namespace nanos {
             {
                const Region& region( dynamic_cast<const Region&>( target ) );
             
-               SyncRecursiveLockBlock lock1( getInstanceLock() );
+               InstanceLockBlock lock1( getInstanceLock() );
                RegionMap::iterator_list_t subregions;
                _regionMap.find( region, /* out */subregions );
                
@@ -264,7 +264,7 @@ namespace nanos {
             {
                const Region& region( dynamic_cast<const Region&>( target ) );
                
-               SyncRecursiveLockBlock lock1( getInstanceLock() );
+               InstanceLockBlock lock1( getInstanceLock() );
                RegionMap::iterator_list_t subregions;
                _regionMap.find( region, /* out */subregions );
                
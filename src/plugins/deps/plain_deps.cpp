@@ -59,7 +59,7 @@ namespace nanos {
                    {
                       // Lock this so we avoid problems when concurrently calling deleteLastWriter
                       // due this function will also chase also the map
-                      SyncRecursiveLockBlock lock1( getInstanceLock() );
+                      InstanceLockBlock lock1( getInstanceLock() );
                       _addressDependencyMap.insert( std::make_pair( target(), status ) );
                    }
                } else {
@@ -153,7 +153,7 @@ namespace nanos {
             inline void deleteLastWriter ( DependableObject &depObj, BaseDependency const &target )
             {
                const Address& address( static_cast<const Address&>( target ) );
-               SyncRecursiveLockBlock lock1( getInstanceLock() );
+               InstanceLockBlock lock1( getInstanceLock() );
                DepsMap::iterator it = _addressDependencyMap.find( address() );
                
                if ( it != _addressDependencyMap.end() ) {
@@ -167,7 +167,7 @@ namespace nanos {
             inline void deleteReader ( DependableObject &depObj, BaseDependency const &target )
             {
                const Address& address( static_cast<const Address&>( target ) );
-               SyncRecursiveLockBlock lock1( getInstanceLock() );
+               InstanceLockBlock lock1( getInstanceLock() );
                DepsMap::iterator it = _addressDependencyMap.find( address() );
                
                if ( it != _addressDependencyMap.end() ) {
@@ -183,7 +183,7 @@ namespace nanos {
             inline void removeCommDO ( CommutationDO *commDO, BaseDependency const &target )
             {
                const Address& address( static_cast<const Address&>( target ) );
-               SyncRecursiveLockBlock lock1( getInstanceLock() );
+               InstanceLockBlock lock1( getInstanceLock() );
                DepsMap::iterator it = _addressDependencyMap.find( address() );
                
                if ( it != _addressDependencyMap.end() ) {
@@ -151,7 +151,7 @@ namespace nanos {
                   fatal( "Task cannot be concurrent AND commutative" );
                }
                
-               SyncRecursiveLockBlock lock1( getInstanceLock() );
+               InstanceLockBlock lock1( getInstanceLock() );
                //typedef std::set<RegionMap::iterator> subregion_set_t;
                typedef RegionMap::iterator_list_t subregion_set_t;
                subregion_set_t subregions;
@@ -214,7 +214,7 @@ namespace nanos {
             {
                const Region& region( dynamic_cast<const Region&>( target ) );
                
-               SyncRecursiveLockBlock lock1( getInstanceLock() );
+               InstanceLockBlock lock1( getInstanceLock() );
                RegionMap::iterator_list_t subregions;
                _regionMap.find( region, /* out */subregions );
                
@@ -239,7 +239,7 @@ namespace nanos {
             {
                const Region& region( dynamic_cast<const Region&>( target ) );
             
-               SyncRecursiveLockBlock lock1( getInstanceLock() );
+               InstanceLockBlock lock1( getInstanceLock() );
                RegionMap::iterator_list_t subregions;
                _regionMap.find( region, /* out */subregions );
                
@@ -266,7 +266,7 @@ namespace nanos {
             {
                const Region& region( dynamic_cast<const Region&>( target ) );
                
-               SyncRecursiveLockBlock lock1( getInstanceLock() );
+               InstanceLockBlock lock1( getInstanceLock() );
                RegionMap::iterator_list_t subregions;
                _regionMap.find( region, /* out */subregions );
                
@@ -325,7 +325,7 @@ namespace nanos {
             
             bool haveDependencePendantWrites ( void *addr )
             {
-               SyncRecursiveLockBlock lock1( getInstanceLock() );                
+               InstanceLockBlock lock1( getInstanceLock() );                
                size_t additionalContribution = 0UL;               
                Region region = RegionBuilder::build( (size_t) addr, 1UL, 1, additionalContribution);
                
@@ -0,0 +1,395 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "basedependenciesdomain.hpp"
+#include "plugin.hpp"
+#include "system.hpp"
+#include "config.hpp"
+#include "address.hpp"
+#include "compatibility.hpp"
+#include "atomic.hpp"
+#include <algorithm>
+#include <alloca.h>
+#include <stdint.h>
+
+namespace nanos {
+   namespace ext {
+
+      /*! \brief Plain dependencies domain with the address map split in independently locked shards
+       *
+       *  The lock of a shard plays the role of the domain instance lock for the addresses in that shard.
+       *  A submission takes the locks of all the shards it touches, in increasing order, before
+       *  processing any access, so two submissions sharing addresses are ordered the same way in all of
+       *  them, and submissions touching disjoint shards proceed in parallel. Finishing objects take the
+       *  locks of their targets' shards (in the same order) before their own lock, so a submitter never
+       *  sees a last writer that is being released.
+       *
+       *  Shard locks are recursive, like the instance lock of the plain domain: releasing an object while
+       *  a shard is held (e.g. a finished commutation object when its reduction is finalized) takes the
+       *  lock of its target's shard again, and that shard is always one already held by the thread.
+       */
+      class ShardedDependenciesDomain : public BaseDependenciesDomain
+      {
+         private:
+            typedef TR1::unordered_map<Address::TargetType, TrackableObject*> DepsMap; /**< Maps addresses to Trackable objects */
+            typedef LatencyLockBlock<SyncRecursiveLockBlock, RecursiveLock, LatencyStats::DEPS_LOCK_WAIT> ShardLockBlock;
+
+            struct Shard {
+               RecursiveLock _lock;      /**< Protects _map and serializes the accesses to its addresses */
+               DepsMap       _map;       /**< Used to track dependencies between DependableObject */
+               char          _pad[NANOS_CACHELINE - ( ( sizeof(RecursiveLock) + sizeof(DepsMap) ) % NANOS_CACHELINE )];
+
+               Shard () : _lock(), _map() {}
+            };
+
+         public:
+            static int              _numShards;   /**< Number of shards per domain (power of 2) */
+         private:
+            Shard * volatile        _shards;      /**< Shards, allocated at the first submission with dependences */
+
+         private:
+            ShardedDependenciesDomain ( const ShardedDependenciesDomain &depDomain );
+            const ShardedDependenciesDomain & operator= ( const ShardedDependenciesDomain &depDomain );
+
+            unsigned int getShardIndex ( Address::TargetType target ) const
+            {
+               uintptr_t addr = (uintptr_t) target;
+               return ( ( addr >> 3 ) ^ ( addr >> 12 ) ) & ( _numShards - 1 );
+            }
+
+            Shard * getShards ( void )
+            {
+               if ( _shards == NULL ) {
+                  Shard *shards = NEW Shard[_numShards];
+                  if ( !compareAndSwap( &_shards, (Shard *) NULL, shards ) ) delete[] shards;
+               }
+               return _shards;
+            }
+
+            //! \brief Clear current dependencies domain
+            //!
+            //! This function should be called withing a thread safe area. It is, when other
+            //! tasks can not update the domain: after a taskwait and before any task submission.
+            void clearDependenciesDomain ( void )
+            {
+               if ( _shards == NULL ) return;
+               for ( int i = 0; i < _numShards; i++ ) {
+                  _shards[i]._map.clear();
+               }
+            }
+
+            //! \brief Collects the sorted, unique shard indices of the given addresses
+            //! \return Number of indices written in shardIds
+            template<typename iterator>
+            size_t getShardIndices ( iterator begin, iterator end, unsigned int *shardIds ) const
+            {
+               size_t numShards = 0;
+               for ( iterator it = begin; it != end; it++ ) {
+                  Address::TargetType target = getTarget( *it );
+                  if ( target != NULL ) shardIds[numShards++] = getShardIndex( target );
+               }
+               std::sort( shardIds, shardIds + numShards );
+               return std::unique( shardIds, shardIds + numShards ) - shardIds;
+            }
+
+            static Address::TargetType getTarget ( DataAccess const &dep ) { return dep.getDepAddress(); }
+            static Address::TargetType getTarget ( BaseDependency const *dep ) { return (*static_cast<const Address *>( dep ))(); }
+
+            //! \brief Looks for the dependency's address, returns the trackableObject associated
+            //! \param shard Shard of the address, its lock must be held by the caller.
+            //! \sa Dependency TrackableObject
+            TrackableObject* lookupDependency ( Shard &shard, const Address& target )
+            {
+               DepsMap::iterator it = shard._map.find( target() );
+               if ( it != shard._map.end() ) return it->second;
+
+               TrackableObject *status = NEW TrackableObject();
+               shard._map.insert( std::make_pair( target(), status ) );
+               return status;
+            }
+
+            //! \brief Looks for an already tracked address, NULL otherwise
+            //! \param shard Shard of the address, its lock must be held by the caller.
+            TrackableObject* findDependency ( Shard &shard, const Address& target )
+            {
+               DepsMap::iterator it = shard._map.find( target() );
+               return it != shard._map.end() ? it->second : NULL;
+            }
+
+         protected:
+            //! \brief Assigns the DependableObject depObj an id in this domain and adds it to the domains dependency system.
+            //! \param depObj DependableObject to be added to the domain.
+            //! \param begin Iterator to the start of the list of dependencies to be associated to the Dependable Object.
+            //! \param end Iterator to the end of the mentioned list.
+            //! \param callback A function to call when a WD has a successor [Optional].
+            //! \sa Dependency DependableObject TrackableObject
+            template<typename iterator>
+            void submitDependableObjectInternal ( DependableObject &depObj, iterator begin, iterator end,
+                                                  SchedulePolicySuccessorFunctor* callback )
+            {
+               // Initializing several properties of the depObject
+               depObj.setId ( _lastDepObjId++ );
+               depObj.init();
+               depObj.setDependenciesDomain( this );
+
+               // Object is not ready to get its dependencies satisfied, so we increase the
+               // number of predecessors to permit other dependableObjects to free some of
+               // its dependencies without triggering the "dependenciesSatisfied" method.
+               depObj.increasePredecessors();
+
+               // flushDeps will be needed for waiting (see decreasePredecessors)
+               std::list<uint64_t> flushDeps;
+
+               // Collect the shards touched by this object, they are locked in increasing order
+               size_t numDeps = 0;
+               for ( iterator it = begin; it != end; it++ ) numDeps++;
+               unsigned int *shardIds = (unsigned int *) alloca( sizeof(unsigned int) * ( numDeps + 1 ) );
+               size_t numShards = getShardIndices( begin, end, shardIds );
+
+               Shard *shards = numShards > 0 ? getShards() : NULL;
+               uint64_t lockTime = LatencyStats::start();
+               for ( size_t i = 0; i < numShards; i++ ) shards[shardIds[i]]._lock.acquire();
+               lockTime = LatencyStats::stop( LatencyStats::DEPS_LOCK_WAIT, lockTime );
+
+               // Iterate from begin to end, just to handle each data access
+               for ( iterator it = begin; it != end; it++ ) {
+                  DataAccess &dep = (*it);
+                  Address target = dep.getDepAddress();
+
+                  // if address == NULL, just ignore it
+                  if ( target() == NULL ) continue;
+                  AccessType const &accessType = dep.flags;
+
+                  submitDependableObjectDataAccess( depObj, shards[getShardIndex( target() )], target, accessType, callback );
+                  flushDeps.push_back( (uint64_t) target() );
+               }
+
+               LatencyStats::stop( LatencyStats::DEPS_LOCK_HOLD, lockTime );
+               for ( size_t i = numShards; i > 0; i-- ) shards[shardIds[i-1]]._lock.release();
+
+               // Calling scheduler policy "atCreate"
+               sys.getDefaultSchedulePolicy()->atCreate( depObj );
+
+               // To Task In Graph count consistent before releasing the fake dependency
+               increaseTasksInGraph();
+
+               depObj.submitted();
+
+               // Now everything is ready, release fake dependency
+               depObj.decreasePredecessors( &flushDeps, NULL, false, true );
+            }
+
+            //! \brief Adds a region access of a DependableObject to the domains dependency system.
+            //! \param depObj target DependableObject
+            //! \param shard Shard of the address, locked by the caller
+            //! \param target accessed memory address
+            //! \param accessType kind of region access
+            //! \param callback Function to call if an immediate predecessor is found.
+            void submitDependableObjectDataAccess( DependableObject &depObj, Shard &shard, Address const &target,
+                                                   AccessType const &accessType, SchedulePolicySuccessorFunctor* callback )
+            {
+
+               ensure(!(accessType.concurrent && accessType.commutative),"Task cannot be concurrent AND commutative");
+
+               TrackableObject &status = *lookupDependency( shard, target );
+
+               if ( status.getLastWriter() == &depObj ) return;
+
+               if ( accessType.concurrent || accessType.commutative ) {
+                  ensure(accessType.input && accessType.output,"Commutative & concurrent must be inout");
+                  ensure(!depObj.waits(), "Commutative & concurrent should not wait" );
+                  submitDependableObjectCommutativeDataAccess( depObj, target, accessType, status, callback );
+               } else if ( accessType.output ) {
+                  if ( accessType.input ) submitDependableObjectInoutDataAccess( depObj, target, accessType, status, callback );
+                  else submitDependableObjectOutputDataAccess( depObj, target, accessType, status, callback );
+                  if ( !depObj.waits() ) depObj.addWriteTarget( target );
+               } else if ( accessType.input ) {
+                  if ( accessType.output ) submitDependableObjectInoutDataAccess( depObj, target, accessType, status, callback );
+                  else submitDependableObjectInputDataAccess( depObj, target, accessType, status, callback );
+                  if ( !depObj.waits() ) depObj.addReadTarget( target );
+               } else {
+                  fatal( "Invalid data access" );
+               }
+
+            }
+
+            //! \pre The lock of the target's shard is held by the caller
+            inline void deleteLastWriter ( DependableObject &depObj, BaseDependency const &target )
+            {
+               const Address& address( static_cast<const Address&>( target ) );
+               TrackableObject *status = findDependency( _shards[getShardIndex( address() )], address );
+               if ( status != NULL ) status->deleteLastWriter( depObj );
+            }
+
+            inline void deleteReader ( DependableObject &depObj, BaseDependency const &target )
+            {
+               const Address& address( static_cast<const Address&>( target ) );
+               if ( _shards == NULL ) return;
+               Shard &shard = _shards[getShardIndex( address() )];
+
+               ShardLockBlock lock1( shard._lock );
+               TrackableObject *status = findDependency( shard, address );
+               if ( status != NULL ) {
+                  SyncLockBlock lock2( status->getReadersLock() );
+                  status->deleteReader( depObj );
+               }
+            }
+
+            inline void removeCommDO ( CommutationDO *commDO, BaseDependency const &target )
+            {
+               const Address& address( static_cast<const Address&>( target ) );
+               if ( _shards == NULL ) return;
+               Shard &shard = _shards[getShardIndex( address() )];
+
+               ShardLockBlock lock1( shard._lock );
+               TrackableObject *status = findDependency( shard, address );
+               if ( status != NULL && status->getCommDO() == commDO ) {
+                  status->setCommDO( 0 );
+               }
+            }
+
+         public:
+            ShardedDependenciesDomain() : BaseDependenciesDomain(), _shards( NULL ) {}
+
+            ~ShardedDependenciesDomain()
+            {
+               if ( _shards == NULL ) return;
+               for ( int i = 0; i < _numShards; i++ ) {
+                  DepsMap &map = _shards[i]._map;
+                  for ( DepsMap::iterator it = map.begin(); it != map.end(); it++ ) {
+                     delete it->second;
+                  }
+               }
+               delete[] _shards;
+            }
+
+            //! \brief Takes the locks of the targets' shards instead of the domain wide lock
+            void deleteLastWriters ( DependableObject &depObj, std::vector<BaseDependency *> const &targets )
+            {
+               if ( _shards == NULL ) return;
+
+               unsigned int *shardIds = (unsigned int *) alloca( sizeof(unsigned int) * ( targets.size() + 1 ) );
+               size_t numShards = getShardIndices( targets.begin(), targets.end(), shardIds );
+
+               uint64_t lockTime = LatencyStats::start();
+               for ( size_t i = 0; i < numShards; i++ ) _shards[shardIds[i]]._lock.acquire();
+               lockTime = LatencyStats::stop( LatencyStats::DEPS_LOCK_WAIT, lockTime );
+               {
+                  SyncLockBlock lock( depObj.getLock() );
+                  for ( unsigned int i = 0; i < targets.size(); i++ ) {
+                     deleteLastWriter ( depObj, *targets[i] );
+                  }
+               }
+               LatencyStats::stop( LatencyStats::DEPS_LOCK_HOLD, lockTime );
+               for ( size_t i = numShards; i > 0; i-- ) _shards[shardIds[i-1]]._lock.release();
+            }
+
+            /*!
+             *  \note This function cannot be implemented in
+             *  BaseDependenciesDomain since it calls a template function,
+             *  and they cannot be virtual.
+             */
+            inline void submitDependableObject ( DependableObject &depObj, std::vector<DataAccess> &deps, SchedulePolicySuccessorFunctor* callback )
+            {
+               submitDependableObjectInternal ( depObj, deps.begin(), deps.end(), callback );
+            }
+
+            /*!
+             *  \note This function cannot be implemented in
+             *  BaseDependenciesDomain since it calls a template function,
+             *  and they cannot be virtual.
+             */
+            inline void submitDependableObject ( DependableObject &depObj, size_t numDeps, DataAccess* deps, SchedulePolicySuccessorFunctor* callback )
+            {
+               submitDependableObjectInternal ( depObj, deps, deps+numDeps, callback );
+            }
+
+            bool haveDependencePendantWrites ( void *addr )
+            {
+               if ( _shards == NULL ) return false;
+               Shard &shard = _shards[getShardIndex( addr )];
+
+               ShardLockBlock lock( shard._lock );
+               TrackableObject *status = findDependency( shard, Address( addr ) );
+               return status != NULL && status->getLastWriter() != NULL;
+            }
+
+            void finalizeAllReductions ( void )
+            {
+               if ( _shards == NULL ) return;
+               for ( int i = 0; i < _numShards; i++ ) {
+                  SyncRecursiveLockBlock lock( _shards[i]._lock );
+                  DepsMap &map = _shards[i]._map;
+                  for ( DepsMap::iterator it = map.begin(); it != map.end(); it++ ) {
+                     finalizeReduction( *( it->second ), Address( it->first ) );
+                  }
+               }
+            }
+      };
+
+      int ShardedDependenciesDomain::_numShards = 64;
+
+      template void ShardedDependenciesDomain::submitDependableObjectInternal ( DependableObject &depObj, DataAccess* begin, DataAccess* end, SchedulePolicySuccessorFunctor* callback );
+      template void ShardedDependenciesDomain::submitDependableObjectInternal ( DependableObject &depObj, std::vector<DataAccess>::iterator begin, std::vector<DataAccess>::iterator end, SchedulePolicySuccessorFunctor* callback );
+
+      class ShardedDependenciesManager : public DependenciesManager
+      {
+         public:
+            ShardedDependenciesManager() : DependenciesManager("Nanos sharded plain dependencies domain") {}
+            virtual ~ShardedDependenciesManager () {}
+
+            /*! \brief Creates a sharded dependencies domain.
+             */
+            DependenciesDomain* createDependenciesDomain () const
+            {
+               return NEW ShardedDependenciesDomain();
+            }
+      };
+
+      class NanosDepsPlugin : public Plugin
+      {
+            
+         public:
+            NanosDepsPlugin() : Plugin( "Nanos++ sharded plain dependencies management plugin",1 )
+            {
+            }
+
+            virtual void config ( Config &cfg )
+            {
+               cfg.setOptionsSection( "Sharded deps", "Sharded plain dependencies plugin" );
+               cfg.registerConfigOption( "deps-shards", NEW Config::PositiveVar( ShardedDependenciesDomain::_numShards ),
+                                         "Number of independently locked address map shards per domain (rounded up to a power of 2)" );
+               cfg.registerArgOption( "deps-shards", "deps-shards" );
+               cfg.registerEnvOption( "deps-shards", "NX_DEPS_SHARDS" );
+            }
+
+            virtual void init()
+            {
+               int shards = 1;
+               while ( shards < ShardedDependenciesDomain::_numShards ) shards <<= 1;
+               ShardedDependenciesDomain::_numShards = shards;
+
+               sys.setDependenciesManager(NEW ShardedDependenciesManager());
+            }
+      };
+
+   }
+}
+
+DECLARE_PLUGIN("deps-sharded",nanos::ext::NanosDepsPlugin);
@@ -0,0 +1,342 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "plugin.hpp"
+#include "system.hpp"
+#include "instrumentation.hpp"
+#include "instrumentationcontext_decl.hpp"
+#include "lock.hpp"
+#include "binary_trace_format.hpp"
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+namespace nanos {
+
+using namespace bintrace;
+
+class InstrumentationBinaryTrace: public Instrumentation 
+{
+#ifndef NANOS_INSTRUMENTATION_ENABLED
+   public:
+      // constructor
+      InstrumentationBinaryTrace() : Instrumentation() {}
+      // destructor
+      ~InstrumentationBinaryTrace() {}
+
+      // low-level instrumentation interface (mandatory functions)
+      void initialize( void ) {}
+      void finalize( void ) {}
+      void disable( void ) {}
+      void enable( void ) {}
+      void addResumeTask( WorkDescriptor &w ) {}
+      void addSuspendTask( WorkDescriptor &w, bool last ) {}
+      void addEventList ( unsigned int count, Event *events ) {}
+      void threadStart( BaseThread &thread ) {}
+      void threadFinish ( BaseThread &thread ) {}
+#else
+   private:
+      /*! Ring of records of one thread. Only the owner thread writes into it,
+       *  so storing a record needs neither locks nor atomic operations.
+       */
+      struct ThreadBuffer {
+         FileHeader    *_header;
+         Record        *_records;
+         uint64_t       _mask;
+         uint64_t       _head;
+      };
+
+      std::string                 _prefix;      /**< Path and name of every trace file, without extension */
+      Lock                        _lock;        /**< Protects _files */
+      std::vector<std::string>    _files;       /**< Buffer files created so far */
+      uint64_t                    _startClock;  /**< Calibration points taken at initialize */
+      uint64_t                    _startNs;
+
+      static __thread ThreadBuffer *_buffer;
+
+   public:
+      static std::string          _traceDir;
+      static std::string          _traceName;
+      static size_t               _bufferSize;  /**< Bytes of ring per thread */
+
+   private:
+      /*! \brief Raw timestamp: the time stamp counter where available
+       *
+       *  The converter maps it to nanoseconds with the calibration points of
+       *  the index, so the counter must be invariant and synchronized among
+       *  cpus (true on any x86 of the last decade).
+       */
+      static inline uint64_t readClock ( void )
+      {
+#if defined(__x86_64__) || defined(__i386__)
+         uint32_t lo, hi;
+         __asm__ __volatile__ ( "rdtsc" : "=a" (lo), "=d" (hi) );
+         return ( (uint64_t) hi << 32 ) | lo;
+#else
+         return readNs();
+#endif
+      }
+
+      static uint64_t readNs ( void )
+      {
+         struct timespec ts;
+         clock_gettime( CLOCK_MONOTONIC, &ts );
+         return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+      }
+
+      ThreadBuffer * createBuffer ( void )
+      {
+         uint64_t capacity = 1;
+         while ( ( capacity * 2 ) * sizeof(Record) <= _bufferSize ) capacity *= 2;
+         size_t length = BINTRACE_HEADER_SIZE + capacity * sizeof(Record);
+
+         std::string file;
+         {
+            LockBlock lock( _lock );
+            std::ostringstream name;
+            name << _prefix << "." << _files.size() << ".bin";
+            file = name.str();
+            _files.push_back( file );
+         }
+
+         int fd = open( file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+         fatal_cond0( fd < 0, "Binary trace: cannot create " << file );
+         fatal_cond0( ftruncate( fd, length ) != 0, "Binary trace: cannot resize " << file );
+         void *map = mmap( NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+         close( fd );
+         fatal_cond0( map == MAP_FAILED, "Binary trace: cannot map " << file );
+
+         ThreadBuffer *buffer = NEW ThreadBuffer();
+         buffer->_header = (FileHeader *) map;
+         buffer->_records = (Record *) ( (char *) map + BINTRACE_HEADER_SIZE );
+         buffer->_mask = capacity - 1;
+         buffer->_head = 0;
+
+         FileHeader *header = buffer->_header;
+         header->magic = BINTRACE_MAGIC;
+         header->version = BINTRACE_VERSION;
+         header->threadId = myThread != NULL ? myThread->getId() : -1;
+         header->cpuId = myThread != NULL ? myThread->getCpuId() : -1;
+         header->recordSize = sizeof(Record);
+         header->pad = 0;
+         header->capacity = capacity;
+         header->written = 0;
+
+         return buffer;
+      }
+
+      inline ThreadBuffer & getBuffer ( void )
+      {
+         if ( _buffer == NULL ) _buffer = createBuffer();
+         return *_buffer;
+      }
+
+      inline void store ( ThreadBuffer &buffer, uint64_t time, uint16_t type, uint32_t key, uint64_t value,
+                          uint16_t domain = 0, int64_t id = 0 )
+      {
+         Record &r = buffer._records[ buffer._head++ & buffer._mask ];
+         r.time = time;
+         r.value = value;
+         r.id = id;
+         r.key = key;
+         r.type = type;
+         r.domain = domain;
+      }
+
+      inline void publish ( ThreadBuffer &buffer )
+      {
+         // Records are complete before the converter can see them counted
+#if defined(__x86_64__) || defined(__i386__)
+         __asm__ __volatile__ ( "" ::: "memory" );
+#else
+         memoryFence();
+#endif
+         buffer._header->written = buffer._head;
+      }
+
+   public:
+      // constructor
+      InstrumentationBinaryTrace() : Instrumentation( *NEW InstrumentationContextDisabled() ), _prefix(), _lock(),
+                                     _files(), _startClock( 0 ), _startNs( 0 ) {}
+      // destructor
+      ~InstrumentationBinaryTrace() {}
+
+      // low-level instrumentation interface (mandatory functions)
+      void initialize( void )
+      {
+         std::ostringstream prefix;
+         prefix << _traceDir << "/" << _traceName << "." << getpid();
+         _prefix = prefix.str();
+
+         _startNs = readNs();
+         _startClock = readClock();
+      }
+
+      void finalize( void )
+      {
+         uint64_t endClock = readClock();
+         uint64_t endNs = readNs();
+
+         std::string index = _prefix + ".idx";
+         std::ofstream out( index.c_str() );
+         if ( !out.good() ) {
+            warning0( "Binary trace: cannot write " << index );
+            return;
+         }
+
+         out << "nanox-bintrace " << BINTRACE_VERSION << std::endl;
+         out << "clock " << _startClock << " " << _startNs << std::endl;
+         out << "clock " << endClock << " " << endNs << std::endl;
+         {
+            LockBlock lock( _lock );
+            for ( unsigned int i = 0; i < _files.size(); i++ ) {
+               // Files are listed relative to the index
+               out << "thread " << _files[i].substr( _files[i].find_last_of( '/' ) + 1 ) << std::endl;
+            }
+         }
+
+         InstrumentationDictionary *iD = getInstrumentationDictionary();
+         InstrumentationDictionary::ConstKeyMapIterator itK;
+         for ( itK = iD->beginKeyMap(); itK != iD->endKeyMap(); itK++ ) {
+            InstrumentationKeyDescriptor *kD = itK->second;
+            out << "key " << kD->getId() << " " << ( kD->isStacked() ? 1 : 0 ) << " " << itK->first << " "
+                << kD->getDescription() << std::endl;
+            InstrumentationKeyDescriptor::ConstValueMapIterator itV;
+            for ( itV = kD->beginValueMap(); itV != kD->endValueMap(); itV++ ) {
+               InstrumentationValueDescriptor *vD = itV->second;
+               out << "value " << kD->getId() << " " << vD->getId() << " " << vD->getDescription() << std::endl;
+            }
+         }
+         out.close();
+
+         message0( "Binary trace written to " << index << ", convert it with nanox-bintrace2prv" );
+      }
+
+      void disable( void ) {}
+      void enable( void ) {}
+
+      void addResumeTask( WorkDescriptor &w )
+      {
+         ThreadBuffer &buffer = getBuffer();
+         store( buffer, readClock(), RECORD_RESUME_TASK, 0, w.getId() );
+         publish( buffer );
+      }
+
+      void addSuspendTask( WorkDescriptor &w, bool last )
+      {
+         ThreadBuffer &buffer = getBuffer();
+         store( buffer, readClock(), RECORD_SUSPEND_TASK, 0, w.getId() );
+         publish( buffer );
+      }
+
+      void addEventList ( unsigned int count, Event *events )
+      {
+         ThreadBuffer &buffer = getBuffer();
+         // Events of the same list happen at the same time
+         uint64_t time = readClock();
+
+         for ( unsigned int i = 0; i < count; i++ ) {
+            Event &e = events[i];
+            nanos_event_type_t type = e.getType();
+            switch ( type ) {
+               case NANOS_STATE_START:
+               case NANOS_SUBSTATE_START:
+                  store( buffer, time, type, 0, e.getState() );
+                  break;
+               case NANOS_STATE_END:
+               case NANOS_SUBSTATE_END:
+                  store( buffer, time, type, 0, 0 );
+                  break;
+               case NANOS_PTP_START:
+               case NANOS_PTP_END:
+                  store( buffer, time, type, e.getKey(), e.getValue(), e.getDomain(), e.getId() );
+                  break;
+               case NANOS_POINT:
+               case NANOS_BURST_START:
+               case NANOS_BURST_END:
+                  if ( e.getKey() == 0 ) continue;
+                  store( buffer, time, type, e.getKey(), e.getValue() );
+                  break;
+               default:
+                  break;
+            }
+         }
+         publish( buffer );
+      }
+
+      void threadStart( BaseThread &thread )
+      {
+         // Creates the buffer early, while the thread knows its ids
+         getBuffer();
+      }
+      void threadFinish ( BaseThread &thread ) {}
+#endif
+
+};
+
+#ifdef NANOS_INSTRUMENTATION_ENABLED
+__thread InstrumentationBinaryTrace::ThreadBuffer *InstrumentationBinaryTrace::_buffer = NULL;
+std::string InstrumentationBinaryTrace::_traceDir = ".";
+std::string InstrumentationBinaryTrace::_traceName = "nanox-trace";
+size_t InstrumentationBinaryTrace::_bufferSize = 64 * 1024 * 1024;
+#endif
+
+namespace ext {
+
+class InstrumentationBinaryTracePlugin : public Plugin {
+   public:
+      InstrumentationBinaryTracePlugin () : Plugin("Instrumentation which writes a binary trace through per-thread mmap'd buffers.",1) {}
+      ~InstrumentationBinaryTracePlugin () {}
+
+      void config( Config &cfg )
+      {
+#ifdef NANOS_INSTRUMENTATION_ENABLED
+         cfg.setOptionsSection( "Binary trace", "Binary trace instrumentation plugin options" );
+
+         cfg.registerConfigOption( "binary-trace-dir", NEW Config::StringVar( InstrumentationBinaryTrace::_traceDir ),
+                                   "Directory where the trace files are written (default: current directory)" );
+         cfg.registerArgOption( "binary-trace-dir", "binary-trace-dir" );
+         cfg.registerEnvOption( "binary-trace-dir", "NX_BINARY_TRACE_DIR" );
+
+         cfg.registerConfigOption( "binary-trace-name", NEW Config::StringVar( InstrumentationBinaryTrace::_traceName ),
+                                   "Name of the trace files, the process id is appended (default: nanox-trace)" );
+         cfg.registerArgOption( "binary-trace-name", "binary-trace-name" );
+
+         cfg.registerConfigOption( "binary-trace-buffer-size", NEW Config::SizeVar( InstrumentationBinaryTrace::_bufferSize ),
+                                   "Size of the ring buffer of every thread, the oldest events are overwritten when it fills up (default: 64M)" );
+         cfg.registerArgOption( "binary-trace-buffer-size", "binary-trace-buffer-size" );
+#endif
+      }
+
+      void init ()
+      {
+         sys.setInstrumentation( NEW InstrumentationBinaryTrace() );
+      }
+};
+
+} // namespace ext
+
+} // namespace nanos
+
+DECLARE_PLUGIN("instrumentation-binary_trace",nanos::ext::InstrumentationBinaryTracePlugin);
@@ -0,0 +1,77 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_BINARY_TRACE_FORMAT
+#define _NANOS_BINARY_TRACE_FORMAT
+
+#include <stdint.h>
+
+/*! \file binary_trace_format.hpp
+ *  \brief On-disk layout shared by the binary_trace plugin and nanox-bintrace2prv
+ *
+ *  A trace is a directory holding one buffer file per thread and a text index.
+ *  Every buffer file starts with a FileHeader (padded to BINTRACE_HEADER_SIZE)
+ *  followed by a ring of 'capacity' Records. 'written' counts every record ever
+ *  stored: when it is bigger than 'capacity' the oldest records have been
+ *  overwritten and the valid ones start at written % capacity.
+ *
+ *  The index ("<name>.idx") lists the buffer files, the clock calibration
+ *  points and the event dictionary:
+ *
+ *     nanox-bintrace <version>
+ *     clock <tsc> <ns>                     (one line at start, one at end)
+ *     thread <file>
+ *     key <key-id> <stacked> <name> <description>
+ *     value <key-id> <value-id> <description>
+ */
+
+namespace nanos {
+namespace bintrace {
+
+const uint32_t BINTRACE_MAGIC       = 0x4E584254; /* "NXBT" */
+const uint32_t BINTRACE_VERSION     = 1;
+const uint32_t BINTRACE_HEADER_SIZE = 4096;       /* Records start page aligned */
+
+/* Record types: the nanos_event_type_t values plus the task switch ones */
+enum RecordType { RECORD_RESUME_TASK = 64, RECORD_SUSPEND_TASK = 65 };
+
+struct FileHeader {
+   uint32_t             magic;
+   uint32_t             version;
+   int32_t              threadId;     /**< Nanos++ thread id, -1 if unknown */
+   int32_t              cpuId;        /**< Cpu the thread was bound to, -1 if unknown */
+   uint32_t             recordSize;   /**< sizeof(Record) */
+   uint32_t             pad;
+   uint64_t             capacity;     /**< Ring size in records, a power of two */
+   volatile uint64_t    written;      /**< Records stored so far */
+};
+
+struct Record {
+   uint64_t             time;         /**< Raw timestamp (see the clock lines of the index) */
+   uint64_t             value;        /**< Event value, state or task id */
+   int64_t              id;           /**< PtP id */
+   uint32_t             key;          /**< Event key */
+   uint16_t             type;         /**< nanos_event_type_t or RecordType */
+   uint16_t             domain;       /**< PtP domain */
+};
+
+} // namespace bintrace
+} // namespace nanos
+
+#endif
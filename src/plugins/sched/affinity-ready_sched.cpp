@@ -170,19 +170,20 @@ namespace nanos {
 
             };
 
+            template <class PQ>
             struct SchedQueuesWDPQ : public SchedQueues
             {
-               WDPriorityQueue<>   _globalReadyQueue;
-               WDPriorityQueue<> * _readyQueues;
+               PQ     _globalReadyQueue;
+               PQ   * _readyQueues;
 
 #ifdef EXTRA_QUEUE_DEBUG
                PE     ** _pes;
 #endif
 
                public:
-                  SchedQueuesWDPQ( int memSpaces ) : SchedQueues(), _globalReadyQueue( /* optimise option */ true )
+                  SchedQueuesWDPQ( int memSpaces ) : SchedQueues(), _globalReadyQueue()
                   {
-                     _readyQueues = NEW WDPriorityQueue<>[memSpaces];
+                     _readyQueues = NEW PQ[memSpaces];
 
 #ifdef EXTRA_QUEUE_DEBUG
                      _pes = NEW PE*[memSpaces];
@@ -244,27 +245,27 @@ namespace nanos {
 
                      WD * wd = NULL;
 
-                     if ( ( wd = _readyQueues[memId].popFrontWithConstraints< NoCopy > ( thread ) ) != NULL ) {
+                     if ( ( wd = _readyQueues[memId].template popFrontWithConstraints< NoCopy > ( thread ) ) != NULL ) {
                         NANOS_INSTRUMENT(static nanos_event_value_t val = NOCOPY;)
                         NANOS_INSTRUMENT(sys.getInstrumentation()->raisePointEvents( 1, &key, &val );)
                         return wd;
                      }
 
                      if ( !_noInvalAware ) {
-                        if ( ( wd = _readyQueues[memId].popFrontWithConstraints< And < WouldNotTriggerInvalidation, Not< NoCopy > > > ( thread ) ) != NULL ) {
+                        if ( ( wd = _readyQueues[memId].template popFrontWithConstraints< And < WouldNotTriggerInvalidation, Not< NoCopy > > > ( thread ) ) != NULL ) {
                            NANOS_INSTRUMENT(static nanos_event_value_t val = SICOPY;)
                            NANOS_INSTRUMENT(sys.getInstrumentation()->raisePointEvents( 1, &key, &val );)
                            return wd;
                         }
                      }
 
-                     if ( ( wd = _readyQueues[memId].popFrontWithConstraints< And < WouldNotRunOutOfMemory, NoCopy > >( thread ) ) != NULL ) {
+                     if ( ( wd = _readyQueues[memId].template popFrontWithConstraints< And < WouldNotRunOutOfMemory, NoCopy > >( thread ) ) != NULL ) {
                         NANOS_INSTRUMENT(static nanos_event_value_t val = NOCOPYNOOUTMEM;)
                         NANOS_INSTRUMENT(sys.getInstrumentation()->raisePointEvents( 1, &key, &val );)
                         return wd;
                      }
 
-                     if ( ( wd = _readyQueues[memId].popFrontWithConstraints< WouldNotRunOutOfMemory >( thread ) ) != NULL ) {
+                     if ( ( wd = _readyQueues[memId].template popFrontWithConstraints< WouldNotRunOutOfMemory >( thread ) ) != NULL ) {
                         NANOS_INSTRUMENT(static nanos_event_value_t val = SICOPYNOOUTMEM;)
                         NANOS_INSTRUMENT(sys.getInstrumentation()->raisePointEvents( 1, &key, &val );)
                         return wd;
@@ -300,7 +301,8 @@ namespace nanos {
                   // +1 to count the host memory space as well
                   _numMemSpaces = sys.getSeparateMemoryAddressSpacesCount() + 1;
 
-                  if ( _usePriority ) _queues = NEW SchedQueuesWDPQ( _numMemSpaces );
+                  if ( _usePriority && _useMultiQueue ) _queues = NEW SchedQueuesWDPQ<WDMultiPriorityQueue>( _numMemSpaces );
+                  else if ( _usePriority ) _queues = NEW SchedQueuesWDPQ< WDPriorityQueue<> >( _numMemSpaces );
                   else _queues = NEW SchedQueuesWDQ( _numMemSpaces );
 
                   if ( _numMemSpaces > 1 ) {
@@ -450,6 +452,7 @@ namespace nanos {
 
          public:
             static bool _usePriority;
+            static bool _useMultiQueue;
             // Depth propagation inside task graph
             // -1 means no depth limit
             //  0 means no propagation
@@ -962,6 +965,7 @@ namespace nanos {
       }
 
       bool ReadyCacheSchedPolicy::_usePriority = true;
+      bool ReadyCacheSchedPolicy::_useMultiQueue = false;
       int ReadyCacheSchedPolicy::_priorityPropagation = 5;
       bool ReadyCacheSchedPolicy::_noSteal = false;
       bool ReadyCacheSchedPolicy::_noInvalAware = false;
@@ -981,6 +985,9 @@ namespace nanos {
                cfg.registerConfigOption ( "affinity-priority", NEW Config::FlagOption( ReadyCacheSchedPolicy::_usePriority ), "Priority queue used as ready task queue");
                cfg.registerArgOption( "affinity-priority", "affinity-priority" );
 
+               cfg.registerConfigOption ( "affinity-priority-multiqueue", NEW Config::FlagOption( ReadyCacheSchedPolicy::_useMultiQueue ), "Relaxed concurrent multi-queue used as priority ready task queue");
+               cfg.registerArgOption( "affinity-priority-multiqueue", "affinity-priority-multiqueue" );
+
                cfg.registerConfigOption ( "affinity-priority-depth", NEW Config::IntegerVar( ReadyCacheSchedPolicy::_priorityPropagation ), "Number of levels to propagate priority upwards in the task graph (0 = no propagation, -1 = no depth limit)");
                cfg.registerArgOption( "affinity-priority-depth", "affinity-priority-depth" );
 
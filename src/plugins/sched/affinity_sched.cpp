@@ -1427,25 +1427,23 @@ namespace nanos {
             WD * atBeforeExit ( BaseThread *thread, WD &current, bool schedule )
             {
                TeamData &tdata = (TeamData &) *thread->getTeam()->getScheduleData();
-               WD * found = NULL;
                tdata._wdMap.prefetch( thread, current );
-               if ( _immediateSuccessor ) {
-                  found = current.getImmediateSuccessor(*thread);
-                  if ( found ) {
-                     found->_mcontrol.preInit();
-                     if ( current._mcontrol.containsAllCopies( found->_mcontrol ) ) {
-                        //*myThread->_file << "wd " << found->getId() << "( " << (found->getDescription() != NULL ? found->getDescription() : "n/a") << ") is a good immediate successor! "<< std::endl;
-                     } else {
-                        tdata._wdMap.insert(found);
-                        found = NULL;
-                        //*myThread->_file << "wd " << found->getId() << "( " << (found->getDescription() != NULL ? found->getDescription() : "n/a") << ") is NOT a good immediate successor! "<< std::endl;
-                     }
-                  }
-                  //if ( found ) {
-                  //   (*myThread->_file) << " atBeforeExit (getImmediateSuccessor) returns wd " << found->getId() << std::endl;
-                  //}
-               }
-               return found;
+               return NULL;
+            }
+
+            bool usesImmediateSuccessor () const
+            {
+               return _immediateSuccessor;
+            }
+
+            /*! \brief Only a successor whose data is already where current left it runs next */
+            bool atImmediateSuccessor ( BaseThread *thread, WD &current, WD &successor )
+            {
+               if ( current._mcontrol.containsAllCopies( successor._mcontrol ) ) return true;
+
+               TeamData &tdata = (TeamData &) *thread->getTeam()->getScheduleData();
+               tdata._wdMap.insert( &successor );
+               return false;
             }
 
             WD *fetchWD ( BaseThread *thread, WD *current );  
@@ -35,16 +35,31 @@ namespace nanos {
 
               TeamData () : ScheduleTeamData(), _readyQueue( NULL )
               {
-                if ( _usePriority || _useSmartPriority ) _readyQueue = NEW WDPriorityQueue<>( true /* enableDeviceCounter */, true /* optimise option */ );
+                if ( _useChaseLev ) return; /* ready queues are per thread */
+                if ( ( _usePriority || _useSmartPriority ) && _useMultiQueue ) _readyQueue = NEW WDMultiPriorityQueue();
+                else if ( _usePriority || _useSmartPriority ) _readyQueue = NEW WDPriorityQueue<>( true /* enableDeviceCounter */, true /* optimise option */ );
                 else _readyQueue = NEW WDDeque( true /* enableDeviceCounter */ );
               }
               ~TeamData () { delete _readyQueue; }
            };
 
+           /*! \brief Per thread ready queue, only used with Chase-Lev deques */
+           struct ThreadData : public ScheduleThreadData
+           {
+              WDChaseLevDeque _readyQueue;
+
+              ThreadData () : ScheduleThreadData(), _readyQueue( true /* enableDeviceCounter */ ) {}
+              ~ThreadData () {
+                 ensure( _readyQueue.empty(), "Destroying non-empty queue" );
+              }
+           };
+
          public:
            static bool       _useStack;
            static bool       _usePriority;
            static bool       _useSmartPriority;
+           static bool       _useChaseLev;
+           static bool       _useMultiQueue;
 
            BreadthFirst() : SchedulePolicy("Breadth First")
            {
@@ -54,13 +69,18 @@ namespace nanos {
                  disable too
                */
                _usePriority = _usePriority && sys.getPrioritiesNeeded();
+
+               if ( _useChaseLev && ( _usePriority || _useSmartPriority ) ) {
+                  warning0( "Chase-Lev deques do not support priorities, using a shared priority queue" );
+                  _useChaseLev = false;
+               }
            }
            virtual ~BreadthFirst () {}
 
          private:
             
            virtual size_t getTeamDataSize () const { return sizeof(TeamData); }
-           virtual size_t getThreadDataSize () const { return 0; }
+           virtual size_t getThreadDataSize () const { return _useChaseLev ? sizeof(ThreadData) : 0; }
 
            virtual ScheduleTeamData * createTeamData ()
            {
@@ -69,13 +89,18 @@ namespace nanos {
 
            virtual ScheduleThreadData * createThreadData ()
            {
-              return 0;
+              return _useChaseLev ? NEW ThreadData() : 0;
            }
 
            virtual void queue ( BaseThread *thread, WD &wd )
            {
               BaseThread *targetThread = wd.isTiedTo();
               if ( targetThread ) targetThread->addNextWD(&wd);
+              else if ( _useChaseLev ) {
+                 ThreadData &data = (ThreadData &) *thread->getTeamData()->getScheduleData();
+                 if ( thread == myThread ) data._readyQueue.setOwner( thread );
+                 data._readyQueue.push_front( &wd );
+              }
               else {
                  TeamData &tdata = (TeamData &) *thread->getTeam()->getScheduleData();
                  if ( _useStack ) return tdata._readyQueue->push_front( &wd );
@@ -86,6 +111,9 @@ namespace nanos {
             virtual void queue ( BaseThread ** threads, WD ** wds, size_t numElems )
             {
                fatal_cond( numElems == 0, "Cannot queue 0 elements.");
+
+               // Per thread deques are filled one by one
+               if ( _useChaseLev ) return SchedulePolicy::queue( threads, wds, numElems );
                
                // First step: check if all threads have the same team
                ThreadTeam* team = threads[0]->getTeam();
@@ -155,7 +183,7 @@ namespace nanos {
                   
                   // Reorder
                   TeamData &tdata = (TeamData &) *myThread->getTeam()->getScheduleData();
-                  WDPriorityQueue<> *q = (WDPriorityQueue<> *) tdata._readyQueue;
+                  WDPriorityPool *q = (WDPriorityPool *) tdata._readyQueue;
                   q->reorderWD( pred );
                }
             }
@@ -166,8 +194,37 @@ namespace nanos {
               return 0;
            }
 
+           /*! \brief Pops from the thread's own deque, then steals from the rest of the team
+            */
+           WD * atIdleChaseLev ( BaseThread *thread )
+           {
+              ThreadData &data = (ThreadData &) *thread->getTeamData()->getScheduleData();
+              data._readyQueue.setOwner( thread );
+
+              WD *wd = _useStack ? data._readyQueue.pop_front( thread ) : data._readyQueue.pop_back( thread );
+              if ( wd != NULL ) return wd;
+
+              ThreadTeam *team = thread->getTeam();
+              int size = team->getFinalSize();
+              int thid = rand() % size;
+
+              for ( int count = 0; count < size && wd == NULL; count++ ) {
+                 thid = ( thid + 1 ) % size;
+
+                 BaseThread &victim = team->getThread(thid);
+                 if ( &victim == thread || victim.getTeam() == NULL ) continue;
+
+                 ThreadData &vdata = (ThreadData &) *victim.getTeamData()->getScheduleData();
+                 wd = vdata._readyQueue.pop_back( thread );
+              }
+
+              return wd;
+           }
+
            WD * atIdle ( BaseThread *thread, int numSteal )
            {
+              if ( _useChaseLev ) return atIdleChaseLev( thread );
+
               TeamData &tdata = (TeamData &) *thread->getTeam()->getScheduleData();
               
               return tdata._readyQueue->pop_front( thread );
@@ -177,7 +234,7 @@ namespace nanos {
            {
               WD * found = current.getImmediateSuccessor(*thread);
               if ( found && (_usePriority || _useSmartPriority) ) {
-                 WDPriorityQueue<> &tdata = (WDPriorityQueue<> &) *((TeamData *) thread->getTeam()->getScheduleData())->_readyQueue;
+                 WDPriorityPool &tdata = (WDPriorityPool &) *((TeamData *) thread->getTeam()->getScheduleData())->_readyQueue;
                  if (found->getPriority() < tdata.maxPriority() ) {
                     queue(thread, *found);
                     found = NULL;
@@ -186,24 +243,29 @@ namespace nanos {
               return found != NULL ? found : atIdle(thread,false);
            }
         
-           WD * atBeforeExit ( BaseThread *thread, WD &current, bool schedule )
+           bool usesImmediateSuccessor () const
            {
-              WD * found = current.getImmediateSuccessor(*thread);
-              if ( found && (_usePriority || _useSmartPriority) && schedule ) {
-                 WDPriorityQueue<> &tdata = (WDPriorityQueue<> &) *((TeamData *) thread->getTeam()->getScheduleData())->_readyQueue;
-                 if (found->getPriority() < tdata.maxPriority() ) {
-                    queue(thread, *found);
-                    found = NULL;
+              return true;
+           }
+
+           /*! \brief A successor with less priority than the queued tasks waits its turn */
+           bool atImmediateSuccessor ( BaseThread *thread, WD &current, WD &successor )
+           {
+              if ( _usePriority || _useSmartPriority ) {
+                 WDPriorityPool &tdata = (WDPriorityPool &) *((TeamData *) thread->getTeam()->getScheduleData())->_readyQueue;
+                 if ( successor.getPriority() < tdata.maxPriority() ) {
+                    queue( thread, successor );
+                    return false;
                  }
               }
-              return found;
+              return true;
            }
 
             bool reorderWD ( BaseThread *t, WD *wd )
             {
               //! \bug FIXME flags of priority must be in queue
                if ( _usePriority || _useSmartPriority ) {
-                  WDPriorityQueue<> *q = (WDPriorityQueue<> *) wd->getMyQueue();
+                  WDPriorityPool *q = (WDPriorityPool *) wd->getMyQueue();
                   return q? q->reorderWD( wd ) : true;
                } else {
                   return true;
@@ -214,8 +276,10 @@ namespace nanos {
             {
                TeamData &tdata = (TeamData &) *myThread->getTeam()->getScheduleData();
                if ( _usePriority || _useSmartPriority ) {
-                  WDPriorityQueue<> &q = (WDPriorityQueue<> &) *(tdata._readyQueue);
+                  WDPriorityPool &q = (WDPriorityPool &) *(tdata._readyQueue);
                   return q.getNumConcurrentWDs();
+               } else if ( _useChaseLev ) {
+                  return SchedulePolicy::getNumConcurrentWDs();
                } else {
                   WDDeque &q = (WDDeque &) *(tdata._readyQueue);
                   return q.getNumConcurrentWDs();
@@ -231,6 +295,8 @@ namespace nanos {
       bool BreadthFirst::_useStack = false;
       bool BreadthFirst::_usePriority = true;
       bool BreadthFirst::_useSmartPriority = false;
+      bool BreadthFirst::_useChaseLev = false;
+      bool BreadthFirst::_useMultiQueue = false;
 
       class BFSchedPlugin : public Plugin
       {
@@ -253,6 +319,12 @@ namespace nanos {
                cfg.registerConfigOption ( "schedule-smart-priority", NEW Config::FlagOption( BreadthFirst::_useSmartPriority ), "Smart priority queue propagates high priorities to predecessors");
                cfg.registerArgOption( "schedule-smart-priority", "schedule-smart-priority" );
 
+               cfg.registerConfigOption ( "schedule-priority-multiqueue", NEW Config::FlagOption( BreadthFirst::_useMultiQueue ), "Relaxed concurrent multi-queue used as priority ready queue");
+               cfg.registerArgOption( "schedule-priority-multiqueue", "schedule-priority-multiqueue" );
+
+               cfg.registerConfigOption ( "schedule-chase-lev", NEW Config::FlagOption( BreadthFirst::_useChaseLev ), "Per thread lock-free Chase-Lev work-stealing deques instead of a shared ready queue");
+               cfg.registerArgOption( "schedule-chase-lev", "schedule-chase-lev" );
+
             }
 
             virtual void init() {
@@ -0,0 +1,259 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "schedule.hpp"
+#include "wddeque.hpp"
+#include "plugin.hpp"
+#include "system.hpp"
+#include "config.hpp"
+#include "hwloc_decl.hpp"
+#include <vector>
+
+namespace nanos {
+   namespace ext {
+
+      /*! \brief Hierarchical work stealing
+       *
+       *  Every thread pushes and pops its own tasks LIFO. An idle thread steals the
+       *  oldest task of another thread, looking for victims from the closest to the
+       *  farthest: SMT siblings of the same core, cores sharing its last level cache,
+       *  cores of its NUMA node and, last, the remote NUMA nodes. A steal from a
+       *  remote node takes half of the victim's tasks at once, so that crossing the
+       *  interconnect pays off.
+       */
+      class HierarchicalWorkStealing : public SchedulePolicy
+      {
+         public:
+            typedef enum { CORE, CACHE, NUMA, REMOTE, NUM_LEVELS } Level;
+
+            static bool          _stealHalf;
+
+         private:
+            static const char   *_stealKeys[NUM_LEVELS];   /**< Instrumentation keys of the steal counters */
+
+            struct ThreadData : public ScheduleThreadData
+            {
+               typedef std::vector<int> VictimList;
+
+               /*! queue of ready tasks to be executed */
+               WDDeque        _readyQueue;
+               /*! team threads by distance, built for a team of _teamSize threads */
+               VictimList     _victims[NUM_LEVELS];
+               size_t         _teamSize;
+               unsigned int   _seed;
+               /*! tasks stolen at every level */
+               unsigned int   _steals[NUM_LEVELS];
+
+               ThreadData () : _readyQueue(), _teamSize( 0 ), _seed( 0 )
+               {
+                  for ( int i = 0; i < NUM_LEVELS; i++ ) _steals[i] = 0;
+               }
+               virtual ~ThreadData () {
+                  ensure( _readyQueue.empty(), "Destroying non-empty queue" );
+               }
+            };
+
+            /*! \brief Location of a thread in the machine */
+            struct Locality
+            {
+               unsigned int   _core;
+               unsigned int   _cache;
+               unsigned int   _numaNode;
+
+               Locality ( BaseThread &thread )
+               {
+                  sys._hwloc.getCpuLocality( thread.getCpuId(), _core, _cache );
+                  _numaNode = thread.runningOn()->getNumaNode();
+               }
+
+               Level distance ( Locality const &other ) const
+               {
+                  if ( _numaNode != other._numaNode ) return REMOTE;
+                  if ( _core == other._core ) return CORE;
+                  if ( _cache == other._cache ) return CACHE;
+                  return NUMA;
+               }
+            };
+
+            HierarchicalWorkStealing ( const HierarchicalWorkStealing & );
+            const HierarchicalWorkStealing & operator= ( const HierarchicalWorkStealing & );
+
+            /*! \brief Sorts the threads of the team by their distance to thread */
+            void buildVictims ( BaseThread *thread, ThreadData &data );
+
+            /*! \brief Steals from the victims of a level, starting at a random one */
+            WD * steal ( BaseThread *thread, ThreadData &data, Level level );
+
+         public:
+            // constructor
+            HierarchicalWorkStealing() : SchedulePolicy( "Hierarchical Work Stealing" ) {}
+            virtual ~HierarchicalWorkStealing() {}
+
+            virtual size_t getTeamDataSize () const { return 0; }
+            virtual size_t getThreadDataSize () const { return sizeof(ThreadData); }
+
+            virtual ScheduleTeamData * createTeamData ()
+            {
+               return 0;
+            }
+
+            virtual ScheduleThreadData * createThreadData ()
+            {
+               return NEW ThreadData();
+            }
+
+            /*!
+             *  \brief Enqueue a work descriptor in the readyQueue of the passed thread
+             *  \param thread pointer to the thread to which readyQueue the task must be appended
+             *  \param wd a reference to the work descriptor to be enqueued
+             *  \sa ThreadData, WD, and BaseThread
+             */
+            virtual void queue ( BaseThread *thread, WD &wd )
+            {
+               ThreadData &data = ( ThreadData & ) *thread->getTeamData()->getScheduleData();
+               data._readyQueue.push_front( &wd );
+            }
+
+            /*!
+             *  \brief Function called when a new task must be created: the new created task
+             *          is queued in the thread that creates it
+             *  \param thread pointer to the thread to which belongs the new task
+             *  \param wd a reference to the work descriptor of the new task
+             *  \sa WD and BaseThread
+             */
+            virtual WD * atSubmit ( BaseThread *thread, WD &newWD )
+            {
+               queue( thread, newWD );
+               return 0;
+            }
+
+            virtual WD * atIdle ( BaseThread *thread, int numSteal );
+      };
+
+      bool HierarchicalWorkStealing::_stealHalf = true;
+      const char *HierarchicalWorkStealing::_stealKeys[NUM_LEVELS] = { "sched-steals-core", "sched-steals-cache",
+                                                                       "sched-steals-numa", "sched-steals-remote" };
+
+      void HierarchicalWorkStealing::buildVictims ( BaseThread *thread, ThreadData &data )
+      {
+         ThreadTeam *team = thread->getTeam();
+         size_t size = team->getFinalSize();
+
+         for ( int level = 0; level < NUM_LEVELS; level++ ) data._victims[level].clear();
+
+         Locality mine( *thread );
+         for ( size_t i = 0; i < size; i++ ) {
+            BaseThread &victim = team->getThread( i );
+            if ( &victim == thread ) continue;
+
+            data._victims[ mine.distance( Locality( victim ) ) ].push_back( i );
+         }
+
+         data._teamSize = size;
+         data._seed = thread->getId();
+      }
+
+      WD * HierarchicalWorkStealing::steal ( BaseThread *thread, ThreadData &data, Level level )
+      {
+         ThreadData::VictimList const &victims = data._victims[level];
+         size_t count = victims.size();
+         if ( count == 0 ) return NULL;
+
+         ThreadTeam *team = thread->getTeam();
+         size_t start = rand_r( &data._seed ) % count;
+
+         for ( size_t i = 0; i < count; i++ ) {
+            BaseThread &victim = team->getThread( victims[ ( start + i ) % count ] );
+            if ( victim.getTeam() == NULL ) continue;
+
+            ThreadData &vdata = ( ThreadData & ) *victim.getTeamData()->getScheduleData();
+            WD *wd = vdata._readyQueue.pop_back( thread );
+            if ( wd == NULL ) continue;
+
+            unsigned int stolen = 1;
+
+            // Crossing NUMA nodes: take half of the victim's tasks, the oldest ones
+            if ( level == REMOTE && _stealHalf ) {
+               size_t half = vdata._readyQueue.size() / 2;
+               for ( ; half > 0; half-- ) {
+                  WD *next = vdata._readyQueue.pop_back( thread );
+                  if ( next == NULL ) break;
+                  data._readyQueue.push_back( next );
+                  stolen++;
+               }
+            }
+
+            data._steals[level] += stolen;
+
+            NANOS_INSTRUMENT ( static nanos_event_key_t keys[NUM_LEVELS]; )
+            NANOS_INSTRUMENT ( if ( keys[level] == 0 ) keys[level] = sys.getInstrumentation()->getInstrumentationDictionary()->getEventKey( _stealKeys[level] ); )
+            NANOS_INSTRUMENT ( nanos_event_value_t value = data._steals[level]; )
+            NANOS_INSTRUMENT ( sys.getInstrumentation()->raisePointEvents( 1, &keys[level], &value ); )
+
+            return wd;
+         }
+
+         return NULL;
+      }
+
+      /*!
+       *  \brief Function called by the scheduler when a thread becomes idle to schedule it
+       *  \param thread pointer to the thread to be scheduled
+       *  \sa BaseThread
+       */
+      WD * HierarchicalWorkStealing::atIdle ( BaseThread *thread, int numSteal )
+      {
+         ThreadData &data = ( ThreadData & ) *thread->getTeamData()->getScheduleData();
+
+         WD *wd = data._readyQueue.pop_front( thread );
+         if ( wd != NULL ) return wd;
+
+         // The team may have grown or shrunk since the victims were sorted
+         if ( data._teamSize != thread->getTeam()->getFinalSize() ) buildVictims( thread, data );
+
+         for ( int level = 0; level < NUM_LEVELS && wd == NULL; level++ ) {
+            wd = steal( thread, data, ( Level ) level );
+         }
+
+         return wd;
+      }
+
+      class HWSSchedPlugin : public Plugin
+      {
+         public:
+            HWSSchedPlugin() : Plugin( "Hierarchical work stealing scheduling Plugin",1 ) {}
+
+            virtual void config( Config& cfg )
+            {
+               cfg.setOptionsSection( "HWS module", "Hierarchical (topology aware) work stealing scheduling module" );
+
+               cfg.registerConfigOption ( "hws-steal-half", NEW Config::FlagOption( HierarchicalWorkStealing::_stealHalf ),
+                                             "Steal half of the tasks of a victim in a remote NUMA node (enabled by default)" );
+               cfg.registerArgOption ( "hws-steal-half", "hws-steal-half" );
+            }
+
+            virtual void init() {
+               sys.setDefaultSchedulePolicy(NEW HierarchicalWorkStealing());
+            }
+      };
+
+   }
+}
+
+DECLARE_PLUGIN("sched-hws",nanos::ext::HWSSchedPlugin);
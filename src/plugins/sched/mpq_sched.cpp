@@ -36,8 +36,10 @@ namespace nanos {
               TeamData () : ScheduleTeamData(), _readyQueue()
               {
                 _readyQueue = (WDPool **) malloc(sizeof(WDPool *)* _numQueues);
-                for (int i=0; i<_numQueues; i++)
-                   _readyQueue[i] = NEW WDDeque();
+                for (int i=0; i<_numQueues; i++) {
+                   if ( _useMultiQueue ) _readyQueue[i] = NEW WDMultiPriorityQueue();
+                   else _readyQueue[i] = NEW WDDeque();
+                }
                //fprintf(stderr,"Nanos++: Max priority = %d, number of queues = %d\n",_maxPriority, _numQueues);
               }
               ~TeamData () {
@@ -52,9 +54,13 @@ namespace nanos {
            static bool       _useSmartPriority;
            static int        _numQueues;
            static int        _maxPriority;
+           static bool       _useMultiQueue;
 
            MultiPriorityQueue() : SchedulePolicy("Multi Priority Queue") {
               _usePriority = _usePriority && sys.getPrioritiesNeeded();
+
+              // The multi-queue orders by exact priority, one is enough
+              if ( _useMultiQueue ) _numQueues = 1;
            }
            virtual ~MultiPriorityQueue () {}
 
@@ -159,7 +165,7 @@ namespace nanos {
 
                   // Reorder
                   TeamData &tdata = (TeamData &) *myThread->getTeam()->getScheduleData();
-                  WDPriorityQueue<> *q = (WDPriorityQueue<> *) tdata._readyQueue[0];
+                  WDPriorityPool *q = (WDPriorityPool *) tdata._readyQueue[0];
                   q->reorderWD( pred );
                }
             }
@@ -203,7 +209,10 @@ namespace nanos {
             bool reorderWD ( BaseThread *t, WD *wd )
             {
               //! \bug FIXME flags of priority must be in queue
-               if ( _usePriority || _useSmartPriority ) {
+               if ( _useMultiQueue ) {
+                  WDPriorityPool *q = (WDPriorityPool *) wd->getMyQueue();
+                  return q? q->reorderWD( wd ) : true;
+               } else if ( _usePriority || _useSmartPriority ) {
                   WDPriorityQueue<> *q = (WDPriorityQueue<> *) wd->getMyQueue();
                   return q? q->reorderWD( wd ) : true;
                } else {
@@ -222,6 +231,7 @@ namespace nanos {
       bool MultiPriorityQueue::_useSmartPriority = false;
       int  MultiPriorityQueue::_maxPriority = 0;
       int  MultiPriorityQueue::_numQueues = 8;
+      bool MultiPriorityQueue::_useMultiQueue = false;
 
       class BFSchedPlugin : public Plugin
       {
@@ -247,6 +257,9 @@ namespace nanos {
                                          "Defines number of queues that will be used by the scheduler" );
                cfg.registerArgOption( "schedule-num-queues", "schedule-num-queues" );
 
+               cfg.registerConfigOption ( "schedule-priority-multiqueue", NEW Config::FlagOption( MultiPriorityQueue::_useMultiQueue ), "Single relaxed concurrent multi-queue, ordered by exact priority, instead of one queue per level");
+               cfg.registerArgOption( "schedule-priority-multiqueue", "schedule-priority-multiqueue" );
+
             }
 
             virtual void init() {
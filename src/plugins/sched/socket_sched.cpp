@@ -119,8 +119,9 @@ namespace nanos {
             {
                unsigned int _cacheId;
                bool _init;
+               std::vector<std::size_t> _homeBytes;   //!< Bytes per node of the WD being placed, see getHomeNode
 
-               ThreadData () : _cacheId(0), _init(false) {}
+               ThreadData () : _cacheId(0), _init(false), _homeBytes( sys.getNumNumaNodes(), 0 ) {}
                virtual ~ThreadData () {}
             };
             
@@ -301,10 +302,42 @@ namespace nanos {
                return createdDataSize > 0;
             }
             
+            /*!
+             *  \brief Returns the node where most of the data of the WD copies
+             *  was placed by nanos_numa_malloc or nanos_numa_first_touch.
+             *
+             * \retval UnassignedNode If no copy has a home node.
+             */
+            inline int getHomeNode( BaseThread *thread, const WD& wd ) const
+            {
+               const CopyData * copies = wd.getCopies();
+               ThreadData &data = ( ThreadData & ) *thread->getTeamData()->getScheduleData();
+               unsigned numNodes = data._homeBytes.size();
+               if ( numNodes == 0 ) return UnassignedNode;
+
+               std::size_t *homeBytes = &data._homeBytes[0];
+               std::fill( homeBytes, homeBytes + numNodes, 0 );
+
+               bool found = false;
+               for ( unsigned int i = 0; i < wd.getNumCopies(); i++ ) {
+                  if ( !copies[i].isPrivate() ) {
+                     found |= sys.getNumaPlacement().addHomeBytes( ( const void * ) copies[i].getFitAddress(),
+                           copies[i].getFitSize(), homeBytes );
+                  }
+               }
+               if ( !found ) return UnassignedNode;
+
+               return std::max_element( homeBytes, homeBytes + numNodes ) - homeBytes;
+            }
+
             /*!
              *  \brief Returns the node this WD should run on, based on copies
              *  information if _useCopies is enabled.
-             *  Otherwise, it will use the node set by the user.
+             *  Otherwise, it will use the node set by the user or, if there
+             *  is none, the home node of its data.
+             *
+             *  Data placed with nanos_numa_malloc always takes precedence over
+             *  the information of the copies.
              *
              *  It will also set the WD NUMA node when using copies, since in
              *  that case that property is set to -1.
@@ -326,15 +359,22 @@ namespace nanos {
                WDData & wdata = *dynamic_cast<WDData*>( wd.getSchedulerData() );
 
                // If copies are disabled, simply return the node set by current_socket
-               if ( !_useCopies )
+               if ( !_useCopies ) {
+                  if ( wd.getNUMANode() == UnassignedNode )
+                     wd.setNUMANode( getHomeNode( thread, wd ) );
                   return wd.getNUMANode();
+               }
 
                const CopyData * copies = wd.getCopies();
                unsigned numNodes = sys.getNumNumaNodes();
                
-               int winner;
+               int winner = getHomeNode( thread, wd );
                
-               if( isInitTask( wd ) )
+               if ( winner != UnassignedNode )
+               {
+                  verbose0( toString( "[NUMA] wd ") + toString( wd.getId() ) + toString( " data has home node " ) + toString( winner ) );
+               }
+               else if( isInitTask( wd ) )
                {
                   wdata._initTask = true;
                   winner = tdata._next++ % sys.getNumNumaNodes();
@@ -775,6 +815,27 @@ namespace nanos {
                return NULL;
             }
             
+            bool usesImmediateSuccessor () const
+            {
+               return _useSuccessor;
+            }
+
+            /*!
+             *  \brief First level tasks are spread across the sockets, they
+             *  only run next if they were meant for the socket of this thread.
+             */
+            bool atImmediateSuccessor ( BaseThread *thread, WD &current, WD &successor )
+            {
+               if ( successor.getDepth() != 1 ) return true;
+
+               int node = successor.getNUMANode();
+               if ( node == UnassignedNode ) return true;
+               if ( node == sys.getVirtualNUMANode( thread->runningOn()->getNumaNode() ) ) return true;
+
+               distribute( thread, successor );
+               return false;
+            }
+
             WD * atPrefetch ( BaseThread *thread, WD &current )
             {
                // If the use of getImmediateSuccessor is not enabled
@@ -32,11 +32,24 @@ namespace nanos {
             struct ThreadData : public ScheduleThreadData
             {
                /*! queue of ready tasks to be executed */
-               WDDeque _readyQueue;
+               WDPool *_readyQueue;
 
-               ThreadData () : _readyQueue() {}
+               ThreadData () : _readyQueue( NULL )
+               {
+                  if ( _useChaseLev ) _readyQueue = NEW WDChaseLevDeque();
+                  else _readyQueue = NEW WDDeque();
+               }
                virtual ~ThreadData () {
-                  ensure(_readyQueue.empty(),"Destroying non-empty queue");
+                  ensure(_readyQueue->empty(),"Destroying non-empty queue");
+                  delete _readyQueue;
+               }
+
+               /*! \brief Binds the queue to the thread it belongs to (Chase-Lev deques only)
+                *  \param thread The thread that owns this ThreadData, must be myThread
+                */
+               void bind ( BaseThread *thread )
+               {
+                  if ( _useChaseLev ) static_cast<WDChaseLevDeque *>( _readyQueue )->setOwner( thread );
                }
             };
 
@@ -48,6 +61,7 @@ namespace nanos {
 
             //alex: FIX: this should be defaults and not common to all instances
             static bool          _stealParent;
+            static bool          _useChaseLev;
             static QueuePolicy   _localPolicy;
             static QueuePolicy   _stealPolicy;
 
@@ -71,16 +85,16 @@ namespace nanos {
             /*! \brief Extracts a WD from the queue either from the beginning or the end of the queue
              *
              *  This function allows to simplify the code to extract code from the queues.
-             *  It's a wrapper around the WDDeque
+             *  It's a wrapper around the WDPool
              *  functions with the actual function chosen with the policy argument.
              *
              *   \param [inout] q The queue from we want to extract a WD
              *   \param [in] policy Either FIFO/LIFO to specify if we extract from the beginning or the end of the queue
              *   \param [in] thread The thread trying to extract the thread
              *   \returns either a WD if one was available in the queues or NULL
-             *   \sa WDDeque::pop_front, WDDeque::pop_back
+             *   \sa WDPool::pop_front, WDPool::pop_back
              */
-            WD * pop ( WDDeque &q, QueuePolicy policy, BaseThread *thread )
+            WD * pop ( WDPool &q, QueuePolicy policy, BaseThread *thread )
             {
                return policy == LIFO  ? q.pop_front(thread) : q.pop_back(thread);
             }
@@ -94,7 +108,8 @@ namespace nanos {
             virtual void queue ( BaseThread *thread, WD &wd )
             {
                 ThreadData &data = ( ThreadData & ) *thread->getTeamData()->getScheduleData();
-                data._readyQueue.push_front ( &wd );
+                if ( thread == myThread ) data.bind( thread );
+                data._readyQueue->push_front ( &wd );
             }
 
             /*!
@@ -111,9 +126,15 @@ namespace nanos {
             }
 
             virtual WD * atIdle ( BaseThread *thread, int numSteal );
+
+            virtual bool usesImmediateSuccessor () const
+            {
+               return true;
+            }
       };
 
       bool WorkFirst::_stealParent = true;
+      bool WorkFirst::_useChaseLev = false;
       WorkFirst::QueuePolicy WorkFirst::_localPolicy = WorkFirst::LIFO;
       WorkFirst::QueuePolicy WorkFirst::_stealPolicy = WorkFirst::FIFO;
 
@@ -128,11 +149,12 @@ namespace nanos {
          WorkDescriptor * next = NULL; 
 
          ThreadData &data = ( ThreadData & ) *thread->getTeamData()->getScheduleData();
+         data.bind( thread );
 
          /*
           *  First try to schedule the thread with a task from its queue
           */
-         if ( ( wd = pop( data._readyQueue, _localPolicy, thread ) ) != NULL ) {
+         if ( ( wd = pop( *data._readyQueue, _localPolicy, thread ) ) != NULL ) {
             return wd;
          } else {
             /*
@@ -166,7 +188,7 @@ namespace nanos {
 
                if ( victim.getTeam() != NULL ) {
                  ThreadData &tdata = ( ThreadData & ) *victim.getTeamData()->getScheduleData();
-                 wd = pop( tdata._readyQueue, _stealPolicy, thread );
+                 wd = pop( *tdata._readyQueue, _stealPolicy, thread );
                }
 
                count++;
@@ -192,6 +214,10 @@ namespace nanos {
                                              "Defines if tries to steal the parent" );
                cfg.registerArgOption ( "schedule-steal-parent", "schedule-parent" );
 
+               cfg.registerConfigOption ( "schedule-chase-lev", NEW Config::FlagOption( WorkFirst::_useChaseLev ),
+                                             "Use lock-free Chase-Lev work-stealing deques as ready queues" );
+               cfg.registerArgOption ( "schedule-chase-lev", "schedule-chase-lev" );
+
                typedef Config::MapVar<WorkFirst::QueuePolicy> QueueConfig;
                
                QueueConfig *queuePolicyLocalConfig = NEW QueueConfig ( WorkFirst::_localPolicy );
@@ -0,0 +1,292 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "plugin.hpp"
+#include "slicer.hpp"
+#include "system.hpp"
+#include "smpdd.hpp"
+#include "atomic.hpp"
+#include <algorithm>
+#include <stdint.h>
+
+namespace nanos {
+namespace ext {
+
+/*! \brief Iteration space shared by all the slices of an adaptive loop
+ *
+ *  Iterations are normalized to [0,niters). Every slice owns a range, packed
+ *  as (lower << 32 | upper) in a single word, and takes chunks from its front.
+ *  A slice whose range is exhausted steals the back half of the biggest range
+ *  left, so both the owner and the thieves update ranges with one CAS.
+ */
+class AdaptiveLoop
+{
+   public:
+      struct Range {
+         Atomic<uint64_t>        _bounds;
+         Atomic<unsigned int>    _steals;    /**< Times this range has been stolen from */
+         char                    _pad[NANOS_CACHELINE - sizeof(Atomic<uint64_t>) - sizeof(Atomic<unsigned int>)];
+      };
+
+      DeviceData::work_fct       _work;      /**< Outlined loop body */
+      int                        _lower;
+      int                        _step;
+      unsigned int               _niters;
+      unsigned int               _minChunk;  /**< User chunk, never split further */
+      unsigned int               _maxChunk;  /**< Chunk taken while nobody steals */
+      int                        _numRanges;
+      Atomic<int>                _running;   /**< Slices still running, the last one frees the loop */
+      Range                     *_ranges;
+
+   public:
+      AdaptiveLoop ( DeviceData::work_fct work, int lower, int step, unsigned int niters, unsigned int chunk, int numRanges )
+         : _work( work ), _lower( lower ), _step( step ), _niters( niters ), _minChunk( chunk ), _maxChunk( chunk ),
+           _numRanges( numRanges ), _running( numRanges ), _ranges( NEW Range[numRanges] )
+      {
+         // Big chunks while there is no imbalance: an eighth of the initial range
+         unsigned int share = niters / ( numRanges * 8 );
+         if ( share > _maxChunk ) _maxChunk = share;
+
+         for ( int i = 0; i < numRanges; i++ ) {
+            uint64_t first = (uint64_t) niters * i / numRanges;
+            uint64_t last = (uint64_t) niters * ( i + 1 ) / numRanges;
+            _ranges[i]._bounds = pack( first, last );
+            _ranges[i]._steals = 0;
+         }
+      }
+
+      ~AdaptiveLoop () { delete[] _ranges; }
+
+      static uint64_t pack ( uint64_t lower, uint64_t upper ) { return ( lower << 32 ) | upper; }
+      static unsigned int lowerOf ( uint64_t bounds ) { return (unsigned int) ( bounds >> 32 ); }
+      static unsigned int upperOf ( uint64_t bounds ) { return (unsigned int) ( bounds & 0xFFFFFFFF ); }
+
+      /*! \brief Takes up to 'chunk' iterations from the front of range 'me' */
+      bool claim ( int me, unsigned int chunk, unsigned int &lower, unsigned int &upper )
+      {
+         Range &range = _ranges[me];
+         while ( true ) {
+            uint64_t bounds = range._bounds.value();
+            lower = lowerOf( bounds );
+            unsigned int end = upperOf( bounds );
+            if ( lower >= end ) return false;
+
+            upper = end - lower > chunk ? lower + chunk : end;
+            if ( range._bounds.cswap( bounds, pack( upper, end ) ) ) return true;
+         }
+      }
+
+      /*! \brief Moves the back half of the biggest range into range 'me', which must be empty */
+      bool steal ( int me )
+      {
+         while ( true ) {
+            int victim = -1;
+            uint64_t bounds = 0;
+            unsigned int biggest = 0;
+            for ( int i = 1; i < _numRanges; i++ ) {
+               int candidate = ( me + i ) % _numRanges;
+               uint64_t b = _ranges[candidate]._bounds.value();
+               unsigned int left = upperOf( b ) - lowerOf( b );
+               if ( lowerOf( b ) < upperOf( b ) && left > biggest ) {
+                  biggest = left;
+                  victim = candidate;
+                  bounds = b;
+               }
+            }
+
+            // Halves smaller than the user chunk are not worth it, the owner finishes them
+            if ( victim < 0 || biggest < 2 * _minChunk ) return false;
+
+            unsigned int lower = lowerOf( bounds );
+            unsigned int upper = upperOf( bounds );
+            unsigned int middle = lower + biggest / 2;
+            if ( _ranges[victim]._bounds.cswap( bounds, pack( lower, middle ) ) ) {
+               _ranges[victim]._steals++;
+               _ranges[me]._bounds = pack( middle, upper );
+               return true;
+            }
+         }
+      }
+};
+
+class SlicerAdaptiveFor: public Slicer
+{
+   private:
+   public:
+      // constructor
+      SlicerAdaptiveFor ( ) { }
+
+      // destructor
+      ~SlicerAdaptiveFor ( ) { }
+
+      // headers (implemented below)
+      void submit ( WorkDescriptor & work ) ;
+      bool dequeue ( WorkDescriptor *wd, WorkDescriptor **slice ) { *slice = wd; return true; }
+};
+
+static void adaptiveLoop ( void *arg )
+{
+   debug ( "Executing adaptive loop wrapper");
+
+   nanos_loop_info_t * loop_info = (nanos_loop_info_t *) arg;
+   AdaptiveLoop *loop = (AdaptiveLoop *) loop_info->args;
+   int me = loop_info->thid;
+
+   //! The chunk halves every time the range of this slice is stolen from and doubles back otherwise
+   unsigned int chunk = loop->_maxChunk;
+   unsigned int steals = loop->_ranges[me]._steals.value();
+   unsigned int lower, upper;
+
+   while ( true ) {
+      if ( !loop->claim( me, chunk, lower, upper ) ) {
+         if ( loop->steal( me ) ) continue;
+         break;
+      }
+
+      //! Computing current parameters
+      loop_info->lower = loop->_lower + (int) lower * loop->_step;
+      loop_info->upper = loop->_lower + (int) ( upper - 1 ) * loop->_step;
+      loop_info->last = ( upper == loop->_niters );
+
+      //! Calling realwork
+      loop->_work( arg );
+
+      unsigned int current = loop->_ranges[me]._steals.value();
+      if ( current != steals ) {
+         steals = current;
+         chunk = std::max( loop->_minChunk, chunk / 2 );
+      } else {
+         chunk = std::min( loop->_maxChunk, chunk * 2 );
+      }
+   }
+
+   if ( --loop->_running == 0 ) delete loop;
+}
+
+void SlicerAdaptiveFor::submit ( WorkDescriptor &work )
+{
+   debug ( "Submitting sliced task " << &work << ":" << work.getId() );
+
+   BaseThread *mythread = myThread;
+   ThreadTeam *team = mythread->getTeam();
+   WorkDescriptor *slice = NULL;
+   nanos_loop_info_t *loop_info;
+   int i;
+
+   // Ensure team stability during the job distribution
+   while ( !team->isStable() ) memoryFence();
+   team->lock();
+
+   // Threads compatible with the work descriptor (see SlicerStaticFor::submit)
+   int num_threads = team->getFinalSize();
+   int valid_threads = 0, first_valid_thread = 0;
+   int *thread_map = (int *) alloca ( sizeof(int) * num_threads );
+   for ( i = 0; i < num_threads; i++) {
+     if (  work.canRunIn( *((*team)[i].runningOn()) ) ) {
+       if ( valid_threads == 0 ) first_valid_thread = i;
+       thread_map[i] = valid_threads++;
+     }
+     else thread_map[i] = -1;
+   }
+
+   // It's safer to unblock threads once the team is unlocked
+   std::vector<BaseThread*> threads_to_unblock;
+   threads_to_unblock.reserve(num_threads);
+
+   loop_info = ( nanos_loop_info_t * ) work.getData();
+
+   int _lower = loop_info->lower;
+   int _upper = loop_info->upper;
+   int _step  = loop_info->step;
+
+   //! Checking empty iteration spaces
+   unsigned int _niters = 0;
+   if ( ( _step > 0 && _lower <= _upper ) || ( _step < 0 && _lower >= _upper ) )
+      _niters = ( ( _upper - _lower ) / _step ) + 1;
+
+   SMPDD &dd = ( SMPDD & ) work.getActiveDevice();
+   AdaptiveLoop *loop = NEW AdaptiveLoop( dd.getWorkFct(), _lower, _step, _niters,
+                                          std::max( 1, loop_info->chunk ), valid_threads );
+   loop_info->args = ( void * ) loop;
+   loop_info->thid = 0;
+   loop_info->threads = valid_threads;
+   dd = SMPDD(adaptiveLoop);
+
+   // Creating additional WorkDescriptors: 1..N, one per valid thread
+   int j = 0; /* initializing thread id */
+   for ( i = 1; i < valid_threads; i++ ) {
+      // Finding 'j', as the next valid thread 
+      while ( (j < num_threads) && (thread_map[j] != i) ) j++;
+
+      slice = NULL;
+      sys.duplicateWD( &slice, &work );
+
+      debug ( "Creating task " << slice << ":" << slice->getId() << " from sliced one " << &work << ":" << work.getId() );
+
+      // The slice starts with range 'i'
+      loop_info = ( nanos_loop_info_t * ) slice->getData();
+      loop_info->thid = i;
+
+      // Submit: slice (WorkDescriptor i, running on Thread j)
+      sys.setupWD ( *slice, work.getParent() );
+      BaseThread &target_thread = (*team)[j];
+      slice->tieTo( target_thread );
+      target_thread.addNextWD(slice);
+      threads_to_unblock.push_back( &target_thread );
+   }
+
+   // Only 1 WD left, we can unlock after obtaining the last target
+   BaseThread &first_thread = (*team)[first_valid_thread];
+   team->unlock();
+
+   // Submit: work (WorkDescriptor 0, running on thread 'first')
+   work.convertToRegularWD();
+   work.tieTo( first_thread );
+   if ( mythread == &first_thread ) {
+      if ( Scheduler::inlineWork( &work, false ) ) {
+         WD::destroy( &work );
+      }
+   }
+   else
+   {
+      first_thread.addNextWD( (WorkDescriptor *) &work);
+   }
+
+   // Finally unblock all threads involved in the slicer
+   threads_to_unblock.push_back( &first_thread );
+   sys.getThreadManager()->unblockThreads( threads_to_unblock );
+}
+
+class SlicerAdaptiveForPlugin : public Plugin {
+   public:
+      SlicerAdaptiveForPlugin () : Plugin("Slicer for Loops using range stealing among threads",1) {}
+      ~SlicerAdaptiveForPlugin () {}
+
+      virtual void config( Config& cfg ) {}
+
+      void init ()
+      {
+         sys.registerSlicer("adaptive_for", NEW SlicerAdaptiveFor() );
+      }
+};
+
+} // namespace ext
+} // namespace nanos
+
+DECLARE_PLUGIN("slicer-adaptive_for",nanos::ext::SlicerAdaptiveForPlugin);
@@ -109,10 +109,10 @@ bool SlicerCompoundWD::dequeue ( WorkDescriptor *wd, WorkDescriptor **slice )
 
    if ( modifiers == true ) {
       if ( _serializeAll ) serialize = true ;
-      if ( _totalTasks != 0) serialize = serialize || (ss._totalTasks > _totalTasks );
-      if ( _totalTasksPerThread != 0) serialize = serialize || ( ss._totalTasks > ( nthreads * _totalTasksPerThread) );
-      if ( _readyTasks != 0) serialize = serialize || (ss._readyTasks > _readyTasks );
-      if ( _readyTasksPerThread != 0) serialize = serialize || (ss._readyTasks > ( nthreads * _readyTasksPerThread) );
+      if ( _totalTasks != 0) serialize = serialize || (ss._totalTasks.approximate() > _totalTasks );
+      if ( _totalTasksPerThread != 0) serialize = serialize || ( ss._totalTasks.approximate() > ( nthreads * _totalTasksPerThread) );
+      if ( _readyTasks != 0) serialize = serialize || (ss._readyTasks.approximate() > _readyTasks );
+      if ( _readyTasksPerThread != 0) serialize = serialize || (ss._readyTasks.approximate() > ( nthreads * _readyTasksPerThread) );
       if ( _depthOfTask != 0) serialize = serialize; //! \todo depthOfTask is not involved in serialize flag
    }
    
@@ -145,8 +145,7 @@ void SlicerCompoundWD::executeWDs ( nanos_compound_wd_data_t *data )
    for ( int i = 0; i < data->nsect; i++ ) {
       slice = (WorkDescriptor*)data->lwd[i];
       Scheduler::inlineWork( slice, /*schedule*/ false );
-      slice->~WorkDescriptor();
-      delete[] (char *)slice;
+      WD::destroy( slice );
    }
 
 }
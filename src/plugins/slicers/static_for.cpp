@@ -232,8 +232,7 @@ void SlicerStaticFor::submit ( WorkDescriptor &work )
    work.tieTo( first_thread );
    if ( mythread == &first_thread ) {
       if ( Scheduler::inlineWork( &work, false ) ) {
-         work.~WorkDescriptor();
-         delete[] (char *) &work;
+         WD::destroy( &work );
       }
    }
    else
@@ -28,16 +28,12 @@ namespace nanos {
 
       class HysteresisThrottle: public ThrottlePolicy
       {
-         private:
-            typedef int (*ntask_getter_t)( void ) ;
-            static int get_total_tasks (void) { return sys.getTaskNum(); }
-            static int get_ready_tasks (void) { return sys.getReadyNum(); }
          private:
             int                                                  _upper;
             int                                                  _lower;
             std::string                                          _type;
-            MultipleSyncCond<LessOrEqualConditionChecker<int> > *_syncCond;
-            ntask_getter_t                                       _get_num_tasks;
+            MultipleSyncCond<CounterLessOrEqualConditionChecker> *_syncCond;
+            ShardedCounter                                      *_counter;
 
             HysteresisThrottle ( const HysteresisThrottle & );
             const HysteresisThrottle & operator= ( const HysteresisThrottle & );
@@ -47,16 +43,17 @@ namespace nanos {
             :  _upper( upper * sys.getNumThreads() ),
                _lower( lower * sys.getNumThreads() ),
                _type ( type ),
-               _syncCond( NULL )
+               _syncCond( NULL ),
+               _counter( NULL )
             {
                if ( _type == "total" ) {
-                  _syncCond = (MultipleSyncCond< LessOrEqualConditionChecker<int> >*) new MultipleSyncCond< LessOrEqualConditionChecker<int> >(LessOrEqualConditionChecker<int>(sys.getSchedulerStats().getTotalTasksAddr(), lower * sys.getNumThreads())) ;
-                  _get_num_tasks = &get_total_tasks;
+                  _counter = &sys.getSchedulerStats().getTotalTasksCounter();
                } else if ( _type == "ready" ) {
-                  _syncCond = (MultipleSyncCond< LessOrEqualConditionChecker<int> >*) new MultipleSyncCond< LessOrEqualConditionChecker<int> >(LessOrEqualConditionChecker<int>(sys.getSchedulerStats().getReadyTasksAddr(), lower * sys.getNumThreads())) ;
-                  _get_num_tasks = &get_ready_tasks;
+                  _counter = &sys.getSchedulerStats().getReadyTasksCounter();
                } else fatal0("Unknow throttle type");
 
+               _syncCond = new MultipleSyncCond< CounterLessOrEqualConditionChecker >(CounterLessOrEqualConditionChecker(_counter, lower * sys.getNumThreads())) ;
+
                verbose0( "Throttle hysteresis created");
                verbose0( "   type of tasks: " << _type );
                verbose0( "   lower bound: " << lower * sys.getNumThreads() );
@@ -79,12 +76,13 @@ namespace nanos {
          // If it's OpenMP, first level tasks will have depth 1
          unsigned maxDepth = ( sys.getPMInterface().getInterface() == PMInterface::OpenMP ) ? 2 : 1;
          // Only dealing with first level tasks
-         if ( ( (myThread->getCurrentWD())->getDepth() < maxDepth ) && ( _get_num_tasks() > _upper ) ) _syncCond->wait();
+         if ( ( (myThread->getCurrentWD())->getDepth() < maxDepth ) && ( _counter->approximate() > _upper ) ) _syncCond->wait();
          return true;
       }
       void HysteresisThrottle::throttleOut ( void )
       {
-         if ( _get_num_tasks() <= _lower ) _syncCond->signal();
+         // The cheap read may be off by a few tasks, the condition checks the exact value
+         if ( _counter->approximate() <= _lower + _counter->skew() ) _syncCond->signal();
       }
 
       class HysteresisThrottlePlugin : public Plugin
@@ -52,7 +52,7 @@ namespace nanos {
 
       bool NumTasksThrottle::throttleIn()
       {
-         if ( sys.getTaskNum() > _limit*sys.getNumWorkers() ) {
+         if ( sys.getApproxTaskNum() > _limit*sys.getNumWorkers() ) {
             return false;
          }
 
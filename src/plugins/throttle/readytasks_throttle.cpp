@@ -52,7 +52,7 @@ namespace nanos {
       bool ReadyTasksThrottle::throttleIn()
       {
          //checking if the number of ready tasks is higher than the allowed maximum
-         if ( sys.getReadyNum() > _limit )  {
+         if ( sys.getApproxReadyNum() > _limit )  {
             verbose0( "Throttle Policy: avoiding task creation!" );
             return false;
          }
@@ -20,44 +20,54 @@
 #include "omp.h"
 #include "nanos.h"
 #include "atomic.hpp"
-#include "lock.hpp"
+#include "queuelock.hpp"
 
-extern "C"
+using namespace nanos;
+
+//! \brief Returns the queue lock of an omp_lock_t, allocating it if the lock was only zeroed
+static QueueLock & getQueueLock ( omp_lock_t *arg )
 {
-   using namespace nanos;
+   QueueLock *lock = (QueueLock *) *arg;
+   if ( lock != NULL ) return *lock;
+
+   lock = NEW QueueLock();
+   if ( !__sync_bool_compare_and_swap( arg, (omp_lock_t) NULL, (omp_lock_t) lock ) ) {
+      delete lock;
+      lock = (QueueLock *) *arg;
+   }
+   return *lock;
+}
 
+extern "C"
+{
    NANOS_API_DEF(void, omp_init_lock, ( omp_lock_t *arg ))
    {
-      // NOTE: This assumes Lock is the same size than Void * so nothing has to be allocated
-      Lock *lock = (Lock *) arg;
-
-      new (lock) Lock;
+      *arg = (omp_lock_t) NEW QueueLock();
    }
 
    NANOS_API_DEF(void, omp_destroy_lock, ( omp_lock_t *arg ))
    {
+      delete (QueueLock *) *arg;
+      *arg = NULL;
    }
 
    NANOS_API_DEF(void, omp_set_lock, ( omp_lock_t *arg ))
    {
-      Lock &lock = *(Lock *) arg;
-      lock++;
+      getQueueLock( arg ).acquire();
    }
 
    NANOS_API_DEF(void, omp_unset_lock,( omp_lock_t *arg ))
    {
-      Lock &lock = *(Lock *) arg;
-      lock--;
+      getQueueLock( arg ).release();
    }
 
    NANOS_API_DEF(int, omp_test_lock ,( omp_lock_t *arg ))
    {
-      Lock &lock = *(Lock *) arg;
-      return lock.tryAcquire();
+      return getQueueLock( arg ).tryAcquire();
    }
 
    struct __omp_nest_lock {
-      Lock lock;
+      QueueLock lock;
       nanos_wd_t owner;
       short count;
    };
@@ -85,7 +95,7 @@ extern "C"
          // count >=1 is assumed because only the owner can set it
          nlock->count++;
       } else {
-         nlock->lock++;
+         nlock->lock.acquire();
          // count == 0 is assumed because we just acquired the lock
          nlock->owner = nanos_current_wd();
          nlock->count++;
@@ -100,7 +110,7 @@ extern "C"
       nlock->count--;
       if ( nlock->count == 0 ) {
          nlock->owner = NULL;
-         nlock->lock--;
+         nlock->lock.release();
       }
    }
 
@@ -16,9 +16,10 @@
 /*      You should have received a copy of the GNU Lesser General Public License     */
 /*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
 /*************************************************************************************/
-
 #include "allocator.hpp"
 #include "basethread.hpp"
+#include "atomic.hpp"
+#include "lock.hpp"
 
 using namespace nanos;
 
@@ -26,6 +27,12 @@ Allocator *nanos::allocator;
 
 size_t Allocator::_headerSize = NANOS_ALIGNED_MEMORY_OFFSET( 0, sizeof(Allocator::ObjectHeader), 16 );
 
+Allocator::Stats Allocator::_retiredStats;
+
+Allocator::RemoteLists *Allocator::_orphans = NULL;
+
+static Lock retiredStatsLock;
+
 Allocator & nanos::getAllocator ( void )
 {
    if (!allocator) {
@@ -39,24 +46,100 @@ Allocator & nanos::getAllocator ( void )
    else return my_thread->getAllocator();
 }
 
-void * Allocator::Arena::allocate ( void )
+Allocator::Allocator ( )
 {
-   unsigned int obj;
+   memset( _classes, 0, sizeof(_classes) );
+   memset( &_stats, 0, sizeof(_stats) );
+   _remote = (RemoteLists *) malloc( sizeof(RemoteLists) );
+   if ( _remote == NULL ) throw( NANOS_ENOMEM );
+   memset( _remote, 0, sizeof(RemoteLists) );
+}
 
-   if ( !_free ) return NULL;
+Allocator::~Allocator ()
+{
+   // From now on every free of our objects is remote, and lands in lists that are kept
+   for ( size_t i = 0; i < NUM_CLASSES; i++ ) {
+      for ( Arena *arena = _classes[i]._arenas; arena != NULL; arena = arena->getNext() ) arena->orphan();
+   }
+   memoryFence();
 
-   for ( obj = 0 ; obj < numObjects ; obj++ ) {
-      if ( _bitmap[obj]._bit ) break;
+   // Account for the remote frees which were never taken back
+   for ( size_t i = 0; i < NUM_CLASSES; i++ ) {
+      size_t objectSize = (size_t) 1 << ( i + MIN_CLASS_SHIFT );
+      FreeObject *list;
+      do {
+         list = _remote->_lists[i];
+      } while ( !compareAndSwap( &_remote->_lists[i], list, (FreeObject *) NULL ) );
+      for ( FreeObject *it = list; it != NULL; it = it->_next ) {
+         _stats._remoteFrees++;
+         _stats._bytesInUse -= objectSize;
+      }
    }
 
-   if (obj == numObjects) {
-      _free = false;
-      return NULL; 
+   LockBlock lock( retiredStatsLock );
+   _remote->_nextOrphan = _orphans;
+   _orphans = _remote;
+   _retiredStats._bytesInUse += _stats._bytesInUse;
+   _retiredStats._peakBytesInUse += _stats._peakBytesInUse;
+   _retiredStats._arenas += _stats._arenas;
+   _retiredStats._localFrees += _stats._localFrees;
+   _retiredStats._remoteFrees += _stats._remoteFrees;
+}
+
+void * Allocator::refill ( size_t sizeClass )
+{
+   SizeClass &sc = _classes[sizeClass];
+   size_t objectSize = (size_t) 1 << ( sizeClass + MIN_CLASS_SHIFT );
+
+   // Take back all the objects freed by other threads
+   if ( _remote->_lists[sizeClass] != NULL ) {
+      FreeObject *list;
+      do {
+         list = _remote->_lists[sizeClass];
+      } while ( !compareAndSwap( &_remote->_lists[sizeClass], list, (FreeObject *) NULL ) );
+
+      size_t count = 1;
+      for ( FreeObject *it = list->_next; it != NULL; it = it->_next ) count++;
+      _stats._remoteFrees += count;
+      _stats._bytesInUse -= count * objectSize;
+
+      sc._free = list->_next;
+      return (void *) list;
    }
 
-   _bitmap[obj]._bit = false;
+   void *obj = sc._arenas != NULL ? sc._arenas->carve() : NULL;
+   if ( obj == NULL ) {
+      size_t numObjects = _arenaSize / objectSize;
+      if ( numObjects == 0 ) numObjects = 1;
+      size_t arenaHeader = NANOS_ALIGNED_MEMORY_OFFSET( 0, sizeof(Arena), 16 );
+
+      char *mem = (char *) malloc( arenaHeader + objectSize * numObjects );
+      if ( mem == NULL ) throw( NANOS_ENOMEM );
+      sc._arenas = new ( mem ) Arena( this, _remote, sizeClass, objectSize, numObjects, mem + arenaHeader, sc._arenas );
+      _stats._arenas++;
+
+      obj = sc._arenas->carve();
+   }
 
-   return (void *) &_arena[obj*_objectSize];
+   ( (ObjectHeader *) obj )->_arena = sc._arenas;
+   return obj;
 }
 
+void Allocator::deallocateRemote ( Arena *arena, FreeObject *object )
+{
+   FreeObject * volatile *head = arena->getRemoteList();
+   FreeObject *old;
+
+   // Only the owner pops, and it always takes the whole list, so there is no ABA.
+   // Once the owner is destroyed nobody pops, the objects just stay in the list
+   do {
+      old = *head;
+      object->_next = old;
+   } while ( !compareAndSwap( head, old, object ) );
+}
 
+Allocator::Stats Allocator::getRetiredStats ( void )
+{
+   LockBlock lock( retiredStatsLock );
+   return _retiredStats;
+}
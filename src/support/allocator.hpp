@@ -34,17 +34,30 @@ inline size_t Allocator::Arena::getObjectSize () const
    return _objectSize;
 }
 
-inline void Allocator::Arena::deallocate ( void *object )
+inline size_t Allocator::Arena::getSizeClass () const
 {
-   unsigned long offset = ((char *) object - _arena);
-   unsigned long index = offset / _objectSize;
+   return _sizeClass;
+}
 
-   //if (sys.getNetwork()->getNodeNum() == 0 && _objectSize > 32768) std::cerr << "Free object size " << _objectSize << " : " << (void *) _objectSize << " addr range is " << (void *) object << ":" << ((void *) (((char*)object)+_objectSize)) << " this is arena " << (void*) this << std::endl;
-   _free = true;
-   _bitmap[index]._bit = true;
+inline Allocator * Allocator::Arena::getOwner () const
+{
+   return _owner;
+}
 
-   //if (sys.getNetwork()->getNodeNum() == 0 && _objectSize > 32768) std::cerr << "memset from " << (void *) &_arena[index*_objectSize] << " to " << (void*) (&_arena[index*_objectSize+_objectSize]) << std::endl;
-   //memset( &_arena[index*_objectSize], 0, _objectSize );
+inline void Allocator::Arena::orphan ( void )
+{
+   _owner = NULL;
+}
+
+inline Allocator::FreeObject * volatile * Allocator::Arena::getRemoteList ( void ) const
+{
+   return &_remote->_lists[_sizeClass];
+}
+
+inline void * Allocator::Arena::carve ( void )
+{
+   if ( _carved == _numObjects ) return NULL;
+   return (void *) &_arena[_objectSize * _carved++];
 }
 
 inline Allocator::Arena * Allocator::Arena::getNext ( void ) const
@@ -52,9 +65,11 @@ inline Allocator::Arena * Allocator::Arena::getNext ( void ) const
    return _next;
 }
 
-inline void Allocator::Arena::setNext ( Arena * a )
+inline size_t Allocator::getSizeClass ( size_t size )
 {
-   _next = a;
+   if ( size <= ( (size_t) 1 << MIN_CLASS_SHIFT ) ) return 0;
+   /* position of the most significant bit of (size - 1), i.e. log2 of size's next power of 2 */
+   return ( sizeof(unsigned long) * 8 - __builtin_clzl( (unsigned long) size - 1 ) ) - MIN_CLASS_SHIFT;
 }
 
 inline void * Allocator::allocateBigObject ( size_t size )
@@ -72,52 +87,18 @@ inline void * Allocator::allocate ( size_t size, const char* file, int line )
 {
    if ( size > _sizeOfBig ) return allocateBigObject(size);
 
-   /* realSize is (size + header )'s next power of 2 */
-   size_t realSize = size + _headerSize + 1;
-   realSize |= realSize >> 1;
-   realSize |= realSize >> 2;
-   realSize |= realSize >> 4;
-   realSize |= realSize >> 8;
-   realSize |= realSize >> 16;
-   realSize++;
- 
-
-   ArenaCollection::iterator it;
-   for ( it = _arenas.begin(); it != _arenas.end(); it++ ) {
-      if ( (*it)->getObjectSize() == realSize ) break;
-   }
-
-   Arena *arena = NULL;
+   size_t sizeClass = getSizeClass( size + _headerSize );
+   SizeClass &sc = _classes[sizeClass];
 
-   if ( it == _arenas.end() ) {
-      // no arena found for that size, create a new one
-      arena = (Arena *) malloc ( sizeof(Arena) );
-      if ( arena == NULL ) throw(NANOS_ENOMEM);
-      new ( arena ) Arena( realSize );
-      _arenas.push_back( arena );
-   }
-   else arena = *it;
+   FreeObject *obj = sc._free;
+   if ( obj != NULL ) sc._free = obj->_next;
+   else obj = (FreeObject *) refill( sizeClass );
 
+   _stats._bytesInUse += (size_t) 1 << ( sizeClass + MIN_CLASS_SHIFT );
+   if ( _stats._bytesInUse > _stats._peakBytesInUse ) _stats._peakBytesInUse = _stats._bytesInUse;
 
-   ObjectHeader * ptr = NULL;
-
-   while ( ptr == NULL ) {
-      ptr = (ObjectHeader *) arena->allocate();
-      if ( ptr == NULL ) { 
-          if ( arena->getNext() == NULL ) {
-             Arena *next = ( Arena *) malloc ( sizeof(Arena) );
-             if ( next == NULL ) throw(NANOS_ENOMEM);
-             new (next) Arena(realSize);
-             arena->setNext( next );
-          }
-          arena = arena->getNext(); 
-      }
-   }
-
-   ptr->_arena = arena;
-   //if (sys.getNetwork()->getNodeNum() == 0 && realSize > 32768) std::cerr << "Allocate object size " << realSize << " : " << (void *) realSize << " addr range is " << (void *) ptr << ":" << ((void *) (((char*)ptr)+realSize)) << " this is arena " << (void *) arena << std::endl;
-
-   return  ((char *) ptr ) + _headerSize;
+   // The header (Arena) of a free object is kept, so there is nothing to set here
+   return  ((char *) obj ) + _headerSize;
 }
 
 inline void Allocator::deallocate ( void *object, const char *file, int line )
@@ -129,10 +110,23 @@ inline void Allocator::deallocate ( void *object, const char *file, int line )
    Arena *arena = ptr->_arena;
 
    // If there is no arena then it was a big object that just needs to be freed
-   if ( arena == NULL )
+   if ( arena == NULL ) {
      free(ptr);
-   else
-     arena->deallocate(ptr);
+     return;
+   }
+
+   FreeObject *obj = (FreeObject *) ptr;
+   Allocator *owner = arena->getOwner();
+
+   if ( owner == &getAllocator() ) {
+      SizeClass &sc = owner->_classes[arena->getSizeClass()];
+      obj->_next = sc._free;
+      sc._free = obj;
+      owner->_stats._bytesInUse -= arena->getObjectSize();
+      owner->_stats._localFrees++;
+   } else {
+      deallocateRemote( arena, obj );
+   }
 }
 
 inline size_t Allocator::getObjectSize ( void *object )
@@ -142,6 +136,11 @@ inline size_t Allocator::getObjectSize ( void *object )
    return arena->getObjectSize() - _headerSize ;
 }
 
+inline const Allocator::Stats & Allocator::getStats ( void ) const
+{
+   return _stats;
+}
+
 } // namespace nanos
 
 #endif
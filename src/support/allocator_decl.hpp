@@ -85,27 +85,56 @@ class InternalAllocator
        inline void destroy( pointer p ) { p->~T(); }
 };
 /*! \class Allocator
+ *
+ *  Per thread allocator. Objects are grouped in power of two size classes,
+ *  each class keeps an intrusive list of free objects (the list pointer is
+ *  stored in the free object itself) and the Arena currently being carved,
+ *  so allocate and deallocate are O(1).
+ *
+ *  Objects freed by a thread which is not the owner of the Allocator are
+ *  pushed (lock-free) to a per class remote list of the owner, which takes
+ *  the whole list back when its own free list runs out.
+ *
+ *  The remote lists live apart from the Allocator, with its Arenas. When the
+ *  Allocator is destroyed its Arenas are orphaned (they have no owner any
+ *  more) and kept, with their remote lists, in a global list, so objects
+ *  can still be freed after their owner thread is gone.
  */
 class Allocator
 {
+   public:
+      /*! \brief Allocator statistics */
+      struct Stats {
+         size_t         _bytesInUse;         /**< Bytes currently allocated (arena objects, headers included) */
+         size_t         _peakBytesInUse;     /**< Maximum of _bytesInUse */
+         size_t         _arenas;             /**< Number of Arenas created */
+         size_t         _localFrees;         /**< Objects freed by the owner thread */
+         size_t         _remoteFrees;        /**< Objects freed by other threads */
+      };
    private:
+      enum { MIN_CLASS_SHIFT = 5, NUM_CLASSES = 20 };
+
+      struct FreeObject;
+
+      /*! \brief Lists of objects freed by threads other than the owner, one per size class */
+      struct RemoteLists {
+         FreeObject * volatile   _lists[NUM_CLASSES];      /**< One per size class */
+         RemoteLists            *_nextOrphan;              /**< Next remote lists of a destroyed Allocator */
+      };
+
      /*! \class Arena
       */
       class Arena
       {
          private: /* Arena data members and disabled constructors */
-            static const size_t numObjects = NANOS_OBJECTS_PER_ARENA;      /** Number of maximum objects allocated in this arena*/
-
-            union bitmap_entry {
-               bool             _bit;
-               char             pad[NANOS_CACHELINE];
-            };                                         /**< bitmap_entry struct */
-
+            Allocator * volatile _owner;              /**< Allocator owning this Arena, NULL once it is destroyed */
+            RemoteLists      *_remote;                /**< Where other threads free the objects of this Arena */
+            size_t            _sizeClass;             /**< Size class of the objects */
             size_t            _objectSize;            /**< Object size in current Arena  */
+            size_t            _numObjects;            /**< Number of objects in current Arena */
+            size_t            _carved;                /**< Objects already handed out at least once */
             char             *_arena;                 /**< Memory region used by Arena */
-            bitmap_entry     *_bitmap;                /**< Bit map (free/busy) */
             Arena            *_next;                  /**< Next Arena in the list */
-            bool              _free;                  /**< Are there free entries */
             /*! \brief Arena copy constructor (disabled)
              */
             Arena ( const Arena &a );
@@ -116,38 +145,35 @@ class Allocator
             */
             Arena ();
          public: /* Arena method members */
-           /*! \brief Arena constructor
+           /*! \brief Arena constructor, memory is allocated by the caller just after the Arena
             */
-            Arena ( size_t objectSize ) : _objectSize(objectSize), _next (NULL), _free(true)
-            {
-               _arena = (char *) malloc( (objectSize + sizeof(bitmap_entry) ) * numObjects );
-               if ( _arena == NULL ) throw ( NANOS_ENOMEM );
-               _bitmap = (bitmap_entry *) (_arena + objectSize * numObjects);
-               for ( size_t i = 0; i < numObjects; i++ ) _bitmap[i]._bit = true;
-            }
+            Arena ( Allocator *owner, RemoteLists *remote, size_t sizeClass, size_t objectSize, size_t numObjects, char *arena, Arena *next )
+               : _owner( owner ), _remote( remote ), _sizeClass( sizeClass ), _objectSize( objectSize ), _numObjects( numObjects ),
+                 _carved( 0 ), _arena( arena ), _next( next ) {}
            /*! \brief Arena destructor
             */
-            ~Arena ()
-            {
-               delete _next;
-               free(_arena);
-               free(_bitmap);
-            }
+            ~Arena () {}
            /*! \brief Returns the size of allocated object
             */
             size_t getObjectSize ( void ) const ; 
-           /*! \brief Returns a free object address (and mark it as busy)
+           /*! \brief Returns the size class of allocated objects
             */
-            void * allocate ( void ) ;
-           /*! \brief Mark 'object' as free
+            size_t getSizeClass ( void ) const ;
+           /*! \brief Returns the Allocator which owns the Arena
             */
-            void deallocate ( void *object ) ;
+            Allocator * getOwner ( void ) const ;
+           /*! \brief Leaves the Arena without owner, its objects are then always freed remotely
+            */
+            void orphan ( void ) ;
+           /*! \brief Returns the remote free list of the Arena's size class
+            */
+            FreeObject * volatile * getRemoteList ( void ) const ;
+           /*! \brief Returns a never used object, or NULL when the Arena is exhausted
+            */
+            void * carve ( void ) ;
            /*! \brief Returns next Arena object in the list
             */
             Arena * getNext ( void ) const;
-           /*! \brief Set as next Arena object 'a'
-            */
-            void setNext ( Arena * a );
       };
       template<typename T>
       struct InternalCollection {
@@ -158,13 +184,31 @@ class Allocator
          Arena     *_arena;
       };
 
-   private: /* Allocator data members */
-      typedef InternalCollection<Arena *>::type  ArenaCollection;
+      /*! \brief Overlays a free object: the header keeps its Arena and the
+       *  list pointer uses the header padding (_headerSize is 16 bytes)
+       */
+      struct FreeObject {
+         ObjectHeader   _header;
+         FreeObject    *_next;
+      };
+
+      /*! \brief Owner-only data of a size class */
+      struct SizeClass {
+         FreeObject    *_free;                 /**< Free objects */
+         Arena         *_arenas;               /**< Arenas of the class, the first one is being carved */
+      };
 
-      ArenaCollection               _arenas;      /**< Vector of Arenas in Allocator*/
+   private: /* Allocator data members */
+      SizeClass                     _classes[NUM_CLASSES];      /**< Size classes, accessed by the owner only */
+      Stats                         _stats;                     /**< Allocator statistics, updated by the owner only */
+      RemoteLists                  *_remote;                    /**< Objects freed by other threads, outlives the Allocator */
       static size_t                 _headerSize;  /**< Size of ObjectHeader */
 
       static const size_t                  _sizeOfBig = 1024*1024*10;
+      static const size_t                  _arenaSize = 1024*1024;  /**< Target size of an Arena */
+
+      static Stats                  _retiredStats;  /**< Statistics of destroyed Allocators */
+      static RemoteLists           *_orphans;       /**< Remote lists of destroyed Allocators, kept with their Arenas */
 
      /*! \brief Allocator copy constructor (disabled)
       */
@@ -177,20 +221,31 @@ class Allocator
      /*! \brief Alternative allocation method for big objects */
       void * allocateBigObject ( size_t size ); 
 
+     /*! \brief Returns the size class for objects of 'size' bytes (header included) */
+      static size_t getSizeClass ( size_t size );
+
+     /*! \brief Allocation slow path: takes back remote frees or carves a (new) Arena */
+      void * refill ( size_t sizeClass );
+
+     /*! \brief Pushes 'object' in the remote list of its Arena */
+      static void deallocateRemote ( Arena *arena, FreeObject *object );
+
    public: /* Allocator method members */
     /*! \brief Allocator default constructor 
      */
-     Allocator ( ) : _arenas() {}
-    /*! \brief Allocator destructor 
+     Allocator ( );
+    /*! \brief Allocator destructor
+     *
+     *  Arenas are not released, objects may outlive the Allocator which created them:
+     *  they are orphaned and objects freed afterwards go to their remote lists.
      */
-     ~Allocator () { }
+     ~Allocator ();
     /*! \brief Allocates 'size' bytes in memory and returns memory pointer
      *
-     *  This function will check in his list of Arenas looking for one who
-     *  stores objects of the given 'size'. If Allocator finds an Arena region
-     *  with this 'size' will ask to it for a new object. If none of the current
-     *  Arenas works with the given 'size' Allocator will create a new Arena entry
-     *  in order to manage this (and future) objects of the given 'size'.
+     *  The object is taken from the free list of the size class of 'size'.
+     *  If the list is empty the objects freed by other threads are taken back
+     *  and, if there are none, a new object is carved from the current Arena
+     *  of the class (creating a new Arena when needed).
      */
      void * allocate ( size_t size, const char *file = NULL, int line = 0 ) ;
     /*! \brief Deallocates 'object' (object has a header which identifies related Arena
@@ -199,6 +254,16 @@ class Allocator
     /*! \brief Get 'object' size for a given pointer
      */
      static size_t getObjectSize ( void *object ) ;
+    /*! \brief Returns the statistics of this Allocator
+     */
+     const Stats & getStats ( void ) const ;
+    /*! \brief Returns the statistics of all the destroyed Allocators
+     *
+     *  Statistics are accumulated when an Allocator is destroyed, so _peakBytesInUse
+     *  is the sum of the peaks of every Allocator, an upper bound of the real peak.
+     *  Objects freed after their Allocator was destroyed are not accounted.
+     */
+     static Stats getRetiredStats ( void ) ;
 };
 
 
@@ -208,4 +273,3 @@ Allocator & getAllocator ( void );
 } // namespace nanos
 
 #endif
-
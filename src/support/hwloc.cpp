@@ -150,6 +150,24 @@ void Hwloc::getNumSockets(unsigned int &allowedNodes, int &numSockets, unsigned
 #endif
 }
 
+void Hwloc::getCpuLocality( unsigned int cpu, unsigned int &core, unsigned int &cache ) const
+{
+   core = cpu;
+   cache = cpu;
+#ifdef HWLOC
+   hwloc_obj_t pu = hwloc_get_pu_obj_by_os_index( _hwlocTopology, cpu );
+   if ( pu == NULL ) return;
+
+   hwloc_obj_t coreObj = hwloc_get_ancestor_obj_by_type( _hwlocTopology, HWLOC_OBJ_CORE, pu );
+   if ( coreObj == NULL ) coreObj = pu;
+   core = hwloc_bitmap_first( coreObj->cpuset );
+
+   // First cache above the core that covers more CPUs than the core itself
+   hwloc_obj_t cacheObj = hwloc_get_shared_cache_covering_obj( _hwlocTopology, coreObj );
+   cache = ( cacheObj != NULL ) ? hwloc_bitmap_first( cacheObj->cpuset ) : core;
+#endif
+}
+
 unsigned int Hwloc::getNumaNodeOfGpu( unsigned int gpu ) {
    unsigned int node = 0;
 #ifdef GPU_DEV
@@ -174,4 +192,36 @@ bool Hwloc::isCpuAvailable( unsigned int cpu ) const
    return hwloc_get_pu_obj_by_os_index( _hwlocTopology, cpu ) != NULL;
 #endif
 }
+
+bool Hwloc::bindMemory( void *addr, size_t len, unsigned int node ) const
+{
+#ifdef HWLOC
+   hwloc_obj_t numaNode = hwloc_get_numanode_obj_by_os_index( _hwlocTopology, node );
+   if ( numaNode == NULL ) return false;
+
+   return hwloc_set_area_membind( _hwlocTopology, addr, len, numaNode->nodeset,
+         HWLOC_MEMBIND_BIND, HWLOC_MEMBIND_MIGRATE | HWLOC_MEMBIND_BYNODESET ) == 0;
+#else
+   return false;
+#endif
+}
+
+bool Hwloc::interleaveMemory( void *addr, size_t len, const std::vector<unsigned int> &nodes ) const
+{
+#ifdef HWLOC
+   hwloc_nodeset_t nodeset = hwloc_bitmap_alloc();
+   for ( std::vector<unsigned int>::const_iterator it = nodes.begin(); it != nodes.end(); ++it ) {
+      hwloc_bitmap_set( nodeset, *it );
+   }
+
+   int res = hwloc_set_area_membind( _hwlocTopology, addr, len, nodeset,
+         HWLOC_MEMBIND_INTERLEAVE, HWLOC_MEMBIND_MIGRATE | HWLOC_MEMBIND_BYNODESET );
+   hwloc_bitmap_free( nodeset );
+
+   return res == 0;
+#else
+   return false;
+#endif
+}
+
 }
@@ -23,6 +23,7 @@
 
 #include <config.hpp>
 #include <string>
+#include <vector>
 
 #ifdef HWLOC
 #include <hwloc.h>
@@ -52,6 +53,17 @@ class Hwloc {
       unsigned int getNumaNodeOfGpu( unsigned int gpu );
       void getNumSockets(unsigned int &allowedNodes, int &numSockets, unsigned int &hwThreads);
 
+      /*!
+       * \brief Finds the core of a CPU and the closest cache it shares with other cores.
+       * Both are identified by the OS index of their first CPU. If hwloc is not
+       * available, or has no info on that CPU, both are the CPU itself.
+       *
+       * @param cpu OS CPU index.
+       * @param core First CPU of the core, SMT siblings share it.
+       * @param cache First CPU of the shared cache (usually the L3).
+       */
+      void getCpuLocality( unsigned int cpu, unsigned int &core, unsigned int &cache ) const;
+
       /*!
        * \brief Checks if we can see the CPU, to create the PE.
        * If hwloc has no info on that CPU, we should not continue creating
@@ -63,6 +75,28 @@ class Hwloc {
        */
       bool isCpuAvailable( unsigned int cpu ) const;
 
+      /*!
+       * \brief Binds the pages of a memory area to a NUMA node.
+       * Pages already touched are migrated (mbind with MPOL_MF_MOVE, or
+       * move_pages, depending on what hwloc uses in this system).
+       *
+       * @param addr Start of the area, page aligned.
+       * @param len Length of the area in bytes.
+       * @param node OS index of the NUMA node.
+       * \return false if hwloc is not available or the binding failed.
+       */
+      bool bindMemory( void *addr, size_t len, unsigned int node ) const;
+
+      /*!
+       * \brief Interleaves the pages of a memory area across NUMA nodes.
+       *
+       * @param addr Start of the area, page aligned.
+       * @param len Length of the area in bytes.
+       * @param nodes OS indexes of the NUMA nodes.
+       * \return false if hwloc is not available or the binding failed.
+       */
+      bool interleaveMemory( void *addr, size_t len, const std::vector<unsigned int> &nodes ) const;
+
 };
 
 } // namespace nanos
@@ -0,0 +1,254 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_INTERVAL_TREE
+#define _NANOS_INTERVAL_TREE
+
+#include "intervaltree_decl.hpp"
+#include "new_decl.hpp"
+#include "debug.hpp"
+#include <new>
+
+namespace nanos {
+
+template <typename T>
+IntervalTree<T>::~IntervalTree ()
+{
+   destroy( _root );
+   for ( std::vector<char *>::iterator it = _chunks.begin(); it != _chunks.end(); it++ ) {
+      delete[] *it;
+   }
+}
+
+template <typename T>
+typename IntervalTree<T>::Node * IntervalTree<T>::allocateNode ( uintptr_t start, uintptr_t end )
+{
+   if ( _freeNodes == NULL ) {
+      char *chunk = NEW char[ sizeof( Node ) * _chunkSize ];
+      _chunks.push_back( chunk );
+      for ( size_t i = 0; i < _chunkSize; i++ ) {
+         Node *slot = ( Node * ) ( chunk + i * sizeof( Node ) );
+         slot->_right = _freeNodes;
+         _freeNodes = slot;
+      }
+   }
+   Node *node = _freeNodes;
+   _freeNodes = node->_right;
+   return new ( node ) Node( start, end );
+}
+
+template <typename T>
+void IntervalTree<T>::releaseNode ( Node *node )
+{
+   node->~Node();
+   node->_right = _freeNodes;
+   _freeNodes = node;
+}
+
+template <typename T>
+void IntervalTree<T>::update ( Node *node )
+{
+   int lh = height( node->_left );
+   int rh = height( node->_right );
+   node->_height = 1 + ( lh > rh ? lh : rh );
+
+   node->_maxEnd = node->_end;
+   if ( node->_left != NULL && node->_left->_maxEnd > node->_maxEnd ) node->_maxEnd = node->_left->_maxEnd;
+   if ( node->_right != NULL && node->_right->_maxEnd > node->_maxEnd ) node->_maxEnd = node->_right->_maxEnd;
+}
+
+template <typename T>
+typename IntervalTree<T>::Node * IntervalTree<T>::rotateLeft ( Node *node )
+{
+   Node *right = node->_right;
+   node->_right = right->_left;
+   right->_left = node;
+   update( node );
+   update( right );
+   return right;
+}
+
+template <typename T>
+typename IntervalTree<T>::Node * IntervalTree<T>::rotateRight ( Node *node )
+{
+   Node *left = node->_left;
+   node->_left = left->_right;
+   left->_right = node;
+   update( node );
+   update( left );
+   return left;
+}
+
+template <typename T>
+typename IntervalTree<T>::Node * IntervalTree<T>::rebalance ( Node *node )
+{
+   update( node );
+   int balance = height( node->_left ) - height( node->_right );
+   if ( balance > 1 ) {
+      if ( height( node->_left->_left ) < height( node->_left->_right ) ) {
+         node->_left = rotateLeft( node->_left );
+      }
+      return rotateRight( node );
+   }
+   if ( balance < -1 ) {
+      if ( height( node->_right->_right ) < height( node->_right->_left ) ) {
+         node->_right = rotateRight( node->_right );
+      }
+      return rotateLeft( node );
+   }
+   return node;
+}
+
+template <typename T>
+typename IntervalTree<T>::Node * IntervalTree<T>::detachMin ( Node *node, Node *&min )
+{
+   if ( node->_left == NULL ) {
+      min = node;
+      return node->_right;
+   }
+   node->_left = detachMin( node->_left, min );
+   return rebalance( node );
+}
+
+template <typename T>
+typename IntervalTree<T>::Node * IntervalTree<T>::insert ( Node *node, uintptr_t start, uintptr_t end, Node *&result )
+{
+   if ( node == NULL ) {
+      result = allocateNode( start, end );
+      _size++;
+      return result;
+   }
+   if ( less( start, end, node ) ) {
+      node->_left = insert( node->_left, start, end, result );
+   } else if ( start != node->_start || end != node->_end ) {
+      node->_right = insert( node->_right, start, end, result );
+   } else {
+      result = node;
+      return node;
+   }
+   return rebalance( node );
+}
+
+template <typename T>
+typename IntervalTree<T>::Node * IntervalTree<T>::erase ( Node *node, uintptr_t start, uintptr_t end, bool &found )
+{
+   if ( node == NULL ) return NULL;
+
+   if ( less( start, end, node ) ) {
+      node->_left = erase( node->_left, start, end, found );
+   } else if ( start != node->_start || end != node->_end ) {
+      node->_right = erase( node->_right, start, end, found );
+   } else {
+      found = true;
+      Node *left = node->_left;
+      Node *right = node->_right;
+      releaseNode( node );
+      _size--;
+
+      if ( right == NULL ) return left;
+
+      // Relink the successor instead of moving values around, so that the
+      // rest of the nodes are left untouched
+      Node *successor;
+      right = detachMin( right, successor );
+      successor->_left = left;
+      successor->_right = right;
+      return rebalance( successor );
+   }
+   return rebalance( node );
+}
+
+template <typename T>
+size_t IntervalTree<T>::findOverlapping ( Node *node, uintptr_t start, uintptr_t end, Node **buffer, size_t capacity, size_t found )
+{
+   // No interval in this subtree reaches start
+   if ( node == NULL || node->_maxEnd <= start ) return found;
+
+   found = findOverlapping( node->_left, start, end, buffer, capacity, found );
+
+   // Neither this node nor its right subtree begin before end
+   if ( node->_start >= end ) return found;
+
+   if ( start < node->_end ) {
+      if ( found < capacity ) buffer[found] = node;
+      found++;
+   }
+   return findOverlapping( node->_right, start, end, buffer, capacity, found );
+}
+
+template <typename T>
+void IntervalTree<T>::destroy ( Node *node )
+{
+   if ( node == NULL ) return;
+   destroy( node->_left );
+   destroy( node->_right );
+   releaseNode( node );
+}
+
+template <typename T>
+typename IntervalTree<T>::Node * IntervalTree<T>::find ( uintptr_t start, uintptr_t end ) const
+{
+   Node *node = _root;
+   while ( node != NULL ) {
+      if ( less( start, end, node ) ) {
+         node = node->_left;
+      } else if ( start != node->_start || end != node->_end ) {
+         node = node->_right;
+      } else {
+         return node;
+      }
+   }
+   return NULL;
+}
+
+template <typename T>
+typename IntervalTree<T>::Node * IntervalTree<T>::findOrInsert ( uintptr_t start, uintptr_t end, bool &inserted )
+{
+   size_t size = _size;
+   Node *result = NULL;
+   _root = insert( _root, start, end, result );
+   inserted = _size != size;
+   return result;
+}
+
+template <typename T>
+size_t IntervalTree<T>::findOverlapping ( uintptr_t start, uintptr_t end, Node **buffer, size_t capacity ) const
+{
+   return findOverlapping( _root, start, end, buffer, capacity, 0 );
+}
+
+template <typename T>
+void IntervalTree<T>::erase ( Node *node )
+{
+   bool found = false;
+   _root = erase( _root, node->_start, node->_end, found );
+   ensure( found, "Erasing a node that does not belong to the interval tree" );
+}
+
+template <typename T>
+void IntervalTree<T>::clear ()
+{
+   destroy( _root );
+   _root = NULL;
+   _size = 0;
+}
+
+} // namespace nanos
+
+#endif
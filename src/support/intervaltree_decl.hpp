@@ -0,0 +1,129 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_INTERVAL_TREE_DECL
+#define _NANOS_INTERVAL_TREE_DECL
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace nanos {
+
+   /*! \class IntervalTree
+    *  \brief Index of half-open address intervals [start, end) with overlap queries
+    *
+    *  AVL tree ordered by (start, end) where every node also keeps the greatest end of
+    *  its subtree, so that the intervals overlapping a given one are found in
+    *  O(log n + k). Each distinct interval holds a value of type T.
+    *
+    *  Nodes come from a pool that is never returned to the system until the tree is
+    *  destroyed, and erasing a node never moves the values of the other ones, so Node
+    *  pointers obtained from a query stay valid until that very node is erased.
+    *
+    *  The tree is not thread safe, users must provide their own locking.
+    */
+   template <typename T>
+   class IntervalTree
+   {
+      public:
+         class Node
+         {
+            private:
+               uintptr_t         _start;
+               uintptr_t         _end;
+               uintptr_t         _maxEnd;    /**< Greatest end in the subtree rooted here */
+               int               _height;
+               Node             *_left;
+               Node             *_right;
+               T                 _value;
+
+               friend class IntervalTree<T>;
+
+               Node ( uintptr_t start, uintptr_t end )
+                  : _start( start ), _end( end ), _maxEnd( end ), _height( 1 ), _left( NULL ), _right( NULL ), _value() {}
+
+               Node ( const Node & );
+               const Node & operator= ( const Node & );
+            public:
+               uintptr_t getStart () const { return _start; }
+               uintptr_t getEnd () const { return _end; }
+               T & getValue () { return _value; }
+               const T & getValue () const { return _value; }
+         };
+
+      private:
+         Node                   *_root;
+         size_t                  _size;
+         std::vector<char *>     _chunks;     /**< Storage of the node pool */
+         Node                   *_freeNodes;  /**< Pool free list, linked through _right */
+
+         static const size_t     _chunkSize = 256;
+
+         IntervalTree ( const IntervalTree & );
+         const IntervalTree & operator= ( const IntervalTree & );
+
+         Node * allocateNode ( uintptr_t start, uintptr_t end );
+         void releaseNode ( Node *node );
+
+         static int height ( Node *node ) { return node != NULL ? node->_height : 0; }
+         static bool less ( uintptr_t start, uintptr_t end, Node *node ) { return start < node->_start || ( start == node->_start && end < node->_end ); }
+         static void update ( Node *node );
+         static Node * rotateLeft ( Node *node );
+         static Node * rotateRight ( Node *node );
+         static Node * rebalance ( Node *node );
+         static Node * detachMin ( Node *node, Node *&min );
+
+         Node * insert ( Node *node, uintptr_t start, uintptr_t end, Node *&result );
+         Node * erase ( Node *node, uintptr_t start, uintptr_t end, bool &found );
+         static size_t findOverlapping ( Node *node, uintptr_t start, uintptr_t end, Node **buffer, size_t capacity, size_t found );
+         void destroy ( Node *node );
+
+      public:
+         IntervalTree () : _root( NULL ), _size( 0 ), _chunks(), _freeNodes( NULL ) {}
+         ~IntervalTree ();
+
+         size_t size () const { return _size; }
+         bool empty () const { return _size == 0; }
+
+         /*! \brief Returns the node of exactly [start, end), or NULL */
+         Node * find ( uintptr_t start, uintptr_t end ) const;
+
+         /*! \brief Returns the node of exactly [start, end), creating it if needed
+          *  \param[out] inserted whether the node has just been created
+          */
+         Node * findOrInsert ( uintptr_t start, uintptr_t end, bool &inserted );
+
+         /*! \brief Fills buffer with the nodes that overlap [start, end) in (start, end) order
+          *  \return Number of overlapping nodes, which may exceed capacity. In that case
+          *  only the first capacity ones are stored and the query must be repeated with a
+          *  bigger buffer.
+          */
+         size_t findOverlapping ( uintptr_t start, uintptr_t end, Node **buffer, size_t capacity ) const;
+
+         /*! \brief Removes node from the tree, other nodes are not affected */
+         void erase ( Node *node );
+
+         /*! \brief Removes all the nodes */
+         void clear ();
+   };
+
+} // namespace nanos
+
+#endif
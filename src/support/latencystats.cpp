@@ -0,0 +1,181 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "latencystats.hpp"
+#include "basethread.hpp"
+#include "config.hpp"
+#include "debug.hpp"
+#include "lock.hpp"
+#include <string.h>
+#include <iomanip>
+#include <fstream>
+#include <algorithm>
+
+using namespace nanos;
+
+bool LatencyStats::_enabled = false;
+LatencyStats *LatencyStats::_retired = NULL;
+
+const char * const LatencyStats::_metricNames[LatencyStats::NUM_METRICS] = {
+   "task-creation", "submit-to-start", "dependence-release", "wddeque-lock-wait", "wddeque-lock-hold",
+   "deps-lock-wait", "deps-lock-hold", "barrier-wait"
+};
+
+const char * const LatencyStats::_counterNames[LatencyStats::NUM_COUNTERS] = {
+   "steal-success", "steal-failure"
+};
+
+static Lock retiredStatsLock;
+
+LatencyHistogram::LatencyHistogram () : _count( 0 ), _sum( 0 ), _min( ~0ULL ), _max( 0 )
+{
+   memset( _buckets, 0, sizeof( _buckets ) );
+}
+
+void LatencyHistogram::merge ( const LatencyHistogram &h )
+{
+   for ( unsigned int i = 0; i < NUM_BUCKETS; i++ ) _buckets[i] += h._buckets[i];
+   _count += h._count;
+   _sum += h._sum;
+   if ( h._min < _min ) _min = h._min;
+   if ( h._max > _max ) _max = h._max;
+}
+
+uint64_t LatencyHistogram::getPercentile ( double q ) const
+{
+   if ( _count == 0 ) return 0;
+
+   uint64_t rank = (uint64_t) ( q * _count );
+   if ( rank == 0 ) rank = 1;
+
+   uint64_t seen = 0;
+   for ( unsigned int i = 0; i < NUM_BUCKETS; i++ ) {
+      seen += _buckets[i];
+      if ( seen >= rank ) {
+         //! Middle of the bucket, the exact extremes are known
+         uint64_t lower = getBucketLowerBound( i );
+         uint64_t value = lower + ( getBucketLowerBound( i + 1 ) - lower ) / 2;
+         return std::min( std::max( value, getMin() ), _max );
+      }
+   }
+   return _max;
+}
+
+void LatencyHistogram::printJSON ( std::ostream &o ) const
+{
+   o << "{\"count\":" << _count << ",\"mean\":" << getMean() << ",\"min\":" << getMin() << ",\"max\":" << _max
+     << ",\"p50\":" << getPercentile( 0.5 ) << ",\"p90\":" << getPercentile( 0.9 ) << ",\"p99\":" << getPercentile( 0.99 )
+     << ",\"buckets\":[";
+   bool first = true;
+   for ( unsigned int i = 0; i < NUM_BUCKETS; i++ ) {
+      if ( _buckets[i] == 0 ) continue;
+      o << ( first ? "" : "," ) << "[" << getBucketLowerBound( i ) << "," << _buckets[i] << "]";
+      first = false;
+   }
+   o << "]}";
+}
+
+LatencyStats::LatencyStats ()
+{
+   memset( _counters, 0, sizeof( _counters ) );
+}
+
+LatencyStats::~LatencyStats ()
+{
+   LockBlock lock( retiredStatsLock );
+   if ( _retired == NULL ) _retired = NEW LatencyStats();
+   _retired->merge( *this );
+}
+
+LatencyStats * LatencyStats::getMine ()
+{
+   BaseThread *thread = getMyThreadSafe();
+   return thread != NULL ? thread->getLatencyStats() : NULL;
+}
+
+std::string & LatencyStats::getJSONFile ()
+{
+   static std::string jsonFile;
+   return jsonFile;
+}
+
+void LatencyStats::merge ( const LatencyStats &stats )
+{
+   for ( unsigned int i = 0; i < NUM_METRICS; i++ ) _histograms[i].merge( stats._histograms[i] );
+   for ( unsigned int i = 0; i < NUM_COUNTERS; i++ ) _counters[i] += stats._counters[i];
+}
+
+void LatencyStats::config ( Config &cfg )
+{
+   cfg.registerConfigOption( "latency-stats", NEW Config::FlagOption( _enabled ),
+                             "Collects latency histograms of the runtime hot paths, printed by --summary (disabled by default)" );
+   cfg.registerArgOption( "latency-stats", "latency-stats" );
+   cfg.registerEnvOption( "latency-stats", "NX_LATENCY_STATS" );
+
+   cfg.registerConfigOption( "latency-stats-json", NEW Config::StringVar( getJSONFile() ),
+                             "Writes the latency histograms as JSON to the given file at exit (with --latency-stats)" );
+   cfg.registerArgOption( "latency-stats-json", "latency-stats-json" );
+   cfg.registerEnvOption( "latency-stats-json", "NX_LATENCY_STATS_JSON" );
+}
+
+void LatencyStats::summary ()
+{
+   LockBlock lock( retiredStatsLock );
+   if ( _retired == NULL ) return;
+
+   message0( "=== Latencies (ns)          samples       mean        p50        p90        p99        max" );
+   for ( unsigned int i = 0; i < NUM_METRICS; i++ ) {
+      const LatencyHistogram &h = _retired->_histograms[i];
+      if ( h.getCount() == 0 ) continue;
+      message0( "===  | " << std::left << std::setw( 20 ) << _metricNames[i] << std::right
+                << std::setw( 10 ) << h.getCount() << std::setw( 11 ) << (uint64_t) h.getMean()
+                << std::setw( 11 ) << h.getPercentile( 0.5 ) << std::setw( 11 ) << h.getPercentile( 0.9 )
+                << std::setw( 11 ) << h.getPercentile( 0.99 ) << std::setw( 11 ) << h.getMax() );
+   }
+
+   uint64_t steals = _retired->_counters[STEAL_SUCCESS] + _retired->_counters[STEAL_FAILURE];
+   if ( steals > 0 ) {
+      message0( "=== Steal attempts: " << steals << ", " << _retired->_counters[STEAL_SUCCESS] << " succeeded ("
+                << ( 100 * _retired->_counters[STEAL_SUCCESS] ) / steals << "%)" );
+   }
+}
+
+void LatencyStats::dumpJSON ()
+{
+   LockBlock lock( retiredStatsLock );
+   const std::string &jsonFile = getJSONFile();
+   if ( _retired == NULL || jsonFile.empty() ) return;
+
+   std::ofstream o( jsonFile.c_str() );
+   if ( !o ) {
+      warning0( "Could not write the latency statistics to " << jsonFile );
+      return;
+   }
+
+   o << "{\"unit\":\"ns\",\"metrics\":{";
+   for ( unsigned int i = 0; i < NUM_METRICS; i++ ) {
+      o << ( i == 0 ? "" : "," ) << "\"" << _metricNames[i] << "\":";
+      _retired->_histograms[i].printJSON( o );
+   }
+   o << "},\"counters\":{";
+   for ( unsigned int i = 0; i < NUM_COUNTERS; i++ ) {
+      o << ( i == 0 ? "" : "," ) << "\"" << _counterNames[i] << "\":" << _retired->_counters[i];
+   }
+   o << "}}" << std::endl;
+}
@@ -0,0 +1,116 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_LATENCY_STATS
+#define _NANOS_LATENCY_STATS
+
+#include "latencystats_decl.hpp"
+#include <time.h>
+
+namespace nanos {
+
+inline unsigned int LatencyHistogram::getBucket ( uint64_t value )
+{
+   if ( value < SUB_BUCKETS ) return value;
+
+   unsigned int shift = ( 63 - __builtin_clzll( value ) ) - SUB_BUCKET_BITS;
+   return ( ( shift + 1 ) << SUB_BUCKET_BITS ) + ( ( value >> shift ) & ( SUB_BUCKETS - 1 ) );
+}
+
+inline uint64_t LatencyHistogram::getBucketLowerBound ( unsigned int bucket )
+{
+   if ( bucket < SUB_BUCKETS ) return bucket;
+
+   unsigned int shift = ( bucket >> SUB_BUCKET_BITS ) - 1;
+   return ( (uint64_t) ( SUB_BUCKETS + ( bucket & ( SUB_BUCKETS - 1 ) ) ) ) << shift;
+}
+
+inline void LatencyHistogram::record ( uint64_t value )
+{
+   _buckets[getBucket( value )]++;
+   _count++;
+   _sum += value;
+   if ( value < _min ) _min = value;
+   if ( value > _max ) _max = value;
+}
+
+inline uint64_t LatencyHistogram::getCount () const { return _count; }
+
+inline uint64_t LatencyHistogram::getMin () const { return _count > 0 ? _min : 0; }
+
+inline uint64_t LatencyHistogram::getMax () const { return _max; }
+
+inline double LatencyHistogram::getMean () const { return _count > 0 ? (double) _sum / _count : 0.0; }
+
+inline bool LatencyStats::isEnabled () { return _enabled; }
+
+inline uint64_t LatencyStats::getTime ()
+{
+   struct timespec ts;
+   clock_gettime( CLOCK_MONOTONIC, &ts );
+   return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+inline uint64_t LatencyStats::start ()
+{
+   return _enabled ? getTime() : 0;
+}
+
+inline uint64_t LatencyStats::stop ( Metric metric, uint64_t begin )
+{
+   if ( begin == 0 ) return 0;
+
+   uint64_t now = getTime();
+   LatencyStats *stats = getMine();
+   if ( stats != NULL ) stats->_histograms[metric].record( now - begin );
+   return now;
+}
+
+inline void LatencyStats::sample ( Metric metric, uint64_t latency )
+{
+   if ( !_enabled ) return;
+
+   LatencyStats *stats = getMine();
+   if ( stats != NULL ) stats->_histograms[metric].record( latency );
+}
+
+inline void LatencyStats::increment ( Counter counter )
+{
+   if ( !_enabled ) return;
+
+   LatencyStats *stats = getMine();
+   if ( stats != NULL ) stats->_counters[counter]++;
+}
+
+template <class LockBlockT, class LockT, int WaitMetric>
+inline LatencyLockBlock<LockBlockT, LockT, WaitMetric>::LatencyLockBlock ( LockT &lock )
+   : _begin( LatencyStats::start() ), _block( lock )
+{
+   _begin = LatencyStats::stop( (LatencyStats::Metric) WaitMetric, _begin );
+}
+
+template <class LockBlockT, class LockT, int WaitMetric>
+inline LatencyLockBlock<LockBlockT, LockT, WaitMetric>::~LatencyLockBlock ()
+{
+   LatencyStats::stop( (LatencyStats::Metric) ( WaitMetric + 1 ), _begin );
+}
+
+} // namespace nanos
+
+#endif
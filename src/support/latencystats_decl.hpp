@@ -0,0 +1,207 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_LATENCY_STATS_DECL
+#define _NANOS_LATENCY_STATS_DECL
+
+#include <stdint.h>
+#include <string>
+#include <ostream>
+#include "config_decl.hpp"
+
+namespace nanos {
+
+   /*! \brief Distribution of latencies in logarithmic buckets
+    *
+    *  Every power of two is split in SUB_BUCKETS linear buckets, as HDR histograms
+    *  do, so any value is kept with a relative error below 1/SUB_BUCKETS and
+    *  record() is a count leading zeros, two shifts and an increment.
+    */
+   class LatencyHistogram
+   {
+      public:
+         enum { SUB_BUCKET_BITS = 3, SUB_BUCKETS = 1 << SUB_BUCKET_BITS, NUM_BUCKETS = ( 65 - SUB_BUCKET_BITS ) * SUB_BUCKETS };
+      private:
+         uint64_t    _count;
+         uint64_t    _sum;
+         uint64_t    _min;
+         uint64_t    _max;
+         uint64_t    _buckets[NUM_BUCKETS];
+
+      public:
+         /*! \brief LatencyHistogram default constructor
+          */
+         LatencyHistogram ();
+
+         /*! \brief Bucket of value
+          */
+         static unsigned int getBucket ( uint64_t value );
+         /*! \brief Smallest value of bucket
+          */
+         static uint64_t getBucketLowerBound ( unsigned int bucket );
+
+         void record ( uint64_t value );
+         void merge ( const LatencyHistogram &h );
+
+         uint64_t getCount () const;
+         uint64_t getMin () const;
+         uint64_t getMax () const;
+         double getMean () const;
+         /*! \brief Value below which a fraction q of the samples are, 0 <= q <= 1
+          */
+         uint64_t getPercentile ( double q ) const;
+
+         /*! \brief Writes the histogram as a JSON object, with its non empty buckets
+          */
+         void printJSON ( std::ostream &o ) const;
+   };
+
+   /*! \brief Latencies and event counts of the runtime hot paths, for --summary
+    *
+    *  Each thread collects its own samples, without synchronization, in the object
+    *  returned by BaseThread::getLatencyStats(), which only exists when the
+    *  collection is enabled (--latency-stats). Objects are merged into a global one
+    *  when they are destroyed, like the Allocator statistics, and the result is
+    *  printed in the execution summary and optionally written as JSON
+    *  (--latency-stats-json).
+    *
+    *  A sample costs two reads of the monotonic clock and a histogram update,
+    *  nothing but a test of isEnabled() when the collection is disabled.
+    */
+   class LatencyStats
+   {
+      public:
+         //! Sampled latencies, each lock has a pair of wait and hold metrics
+         typedef enum {
+            TASK_CREATION = 0,         /**< System::createWD */
+            SUBMIT_TO_START,           /**< From the submission of a WD to its start */
+            DEPENDENCE_RELEASE,        /**< Release of the successors of a finished WD */
+            WDDEQUE_LOCK_WAIT,
+            WDDEQUE_LOCK_HOLD,
+            DEPS_LOCK_WAIT,            /**< Locks of the dependencies domains */
+            DEPS_LOCK_HOLD,
+            BARRIER_WAIT,              /**< ThreadTeam::barrier */
+            NUM_METRICS
+         } Metric;
+
+         typedef enum {
+            STEAL_SUCCESS = 0,         /**< Steal attempts of idle threads that got a WD */
+            STEAL_FAILURE,
+            NUM_COUNTERS
+         } Counter;
+
+      private:
+         LatencyHistogram        _histograms[NUM_METRICS];
+         uint64_t                _counters[NUM_COUNTERS];
+
+         static bool             _enabled;
+         static LatencyStats    *_retired;          /**< Statistics of destroyed objects */
+
+         static const char * const _metricNames[NUM_METRICS];
+         static const char * const _counterNames[NUM_COUNTERS];
+
+      private:
+         /*! \brief LatencyStats copy constructor (disabled)
+          */
+         LatencyStats ( const LatencyStats & );
+         /*! \brief LatencyStats copy assignment operator (disabled)
+          */
+         const LatencyStats & operator= ( const LatencyStats & );
+
+         void merge ( const LatencyStats &stats );
+
+         /*! \brief Where the merged statistics are written, if any
+          *  \note Options are registered while sys is constructed, so it cannot be a static member
+          */
+         static std::string & getJSONFile ();
+
+         /*! \brief Statistics of the current thread, NULL if there are none
+          */
+         static LatencyStats * getMine ();
+
+      public:
+         /*! \brief LatencyStats default constructor
+          */
+         LatencyStats ();
+         /*! \brief LatencyStats destructor, merges the statistics into the global ones
+          */
+         ~LatencyStats ();
+
+         static void config ( Config &cfg );
+         static bool isEnabled ();
+
+         /*! \brief Monotonic time in nanoseconds
+          */
+         static uint64_t getTime ();
+
+         /*! \brief Starts a sample, returns 0 if the collection is disabled
+          */
+         static uint64_t start ();
+         /*! \brief Records the time elapsed since begin, a value returned by start()
+          *  \return The current time, or 0 if begin was 0
+          */
+         static uint64_t stop ( Metric metric, uint64_t begin );
+         /*! \brief Records a latency already measured
+          */
+         static void sample ( Metric metric, uint64_t latency );
+         static void increment ( Counter counter );
+
+         /*! \brief Prints the global statistics, for the execution summary
+          */
+         static void summary ();
+         /*! \brief Writes the global statistics as JSON, if a file was given
+          */
+         static void dumpJSON ();
+   };
+
+   /*! \brief Records the time spent in a scope as a sample of Metric
+    */
+   class LatencyScope
+   {
+      private:
+         LatencyStats::Metric    _metric;
+         uint64_t                _begin;
+
+         LatencyScope ( const LatencyScope & );
+         const LatencyScope & operator= ( const LatencyScope & );
+      public:
+         LatencyScope ( LatencyStats::Metric metric ) : _metric( metric ), _begin( LatencyStats::start() ) {}
+         ~LatencyScope () { LatencyStats::stop( _metric, _begin ); }
+   };
+
+   /*! \brief Lock block that records how long it waited for the lock (WaitMetric)
+    *  and how long it held it (the metric that follows WaitMetric)
+    */
+   template <class LockBlockT, class LockT, int WaitMetric>
+   class LatencyLockBlock
+   {
+      private:
+         uint64_t       _begin;      /**< Initialized before _block takes the lock */
+         LockBlockT     _block;
+
+         LatencyLockBlock ( const LatencyLockBlock & );
+         const LatencyLockBlock & operator= ( const LatencyLockBlock & );
+      public:
+         LatencyLockBlock ( LockT &lock );
+         ~LatencyLockBlock ();
+   };
+
+} // namespace nanos
+
+#endif
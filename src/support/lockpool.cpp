@@ -0,0 +1,67 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "lockpool_decl.hpp"
+#include "queuelock.hpp"
+#include "atomic.hpp"
+#include "debug.hpp"
+#include <stdint.h>
+
+using namespace nanos;
+
+LockPool::~LockPool ()
+{
+   delete[] _stripes;
+}
+
+void LockPool::init ( size_t numThreads )
+{
+   ensure0( _stripes == NULL, "Lock pool resized after its first use" );
+
+   unsigned int bits = 0;
+   while ( ( 1UL << bits ) < MIN_STRIPES || ( 1UL << bits ) < numThreads * STRIPES_PER_THREAD ) bits++;
+   _bits = bits;
+}
+
+LockPool::Stripe * LockPool::getStripes ()
+{
+   Stripe *stripes = _stripes;
+   if ( stripes != NULL ) return stripes;
+
+   stripes = NEW Stripe[getNumLocks()];
+   memoryFence();
+
+   if ( !__sync_bool_compare_and_swap( &_stripes, (Stripe *) NULL, stripes ) ) {
+      delete[] stripes;
+      stripes = _stripes;
+   }
+   return stripes;
+}
+
+nanos_lock_t * LockPool::getLock ( void *addr )
+{
+   //! Fibonacci hashing: the top bits of the product spread consecutive words over the whole array
+   uint64_t hash = (uint64_t) ( (uintptr_t) addr >> 2 ) * 0x9E3779B97F4A7C15ULL;
+   return &getStripes()[hash >> ( 64 - _bits )]._lock;
+}
+
+size_t LockPool::getNumLocks () const
+{
+   return (size_t) 1 << _bits;
+}
@@ -0,0 +1,71 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_LOCK_POOL_DECL
+#define _NANOS_LOCK_POOL_DECL
+
+#include <stddef.h>
+#include "queuelock_decl.hpp"
+#include "allocator_decl.hpp"
+
+namespace nanos {
+
+   /*! \brief Locks associated to addresses (nanos_get_lock_address)
+    *
+    *  Addresses are hashed into a fixed array of locks, each one in its own
+    *  cache line. The array is sized from the number of threads, so unrelated
+    *  critical sections rarely share a lock, and neighbouring addresses never
+    *  do while there are fewer of them than locks. Looking up a lock neither
+    *  allocates nor takes a lock.
+    */
+   class LockPool
+   {
+      public:
+         enum { MIN_STRIPES = 256, STRIPES_PER_THREAD = 16 };
+      private:
+         struct Stripe {
+            TicketLock     _lock;
+            char           _pad[NANOS_CACHELINE - sizeof( TicketLock )];
+         };
+
+         Stripe * volatile    _stripes;        /**< Allocated at the first lookup */
+         unsigned int         _bits;           /**< log2 of the number of stripes */
+
+         LockPool ( const LockPool & );
+         const LockPool & operator= ( const LockPool & );
+
+         Stripe * getStripes ();
+      public:
+         LockPool () : _stripes( NULL ), _bits( 8 ) {}
+         ~LockPool ();
+
+         /*! \brief Sizes the pool for numThreads threads, before the first lookup
+          */
+         void init ( size_t numThreads );
+
+         /*! \brief Lock of addr
+          */
+         nanos_lock_t * getLock ( void *addr );
+
+         size_t getNumLocks () const;
+   };
+
+} // namespace nanos
+
+#endif
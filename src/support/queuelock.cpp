@@ -0,0 +1,79 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "queuelock.hpp"
+#include "config.hpp"
+#include "basethread.hpp"
+#include "schedule.hpp"
+#include "system.hpp"
+#include <sched.h>
+
+using namespace nanos;
+
+unsigned int LockWaiter::_spins = 1000;
+unsigned int LockWaiter::_backoff = 16;
+
+//! One spare node per thread saves an allocation in most acquisitions
+static __thread QueueLockNode *spareQueueLockNode = NULL;
+
+void LockWaiter::config ( Config &cfg )
+{
+   cfg.setOptionsSection( "Locks", "User level locks (omp_set_lock, nanos_set_lock and critical sections)" );
+
+   cfg.registerConfigOption( "lock-spins", NEW Config::UintVar( _spins ),
+                             "Rounds a lock waiter spins before running other ready tasks (default = 1000)" );
+   cfg.registerArgOption( "lock-spins", "lock-spins" );
+   cfg.registerEnvOption( "lock-spins", "NX_LOCK_SPINS" );
+
+   cfg.registerConfigOption( "lock-backoff", NEW Config::UintVar( _backoff ),
+                             "Pauses of a spinning lock waiter per waiter ahead of it (default = 16)" );
+   cfg.registerArgOption( "lock-backoff", "lock-backoff" );
+   cfg.registerEnvOption( "lock-backoff", "NX_LOCK_BACKOFF" );
+}
+
+void LockWaiter::yield ()
+{
+   BaseThread *thread = getMyThreadSafe();
+
+   if ( thread == NULL ) {
+      sched_yield();
+   } else if ( thread->getTeam() != NULL && thread->runningOn()->supportsUserLevelThreads() &&
+               sys.getSchedulerConf().getSchedulerEnabled() ) {
+      //! The current task is queued again, tasks switched to that want the same lock queue behind it
+      Scheduler::yield();
+   } else {
+      //! Without user level threads a task would be run on top of the waiter, which could deadlock
+      thread->yield();
+   }
+}
+
+QueueLockNode * QueueLock::getNode ()
+{
+   QueueLockNode *node = spareQueueLockNode;
+   if ( node == NULL ) return NEW QueueLockNode();
+
+   spareQueueLockNode = NULL;
+   return node;
+}
+
+void QueueLock::putNode ( QueueLockNode *node )
+{
+   if ( spareQueueLockNode == NULL ) spareQueueLockNode = node;
+   else delete node;
+}
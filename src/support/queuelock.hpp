@@ -0,0 +1,153 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_QUEUE_LOCK
+#define _NANOS_QUEUE_LOCK
+
+#include "queuelock_decl.hpp"
+#include "atomic.hpp"
+
+namespace nanos {
+
+inline unsigned int LockWaiter::getSpins () { return _spins; }
+
+inline void LockWaiter::pause ( unsigned int distance )
+{
+   if ( _rounds++ < _spins ) {
+      for ( unsigned int i = 0; i < distance * _backoff; i++ ) {
+#if defined(__i386__) || defined(__x86_64__)
+         __builtin_ia32_pause();
+#else
+         __asm__ __volatile__ ( "" ::: "memory" );
+#endif
+      }
+   } else {
+      yield();
+   }
+}
+
+inline volatile unsigned int * TicketLock::getWord ()
+{
+   return ( volatile unsigned int * ) &state_;
+}
+
+inline void TicketLock::acquire ()
+{
+   volatile unsigned int *word = getWord();
+   LockWaiter waiter;
+   unsigned int old, ticket, ahead;
+
+   while ( true ) {
+      old = *word;
+      ticket = old & TICKET_MASK;
+      ahead = ( ticket - ( old >> TICKET_BITS ) ) & TICKET_MASK;
+
+      //! Only queue right behind the holder, see LockWaiter
+      if ( ahead > 1 ) {
+         waiter.pause( ahead );
+      } else if ( __sync_bool_compare_and_swap( word, old, ( old & ~( (unsigned int) TICKET_MASK ) ) | ( ( ticket + 1 ) & TICKET_MASK ) ) ) {
+         break;
+      }
+   }
+
+   if ( ahead == 0 ) return;
+
+   unsigned int serving;
+   while ( ( serving = ( ( *word >> TICKET_BITS ) & TICKET_MASK ) ) != ticket ) {
+      waiter.pause( ( ticket - serving ) & TICKET_MASK );
+   }
+   memoryFence();
+}
+
+inline bool TicketLock::tryAcquire ()
+{
+   volatile unsigned int *word = getWord();
+   unsigned int old = *word;
+   unsigned int ticket = old & TICKET_MASK;
+
+   if ( ( ( old >> TICKET_BITS ) & TICKET_MASK ) != ticket ) return false;
+   return __sync_bool_compare_and_swap( word, old, ( old & ~( (unsigned int) TICKET_MASK ) ) | ( ( ticket + 1 ) & TICKET_MASK ) );
+}
+
+inline void TicketLock::release ()
+{
+   //! The ticket being served wraps around out of the word
+   __sync_fetch_and_add( getWord(), 1U << TICKET_BITS );
+}
+
+inline void QueueLock::acquire ()
+{
+   LockWaiter waiter;
+
+   //! Only queue right behind the holder, see LockWaiter
+   QueueLockNode *tail;
+   while ( ( tail = _tail ) != NULL && tail != _holder ) waiter.pause();
+
+   QueueLockNode *node = getNode();
+   node->_next = NULL;
+   node->_locked = true;
+   memoryFence();
+
+   QueueLockNode *pred = __sync_lock_test_and_set( &_tail, node );
+   if ( pred != NULL ) {
+      pred->_next = node;
+
+      while ( node->_locked ) waiter.pause();
+      memoryFence();
+   }
+   _holder = node;
+}
+
+inline bool QueueLock::tryAcquire ()
+{
+   if ( _tail != NULL ) return false;
+
+   QueueLockNode *node = getNode();
+   node->_next = NULL;
+   node->_locked = false;
+   memoryFence();
+
+   if ( !__sync_bool_compare_and_swap( &_tail, (QueueLockNode *) NULL, node ) ) {
+      putNode( node );
+      return false;
+   }
+   _holder = node;
+   return true;
+}
+
+inline void QueueLock::release ()
+{
+   QueueLockNode *node = _holder;
+
+   if ( node->_next == NULL ) {
+      if ( __sync_bool_compare_and_swap( &_tail, node, (QueueLockNode *) NULL ) ) {
+         putNode( node );
+         return;
+      }
+      //! A waiter is being appended, wait until it links itself
+      while ( node->_next == NULL ) memoryFence();
+   }
+   memoryFence();
+   node->_next->_locked = false;
+   putNode( node );
+}
+
+} // namespace nanos
+
+#endif
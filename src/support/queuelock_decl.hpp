@@ -0,0 +1,132 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_QUEUE_LOCK_DECL
+#define _NANOS_QUEUE_LOCK_DECL
+
+#include "nanos-int.h"
+#include "config_decl.hpp"
+#include "allocator_decl.hpp"
+
+namespace nanos {
+
+   /*! \brief Waiting policy of the user level locks
+    *
+    *  Waiters spin with a backoff proportional to how far they are from getting
+    *  the lock. Once they have spun for getSpins() rounds, the task-aware slow
+    *  path lets other ready tasks run on the thread (or yields the processor
+    *  when the thread cannot switch to them) between checks.
+    *
+    *  A queued waiter that runs other tasks keeps its place, and the lock waits
+    *  for it once it is its turn. So the FIFO locks only queue a waiter right
+    *  behind the holder; other waiters wait outside the queue until there is
+    *  room, which bounds that delay to a single waiter.
+    */
+   class LockWaiter
+   {
+      private:
+         unsigned int            _rounds;        /**< Waiting rounds done so far */
+
+         static unsigned int     _spins;         /**< Rounds spun before taking the slow path */
+         static unsigned int     _backoff;       /**< Pauses per round for each waiter ahead */
+
+         LockWaiter ( const LockWaiter & );
+         const LockWaiter & operator= ( const LockWaiter & );
+
+         /*! \brief Runs other ready tasks, or yields the processor
+          */
+         static void yield ();
+      public:
+         LockWaiter () : _rounds( 0 ) {}
+
+         static void config ( Config &cfg );
+         static unsigned int getSpins ();
+
+         /*! \brief Waits for one round
+          *  \param distance number of waiters that will get the lock before the caller
+          */
+         void pause ( unsigned int distance = 1 );
+   };
+
+   /*! \brief FIFO ticket lock stored in a nanos_lock_t
+    *
+    *  The lock keeps the next ticket in the lower half of the word and the ticket
+    *  being served in the upper one, so it fits the nanos_lock_t word that
+    *  compilers allocate and initialize statically: NANOS_INIT_LOCK_FREE is an
+    *  unlocked ticket lock and NANOS_INIT_LOCK_BUSY one held without waiters.
+    *  Waiters back off proportionally to their distance to the ticket being
+    *  served.
+    */
+   class TicketLock : public nanos_lock_t
+   {
+      private:
+         enum { TICKET_BITS = 16, TICKET_MASK = ( 1 << TICKET_BITS ) - 1 };
+
+         TicketLock ( const TicketLock & );
+         const TicketLock & operator= ( const TicketLock & );
+
+         volatile unsigned int * getWord ();
+      public:
+         TicketLock () : nanos_lock_t( NANOS_LOCK_FREE ) {}
+
+         void acquire ();
+         bool tryAcquire ();
+         void release ();
+   };
+
+   /*! \brief Queue node of a QueueLock acquirer
+    */
+   struct QueueLockNode
+   {
+      QueueLockNode * volatile   _next;          /**< Next waiter, if any */
+      volatile bool              _locked;        /**< Cleared by the predecessor when it hands over the lock */
+      char                       _pad[NANOS_CACHELINE - sizeof( QueueLockNode * ) - sizeof( bool )];
+   };
+
+   /*! \brief MCS queue lock
+    *
+    *  Each acquirer appends a node to the queue and spins on its own node until
+    *  its predecessor hands the lock over, so a contended lock costs one remote
+    *  write per handover instead of having every waiter hammering the same word.
+    *  The holder's node is kept in the lock, so it can be released by the task
+    *  that acquired it even after it has been moved to another thread.
+    */
+   class QueueLock
+   {
+      private:
+         QueueLockNode * volatile   _tail;       /**< Last node of the queue, NULL when the lock is free */
+         QueueLockNode             *_holder;     /**< Node of the current holder */
+
+         QueueLock ( const QueueLock & );
+         const QueueLock & operator= ( const QueueLock & );
+
+         static QueueLockNode * getNode ();
+         static void putNode ( QueueLockNode *node );
+      public:
+         QueueLock () : _tail( NULL ), _holder( NULL ) {}
+         ~QueueLock () {}
+
+         void acquire ();
+         bool tryAcquire ();
+         void release ();
+   };
+
+} // namespace nanos
+
+#endif
@@ -0,0 +1,81 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_SHARDED_COUNTER
+#define _NANOS_SHARDED_COUNTER
+
+#include "shardedcounter_decl.hpp"
+#include "atomic.hpp"
+
+namespace nanos {
+
+inline int ShardedCounter::getSlot ()
+{
+   if ( _mySlot < 0 ) {
+      _mySlot = _usedSlots++ % MAX_SLOTS;
+   }
+   return _mySlot;
+}
+
+inline int ShardedCounter::getNumUsedSlots ()
+{
+   int used = _usedSlots.value();
+   return used < MAX_SLOTS ? used : MAX_SLOTS;
+}
+
+inline int ShardedCounter::add ( int val )
+{
+   // Threads beyond MAX_SLOTS share slots, so the slot itself is still atomic
+   Atomic<int> &delta = _slots[getSlot()]._delta;
+   int local = delta.addAndFetch( val );
+
+   if ( local >= FOLD || local <= -FOLD ) {
+      // Moving exactly 'local' keeps total + slots unchanged even if another
+      // thread sharing the slot folds at the same time
+      int total = _total.addAndFetch( local );
+      delta -= local;
+      return total;
+   }
+
+   return _total.value();
+}
+
+inline int ShardedCounter::approximate () const
+{
+   return _total.value();
+}
+
+inline int ShardedCounter::skew () const
+{
+   return ( FOLD - 1 ) * getNumUsedSlots();
+}
+
+inline int ShardedCounter::value () const
+{
+   int result = _total.value();
+   int used = getNumUsedSlots();
+   for ( int i = 0; i < used; i++ ) {
+      result += _slots[i]._delta.value();
+   }
+   return result;
+}
+
+} // namespace nanos
+
+#endif
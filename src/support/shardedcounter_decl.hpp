@@ -0,0 +1,96 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_SHARDED_COUNTER_DECL
+#define _NANOS_SHARDED_COUNTER_DECL
+
+#include "atomic_decl.hpp"
+#include "allocator_decl.hpp"
+
+namespace nanos {
+
+   /*! \brief Integer counter split in per-thread slots.
+    *
+    *  Each thread updates its own cache line padded slot. When the local delta
+    *  of a slot reaches FOLD units it is moved to the shared total, so the
+    *  shared cache line is only written once every FOLD updates.
+    *
+    *  approximate() only reads the shared total and may differ from the real
+    *  value by up to skew(). value() also adds the slots, it is exact once the
+    *  concurrent updates have finished.
+    */
+   class ShardedCounter
+   {
+      public:
+         enum { MAX_SLOTS = 64, FOLD = 16 };
+      private:
+         struct Slot {
+            Atomic<int>    _delta;
+            char           _pad[NANOS_CACHELINE - sizeof(Atomic<int>)];
+
+            Slot () : _delta( 0 ) {}
+         };
+
+         Atomic<int>          _total;                                        /**< Folded value */
+         char                 _totalPad[NANOS_CACHELINE - sizeof(Atomic<int>)];
+         Slot                 _slots[MAX_SLOTS];                             /**< Per-thread deltas */
+
+         static Atomic<int>   _usedSlots;                                    /**< Slots handed out to threads */
+         static __thread int  _mySlot;                                       /**< Slot of the current thread, -1 if none yet */
+      private:
+         /*! \brief ShardedCounter copy constructor (private)
+          */
+         ShardedCounter ( const ShardedCounter & );
+         /*! \brief ShardedCounter copy assignment operator (private)
+          */
+         const ShardedCounter & operator= ( const ShardedCounter & );
+
+         static int getSlot ();
+         static int getNumUsedSlots ();
+      public:
+         /*! \brief ShardedCounter constructor
+          */
+         ShardedCounter ( int init = 0 ) : _total( init ), _slots() {}
+         /*! \brief ShardedCounter destructor
+          */
+         ~ShardedCounter () {}
+
+         /*! \brief Adds val to the slot of the current thread
+          *  \return the approximate value of the counter after the update
+          */
+         int add ( int val );
+
+         int operator++ () { return add( 1 ); }
+         int operator-- () { return add( -1 ); }
+         int operator++ ( int ) { return add( 1 ); }
+         int operator-- ( int ) { return add( -1 ); }
+         int operator+= ( int val ) { return add( val ); }
+         int operator-= ( int val ) { return add( -val ); }
+
+         /*! \brief Cheap read: only the shared total */
+         int approximate () const;
+         /*! \brief Upper bound of the difference between approximate() and value() */
+         int skew () const;
+         /*! \brief Exact read: shared total plus every used slot */
+         int value () const;
+   };
+
+} // namespace nanos
+
+#endif
@@ -0,0 +1,92 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#include "slaballocator.hpp"
+
+using namespace nanos;
+
+const size_t SlabAllocator::_headerSize = NANOS_ALIGNED_MEMORY_OFFSET( 0, sizeof(SlabAllocator::ObjectHeader), 16 );
+
+const size_t SlabAllocator::_classSize[SlabAllocator::NUM_CLASSES] = {
+   128, 192, 256, 320, 384, 512, 640, 768, 1024, 1280, 1536, 2048, 3072, 4096, 6144, 8192
+};
+
+SlabAllocator::CentralList SlabAllocator::_central[SlabAllocator::NUM_CLASSES];
+
+__thread SlabAllocator::ThreadCache SlabAllocator::_cache[SlabAllocator::NUM_CLASSES];
+
+void SlabAllocator::refill ( int sizeClass )
+{
+   ThreadCache &cache = _cache[sizeClass];
+   CentralList &central = _central[sizeClass];
+
+   if ( central._head != NULL ) {
+      LockBlock lock( central._lock );
+
+      // Take up to BATCH objects from the head of the central list
+      FreeObject *first = central._head;
+
+      if ( first != NULL ) {
+         FreeObject *last = first;
+         unsigned int taken = 1;
+         while ( taken < BATCH && last->_next != NULL ) {
+            last = last->_next;
+            taken++;
+         }
+
+         central._head = last->_next;
+         central._count -= taken;
+         last->_next = cache._head;
+         cache._head = first;
+         cache._count += taken;
+         return;
+      }
+   }
+
+   // Central list is empty: carve a new slab of BATCH objects
+   size_t objSize = _classSize[sizeClass];
+   char *slab = (char *) malloc( objSize * BATCH );
+   if ( slab == NULL ) throw(NANOS_ENOMEM);
+
+   for ( int i = BATCH - 1; i >= 0; i-- ) {
+      FreeObject *obj = (FreeObject *) ( slab + i * objSize );
+      obj->_next = cache._head;
+      cache._head = obj;
+   }
+   cache._count += BATCH;
+}
+
+void SlabAllocator::release ( int sizeClass )
+{
+   ThreadCache &cache = _cache[sizeClass];
+   CentralList &central = _central[sizeClass];
+
+   // Detach the BATCH most recently freed objects, the rest stay hot in the cache
+   FreeObject *first = cache._head;
+   FreeObject *last = first;
+   for ( int i = 1; i < BATCH; i++ ) last = last->_next;
+
+   cache._head = last->_next;
+   cache._count -= BATCH;
+
+   LockBlock lock( central._lock );
+   last->_next = central._head;
+   central._head = first;
+   central._count += BATCH;
+}
@@ -0,0 +1,87 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_SLAB_ALLOCATOR
+#define _NANOS_SLAB_ALLOCATOR
+
+#include "slaballocator_decl.hpp"
+#include "lock.hpp"
+#include <cstdlib>
+
+namespace nanos {
+
+inline int SlabAllocator::getSizeClass ( size_t size )
+{
+   for ( int c = 0; c < NUM_CLASSES; c++ ) {
+      if ( size <= _classSize[c] ) return c;
+   }
+   return -1;
+}
+
+inline void * SlabAllocator::allocate ( size_t size )
+{
+   int sizeClass = getSizeClass( size + _headerSize );
+   ObjectHeader *ptr;
+
+   if ( sizeClass < 0 ) {
+      ptr = (ObjectHeader *) malloc( size + _headerSize );
+      if ( ptr == NULL ) throw(NANOS_ENOMEM);
+      ptr->_size = size;
+   } else {
+      ThreadCache &cache = _cache[sizeClass];
+      if ( cache._head == NULL ) refill( sizeClass );
+
+      ptr = (ObjectHeader *) cache._head;
+      cache._head = cache._head->_next;
+      cache._count--;
+      ptr->_size = _classSize[sizeClass] - _headerSize;
+   }
+
+   ptr->_sizeClass = sizeClass;
+   return ((char *) ptr) + _headerSize;
+}
+
+inline void SlabAllocator::deallocate ( void *object )
+{
+   if ( object == NULL ) return;
+
+   ObjectHeader *ptr = (ObjectHeader *) ( ((char *) object) - _headerSize );
+   int sizeClass = ptr->_sizeClass;
+
+   if ( sizeClass < 0 ) {
+      free( ptr );
+      return;
+   }
+
+   ThreadCache &cache = _cache[sizeClass];
+   FreeObject *obj = (FreeObject *) ptr;
+   obj->_next = cache._head;
+   cache._head = obj;
+   if ( ++cache._count >= 2 * BATCH ) release( sizeClass );
+}
+
+inline size_t SlabAllocator::getObjectSize ( void *object )
+{
+   ObjectHeader *ptr = (ObjectHeader *) ( ((char *) object) - _headerSize );
+   return ptr->_size;
+}
+
+} // namespace nanos
+
+#endif
@@ -0,0 +1,99 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+#ifndef _NANOS_SLAB_ALLOCATOR_DECL
+#define _NANOS_SLAB_ALLOCATOR_DECL
+
+#include <cstddef>
+#include "lock_decl.hpp"
+#include "allocator_decl.hpp"
+
+namespace nanos {
+
+/*! \class SlabAllocator
+ *  \brief Size-class allocator with per-thread caches, used for WD chunks.
+ *
+ *  Objects are rounded up to one of NUM_CLASSES size classes. Every thread
+ *  keeps a free list per class and allocates from it without locking. A
+ *  thread that runs out takes a batch of BATCH objects from the central list
+ *  of the class (or carves a new slab). Frees always go to the cache of the
+ *  freeing thread, which is usually not the allocating one: once a cache
+ *  holds 2 * BATCH objects it returns a batch to the central list, so remote
+ *  frees cost one lock acquisition every BATCH objects.
+ *
+ *  Objects bigger than the largest class are served by malloc. Slabs are
+ *  kept for the lifetime of the process.
+ */
+class SlabAllocator
+{
+   public:
+      enum { NUM_CLASSES = 16, BATCH = 32 };
+   private:
+      struct FreeObject {
+         FreeObject    *_next;
+      };
+
+      struct ObjectHeader {
+         size_t         _size;         /**< Usable size of the object */
+         int            _sizeClass;    /**< -1 for objects served by malloc */
+      };
+
+      struct ThreadCache {
+         FreeObject    *_head;
+         unsigned int   _count;
+      };
+
+      struct CentralList {
+         Lock           _lock;
+         FreeObject    *_head;
+         unsigned int   _count;
+         char           _pad[NANOS_CACHELINE - sizeof(Lock) - sizeof(FreeObject *) - sizeof(unsigned int)];
+      };
+
+      static const size_t         _headerSize;               /**< Size of ObjectHeader, keeps objects 16-byte aligned */
+      static const size_t         _classSize[NUM_CLASSES];   /**< Object size (header included) of each class */
+      static CentralList          _central[NUM_CLASSES];     /**< Shared free lists */
+      static __thread ThreadCache _cache[NUM_CLASSES];       /**< Per-thread free lists */
+
+   private:
+      /*! \brief SlabAllocator default constructor (disabled), only static members
+       */
+      SlabAllocator ();
+
+      static int getSizeClass ( size_t size );
+      /*! \brief Fills the cache of the current thread for the given class */
+      static void refill ( int sizeClass );
+      /*! \brief Returns a batch of the current thread's cache to the central list */
+      static void release ( int sizeClass );
+
+   public:
+      /*! \brief Returns a chunk of at least 'size' bytes, 16-byte aligned
+       */
+      static void * allocate ( size_t size );
+      /*! \brief Frees a chunk returned by allocate, from any thread
+       */
+      static void deallocate ( void *object );
+      /*! \brief Usable size of a chunk returned by allocate
+       */
+      static size_t getObjectSize ( void *object );
+};
+
+} // namespace nanos
+
+#endif
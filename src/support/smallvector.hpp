@@ -0,0 +1,171 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+
+#ifndef _NANOS_SMALL_VECTOR
+#define _NANOS_SMALL_VECTOR
+
+#include "smallvector_decl.hpp"
+#include <algorithm>
+
+namespace nanos {
+
+template <typename T, size_t N>
+inline SmallVector<T,N>::SmallVector () : _data( _inline ), _size( 0 ), _capacity( N ) {}
+
+template <typename T, size_t N>
+inline SmallVector<T,N>::SmallVector ( const SmallVector &sv ) : _data( _inline ), _size( 0 ), _capacity( N )
+{
+   reserve( sv._size );
+   std::copy( sv.begin(), sv.end(), _data );
+   _size = sv._size;
+}
+
+template <typename T, size_t N>
+inline const SmallVector<T,N> & SmallVector<T,N>::operator= ( const SmallVector &sv )
+{
+   if ( this == &sv ) return *this;
+   reserve( sv._size );
+   std::copy( sv.begin(), sv.end(), _data );
+   _size = sv._size;
+   return *this;
+}
+
+template <typename T, size_t N>
+inline SmallVector<T,N>::~SmallVector ()
+{
+   if ( _data != _inline ) delete[] _data;
+}
+
+template <typename T, size_t N>
+void SmallVector<T,N>::reserve ( size_t capacity )
+{
+   if ( capacity <= _capacity ) return;
+
+   unsigned int newCapacity = _capacity * 2;
+   if ( newCapacity < capacity ) newCapacity = capacity;
+
+   T *data = NEW T[newCapacity];
+   std::copy( _data, _data + _size, data );
+   if ( _data != _inline ) delete[] _data;
+   _data = data;
+   _capacity = newCapacity;
+}
+
+template <typename T, size_t N>
+inline typename SmallVector<T,N>::iterator SmallVector<T,N>::begin () { return _data; }
+
+template <typename T, size_t N>
+inline typename SmallVector<T,N>::iterator SmallVector<T,N>::end () { return _data + _size; }
+
+template <typename T, size_t N>
+inline typename SmallVector<T,N>::const_iterator SmallVector<T,N>::begin () const { return _data; }
+
+template <typename T, size_t N>
+inline typename SmallVector<T,N>::const_iterator SmallVector<T,N>::end () const { return _data + _size; }
+
+template <typename T, size_t N>
+inline size_t SmallVector<T,N>::size () const { return _size; }
+
+template <typename T, size_t N>
+inline bool SmallVector<T,N>::empty () const { return _size == 0; }
+
+template <typename T, size_t N>
+inline void SmallVector<T,N>::clear ()
+{
+   if ( _data != _inline ) delete[] _data;
+   _data = _inline;
+   _size = 0;
+   _capacity = N;
+}
+
+template <typename T, size_t N>
+inline T & SmallVector<T,N>::operator[] ( size_t i ) { return _data[i]; }
+
+template <typename T, size_t N>
+inline T const & SmallVector<T,N>::operator[] ( size_t i ) const { return _data[i]; }
+
+template <typename T, size_t N>
+inline void SmallVector<T,N>::push_back ( const T &elem )
+{
+   if ( _size == _capacity ) reserve( _size + 1 );
+   _data[_size++] = elem;
+}
+
+template <typename T, size_t N>
+inline typename SmallVector<T,N>::iterator SmallVector<T,N>::insert ( iterator pos, const T &elem )
+{
+   unsigned int idx = pos - _data;
+   if ( _size == _capacity ) reserve( _size + 1 );
+   std::copy_backward( _data + idx, _data + _size, _data + _size + 1 );
+   _data[idx] = elem;
+   _size++;
+   return _data + idx;
+}
+
+template <typename T, size_t N>
+inline typename SmallVector<T,N>::iterator SmallVector<T,N>::erase ( iterator pos )
+{
+   std::copy( pos + 1, end(), pos );
+   _size--;
+   return pos;
+}
+
+template <typename T, size_t N>
+inline void SmallVector<T,N>::remove ( const T &elem )
+{
+   _size = std::remove( begin(), end(), elem ) - _data;
+}
+
+template <typename T, size_t N>
+inline typename SmallSet<T,N>::iterator SmallSet<T,N>::lowerBound ( const T &elem )
+{
+   // Fast path for keys inserted in increasing order
+   if ( _elems.empty() || _elems[_elems.size() - 1] < elem ) return _elems.end();
+   return std::lower_bound( _elems.begin(), _elems.end(), elem );
+}
+
+template <typename T, size_t N>
+inline std::pair<typename SmallSet<T,N>::iterator,bool> SmallSet<T,N>::insert ( const T &elem )
+{
+   iterator it = lowerBound( elem );
+   if ( it != _elems.end() && !( elem < *it ) ) return std::make_pair( it, false );
+   return std::make_pair( _elems.insert( it, elem ), true );
+}
+
+template <typename T, size_t N>
+inline typename SmallSet<T,N>::iterator SmallSet<T,N>::find ( const T &elem )
+{
+   iterator it = lowerBound( elem );
+   if ( it != _elems.end() && !( elem < *it ) ) return it;
+   return _elems.end();
+}
+
+template <typename T, size_t N>
+inline size_t SmallSet<T,N>::erase ( const T &elem )
+{
+   iterator it = find( elem );
+   if ( it == _elems.end() ) return 0;
+   _elems.erase( it );
+   return 1;
+}
+
+} // namespace nanos
+
+#endif
@@ -0,0 +1,121 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+
+#ifndef _NANOS_SMALL_VECTOR_DECL
+#define _NANOS_SMALL_VECTOR_DECL
+
+#include <cstddef>
+#include <utility>
+
+namespace nanos {
+
+/*! \class SmallVector
+ *  \brief Array that keeps its first N elements inline and only goes to the heap when it grows beyond them.
+ *
+ *  Meant for short lists of trivially copyable elements (pointers, pairs of ids and pointers) that are
+ *  created at a high rate. Storage grows by doubling and is never shrunk until clear(). Erasing or
+ *  inserting invalidates the iterators after the modified position.
+ */
+template <typename T, size_t N>
+class SmallVector
+{
+   public:
+      typedef T         value_type;
+      typedef T *       iterator;
+      typedef const T * const_iterator;
+
+   private:
+      T              *_data;         /**< Points to _inline or to heap storage */
+      unsigned int    _size;         /**< Number of elements */
+      unsigned int    _capacity;     /**< Number of elements that fit in _data */
+      T               _inline[N];    /**< Inline storage for the first N elements */
+
+      /*! \brief Makes room for at least 'capacity' elements */
+      void reserve ( size_t capacity );
+
+   public:
+      SmallVector ();
+      SmallVector ( const SmallVector &sv );
+      const SmallVector & operator= ( const SmallVector &sv );
+      ~SmallVector ();
+
+      iterator begin ();
+      iterator end ();
+      const_iterator begin () const;
+      const_iterator end () const;
+
+      size_t size () const;
+      bool empty () const;
+      void clear ();
+
+      T & operator[] ( size_t i );
+      T const & operator[] ( size_t i ) const;
+
+      void push_back ( const T &elem );
+      /*! \brief Inserts elem before pos, returns an iterator to it */
+      iterator insert ( iterator pos, const T &elem );
+      /*! \brief Removes the element at pos, returns an iterator to the following one */
+      iterator erase ( iterator pos );
+      /*! \brief Removes every element equal to elem */
+      void remove ( const T &elem );
+};
+
+/*! \class SmallSet
+ *  \brief Set kept as a sorted SmallVector.
+ *
+ *  Lookups are binary searches and iteration goes in key order, like std::set, without allocating a
+ *  node per element. Inserting keys in increasing order (the usual case when keys are ids handed out
+ *  in creation order) is an append.
+ */
+template <typename T, size_t N>
+class SmallSet
+{
+   public:
+      typedef T                                          value_type;
+      typedef typename SmallVector<T,N>::iterator        iterator;
+      typedef typename SmallVector<T,N>::const_iterator  const_iterator;
+
+   private:
+      SmallVector<T,N>  _elems;   /**< Sorted elements */
+
+      iterator lowerBound ( const T &elem );
+
+   public:
+      SmallSet () : _elems() {}
+
+      iterator begin () { return _elems.begin(); }
+      iterator end () { return _elems.end(); }
+      const_iterator begin () const { return _elems.begin(); }
+      const_iterator end () const { return _elems.end(); }
+
+      size_t size () const { return _elems.size(); }
+      bool empty () const { return _elems.empty(); }
+      void clear () { _elems.clear(); }
+
+      std::pair<iterator,bool> insert ( const T &elem );
+      iterator find ( const T &elem );
+      size_t erase ( const T &elem );
+      /*! \brief Removes the element at pos, returns an iterator to the following one */
+      iterator erase ( iterator pos ) { return _elems.erase( pos ); }
+};
+
+} // namespace nanos
+
+#endif
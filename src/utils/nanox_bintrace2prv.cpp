@@ -0,0 +1,369 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*! \file nanox_bintrace2prv.cpp
+ *  \brief Converts a trace of the binary_trace instrumentation plugin to Paraver
+ *
+ *  Event types follow the ones of the extrae plugin, so the configurations of
+ *  doc/paraver_configs work on the converted traces.
+ */
+
+#include "binary_trace_format.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace nanos::bintrace;
+
+namespace {
+
+// Same values than the extrae plugin
+const uint64_t PRV_STATE     = 9000000;
+const uint64_t PRV_SUBSTATE  = 9000004;
+const uint64_t PRV_TASK      = 9000010;
+const uint64_t PRV_KEY_BASE  = 9200000;
+
+// Must follow nanos_event_state_value_t
+const char *stateNames[] = { "NOT CREATED", "NOT RUNNING", "STARTUP", "SHUTDOWN", "ERROR", "IDLE",
+   "RUNTIME", "RUNNING", "SYNCHRONIZATION", "SCHEDULING", "CREATION",
+   "DATA TRANSFER ISSUE", "CACHE ALLOC/FREE", "YIELD", "ACQUIRING LOCK", "CONTEXT SWITCH",
+   "FILL COLOR", "WAKING UP", "STOPPED", "SYNCED RUNNING", "DEBUG" };
+const unsigned int numStates = sizeof(stateNames) / sizeof(stateNames[0]);
+
+// nanos_event_type_t values, as stored in the records
+enum { STATE_START, STATE_END, SUBSTATE_START, SUBSTATE_END, BURST_START, BURST_END, PTP_START, PTP_END, POINT };
+
+struct Key {
+   bool                                  stacked;
+   std::string                           name;
+   std::string                           description;
+   std::vector<std::pair<uint64_t, std::string> > values;
+};
+
+struct Index {
+   std::vector<uint64_t>                 clocks;      /**< tsc, ns pairs */
+   std::vector<std::string>              threads;
+   std::map<uint32_t, Key>               keys;
+};
+
+struct Line {
+   uint64_t                              time;
+   unsigned int                          order;       /**< Keeps lines of the same time in trace order */
+   std::string                           text;
+
+   bool operator< ( const Line &other ) const
+   {
+      if ( time != other.time ) return time < other.time;
+      return order < other.order;
+   }
+};
+
+struct Endpoint {
+   unsigned int                          thread;
+   uint64_t                              time;
+   uint64_t                              size;
+};
+
+typedef std::pair<uint16_t, int64_t>     CommId;     /**< PtP domain and id */
+
+void usage ( const char *prog )
+{
+   std::cerr << "usage: " << prog << " <trace.idx> [output name]" << std::endl;
+   std::cerr << "   Writes <output name>.prv, .pcf and .row (default output name: the index without .idx)" << std::endl;
+   exit( 1 );
+}
+
+bool readIndex ( const std::string &file, Index &index )
+{
+   std::ifstream in( file.c_str() );
+   if ( !in.good() ) return false;
+
+   std::string line;
+   while ( std::getline( in, line ) ) {
+      std::istringstream fields( line );
+      std::string what;
+      fields >> what;
+      if ( what == "nanox-bintrace" ) {
+         unsigned int version;
+         fields >> version;
+         if ( version != BINTRACE_VERSION ) {
+            std::cerr << "Unsupported trace version " << version << std::endl;
+            return false;
+         }
+      } else if ( what == "clock" ) {
+         uint64_t tsc, ns;
+         fields >> tsc >> ns;
+         index.clocks.push_back( tsc );
+         index.clocks.push_back( ns );
+      } else if ( what == "thread" ) {
+         std::string name;
+         fields >> name;
+         index.threads.push_back( name );
+      } else if ( what == "key" ) {
+         uint32_t id;
+         int stacked;
+         Key key;
+         fields >> id >> stacked >> key.name >> std::ws;
+         std::getline( fields, key.description );
+         key.stacked = stacked != 0;
+         index.keys[id] = key;
+      } else if ( what == "value" ) {
+         uint32_t id;
+         uint64_t value;
+         std::string description;
+         fields >> id >> value >> std::ws;
+         std::getline( fields, description );
+         index.keys[id].values.push_back( std::make_pair( value, description ) );
+      }
+   }
+   return index.clocks.size() == 4;
+}
+
+bool readBuffer ( const std::string &file, FileHeader &header, std::vector<Record> &records )
+{
+   FILE *f = fopen( file.c_str(), "rb" );
+   if ( f == NULL ) return false;
+
+   bool ok = fread( &header, sizeof(header), 1, f ) == 1 && header.magic == BINTRACE_MAGIC &&
+             header.version == BINTRACE_VERSION && header.recordSize == sizeof(Record) &&
+             header.capacity > 0 && ( header.capacity & ( header.capacity - 1 ) ) == 0;
+
+   if ( ok ) {
+      uint64_t written = header.written;
+      uint64_t count = std::min( written, (uint64_t) header.capacity );
+      uint64_t first = written > header.capacity ? written & ( header.capacity - 1 ) : 0;
+      if ( written > header.capacity ) {
+         std::cerr << file << ": ring buffer wrapped, " << written - header.capacity << " oldest records lost" << std::endl;
+      }
+
+      std::vector<Record> ring( count );
+      ok = fseek( f, BINTRACE_HEADER_SIZE, SEEK_SET ) == 0 &&
+           ( count == 0 || fread( &ring[0], sizeof(Record), count, f ) == count );
+      records.clear();
+      records.reserve( count );
+      for ( uint64_t i = 0; ok && i < count; i++ ) records.push_back( ring[ ( first + i ) % count ] );
+   }
+
+   fclose( f );
+   return ok;
+}
+
+/*! \brief Stack of values of one event type, the end of a burst restores the enclosing value */
+uint64_t pop ( std::vector<uint64_t> &stack )
+{
+   if ( !stack.empty() ) stack.pop_back();
+   return stack.empty() ? 0 : stack.back();
+}
+
+} // namespace
+
+int main ( int argc, char **argv )
+{
+   if ( argc < 2 || argc > 3 ) usage( argv[0] );
+
+   std::string indexFile = argv[1];
+   std::string output;
+   if ( argc == 3 ) output = argv[2];
+   else if ( indexFile.size() > 4 && indexFile.substr( indexFile.size() - 4 ) == ".idx" )
+      output = indexFile.substr( 0, indexFile.size() - 4 );
+   else output = indexFile;
+
+   Index index;
+   if ( !readIndex( indexFile, index ) ) {
+      std::cerr << "Cannot read trace index " << indexFile << std::endl;
+      return 1;
+   }
+
+   std::string dir;
+   size_t slash = indexFile.find_last_of( '/' );
+   if ( slash != std::string::npos ) dir = indexFile.substr( 0, slash + 1 );
+
+   // Linear map from raw timestamps to nanoseconds since initialization
+   uint64_t clock0 = index.clocks[0];
+   double nsPerTick = index.clocks[2] > clock0 ?
+                      (double) ( index.clocks[3] - index.clocks[1] ) / ( index.clocks[2] - clock0 ) : 1.0;
+   uint64_t endTime = index.clocks[3] - index.clocks[1];
+
+   // The "xfer-size" key carries the size of the PtP events
+   uint32_t sizeKey = 0;
+   for ( std::map<uint32_t, Key>::const_iterator it = index.keys.begin(); it != index.keys.end(); it++ )
+      if ( it->second.name == "xfer-size" ) sizeKey = it->first;
+
+   unsigned int numThreads = index.threads.size();
+   std::vector<Line> lines;
+   std::map<CommId, Endpoint> sends, recvs;
+   std::vector<std::string> comms;
+
+   for ( unsigned int t = 0; t < numThreads; t++ ) {
+      FileHeader header;
+      std::vector<Record> records;
+      if ( !readBuffer( dir + index.threads[t], header, records ) ) {
+         std::cerr << "Cannot read buffer " << dir + index.threads[t] << std::endl;
+         return 1;
+      }
+
+      unsigned int thread = t + 1;
+      std::vector<uint64_t> states, substates;
+      std::map<uint32_t, std::vector<uint64_t> > stacks;
+
+      for ( size_t i = 0; i < records.size(); ) {
+         // Records stored by the same event list share their timestamp and become one line
+         int64_t ticks = (int64_t) ( records[i].time - clock0 );
+         uint64_t time = ticks > 0 ? (uint64_t) ( ticks * nsPerTick ) : 0;
+         std::ostringstream events;
+
+         size_t j = i;
+         for ( ; j < records.size() && records[j].time == records[i].time; j++ ) {
+            const Record &r = records[j];
+            uint64_t type = 0, value = 0;
+            switch ( r.type ) {
+               case STATE_START: states.push_back( r.value ); type = PRV_STATE; value = r.value; break;
+               case STATE_END: type = PRV_STATE; value = pop( states ); break;
+               case SUBSTATE_START: substates.push_back( r.value ); type = PRV_SUBSTATE; value = r.value; break;
+               case SUBSTATE_END: type = PRV_SUBSTATE; value = pop( substates ); break;
+               case RECORD_RESUME_TASK: type = PRV_TASK; value = r.value; break;
+               case RECORD_SUSPEND_TASK: type = PRV_TASK; value = 0; break;
+               case POINT: type = PRV_KEY_BASE + r.key; value = r.value; break;
+               case BURST_START:
+                  type = PRV_KEY_BASE + r.key;
+                  value = r.value;
+                  if ( index.keys[r.key].stacked ) stacks[r.key].push_back( r.value );
+                  break;
+               case BURST_END:
+                  type = PRV_KEY_BASE + r.key;
+                  value = index.keys[r.key].stacked ? pop( stacks[r.key] ) : 0;
+                  break;
+               case PTP_START:
+               case PTP_END:
+               {
+                  Endpoint point = { thread, time, r.key != 0 && r.key == sizeKey ? r.value : (uint64_t) r.id };
+                  CommId id( r.domain, r.id );
+                  std::map<CommId, Endpoint> &mine = r.type == PTP_START ? sends : recvs;
+                  std::map<CommId, Endpoint> &other = r.type == PTP_START ? recvs : sends;
+                  std::map<CommId, Endpoint>::iterator match = other.find( id );
+                  if ( match == other.end() ) {
+                     mine[id] = point;
+                     break;
+                  }
+                  const Endpoint &send = r.type == PTP_START ? point : match->second;
+                  const Endpoint &recv = r.type == PTP_START ? match->second : point;
+                  std::ostringstream comm;
+                  comm << "3:" << send.thread << ":1:1:" << send.thread << ":" << send.time << ":" << send.time << ":"
+                       << recv.thread << ":1:1:" << recv.thread << ":" << recv.time << ":" << recv.time << ":"
+                       << send.size << ":" << r.domain;
+                  Line l = { send.time, 0, comm.str() };
+                  lines.push_back( l );
+                  other.erase( match );
+                  break;
+               }
+               default: break;
+            }
+            if ( type != 0 ) events << ":" << type << ":" << value;
+         }
+
+         if ( !events.str().empty() ) {
+            std::ostringstream event;
+            event << "2:" << thread << ":1:1:" << thread << ":" << time << events.str();
+            Line l = { time, 0, event.str() };
+            lines.push_back( l );
+         }
+         endTime = std::max( endTime, time );
+         i = j;
+      }
+   }
+
+   if ( !sends.empty() || !recvs.empty() ) {
+      std::cerr << sends.size() + recvs.size() << " unmatched point to point events" << std::endl;
+   }
+
+   for ( unsigned int i = 0; i < lines.size(); i++ ) lines[i].order = i;
+   std::sort( lines.begin(), lines.end() );
+
+   // Trace
+   std::string prvFile = output + ".prv";
+   FILE *prv = fopen( prvFile.c_str(), "w" );
+   if ( prv == NULL ) {
+      std::cerr << "Cannot write " << prvFile << std::endl;
+      return 1;
+   }
+   char date[64];
+   time_t now = time( NULL );
+   strftime( date, sizeof(date), "%d/%m/%y at %H:%M", localtime( &now ) );
+   fprintf( prv, "#Paraver (%s):%llu_ns:1(%u):1:1(%u:1)\n", date, (unsigned long long) endTime, numThreads, numThreads );
+   for ( unsigned int i = 0; i < lines.size(); i++ ) fprintf( prv, "%s\n", lines[i].text.c_str() );
+   fclose( prv );
+
+   // Configuration
+   std::ofstream pcf( ( output + ".pcf" ).c_str() );
+   pcf << "DEFAULT_OPTIONS" << std::endl << std::endl
+       << "LEVEL               THREAD" << std::endl
+       << "UNITS               NANOSEC" << std::endl
+       << "LOOK_BACK           100" << std::endl
+       << "SPEED               1" << std::endl
+       << "FLAG_ICONS          ENABLED" << std::endl
+       << "NUM_OF_STATE_COLORS 1000" << std::endl
+       << "YMAX_SCALE          37" << std::endl << std::endl << std::endl;
+   pcf << "STATES" << std::endl;
+   for ( unsigned int s = 0; s < numStates; s++ ) pcf << s << "    " << stateNames[s] << std::endl;
+   pcf << std::endl << std::endl;
+
+   const char *stateTypes[] = { "Thread state", "Thread sub-state" };
+   const uint64_t stateIds[] = { PRV_STATE, PRV_SUBSTATE };
+   for ( unsigned int t = 0; t < 2; t++ ) {
+      pcf << "EVENT_TYPE" << std::endl << "0    " << stateIds[t] << "    " << stateTypes[t] << std::endl << "VALUES" << std::endl;
+      for ( unsigned int s = 0; s < numStates; s++ ) pcf << s << "      " << stateNames[s] << std::endl;
+      pcf << std::endl << std::endl;
+   }
+   pcf << "EVENT_TYPE" << std::endl << "0    " << PRV_TASK << "    Running task id" << std::endl << std::endl << std::endl;
+
+   for ( std::map<uint32_t, Key>::const_iterator it = index.keys.begin(); it != index.keys.end(); it++ ) {
+      const Key &key = it->second;
+      pcf << "EVENT_TYPE" << std::endl << "0    " << PRV_KEY_BASE + it->first << "    " << key.description << std::endl;
+      if ( !key.values.empty() ) {
+         pcf << "VALUES" << std::endl << "0      End" << std::endl;
+         for ( unsigned int v = 0; v < key.values.size(); v++ )
+            pcf << key.values[v].first << "      " << key.values[v].second << std::endl;
+      }
+      pcf << std::endl << std::endl;
+   }
+   pcf.close();
+
+   // Names of the objects
+   std::ofstream row( ( output + ".row" ).c_str() );
+   row << "LEVEL CPU SIZE " << numThreads << std::endl;
+   for ( unsigned int t = 0; t < numThreads; t++ ) row << "CPU " << t + 1 << std::endl;
+   char host[256] = "localhost";
+   gethostname( host, sizeof(host) - 1 );
+   row << std::endl << "LEVEL NODE SIZE 1" << std::endl << host << std::endl;
+   row << std::endl << "LEVEL THREAD SIZE " << numThreads << std::endl;
+   for ( unsigned int t = 0; t < numThreads; t++ ) row << "THREAD 1.1." << t + 1 << std::endl;
+   row.close();
+
+   std::cout << "Paraver trace written to " << prvFile << std::endl;
+   return 0;
+}
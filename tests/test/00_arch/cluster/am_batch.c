@@ -0,0 +1,115 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator=gens/cluster-generator
+exec_versions="single batch small_batch"
+
+declare test_ENV_single="NX_ARGS='--cluster'"
+declare test_ENV_batch="NX_ARGS='--cluster --cluster-am-batch'"
+declare test_ENV_small_batch="NX_ARGS='--cluster --cluster-am-batch --cluster-am-batch-size=512 --cluster-am-batch-timeout=0'"
+</testinfo>
+*/
+
+/*
+ * Many small tasks offloaded to the other cluster node, with and without
+ * packing their dispatches and work-done notifications in batches. The small
+ * batches do not fit every WD, which then takes the single message path.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <nanos.h>
+
+#define NUM_TASKS    256
+#define BLOCK_SIZE   64
+#define ROUNDS       4
+
+typedef struct {
+   int inc;
+   int *block;
+} my_args;
+
+int vector[NUM_TASKS * BLOCK_SIZE];
+
+void add( void *ptr );
+void add( void *ptr )
+{
+   my_args *args = (my_args *) ptr;
+   int *block;
+   int i;
+
+   NANOS_SAFE( nanos_get_addr( 0, (void **) &block, nanos_current_wd() ) );
+   for ( i = 0; i < BLOCK_SIZE; i++ ) block[i] += args->inc;
+}
+
+nanos_smp_args_t add_device_arg = { add };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 const_data =
+{
+   { { .mandatory_creation = true, .tied = false }, __alignof__(my_args), 1, 1, 1, NULL },
+   { { nanos_smp_factory, &add_device_arg } }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+static void submit_add ( int t, int inc )
+{
+   my_args *args = NULL;
+   nanos_wd_t wd = NULL;
+   nanos_copy_data_t *cd = NULL;
+   nanos_region_dimension_internal_t *dims = NULL;
+
+   NANOS_SAFE( nanos_create_wd_compact( &wd, &const_data.base, &dyn_props, sizeof( my_args ), (void **) &args,
+                                        nanos_current_wd(), &cd, &dims ) );
+   args->inc = inc;
+   args->block = &vector[t * BLOCK_SIZE];
+
+   dims[0] = (nanos_region_dimension_internal_t) { BLOCK_SIZE * sizeof( int ), 0, BLOCK_SIZE * sizeof( int ) };
+   cd[0] = (nanos_copy_data_t) { (void *) args->block, NANOS_SHARED, { true, true }, 1, &dims[0], 0 };
+
+   NANOS_SAFE( nanos_submit( wd, 0, NULL, 0 ) );
+}
+
+int main ( int argc, char **argv )
+{
+   int r, t, i, expected = 0;
+
+   for ( r = 1; r <= ROUNDS; r++ ) {
+      for ( t = 0; t < NUM_TASKS; t++ ) submit_add( t, r );
+      NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+      expected += r;
+
+      for ( i = 0; i < NUM_TASKS * BLOCK_SIZE; i++ ) {
+         if ( vector[i] != expected ) {
+            fprintf( stderr, "round %d: vector[%d] is %d instead of %d\n", r, i, vector[i], expected );
+            return 1;
+         }
+      }
+   }
+   return 0;
+}
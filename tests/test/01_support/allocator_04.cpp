@@ -0,0 +1,81 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/* DESCRIPTION: Objects freed after the Allocator which created them has been destroyed,
+ * as it happens with objects that outlive their thread. The memory of the destroyed
+ * Allocator is overwritten before the frees, which must not touch it.
+ */
+
+/*<testinfo>
+test_generator="gens/core-generator -a \"--gpus=0\""
+</testinfo>*/
+
+#include <iostream>
+#include <string.h>
+#include "config.hpp"
+#include "smpprocessor.hpp"
+#include "system.hpp"
+#include "allocator.hpp"
+
+using namespace std;
+using namespace nanos;
+using namespace nanos::ext;
+
+#define OBJECTS 1000
+
+int sizes[] = { 7, 17, 33, 63, 123, 4000 };
+
+void deallocate ( void *args );
+void deallocate ( void *args )
+{
+   void **objects = *( (void ***) args );
+   for ( int i = 0; i < OBJECTS; i++ ) Allocator::deallocate( objects[i] );
+}
+
+int main ( int argc, char **argv )
+{
+   void *objects[OBJECTS];
+   void **objectsPtr = objects;
+
+   char *memory = (char *) malloc( sizeof( Allocator ) );
+   Allocator *dead = new ( memory ) Allocator();
+
+   for ( int i = 0; i < OBJECTS; i++ ) {
+      objects[i] = dead->allocate( sizes[i % ( sizeof( sizes ) / sizeof( int ) )] );
+   }
+   // Half of the objects freed (remotely) while the Allocator is alive
+   for ( int i = 0; i < OBJECTS; i += 2 ) Allocator::deallocate( objects[i] );
+
+   dead->~Allocator();
+   memset( memory, 0xff, sizeof( Allocator ) );
+
+   // The other half from this thread and from another one, with objects of a live Allocator
+   for ( int i = 1; i < OBJECTS / 2; i += 2 ) Allocator::deallocate( objects[i] );
+   for ( int i = OBJECTS / 2 + 1; i < OBJECTS; i += 2 ) objects[( i - OBJECTS / 2 ) / 2] = objects[i];
+   for ( int i = OBJECTS / 4; i < OBJECTS; i++ ) objects[i] = getAllocator().allocate( 16 );
+
+   WD *wg = getMyThreadSafe()->getCurrentWD();
+   WD *wd = new WD( new SMPDD( deallocate ), sizeof( void ** ), __alignof__( void ** ), &objectsPtr );
+   wg->addWork( *wd );
+   sys.submit( *wd );
+   wg->waitCompletion();
+
+   free( memory );
+   return 0;
+}
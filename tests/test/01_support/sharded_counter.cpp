@@ -0,0 +1,87 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator=gens/core-generator
+</testinfo>
+*/
+
+#include "config.hpp"
+#include "nanos.h"
+#include <iostream>
+#include "smpprocessor.hpp"
+#include "system.hpp"
+#include "shardedcounter.hpp"
+
+using namespace std;
+
+using namespace nanos;
+using namespace nanos::ext;
+
+#define NUM_TASKS     100
+#define NUM_ITERS     1000
+
+ShardedCounter up( 10 );
+ShardedCounter down;
+
+void task ( void *args );
+
+/**
+ * Every task adds NUM_ITERS to one counter and leaves the other unchanged,
+ * so both folded totals and per thread slots are exercised.
+ */
+void task ( void *args )
+{
+   for ( int i = 0; i < NUM_ITERS; i++ ) {
+      up++;
+      down -= 2;
+      down += 1;
+      ++down;
+   }
+}
+
+int main ( int argc, char **argv )
+{
+   WD *wg = getMyThreadSafe()->getCurrentWD();
+   for ( int i = 0; i < NUM_TASKS; i++ ) {
+      WD * wd = new WD( new SMPDD( task ) );
+      wg->addWork( *wd );
+      sys.submit( *wd );
+   }
+   wg->waitCompletion();
+
+   bool check = true;
+   if ( up.value() != 10 + NUM_TASKS * NUM_ITERS ) check = false;
+   if ( down.value() != 0 ) check = false;
+
+   int diff = up.value() - up.approximate();
+   if ( diff < -up.skew() || diff > up.skew() ) check = false;
+   diff = down.value() - down.approximate();
+   if ( diff < -down.skew() || diff > down.skew() ) check = false;
+
+   if ( check ) {
+      fprintf(stderr, "%s : %s\n", argv[0], "successful");
+      return 0;
+   }
+   else {
+      fprintf(stderr, "%s: %s\n", argv[0], "unsuccessful");
+      return -1;
+   }
+}
@@ -0,0 +1,115 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+/* DESCRIPTION: Checking SlabAllocator allocations in several threads, with memory
+ * deallocated in a different thread from the one which allocated it, so that
+ * objects go back and forth between thread caches and the central lists.
+ */
+
+/*<testinfo>
+test_generator="gens/core-generator -a \"--gpus=0\""
+</testinfo>*/
+
+#include <iostream>
+#include <string.h>
+#include <stdint.h>
+#include "config.hpp"
+#include "smpprocessor.hpp"
+#include "system.hpp"
+#include "slaballocator.hpp"
+
+using namespace std;
+using namespace nanos;
+using namespace nanos::ext;
+
+#define CHECK_VALUE 3456
+#define TIMES 1000
+
+size_t sizes[] = { 8, 100, 700, 1000, 3000, 20000 };
+bool check = true;
+
+void allocate( void *args );
+void deallocate ( void *ptr );
+
+void deallocate ( void *ptr )
+{
+   SlabAllocator::deallocate( ptr );
+}
+
+void allocate( void *args )
+{
+   int num_pes = sys.getSMPPlugin()->getNumWorkers();
+   int id = *((int *) args);
+
+   WD *wg = getMyThreadSafe()->getCurrentWD();
+
+   for ( int  n = 1; n <= TIMES; n++ ) {
+      for ( unsigned int i = 0; i < (sizeof( sizes )/sizeof(size_t)); i++ ) {
+
+         int *ptr = (int *) SlabAllocator::allocate( sizes[i] );
+         if ( ptr == NULL ) check = false;
+         if ( ( (uintptr_t) ptr ) % 16 != 0 ) check = false;
+         if ( SlabAllocator::getObjectSize( ptr ) < sizes[i] ) check = false;
+
+         int elems = sizes[i] / sizeof(int);
+         for ( int j = 0; j < elems; j++ ) ptr[j]=CHECK_VALUE; // INI
+         for ( int j = 0; j < elems; j++ ) ptr[j]++; // INC
+         for ( int j = 0; j < elems; j++ ) ptr[j]--; // DEC
+
+         // Check result
+         for ( int j = 0; j < elems; j++ ) {
+            if ( ptr[j] != CHECK_VALUE ) exit(-1);
+         }
+
+         // Creating a work descriptor to deallocate ptr in other thread
+         ThreadTeam &team = *getMyThreadSafe()->getTeam();
+         WD * wd = new WD( new SMPDD( deallocate ), sizeof( void * ), __alignof__( void * ), ptr  );
+         wg->addWork( *wd );
+         wd->tieTo(team[(id+1)%num_pes]);
+         sys.submit( *wd );
+
+         // Waiting decendants (to overlapping deallocations)
+         if ( ((n*i)%7) == 0 ) wg->waitCompletion();
+      }
+   }
+
+   wg->waitCompletion();
+}
+
+int main ( int argc, char **argv )
+{
+   int num_pes = sys.getSMPPlugin()->getNumWorkers();
+   int id[num_pes];
+
+   // Work Group affiliation
+   WD *wg = getMyThreadSafe()->getCurrentWD();
+
+   ThreadTeam &team = *getMyThreadSafe()->getTeam();
+   for ( int i = 0; i < num_pes; i++ ) {
+      id[i] = i;
+      WD * wd = new WD( new SMPDD( allocate ), sizeof( int ), __alignof__( int ), &id[i]  );
+      wg->addWork( *wd );
+      wd->tieTo(team[i]);
+      sys.submit( *wd );
+   }
+
+   // barrier (kind of)
+   wg->waitCompletion();
+
+   if (check) { return 0; } else { return -1; }
+}
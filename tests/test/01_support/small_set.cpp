@@ -0,0 +1,107 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator=gens/core-generator
+test_max_cpus=1
+</testinfo>
+*/
+
+#include "config.hpp"
+#include "nanos.h"
+#include <iostream>
+#include <set>
+#include <stdio.h>
+#include <stdlib.h>
+#include "smallvector.hpp"
+
+using namespace std;
+
+using namespace nanos;
+
+#define NUM_KEYS     1000
+
+typedef std::pair<unsigned int, int *> Key;
+
+/**
+ * Inserts and erases the same keys in a SmallSet and in a std::set and checks they hold the same
+ * elements in the same order, both below and above the inline capacity.
+ */
+static bool same ( SmallSet<Key,3> &small, std::set<Key> &ref )
+{
+   if ( small.size() != ref.size() ) return false;
+   std::set<Key>::iterator rit = ref.begin();
+   for ( SmallSet<Key,3>::iterator it = small.begin(); it != small.end(); it++, rit++ ) {
+      if ( *it != *rit ) return false;
+   }
+   return true;
+}
+
+int main ( int argc, char **argv )
+{
+   bool check = true;
+   SmallSet<Key,3> small;
+   std::set<Key> ref;
+   int dummy[4];
+
+   srand( 1 );
+   for ( int i = 0; i < NUM_KEYS; i++ ) {
+      // Mostly increasing ids, like WD ids of successors, with some going back
+      unsigned int id = ( rand() % 4 == 0 ) ? rand() % ( i + 1 ) : i;
+      Key key( id, &dummy[rand() % 4] );
+      if ( small.insert( key ).second != ref.insert( key ).second ) check = false;
+      if ( i % 3 == 0 ) {
+         Key victim( rand() % ( i + 1 ), &dummy[rand() % 4] );
+         if ( small.erase( victim ) != ref.erase( victim ) ) check = false;
+      }
+      if ( ( small.find( key ) == small.end() ) != ( ref.find( key ) == ref.end() ) ) check = false;
+   }
+   if ( !same( small, ref ) ) check = false;
+
+   // Erase through iterators, as done while releasing successors
+   for ( SmallSet<Key,3>::iterator it = small.begin(); it != small.end(); ) {
+      if ( it->first % 2 == 0 ) {
+         ref.erase( *it );
+         it = small.erase( it );
+      } else it++;
+   }
+   if ( !same( small, ref ) ) check = false;
+
+   SmallSet<Key,3> copy = small;
+   small.clear();
+   if ( !small.empty() || !same( copy, ref ) ) check = false;
+
+   SmallVector<int *,4> readers;
+   for ( int i = 0; i < 10; i++ ) readers.push_back( &dummy[i % 4] );
+   readers.remove( &dummy[1] );
+   if ( readers.size() != 7 ) check = false;
+   for ( SmallVector<int *,4>::iterator it = readers.begin(); it != readers.end(); it++ ) {
+      if ( *it == &dummy[1] ) check = false;
+   }
+
+   if ( check ) {
+      fprintf(stderr, "%s : %s\n", argv[0], "successful");
+      return 0;
+   }
+   else {
+      fprintf(stderr, "%s: %s\n", argv[0], "unsuccessful");
+      return -1;
+   }
+}
@@ -0,0 +1,146 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator=gens/api-generator
+exec_versions="async small_chunks non_temporal sync"
+
+declare test_ENV_async="NX_ARGS='--smp-private-memory'"
+declare test_ENV_small_chunks="NX_ARGS='--smp-private-memory --smp-copy-chunk=1000'"
+declare test_ENV_non_temporal="NX_ARGS='--smp-private-memory --smp-copy-chunk=4096 --smp-copy-nt-threshold=4096'"
+declare test_ENV_sync="NX_ARGS='--smp-private-memory --smp-sync-transfers'"
+</testinfo>
+*/
+
+/*
+ * Copies to and from the private memory of each SMP thread: contiguous blocks
+ * bigger than a copy chunk, strided column blocks of a matrix and a private
+ * argument, whose copy is not transferred but read from the task arguments.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <nanos.h>
+
+#define NUM_BLOCKS   8
+#define BLOCK_SIZE   5000
+#define ROWS         64
+#define COLS         ( NUM_BLOCKS * COL_BLOCK )
+#define COL_BLOCK    24
+#define ROUNDS       3
+
+typedef struct {
+   int inc;
+   int *block;
+   int *matrix;
+   int col;
+} my_args;
+
+int vector[NUM_BLOCKS * BLOCK_SIZE];
+int matrix[ROWS * COLS];
+
+void add( void *ptr );
+void add( void *ptr )
+{
+   my_args *args = (my_args *) ptr;
+   int *inc, *block, *m;
+   int i, j;
+
+   NANOS_SAFE( nanos_get_addr( 0, (void **) &inc, nanos_current_wd() ) );
+   NANOS_SAFE( nanos_get_addr( 1, (void **) &block, nanos_current_wd() ) );
+   NANOS_SAFE( nanos_get_addr( 2, (void **) &m, nanos_current_wd() ) );
+
+   if ( *inc != args->inc ) {
+      fprintf( stderr, "private argument is %d instead of %d\n", *inc, args->inc );
+      abort();
+   }
+   for ( i = 0; i < BLOCK_SIZE; i++ ) block[i] += *inc;
+   for ( i = 0; i < ROWS; i++ ) {
+      for ( j = args->col; j < args->col + COL_BLOCK; j++ ) m[i * COLS + j] += *inc;
+   }
+}
+
+nanos_smp_args_t add_device_arg = { add };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 const_data =
+{
+   { { .mandatory_creation = true, .tied = false }, __alignof__(my_args), 3, 1, 4, NULL },
+   { { nanos_smp_factory, &add_device_arg } }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+static void submit_add ( int b, int inc )
+{
+   my_args *args = NULL;
+   nanos_wd_t wd = NULL;
+   nanos_copy_data_t *cd = NULL;
+   nanos_region_dimension_internal_t *dims = NULL;
+
+   NANOS_SAFE( nanos_create_wd_compact( &wd, &const_data.base, &dyn_props, sizeof( my_args ), (void **) &args,
+                                        nanos_current_wd(), &cd, &dims ) );
+   args->inc = inc;
+   args->block = &vector[b * BLOCK_SIZE];
+   args->matrix = matrix;
+   args->col = b * COL_BLOCK;
+
+   dims[0] = (nanos_region_dimension_internal_t) { sizeof( int ), 0, sizeof( int ) };
+   dims[1] = (nanos_region_dimension_internal_t) { BLOCK_SIZE * sizeof( int ), 0, BLOCK_SIZE * sizeof( int ) };
+   dims[2] = (nanos_region_dimension_internal_t) { COLS * sizeof( int ), args->col * sizeof( int ), COL_BLOCK * sizeof( int ) };
+   dims[3] = (nanos_region_dimension_internal_t) { ROWS, 0, ROWS };
+
+   cd[0] = (nanos_copy_data_t) { (void *) &args->inc, NANOS_PRIVATE, { true, false }, 1, &dims[0], 0 };
+   cd[1] = (nanos_copy_data_t) { (void *) args->block, NANOS_SHARED, { true, true }, 1, &dims[1], 0 };
+   cd[2] = (nanos_copy_data_t) { (void *) matrix, NANOS_SHARED, { true, true }, 2, &dims[2], 0 };
+
+   NANOS_SAFE( nanos_submit( wd, 0, NULL, 0 ) );
+}
+
+int main ( int argc, char **argv )
+{
+   int r, b, i, expected = 0;
+
+   for ( r = 1; r <= ROUNDS; r++ ) {
+      for ( b = 0; b < NUM_BLOCKS; b++ ) submit_add( b, r );
+      NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+      expected += r;
+
+      for ( i = 0; i < NUM_BLOCKS * BLOCK_SIZE; i++ ) {
+         if ( vector[i] != expected ) {
+            fprintf( stderr, "round %d: vector[%d] is %d instead of %d\n", r, i, vector[i], expected );
+            return 1;
+         }
+      }
+      for ( i = 0; i < ROWS * COLS; i++ ) {
+         if ( matrix[i] != expected ) {
+            fprintf( stderr, "round %d: matrix[%d] is %d instead of %d\n", r, i, matrix[i], expected );
+            return 1;
+         }
+      }
+   }
+   return 0;
+}
@@ -0,0 +1,130 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator=gens/api-generator
+exec_versions="evict evict_sync"
+
+declare test_ENV_evict="NX_ARGS='--smp-private-memory --smp-private-memory-size=262144'"
+declare test_ENV_evict_sync="NX_ARGS='--smp-private-memory --smp-private-memory-size=262144 --smp-sync-transfers'"
+</testinfo>
+*/
+
+/*
+ * The blocks do not fit in the private memory of a thread, so the cache has
+ * to evict chunks to make room. Within the same wait, single sized blocks fill
+ * the memory, so the first double sized block has to evict a run of two
+ * contiguous chunks. The other blocks reuse a chunk of their own size.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <nanos.h>
+
+#define NUM_BLOCKS   32
+#define BLOCK_SIZE   4096
+#define ROUNDS       4
+
+typedef struct {
+   int inc;
+   int *block;
+   int size;
+} my_args;
+
+int first[NUM_BLOCKS * BLOCK_SIZE];
+int doubles[NUM_BLOCKS * BLOCK_SIZE];
+int last[NUM_BLOCKS * BLOCK_SIZE];
+
+void add( void *ptr );
+void add( void *ptr )
+{
+   my_args *args = (my_args *) ptr;
+   int *block;
+   int i;
+
+   NANOS_SAFE( nanos_get_addr( 0, (void **) &block, nanos_current_wd() ) );
+
+   for ( i = 0; i < args->size; i++ ) block[i] += args->inc;
+}
+
+nanos_smp_args_t add_device_arg = { add };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 const_data =
+{
+   { { .mandatory_creation = true, .tied = false }, __alignof__(my_args), 1, 1, 1, NULL },
+   { { nanos_smp_factory, &add_device_arg } }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+static void submit_add ( int *vector, int b, int num_blocks, int inc )
+{
+   my_args *args = NULL;
+   nanos_wd_t wd = NULL;
+   nanos_copy_data_t *cd = NULL;
+   nanos_region_dimension_internal_t *dims = NULL;
+
+   NANOS_SAFE( nanos_create_wd_compact( &wd, &const_data.base, &dyn_props, sizeof( my_args ), (void **) &args,
+                                        nanos_current_wd(), &cd, &dims ) );
+   args->inc = inc;
+   args->block = &vector[b * BLOCK_SIZE];
+   args->size = num_blocks * BLOCK_SIZE;
+
+   dims[0] = (nanos_region_dimension_internal_t) { args->size * sizeof( int ), 0, args->size * sizeof( int ) };
+   cd[0] = (nanos_copy_data_t) { (void *) args->block, NANOS_SHARED, { true, true }, 1, &dims[0], 0 };
+
+   NANOS_SAFE( nanos_submit( wd, 0, NULL, 0 ) );
+}
+
+static int check ( const char *name, int *vector, int r, int expected )
+{
+   int i;
+
+   for ( i = 0; i < NUM_BLOCKS * BLOCK_SIZE; i++ ) {
+      if ( vector[i] != expected ) {
+         fprintf( stderr, "round %d: %s[%d] is %d instead of %d\n", r, name, i, vector[i], expected );
+         return 1;
+      }
+   }
+   return 0;
+}
+
+int main ( int argc, char **argv )
+{
+   int r, b, expected = 0;
+
+   for ( r = 1; r <= ROUNDS; r++ ) {
+      for ( b = 0; b < NUM_BLOCKS; b++ ) submit_add( first, b, 1, r );
+      for ( b = 0; b < NUM_BLOCKS; b += 2 ) submit_add( doubles, b, 2, r );
+      for ( b = 0; b < NUM_BLOCKS; b++ ) submit_add( last, b, 1, r );
+      NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+      expected += r;
+      if ( check( "first", first, r, expected ) ) return 1;
+      if ( check( "doubles", doubles, r, expected ) ) return 1;
+      if ( check( "last", last, r, expected ) ) return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,136 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator=gens/api-generator
+test_deps_plugins=plain,sharded,regions,perfect-regions
+</testinfo>
+*/
+
+/*
+ * Concurrent (reduction) and commutative tasks that have all finished when the
+ * next access to their address is seen. Closing their group then releases it
+ * right away, from within the dependencies domain: at the taskwait, and when a
+ * task with another kind of access is submitted.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <nanos.h>
+
+#define NUM_TASKS 64
+#define NUM_VARS  8
+
+typedef struct {
+   int *p_i;
+} my_args;
+
+int vars[NUM_VARS];
+volatile int done;
+
+void increment ( void *ptr );
+void increment ( void *ptr )
+{
+   int *i = ( (my_args *) ptr )->p_i;
+   __sync_fetch_and_add( i, 1 );
+   __sync_fetch_and_add( &done, 1 );
+}
+
+nanos_smp_args_t increment_device_arg = { increment };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 const_data =
+{
+   { { .mandatory_creation = true, .tied = false }, __alignof__(my_args), 0, 1, 0, NULL },
+   { { nanos_smp_factory, &increment_device_arg } }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+enum access_kind { INOUT, CONCURRENT, COMMUTATIVE };
+
+static void submit_task ( int *var, enum access_kind kind )
+{
+   my_args *args = NULL;
+   nanos_wd_t wd = NULL;
+   nanos_region_dimension_t dimensions[1] = {{ sizeof(int), 0, sizeof(int) }};
+   nanos_data_access_t data_accesses[1] = {{ var, { 1, 1, 0, kind == CONCURRENT, kind == COMMUTATIVE }, 1, dimensions, 0 }};
+
+   NANOS_SAFE( nanos_create_wd_compact( &wd, &const_data.base, &dyn_props, sizeof( my_args ), (void **) &args,
+                                        nanos_current_wd(), NULL, NULL ) );
+   args->p_i = var;
+   NANOS_SAFE( nanos_submit( wd, 1, data_accesses, 0 ) );
+}
+
+//! \brief Submits a group of tasks on each variable and waits until all of them have run
+static void run_group ( enum access_kind kind )
+{
+   int i, j;
+
+   done = 0;
+   for ( i = 0; i < NUM_TASKS; i++ ) {
+      for ( j = 0; j < NUM_VARS; j++ ) submit_task( &vars[j], kind );
+   }
+   while ( done != NUM_TASKS * NUM_VARS ) NANOS_SAFE( nanos_yield() );
+}
+
+static bool check ( int expected )
+{
+   int j;
+   for ( j = 0; j < NUM_VARS; j++ ) {
+      if ( vars[j] != expected ) {
+         fprintf( stderr, "vars[%d] is %d instead of %d\n", j, vars[j], expected );
+         return false;
+      }
+   }
+   return true;
+}
+
+int main ( int argc, char **argv )
+{
+   //! Finished concurrent tasks released at the taskwait
+   run_group( CONCURRENT );
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+   if ( !check( NUM_TASKS ) ) return 1;
+
+   //! Finished commutative tasks released at the taskwait
+   run_group( COMMUTATIVE );
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+   if ( !check( 2 * NUM_TASKS ) ) return 1;
+
+   //! Finished concurrent tasks released by the submission of commutative ones
+   run_group( CONCURRENT );
+   run_group( COMMUTATIVE );
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+   if ( !check( 4 * NUM_TASKS ) ) return 1;
+
+   //! Finished commutative tasks released by the submission of inout ones
+   run_group( COMMUTATIVE );
+   run_group( INOUT );
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+   if ( !check( 6 * NUM_TASKS ) ) return 1;
+
+   return 0;
+}
@@ -0,0 +1,164 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+/*
+<testinfo>
+test_generator=gens/api-generator
+exec_versions="no_throttle throttle"
+
+declare test_ENV_throttle="NX_ARGS='--throttle-upper=2 --throttle-lower=2'"
+</testinfo>
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <nanos.h>
+
+#define NUM_ELEMS    8
+#define NUM_ITERS    20
+#define EXTRA_ITER   7     /* Submits one more task before the recorded ones */
+#define SHORT_ITER   10    /* Does not submit the last recorded task */
+#define WAIT_ITER    18    /* Waits in the middle of the region */
+
+typedef struct { int i; } task_args_t;
+
+int a[NUM_ELEMS], b[NUM_ELEMS], total;
+int ea[NUM_ELEMS], eb[NUM_ELEMS], etotal;
+
+void add_task ( void *args );
+void add_task ( void *args )
+{
+   a[((task_args_t *) args)->i]++;
+}
+
+void combine_task ( void *args );
+void combine_task ( void *args )
+{
+   int i = ((task_args_t *) args)->i;
+   b[i] += a[i];
+}
+
+void reduce_task ( void *args );
+void reduce_task ( void *args )
+{
+   int i;
+   for ( i = 0; i < NUM_ELEMS; i++ ) total += b[i];
+}
+
+nanos_smp_args_t add_device_arg = { (void(*)())add_task };
+nanos_smp_args_t combine_device_arg = { (void(*)())combine_task };
+nanos_smp_args_t reduce_device_arg = { (void(*)())reduce_task };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 add_data = { {{ .mandatory_creation = false, .tied = false}, 0, 0, 1, 0, NULL}, { { nanos_smp_factory, &add_device_arg } } };
+struct nanos_const_wd_definition_1 combine_data = { {{ .mandatory_creation = false, .tied = false}, 0, 0, 1, 0, NULL}, { { nanos_smp_factory, &combine_device_arg } } };
+struct nanos_const_wd_definition_1 reduce_data = { {{ .mandatory_creation = false, .tied = false}, 0, 0, 1, 0, NULL}, { { nanos_smp_factory, &reduce_device_arg } } };
+
+nanos_region_dimension_t dimensions[1] = {{sizeof(int), 0, sizeof(int)}};
+
+void submit_task ( struct nanos_const_wd_definition_1 *def, int i, size_t num_deps, nanos_data_access_t *deps );
+void submit_task ( struct nanos_const_wd_definition_1 *def, int i, size_t num_deps, nanos_data_access_t *deps )
+{
+   nanos_wd_t wd = 0;
+   nanos_wd_dyn_props_t dyn_props = {0};
+   task_args_t *args = NULL;
+
+   def->base.data_alignment = __alignof__(task_args_t);
+   NANOS_SAFE( nanos_create_wd_compact( &wd, &def->base, &dyn_props, sizeof(task_args_t), (void **) &args,
+               nanos_current_wd(), NULL, NULL ) );
+   if ( wd != NULL ) {
+      args->i = i;
+      NANOS_SAFE( nanos_submit( wd, num_deps, deps, 0 ) );
+   } else {
+      task_args_t imm_args = { i };
+      NANOS_SAFE( nanos_create_wd_and_run_compact( &def->base, &dyn_props, sizeof(task_args_t), &imm_args,
+                  num_deps, deps, NULL, NULL, NULL ) );
+   }
+}
+
+void submit_add ( int i );
+void submit_add ( int i )
+{
+   nanos_data_access_t deps[1] = {{&a[i], {1,1,0,0,0}, 1, dimensions, 0}};
+   submit_task( &add_data, i, 1, deps );
+   ea[i]++;
+}
+
+/* Every instance of the region submits the same graph: a chain add -> combine per
+ * element, all of them joined by a reduction. Some iterations change it on purpose.
+ * With a low throttle limit, submissions wait for tasks of the region to finish.
+ */
+int main ( int argc, char **argv )
+{
+   nanos_taskgraph_t graph = NULL;
+   int iter, i;
+
+   for ( iter = 0; iter < NUM_ITERS; iter++ ) {
+      NANOS_SAFE( nanos_taskgraph_begin( &graph ) );
+
+      if ( iter == EXTRA_ITER ) submit_add( 0 );
+
+      for ( i = 0; i < NUM_ELEMS; i++ ) {
+         nanos_data_access_t deps[2] = {{&a[i], {1,0,0,0,0}, 1, dimensions, 0}, {&b[i], {1,1,0,0,0}, 1, dimensions, 0}};
+
+         submit_add( i );
+         submit_task( &combine_data, i, 2, deps );
+         eb[i] += ea[i];
+
+         if ( iter == WAIT_ITER && i == NUM_ELEMS / 2 ) {
+            NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+         }
+      }
+
+      if ( iter != SHORT_ITER ) {
+         nanos_data_access_t deps[NUM_ELEMS + 1];
+         for ( i = 0; i < NUM_ELEMS; i++ ) {
+            nanos_data_access_t in = {&b[i], {1,0,0,0,0}, 1, dimensions, 0};
+            deps[i] = in;
+         }
+         nanos_data_access_t inout = {&total, {1,1,0,0,0}, 1, dimensions, 0};
+         deps[NUM_ELEMS] = inout;
+
+         submit_task( &reduce_data, 0, NUM_ELEMS + 1, deps );
+         for ( i = 0; i < NUM_ELEMS; i++ ) etotal += eb[i];
+      }
+
+      NANOS_SAFE( nanos_taskgraph_end( graph ) );
+
+      for ( i = 0; i < NUM_ELEMS; i++ ) {
+         if ( a[i] != ea[i] || b[i] != eb[i] ) {
+            fprintf( stderr, "Error: wrong value of element %d after iteration %d\n", i, iter );
+            return 1;
+         }
+      }
+      if ( total != etotal ) {
+         fprintf( stderr, "Error: wrong total after iteration %d (%d != %d)\n", iter, total, etotal );
+         return 1;
+      }
+   }
+
+   NANOS_SAFE( nanos_taskgraph_destroy( graph ) );
+
+   return 0;
+}
+
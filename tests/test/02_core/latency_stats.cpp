@@ -0,0 +1,109 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+/*
+<testinfo>
+test_generator="gens/core-generator -a \"--latency-stats --smp-workers=4|--latency-stats --latency-stats-json=latency_stats.json --summary\""
+</testinfo>
+*/
+
+#include "config.hpp"
+#include "nanos.h"
+#include <iostream>
+#include "smpprocessor.hpp"
+#include "system.hpp"
+#include "latencystats.hpp"
+
+using namespace std;
+
+using namespace nanos;
+using namespace nanos::ext;
+
+#define NUM_TASKS    256
+
+Atomic<int> counter;
+
+typedef struct {
+   int value;
+} main__task_data_t;
+
+void main__task ( void *args );
+
+void main__task ( void *args )
+{
+   main__task_data_t *hargs = (main__task_data_t * ) args;
+   counter += hargs->value;
+}
+
+// Every value must fall in a bucket whose bounds are within 1/SUB_BUCKETS of it
+static bool check_buckets ( void )
+{
+   for ( uint64_t value = 1; value < ( 1ULL << 40 ); value = value * 3 / 2 + 1 ) {
+      unsigned int bucket = LatencyHistogram::getBucket( value );
+      uint64_t lower = LatencyHistogram::getBucketLowerBound( bucket );
+      uint64_t upper = LatencyHistogram::getBucketLowerBound( bucket + 1 );
+      if ( lower > value || upper <= value ) return false;
+      if ( ( upper - lower ) * LatencyHistogram::SUB_BUCKETS > value && upper - lower > 1 ) return false;
+   }
+   return true;
+}
+
+static bool check_percentiles ( void )
+{
+   LatencyHistogram h;
+   for ( uint64_t value = 1; value <= 1000; value++ ) h.record( value );
+
+   if ( h.getCount() != 1000 || h.getMin() != 1 || h.getMax() != 1000 ) return false;
+   if ( h.getMean() < 500.0 || h.getMean() > 501.0 ) return false;
+
+   uint64_t p50 = h.getPercentile( 0.5 ), p99 = h.getPercentile( 0.99 );
+   return p50 >= 500 - 500 / 8 && p50 <= 500 + 500 / 8 && p99 >= 990 - 990 / 8 && p99 <= 1000;
+}
+
+int main ( int argc, char **argv )
+{
+   int expected = 0;
+   main__task_data_t _task_data[NUM_TASKS];
+
+   counter = 0;
+
+   if ( !LatencyStats::isEnabled() || getMyThreadSafe()->getLatencyStats() == NULL ) {
+      fprintf(stderr, "%s: %s\n", argv[0], "latency statistics are not enabled");
+      return -1;
+   }
+
+   WD *wg = getMyThreadSafe()->getCurrentWD();
+   for ( int i = 0; i < NUM_TASKS; i++ ) {
+      _task_data[i].value = i;
+      expected += i;
+
+      WD * wd = new WD( new SMPDD( main__task ), sizeof( main__task_data_t ), __alignof__(main__task_data_t), ( void * ) &_task_data[i] );
+      wg->addWork( *wd );
+      sys.submit( *wd );
+   }
+   wg->waitCompletion();
+
+   if ( counter.value() == expected && check_buckets() && check_percentiles() ) {
+      fprintf(stderr, "%s : %s\n", argv[0], "successful");
+      return 0;
+   }
+   else {
+      fprintf(stderr, "%s: %s\n", argv[0], "unsuccessful");
+      return -1;
+   }
+}
@@ -0,0 +1,132 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator=gens/core-generator
+exec_versions="default no_pool no_guard"
+
+declare test_ENV_no_pool="NX_ARGS='--smp-stack-hot=0 --smp-stack-cached=0'"
+declare test_ENV_no_guard="NX_ARGS='--smp-stack-no-guard --summary'"
+</testinfo>
+*/
+
+#include "config.hpp"
+#include "nanos.h"
+#include <iostream>
+#include "smpprocessor.hpp"
+#include "system.hpp"
+#include "smpstackpool.hpp"
+
+using namespace std;
+
+using namespace nanos;
+using namespace nanos::ext;
+
+#define NUM_STACKS   8
+#define NUM_TASKS    256
+
+Atomic<int> counter;
+
+typedef struct {
+   int value;
+} main__task_data_t;
+
+void child__task ( void *args );
+
+void child__task ( void *args )
+{
+   main__task_data_t *hargs = (main__task_data_t * ) args;
+   counter += hargs->value;
+}
+
+void main__task ( void *args );
+
+// Waiting for a child makes the task block on its own stack
+void main__task ( void *args )
+{
+   WD *parent = getMyThreadSafe()->getCurrentWD();
+   WD * wd = new WD( new SMPDD( child__task ), sizeof( main__task_data_t ), __alignof__(main__task_data_t), args );
+   parent->addWork( *wd );
+   sys.submit( *wd );
+   parent->waitCompletion();
+}
+
+// Stacks must be usable end to end and the pool must account for all of them
+static bool check_pool ( void )
+{
+   size_t size = SMPDD::getStackSize();
+   SMPStackPool::Stats before = SMPStackPool::getStats();
+   char *stacks[NUM_STACKS];
+
+   for ( int i = 0; i < NUM_STACKS; i++ ) {
+      stacks[i] = (char *) SMPStackPool::get();
+      stacks[i][0] = stacks[i][size - 1] = i;
+   }
+   if ( SMPStackPool::getStats()._inUse != before._inUse + NUM_STACKS ) return false;
+   if ( SMPStackPool::getStats()._peakInUse < before._inUse + NUM_STACKS ) return false;
+
+   for ( int i = 0; i < NUM_STACKS; i++ ) SMPStackPool::put( stacks[i] );
+   if ( SMPStackPool::getStats()._inUse != before._inUse ) return false;
+   // Fewer stacks than a trimming batch are only trimmed when the thread is idle
+   if ( SMPStackPool::getStats()._trimmed != before._trimmed ) return false;
+
+   // A pool that kept the stacks hands them out again without mapping new ones
+   SMPStackPool::Stats pooled = SMPStackPool::getStats();
+   char *stack = (char *) SMPStackPool::get();
+   stack[0] = stack[size - 1] = 0;
+   bool reused = SMPStackPool::getStats()._created == pooled._created;
+   SMPStackPool::put( stack );
+   if ( pooled._mapped > pooled._created || ( pooled._mapped != before._mapped && !reused ) ) return false;
+
+   // An exiting thread gives back every stack it pooled
+   SMPStackPool::trimPending();
+   SMPStackPool::releaseThread();
+   return SMPStackPool::getStats()._mapped <= before._mapped;
+}
+
+int main ( int argc, char **argv )
+{
+   int expected = 0;
+   main__task_data_t _task_data[NUM_TASKS];
+
+   counter = 0;
+
+   bool pool_ok = check_pool();
+
+   WD *wg = getMyThreadSafe()->getCurrentWD();
+   for ( int i = 0; i < NUM_TASKS; i++ ) {
+      _task_data[i].value = i;
+      expected += i;
+
+      WD * wd = new WD( new SMPDD( main__task ), sizeof( main__task_data_t ), __alignof__(main__task_data_t), ( void * ) &_task_data[i] );
+      wg->addWork( *wd );
+      sys.submit( *wd );
+   }
+   wg->waitCompletion();
+
+   if ( counter.value() == expected && pool_ok ) {
+      fprintf(stderr, "%s : %s\n", argv[0], "successful");
+      return 0;
+   }
+   else {
+      fprintf(stderr, "%s: %s\n", argv[0], "unsuccessful");
+      return -1;
+   }
+}
@@ -0,0 +1,89 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator="gens/core-generator -a \"--thread-manager=park --smp-workers=4|--thread-manager=park --smp-workers=4 --park-max-spin=0 --park-timeout=100000\""
+</testinfo>
+*/
+
+#include "config.hpp"
+#include "nanos.h"
+#include <iostream>
+#include <unistd.h>
+#include "smpprocessor.hpp"
+#include "system.hpp"
+
+using namespace std;
+
+using namespace nanos;
+using namespace nanos::ext;
+
+#define NUM_BURSTS    50
+#define BURST_SIZE    64
+
+Atomic<int> counter;
+
+typedef struct {
+   int value;
+} main__task_data_t;
+
+void main__task ( void *args );
+
+void main__task ( void *args )
+{
+   main__task_data_t *hargs = (main__task_data_t * ) args;
+   counter += hargs->value;
+}
+
+int main ( int argc, char **argv )
+{
+   int expected = 0;
+   main__task_data_t _task_data[BURST_SIZE];
+
+   counter = 0;
+
+   // Bursts of tasks separated by pauses long enough for the workers to park,
+   // every burst must wake them up again
+   for ( int i = 0; i < NUM_BURSTS; i++ ) {
+      WD *wg = getMyThreadSafe()->getCurrentWD();
+
+      for ( int j = 0; j < BURST_SIZE; j++ ) {
+         _task_data[j].value = i + j;
+         expected += i + j;
+
+         WD * wd = new WD( new SMPDD( main__task ), sizeof( main__task_data_t ), __alignof__(main__task_data_t), ( void * ) &_task_data[j] );
+         wg->addWork( *wd );
+         sys.submit( *wd );
+      }
+
+      wg->waitCompletion();
+
+      usleep( ( i % 5 ) * 500 );
+   }
+
+   if ( counter.value() == expected ) {
+      fprintf(stderr, "%s : %s\n", argv[0], "successful");
+      return 0;
+   }
+   else {
+      fprintf(stderr, "%s: %s\n", argv[0], "unsuccessful");
+      return -1;
+   }
+}
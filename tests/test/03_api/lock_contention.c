@@ -0,0 +1,149 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator="gens/api-omp-generator -a \"--lock-spins=0|--lock-backoff=1\""
+</testinfo>
+*/
+
+/*
+ * Test description:
+ * Many tasks update counters under the locks of nanos_get_lock_address, both a
+ * shared one and one per slot, and under a lazily allocated omp_lock_t. Checks
+ * the counters and that the lock pool maps each address to a single lock.
+ */
+
+#include <stdio.h>
+#include <nanos.h>
+#include <omp.h>
+
+#define NUM_TASKS    1000
+#define NUM_SLOTS    64
+#define NUM_ITERS    100
+
+typedef struct {
+   int index;
+} task_args_t;
+
+int shared_counter;
+int slot_counters[NUM_SLOTS];
+int omp_counter;
+omp_lock_t omp_lock = 0;
+
+void lock_task ( void *p_args );
+void lock_task ( void *p_args )
+{
+   task_args_t *args = (task_args_t *) p_args;
+   nanos_lock_t *shared_lock, *slot_lock;
+   int i;
+
+   NANOS_SAFE( nanos_get_lock_address( &shared_counter, &shared_lock ) );
+   NANOS_SAFE( nanos_get_lock_address( &slot_counters[args->index % NUM_SLOTS], &slot_lock ) );
+
+   for ( i = 0; i < NUM_ITERS; i++ ) {
+      NANOS_SAFE( nanos_set_lock( shared_lock ) );
+      shared_counter++;
+      NANOS_SAFE( nanos_unset_lock( shared_lock ) );
+
+      NANOS_SAFE( nanos_set_lock( slot_lock ) );
+      slot_counters[args->index % NUM_SLOTS]++;
+      NANOS_SAFE( nanos_unset_lock( slot_lock ) );
+
+      omp_set_lock( &omp_lock );
+      omp_counter++;
+      omp_unset_lock( &omp_lock );
+   }
+}
+
+nanos_smp_args_t lock_task_device_args = { lock_task };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 lock_const_data =
+{
+   { { .mandatory_creation = true, .tied = false}, __alignof__( task_args_t), 0, 1, 0, NULL },
+   { { nanos_smp_factory, &lock_task_device_args } }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+int main ( int argc, char **argv )
+{
+   nanos_lock_t *first, *second;
+   int i;
+
+   /* The same address always maps to the same lock, different ones do not */
+   NANOS_SAFE( nanos_get_lock_address( &slot_counters[0], &first ) );
+   NANOS_SAFE( nanos_get_lock_address( &slot_counters[0], &second ) );
+   if ( first != second ) {
+      fprintf( stderr, "Different locks for the same address\n" );
+      return 1;
+   }
+   for ( i = 1; i < NUM_SLOTS; i++ ) {
+      NANOS_SAFE( nanos_get_lock_address( &slot_counters[i], &second ) );
+      if ( first == second ) {
+         fprintf( stderr, "Same lock for different addresses\n" );
+         return 1;
+      }
+   }
+
+   /* A lock taken with a try can not be taken again until it is released */
+   NANOS_SAFE( nanos_get_lock_address( &omp_counter, &first ) );
+   bool acquired = false;
+   NANOS_SAFE( nanos_try_lock( first, &acquired ) );
+   if ( !acquired ) {
+      fprintf( stderr, "Could not take a free lock\n" );
+      return 1;
+   }
+   NANOS_SAFE( nanos_try_lock( first, &acquired ) );
+   if ( acquired ) {
+      fprintf( stderr, "Took a busy lock\n" );
+      return 1;
+   }
+   NANOS_SAFE( nanos_unset_lock( first ) );
+
+   for ( i = 0; i < NUM_TASKS; i++ ) {
+      nanos_wd_t wd = NULL;
+      task_args_t *args = NULL;
+      NANOS_SAFE( nanos_create_wd_compact ( &wd, &lock_const_data.base, &dyn_props, sizeof( task_args_t ),
+                                            (void **) &args, nanos_current_wd(), NULL, NULL ) );
+      args->index = i;
+      NANOS_SAFE( nanos_submit( wd, 0, NULL, NULL ) );
+   }
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+
+   omp_destroy_lock( &omp_lock );
+
+   if ( shared_counter != NUM_TASKS * NUM_ITERS || omp_counter != NUM_TASKS * NUM_ITERS ) {
+      fprintf( stderr, "%s : unsuccessful, shared counter %d omp counter %d\n", argv[0], shared_counter, omp_counter );
+      return 1;
+   }
+   for ( i = 0; i < NUM_SLOTS; i++ ) {
+      if ( slot_counters[i] != NUM_TASKS / NUM_SLOTS * NUM_ITERS + ( i < NUM_TASKS % NUM_SLOTS ? NUM_ITERS : 0 ) ) {
+         fprintf( stderr, "%s : unsuccessful, slot %d counter %d\n", argv[0], i, slot_counters[i] );
+         return 1;
+      }
+   }
+   return 0;
+}
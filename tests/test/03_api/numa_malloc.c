@@ -0,0 +1,159 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator=gens/api-generator
+</testinfo>
+*/
+
+/*
+ * Test description:
+ * Allocates memory with every placement policy of nanos_numa_malloc, checks the
+ * recorded home nodes and that the memory is usable, including an array first
+ * touched by a task given with nanos_numa_first_touch, and many small areas
+ * bound to different nodes.
+ */
+
+#include <stdio.h>
+#include <nanos.h>
+
+#define SIZE   100000
+#define SMALL  200
+
+typedef struct {
+   int *array;
+} task_args_t;
+
+void init_task ( void *p_args );
+void init_task ( void *p_args )
+{
+   task_args_t *args = (task_args_t *) p_args;
+   int i;
+   for ( i = 0; i < SIZE; i++ ) args->array[i] = i;
+}
+
+nanos_smp_args_t init_task_device_args = { init_task };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 init_const_data =
+{
+   {
+     { .mandatory_creation = true, .tied = false},
+     __alignof__( task_args_t), 0, 1, 0, NULL
+   },
+   {
+      { nanos_smp_factory, &init_task_device_args }
+   }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+static int check_array ( int *array )
+{
+   int i, error = 0;
+   for ( i = 0; i < SIZE; i++ ) array[i] = i;
+   for ( i = 0; i < SIZE; i++ ) if ( array[i] != i ) error++;
+   return error;
+}
+
+int main ( int argc, char **argv )
+{
+   int *bound, *interleaved, *blocked, *touched;
+   int *small[SMALL];
+   char *first, *last;
+   int num_nodes, node, i;
+   int error = 0;
+   nanos_wd_t wd = NULL;
+   task_args_t *args = NULL;
+
+   NANOS_SAFE( nanos_get_num_sockets( &num_nodes ) );
+   if ( num_nodes < 1 ) num_nodes = 1;
+
+   NANOS_SAFE( nanos_numa_malloc( (void **) &bound, SIZE * sizeof(int), NANOS_NUMA_BIND, num_nodes - 1, __FILE__, __LINE__ ) );
+   NANOS_SAFE( nanos_numa_malloc( (void **) &interleaved, SIZE * sizeof(int), NANOS_NUMA_INTERLEAVE, 0, __FILE__, __LINE__ ) );
+   NANOS_SAFE( nanos_numa_malloc( (void **) &blocked, SIZE * sizeof(int), NANOS_NUMA_BLOCK, 0, __FILE__, __LINE__ ) );
+   NANOS_SAFE( nanos_numa_malloc( (void **) &touched, SIZE * sizeof(int), NANOS_NUMA_FIRST_TOUCH, 0, __FILE__, __LINE__ ) );
+
+   if ( nanos_numa_malloc( (void **) &bound, SIZE, NANOS_NUMA_BIND, num_nodes, __FILE__, __LINE__ ) != NANOS_INVALID_PARAM ) error++;
+
+   /* Homes */
+   NANOS_SAFE( nanos_numa_get_home( bound, SIZE * sizeof(int), &node ) );
+   if ( node != num_nodes - 1 ) error++;
+   NANOS_SAFE( nanos_numa_get_home( interleaved, SIZE * sizeof(int), &node ) );
+   if ( node != -1 ) error++;
+   NANOS_SAFE( nanos_numa_get_home( blocked, sizeof(int), &node ) );
+   if ( node != 0 ) error++;
+   NANOS_SAFE( nanos_numa_get_home( &blocked[SIZE - 1], sizeof(int), &node ) );
+   if ( node != num_nodes - 1 ) error++;
+   NANOS_SAFE( nanos_numa_get_home( touched, SIZE * sizeof(int), &node ) );
+   if ( node != -1 ) error++;
+
+   /* The first touch task gives its node to the array */
+   NANOS_SAFE( nanos_create_wd_compact ( &wd, &init_const_data.base, &dyn_props, sizeof( task_args_t ),
+                                         (void **) &args, nanos_current_wd(), NULL, NULL ) );
+   args->array = touched;
+   NANOS_SAFE( nanos_numa_first_touch( touched, SIZE * sizeof(int), wd ) );
+   NANOS_SAFE( nanos_numa_get_home( touched, SIZE * sizeof(int), &node ) );
+   if ( node < 0 || node >= num_nodes ) error++;
+   NANOS_SAFE( nanos_submit( wd, 0, NULL, NULL ) );
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+
+   for ( i = 0; i < SIZE; i++ ) if ( touched[i] != i ) error++;
+   error += check_array( bound );
+   error += check_array( interleaved );
+   error += check_array( blocked );
+
+   NANOS_SAFE( nanos_numa_free( bound ) );
+   NANOS_SAFE( nanos_numa_free( interleaved ) );
+   NANOS_SAFE( nanos_numa_free( blocked ) );
+   NANOS_SAFE( nanos_numa_free( touched ) );
+
+   /* Many areas, and a range that spans all of them */
+   for ( i = 0; i < SMALL; i++ ) {
+      NANOS_SAFE( nanos_numa_malloc( (void **) &small[i], sizeof(int), NANOS_NUMA_BIND, i % num_nodes, __FILE__, __LINE__ ) );
+   }
+   first = last = (char *) small[0];
+   for ( i = 0; i < SMALL; i++ ) {
+      NANOS_SAFE( nanos_numa_get_home( small[i], sizeof(int), &node ) );
+      if ( node != i % num_nodes ) error++;
+      if ( (char *) small[i] < first ) first = (char *) small[i];
+      if ( (char *) small[i] > last ) last = (char *) small[i];
+   }
+   NANOS_SAFE( nanos_numa_get_home( first, last + sizeof(int) - first, &node ) );
+   if ( node < 0 || node >= num_nodes ) error++;
+   for ( i = 0; i < SMALL; i++ ) {
+      NANOS_SAFE( nanos_numa_free( small[i] ) );
+   }
+   NANOS_SAFE( nanos_numa_get_home( first, last + sizeof(int) - first, &node ) );
+   if ( node != -1 ) error++;
+
+   /* Freed memory has no home and cannot be freed again */
+   NANOS_SAFE( nanos_numa_get_home( blocked, sizeof(int), &node ) );
+   if ( node != -1 ) error++;
+   if ( nanos_numa_free( blocked ) != NANOS_INVALID_PARAM ) error++;
+
+   fprintf( stderr, "%s : %s\n", argv[0], error == 0 ? "  successful" : "unsuccessful" );
+   return error == 0 ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator=gens/api-generator
+</testinfo>
+*/
+
+/*
+ * Test description:
+ * Submits tasks in batches through nanos_submit_batch. The first part only
+ * submits independent tasks. In the second one every batch mixes independent
+ * tasks with tasks chained through an inout dependence on the same variable,
+ * whose final value depends on the chain being executed in order.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <nanos.h>
+
+#define NUM_TASKS    1024
+#define BATCH        64
+
+typedef struct {
+   int *slot;
+   int value;
+} task_args_t;
+
+void set_task ( void *p_args );
+void set_task ( void *p_args )
+{
+   task_args_t *args = (task_args_t *) p_args;
+   *args->slot = args->value;
+}
+
+void chain_task ( void *p_args );
+void chain_task ( void *p_args )
+{
+   task_args_t *args = (task_args_t *) p_args;
+   *args->slot = ( *args->slot * 3 + args->value ) % 1000003;
+}
+
+nanos_smp_args_t set_task_device_args = { set_task };
+nanos_smp_args_t chain_task_device_args = { chain_task };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 set_const_data =
+{
+   {
+     { .mandatory_creation = true, .tied = false},
+     __alignof__( task_args_t), 0, 1, 0, NULL
+   },
+   {
+      { nanos_smp_factory, &set_task_device_args }
+   }
+};
+
+struct nanos_const_wd_definition_1 chain_const_data =
+{
+   {
+     { .mandatory_creation = true, .tied = false},
+     __alignof__( task_args_t), 0, 1, 0, NULL
+   },
+   {
+      { nanos_smp_factory, &chain_task_device_args }
+   }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+int slots[NUM_TASKS];
+int chain = 1;
+
+static nanos_wd_t create_task ( struct nanos_const_wd_definition_1 *const_data, int *slot, int value )
+{
+   nanos_wd_t wd = NULL;
+   task_args_t *args = NULL;
+
+   NANOS_SAFE( nanos_create_wd_compact ( &wd, &const_data->base, &dyn_props, sizeof( task_args_t ),
+                                         (void **) &args, nanos_current_wd(), NULL, NULL ) );
+   args->slot = slot;
+   args->value = value;
+   return wd;
+}
+
+int main ( int argc, char **argv )
+{
+   nanos_wd_t wds[BATCH];
+   size_t num_deps[BATCH];
+   nanos_data_access_t *deps[BATCH];
+   nanos_data_access_t accesses[BATCH];
+   nanos_region_dimension_t dimension = { sizeof(int), 0, sizeof(int) };
+   int i, j, expected = 1;
+   int error = 0;
+
+   /* Independent tasks only */
+   memset( slots, 0, sizeof(slots) );
+   for ( i = 0; i < NUM_TASKS; i += BATCH ) {
+      for ( j = 0; j < BATCH; j++ ) {
+         wds[j] = create_task( &set_const_data, &slots[i+j], i + j + 1 );
+      }
+      NANOS_SAFE( nanos_submit_batch( BATCH, wds, NULL, NULL, NULL ) );
+   }
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+
+   for ( i = 0; i < NUM_TASKS; i++ ) {
+      if ( slots[i] != i + 1 ) error++;
+   }
+
+   /* Even tasks of every batch form a chain on 'chain', odd ones are independent */
+   memset( slots, 0, sizeof(slots) );
+   for ( i = 0; i < NUM_TASKS; i += BATCH ) {
+      for ( j = 0; j < BATCH; j++ ) {
+         if ( j % 2 == 0 ) {
+            wds[j] = create_task( &chain_const_data, &chain, i + j );
+            expected = ( expected * 3 + i + j ) % 1000003;
+
+            accesses[j].address = &chain;
+            accesses[j].flags.input = 1;
+            accesses[j].flags.output = 1;
+            accesses[j].flags.can_rename = 0;
+            accesses[j].flags.concurrent = 0;
+            accesses[j].flags.commutative = 0;
+            accesses[j].dimension_count = 1;
+            accesses[j].dimensions = &dimension;
+            accesses[j].offset = 0;
+
+            num_deps[j] = 1;
+            deps[j] = &accesses[j];
+         } else {
+            wds[j] = create_task( &set_const_data, &slots[i+j], i + j + 1 );
+            num_deps[j] = 0;
+            deps[j] = NULL;
+         }
+      }
+      NANOS_SAFE( nanos_submit_batch( BATCH, wds, num_deps, deps, NULL ) );
+   }
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+
+   for ( i = 1; i < NUM_TASKS; i += 2 ) {
+      if ( slots[i] != i + 1 ) error++;
+   }
+   if ( chain != expected ) error++;
+
+   fprintf( stderr, "%s : %s\n", argv[0], error == 0 ? "  successful" : "unsuccessful" );
+   return error == 0 ? 0 : 1;
+}
@@ -0,0 +1,190 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator="gens/api-generator -a \"--reduction-block-size=0|--reduction-block-size=4096\""
+</testinfo>
+*/
+
+/*
+ * Test description:
+ * Array task reductions combined by the runtime: an int sum registered with a
+ * built-in operator, a double max registered with the built-in reducer of
+ * nanos_reduction.h and a long sum with a user reducer. With a small reduction
+ * block size the arrays are split in blocks that are reduced in parallel.
+ */
+
+#include <stdio.h>
+#include <nanos.h>
+#include "nanos_reduction.h"
+
+#define NUM_TASKS    64
+#define SIZE         20000
+
+typedef struct {
+   int task;
+} task_args_t;
+
+int sum[SIZE];
+double max[SIZE];
+long user[SIZE];
+
+void init_int ( void *priv, void *orig );
+void init_int ( void *priv, void *orig ) { *(int *) priv = 0; }
+
+void init_double ( void *priv, void *orig );
+void init_double ( void *priv, void *orig ) { *(double *) priv = -1.0; }
+
+void init_long ( void *priv, void *orig );
+void init_long ( void *priv, void *orig ) { *(long *) priv = 0; }
+
+void reduce_int ( void *a, void *b );
+void reduce_int ( void *a, void *b ) { *(int *) a += *(int *) b; }
+
+void reduce_long ( void *a, void *b );
+void reduce_long ( void *a, void *b ) { *(long *) a += *(long *) b; }
+
+void reduction_task ( void *p_args );
+void reduction_task ( void *p_args )
+{
+   task_args_t *args = (task_args_t *) p_args;
+   int *p_sum;
+   double *p_max;
+   long *p_user;
+   int i;
+
+   NANOS_SAFE( nanos_task_reduction_get_thread_storage( sum, (void **) &p_sum ) );
+   NANOS_SAFE( nanos_task_reduction_get_thread_storage( max, (void **) &p_max ) );
+   NANOS_SAFE( nanos_task_reduction_get_thread_storage( user, (void **) &p_user ) );
+
+   for ( i = 0; i < SIZE; i++ ) {
+      double value = ( args->task * 7 + i ) % 101;
+      p_sum[i] += args->task + i % 3;
+      if ( value > p_max[i] ) p_max[i] = value;
+      p_user[i] += i;
+   }
+}
+
+void empty_task ( void *p_args );
+void empty_task ( void *p_args ) {}
+
+nanos_smp_args_t reduction_task_device_args = { reduction_task };
+nanos_smp_args_t empty_task_device_args = { empty_task };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 reduction_const_data =
+{
+   {
+     { .mandatory_creation = true, .tied = false},
+     __alignof__( task_args_t), 0, 1, 0, NULL
+   },
+   {
+      { nanos_smp_factory, &reduction_task_device_args }
+   }
+};
+
+struct nanos_const_wd_definition_1 empty_const_data =
+{
+   {
+     { .mandatory_creation = true, .tied = false},
+     __alignof__( task_args_t), 0, 1, 0, NULL
+   },
+   {
+      { nanos_smp_factory, &empty_task_device_args }
+   }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+nanos_region_dimension_t sum_dimension = { sizeof(sum), 0, sizeof(sum) };
+nanos_region_dimension_t max_dimension = { sizeof(max), 0, sizeof(max) };
+nanos_region_dimension_t user_dimension = { sizeof(user), 0, sizeof(user) };
+
+static void set_access ( nanos_data_access_t *access, void *address, nanos_region_dimension_t *dimension, int concurrent )
+{
+   access->address = address;
+   access->flags.input = 1;
+   access->flags.output = concurrent;
+   access->flags.can_rename = 0;
+   access->flags.concurrent = concurrent;
+   access->flags.commutative = 0;
+   access->dimension_count = 1;
+   access->dimensions = dimension;
+   access->offset = 0;
+}
+
+static void submit ( struct nanos_const_wd_definition_1 *const_data, int task, int concurrent )
+{
+   nanos_data_access_t accesses[3];
+   nanos_wd_t wd = NULL;
+   task_args_t *args = NULL;
+
+   set_access( &accesses[0], sum, &sum_dimension, concurrent );
+   set_access( &accesses[1], max, &max_dimension, concurrent );
+   set_access( &accesses[2], user, &user_dimension, concurrent );
+
+   NANOS_SAFE( nanos_create_wd_compact ( &wd, &const_data->base, &dyn_props, sizeof( task_args_t ),
+                                         (void **) &args, nanos_current_wd(), NULL, NULL ) );
+   args->task = task;
+   NANOS_SAFE( nanos_submit( wd, 3, accesses, NULL ) );
+}
+
+int main ( int argc, char **argv )
+{
+   int i, t;
+   int error = 0;
+
+   for ( i = 0; i < SIZE; i++ ) {
+      sum[i] = 0;
+      max[i] = -1.0;
+      user[i] = 0;
+   }
+
+   NANOS_SAFE( nanos_task_reduction_register_builtin( sum, sizeof(sum), sizeof(int), init_int, reduce_int,
+                                                      NANOS_REDUCTION_ADD, NANOS_REDUCTION_INT ) );
+   NANOS_SAFE( nanos_task_reduction_register( max, sizeof(max), sizeof(double), init_double,
+                                              nanos_reduction_bop_max_double ) );
+   NANOS_SAFE( nanos_task_reduction_register( user, sizeof(user), sizeof(long), init_long, reduce_long ) );
+
+   for ( t = 0; t < NUM_TASKS; t++ ) submit( &reduction_const_data, t, 1 );
+
+   /* Reading the arrays finalizes the reductions */
+   submit( &empty_const_data, 0, 0 );
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+
+   for ( i = 0; i < SIZE; i++ ) {
+      double expected_max = -1.0;
+      for ( t = 0; t < NUM_TASKS; t++ ) {
+         double value = ( t * 7 + i ) % 101;
+         if ( value > expected_max ) expected_max = value;
+      }
+      if ( sum[i] != NUM_TASKS * ( NUM_TASKS - 1 ) / 2 + NUM_TASKS * ( i % 3 ) ) error++;
+      if ( max[i] != expected_max ) error++;
+      if ( user[i] != (long) NUM_TASKS * i ) error++;
+   }
+
+   fprintf( stderr, "%s : %s\n", argv[0], error == 0 ? "  successful" : "unsuccessful" );
+   return error == 0 ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator="gens/core-generator -a \"--gpus=0 --smp-workers=4 --barrier=combining|--gpus=0 --smp-workers=7 --barrier=combining --barrier-combining-radix=2\""
+</testinfo>
+*/
+
+#include "config.hpp"
+#include "nanos.h"
+#include <iostream>
+#include "smpprocessor.hpp"
+#include "system.hpp"
+#include "threadteam.hpp"
+#include <string.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace nanos;
+using namespace nanos::ext;
+
+#define BARR_NUM 10
+
+int* counts;
+int size;
+
+long long sum;
+volatile int registered = 0;
+long long* privates;
+
+void sum_bop ( void *original, void *current, int num_scalars );
+void no_cleanup ( void *descriptor );
+void barrier_code ( void * );
+
+void sum_bop ( void *original, void *current, int num_scalars )
+{
+   *(long long *) original += *(long long *) current;
+}
+
+void no_cleanup ( void *descriptor ) {}
+
+/*! the first barrier of every iteration also folds the contribution of every participant to 'sum' */
+void barrier_code ( void * )
+{
+       int me = getMyThreadSafe()->getTeamId();
+
+       for ( int i = 0; i < BARR_NUM; i++ ) {
+              // the reduction is registered before anybody arrives at the barrier that folds it
+              if ( me == 0 ) {
+                 // the barrier releases the reduction once it has been folded
+                 nanos_reduction_t *red;
+                 NANOS_SAFE( nanos_malloc( (void **) &red, sizeof(nanos_reduction_t), __FILE__, __LINE__ ) );
+                 memset( red, 0, sizeof(nanos_reduction_t) );
+                 red->original = &sum;
+                 red->privates = privates;
+                 red->descriptor = privates;
+                 red->element_size = sizeof(long long);
+                 red->num_scalars = 1;
+                 red->bop = sum_bop;
+                 red->cleanup = no_cleanup;
+
+                 sum = 0;
+                 NANOS_SAFE( nanos_register_reduction( red ) );
+                 memoryFence();
+                 registered = i + 1;
+              }
+              while ( registered != i + 1 ) memoryFence();
+
+              counts[me]++;
+              privates[me] = me + i;
+
+              nanos_team_barrier();
+
+              if ( counts[ (me+1)%size ] != i+1 ) {
+                 cerr << "Error: the barrier is broken." << std::endl;
+                 abort();
+              }
+              long long expected = (long long) size * ( size - 1 ) / 2 + (long long) size * i;
+              if ( sum != expected ) {
+                 cerr << "Error: the reduction is " << sum << " instead of " << expected << std::endl;
+                 abort();
+              }
+
+              nanos_team_barrier();
+       }
+}
+
+int main (int argc, char **argv)
+{
+       cout << "start" << endl;
+       //all threads perform a barrier: 
+       ThreadTeam &team = *getMyThreadSafe()->getTeam();
+
+       size = team.size();
+       counts = new int[team.size()];
+       privates = new long long[team.size()];
+
+       counts[0] = 0;
+
+       for ( unsigned i = 1; i < team.size(); i++ ) {
+              counts[i] = 0;
+              WD * wd = new WD(new SMPDD(barrier_code));
+	      wd->tieTo(team[i]);
+              sys.submit(*wd);
+       }
+       usleep(100);
+
+       WD *wd = getMyThreadSafe()->getCurrentWD();
+       wd->tieTo(*getMyThreadSafe());
+       barrier_code(NULL);
+
+       cout << "end" << endl;
+}
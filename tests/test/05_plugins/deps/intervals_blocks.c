@@ -0,0 +1,177 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator=gens/api-generator
+test_deps_plugins=intervals,regions
+</testinfo>
+*/
+
+/*
+ * Test description:
+ * Tasks update or read overlapping rectangular blocks of a matrix through
+ * two-dimensional dependences. Updates do not commute, and every read stores
+ * the sum of its block, so both the matrix and the sums only match the
+ * sequential execution if every overlap has been honoured. Some blocks are
+ * taller than the row limit of the intervals plugin and are tracked as their
+ * bounding interval.
+ */
+
+#include <stdio.h>
+#include <nanos.h>
+
+#define N            64
+#define NUM_TASKS    600
+#define MAX_BLOCK    40
+
+typedef struct {
+   int row, col, height, width;
+   int value;
+   int *sum;          /* NULL for updates */
+} task_args_t;
+
+int matrix[N][N];
+int sums[NUM_TASKS];
+
+void block_task ( void *p_args );
+void block_task ( void *p_args )
+{
+   task_args_t *args = (task_args_t *) p_args;
+   int i, j, sum = 0;
+
+   for ( i = args->row; i < args->row + args->height; i++ ) {
+      for ( j = args->col; j < args->col + args->width; j++ ) {
+         if ( args->sum == NULL ) {
+            matrix[i][j] = ( matrix[i][j] * 3 + args->value ) % 10007;
+         } else {
+            sum += matrix[i][j];
+         }
+      }
+   }
+   if ( args->sum != NULL ) *args->sum = sum;
+}
+
+nanos_smp_args_t block_task_device_args = { block_task };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 block_const_data =
+{
+   {
+     { .mandatory_creation = true, .tied = false},
+     __alignof__( task_args_t), 0, 1, 0, NULL
+   },
+   {
+      { nanos_smp_factory, &block_task_device_args }
+   }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+static unsigned int seed = 12345;
+static int next_random ( int max )
+{
+   seed = seed * 1103515245 + 12345;
+   return ( seed >> 16 ) % max;
+}
+
+int main ( int argc, char **argv )
+{
+   static int expected[N][N];
+   static int expected_sums[NUM_TASKS];
+   int t, i, j;
+   int error = 0;
+
+   for ( i = 0; i < N; i++ ) {
+      for ( j = 0; j < N; j++ ) {
+         matrix[i][j] = expected[i][j] = i + j;
+      }
+   }
+
+   for ( t = 0; t < NUM_TASKS; t++ ) {
+      nanos_wd_t wd = NULL;
+      task_args_t *args = NULL;
+      nanos_region_dimension_t dimensions[2];
+      nanos_data_access_t access;
+      int row, col, height, width, update;
+
+      height = 1 + next_random( t % 10 == 0 ? MAX_BLOCK : 12 );
+      width = 1 + next_random( 12 );
+      row = next_random( N - height + 1 );
+      col = next_random( N - width + 1 );
+      update = next_random( 3 ) != 0;
+
+      NANOS_SAFE( nanos_create_wd_compact ( &wd, &block_const_data.base, &dyn_props, sizeof( task_args_t ),
+                                            (void **) &args, nanos_current_wd(), NULL, NULL ) );
+      args->row = row;
+      args->col = col;
+      args->height = height;
+      args->width = width;
+      args->value = t;
+      args->sum = update ? NULL : &sums[t];
+
+      /* Sequential emulation */
+      expected_sums[t] = 0;
+      sums[t] = 0;
+      for ( i = row; i < row + height; i++ ) {
+         for ( j = col; j < col + width; j++ ) {
+            if ( update ) expected[i][j] = ( expected[i][j] * 3 + t ) % 10007;
+            else expected_sums[t] += expected[i][j];
+         }
+      }
+
+      /* First dimension in bytes */
+      dimensions[0].size = N * sizeof( int );
+      dimensions[0].lower_bound = col * sizeof( int );
+      dimensions[0].accessed_length = width * sizeof( int );
+      dimensions[1].size = N;
+      dimensions[1].lower_bound = row;
+      dimensions[1].accessed_length = height;
+
+      access.address = matrix;
+      access.flags.input = 1;
+      access.flags.output = update;
+      access.flags.can_rename = 0;
+      access.flags.concurrent = 0;
+      access.flags.commutative = 0;
+      access.dimension_count = 2;
+      access.dimensions = dimensions;
+      access.offset = ( row * N + col ) * sizeof( int );
+
+      NANOS_SAFE( nanos_submit( wd, 1, &access, NULL ) );
+   }
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+
+   for ( i = 0; i < N; i++ ) {
+      for ( j = 0; j < N; j++ ) {
+         if ( matrix[i][j] != expected[i][j] ) error++;
+      }
+   }
+   for ( t = 0; t < NUM_TASKS; t++ ) {
+      if ( sums[t] != expected_sums[t] ) error++;
+   }
+
+   fprintf( stderr, "%s : %s\n", argv[0], error == 0 ? "  successful" : "unsuccessful" );
+   return error == 0 ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator=gens/core-generator
+test_schedule="hws"
+</testinfo>
+*/
+
+#include "config.hpp"
+#include "nanos.h"
+#include "atomic.hpp"
+#include <iostream>
+#include "smpprocessor.hpp"
+#include "system.hpp"
+
+using namespace std;
+
+using namespace nanos;
+using namespace nanos::ext;
+
+#define NUM_PARENTS   100
+#define NUM_CHILDREN  50
+
+Atomic<int> counter( 0 );
+
+typedef struct {
+   int children;
+} parent_data_t;
+
+void child ( void *args );
+void parent ( void *args );
+
+void child ( void *args )
+{
+   counter++;
+}
+
+/**
+ * Every parent task creates its own children in the deque of its thread, idle
+ * threads steal them going through every level of the machine topology.
+ */
+void parent ( void *args )
+{
+   parent_data_t *hargs = (parent_data_t *) args;
+   WD *wg = getMyThreadSafe()->getCurrentWD();
+
+   for ( int i = 0; i < hargs->children; i++ ) {
+      WD * wd = new WD( new SMPDD( child ) );
+      wg->addWork( *wd );
+      sys.submit( *wd );
+   }
+
+   wg->waitCompletion();
+   counter++;
+}
+
+int main ( int argc, char **argv )
+{
+   parent_data_t _data;
+   _data.children = NUM_CHILDREN;
+
+   WD *wg = getMyThreadSafe()->getCurrentWD();
+   for ( int i = 0; i < NUM_PARENTS; i++ ) {
+      WD * wd = new WD( new SMPDD( parent ), sizeof( _data ), __alignof__(parent_data_t), ( void * ) &_data );
+      wg->addWork( *wd );
+      sys.submit( *wd );
+   }
+   wg->waitCompletion();
+
+   if ( counter.value() == NUM_PARENTS * ( NUM_CHILDREN + 1 ) ) {
+      fprintf(stderr, "%s : %s\n", argv[0], "successful");
+      return 0;
+   }
+   else {
+      fprintf(stderr, "%s: %s\n", argv[0], "unsuccessful");
+      return -1;
+   }
+}
@@ -0,0 +1,124 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_generator="gens/api-generator -a \"--schedule=bf|--schedule=wf|--schedule=socket|--schedule=affinity,--immediate-successor-depth=0|--immediate-successor-depth=4|--immediate-successor-depth=64\""
+exec_versions="default prefetch"
+
+declare test_ENV_prefetch="NX_ARGS='--socket-immediate --affinity-use-immediate-successor'"
+</testinfo>
+*/
+
+/*
+ * Test description:
+ * Several chains of tasks linked through an inout dependence. When a link
+ * finishes, the next one is its only successor and runs next on the same
+ * thread; the final value of every chain depends on its links running in order.
+ * The prefetch version enables the successor prefetching of the socket and
+ * affinity policies.
+ */
+
+#include <stdio.h>
+#include <nanos.h>
+
+#define NUM_CHAINS   8
+#define NUM_LINKS    256
+
+typedef struct {
+   int *chain;
+   int value;
+} task_args_t;
+
+void link_task ( void *p_args );
+void link_task ( void *p_args )
+{
+   task_args_t *args = (task_args_t *) p_args;
+   *args->chain = ( *args->chain * 3 + args->value ) % 1000003;
+}
+
+nanos_smp_args_t link_task_device_args = { link_task };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 link_const_data =
+{
+   {
+     { .mandatory_creation = true, .tied = false},
+     __alignof__( task_args_t), 0, 1, 0, NULL
+   },
+   {
+      { nanos_smp_factory, &link_task_device_args }
+   }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+int chains[NUM_CHAINS];
+
+int main ( int argc, char **argv )
+{
+   nanos_region_dimension_t dimension = { sizeof(int), 0, sizeof(int) };
+   int expected[NUM_CHAINS];
+   int i, k;
+   int error = 0;
+
+   for ( k = 0; k < NUM_CHAINS; k++ ) {
+      chains[k] = 1;
+      expected[k] = 1;
+   }
+
+   for ( i = 0; i < NUM_LINKS; i++ ) {
+      for ( k = 0; k < NUM_CHAINS; k++ ) {
+         nanos_wd_t wd = NULL;
+         task_args_t *args = NULL;
+         nanos_data_access_t access;
+
+         NANOS_SAFE( nanos_create_wd_compact ( &wd, &link_const_data.base, &dyn_props, sizeof( task_args_t ),
+                                               (void **) &args, nanos_current_wd(), NULL, NULL ) );
+         args->chain = &chains[k];
+         args->value = i + k;
+         expected[k] = ( expected[k] * 3 + i + k ) % 1000003;
+
+         access.address = &chains[k];
+         access.flags.input = 1;
+         access.flags.output = 1;
+         access.flags.can_rename = 0;
+         access.flags.concurrent = 0;
+         access.flags.commutative = 0;
+         access.dimension_count = 1;
+         access.dimensions = &dimension;
+         access.offset = 0;
+
+         NANOS_SAFE( nanos_submit( wd, 1, &access, NULL ) );
+      }
+   }
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+
+   for ( k = 0; k < NUM_CHAINS; k++ ) {
+      if ( chains[k] != expected[k] ) error++;
+   }
+
+   fprintf( stderr, "%s : %s\n", argv[0], error == 0 ? "  successful" : "unsuccessful" );
+   return error == 0 ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_mode=performance
+test_generator="gens/core-generator -a \"--barrier=centralized|--barrier=old-centralized|--barrier=combining\""
+</testinfo>
+*/
+
+/*
+ * Benchmark description:
+ * Latency of back to back team barriers with every thread of the team taking
+ * part in them:
+ *  - barrier: time per barrier as seen by the master thread
+ */
+
+#include "config.hpp"
+#include "nanos.h"
+#include "smpprocessor.hpp"
+#include "system.hpp"
+#include "threadteam.hpp"
+#include "common.h"
+
+using namespace nanos;
+using namespace nanos::ext;
+
+#define BARRIERS_PER_SAMPLE   200
+
+void barrier_code ( void * );
+void barrier_code ( void * )
+{
+   for ( int i = 0; i < ( BENCH_NWARMUP + BENCH_NSAMPLES ) * BARRIERS_PER_SAMPLE; i++ ) {
+      nanos_team_barrier();
+   }
+}
+
+static double barrier_sample ( void )
+{
+   double t0 = get_usecs();
+
+   for ( int i = 0; i < BARRIERS_PER_SAMPLE; i++ ) {
+      nanos_team_barrier();
+   }
+   return ( get_usecs() - t0 ) / BARRIERS_PER_SAMPLE;
+}
+
+int main ( int argc, char **argv )
+{
+   ThreadTeam &team = *getMyThreadSafe()->getTeam();
+
+   for ( unsigned i = 1; i < team.size(); i++ ) {
+      WD * wd = new WD( new SMPDD( barrier_code ) );
+      wd->tieTo( team[i] );
+      sys.submit( *wd );
+   }
+
+   WD *wd = getMyThreadSafe()->getCurrentWD();
+   wd->tieTo( *getMyThreadSafe() );
+
+   bench_run( "barrier", "us/barrier", barrier_sample );
+
+   return 0;
+}
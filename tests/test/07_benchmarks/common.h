@@ -18,10 +18,18 @@
 /*************************************************************************************/
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <math.h>
 #include <time.h>
 #include "nanos.h"
 
+#ifdef __cplusplus
+extern "C"
+#endif
+int omp_get_max_threads ( void );
+
 double get_usecs () {
    struct timespec tp;
    int error = clock_gettime( CLOCK_REALTIME, &tp);
@@ -125,3 +133,83 @@ void print_stats ( const char *name, const char *desc, stats_t *s )
 
 void task ( int usecs ) { usleep(usecs); }
 
+/*
+ * Support for the benchmark suite. Every benchmark measures BENCH_NSAMPLES
+ * samples of one or more metrics (lower is better) after a warm-up round and
+ * reports each metric as a single line:
+ *
+ *    #BENCH {"name":...,"unit":...,"config":...,"mean":...,"samples":[...]}
+ *
+ * where config is the runtime configuration: NX_ARGS followed by any other NX_*
+ * variable of the environment. These lines are what scripts/bench_compare.py
+ * reads to build baselines and detect regressions.
+ */
+
+extern char **environ;
+
+#define BENCH_NSAMPLES  30   /* Reported samples for each metric */
+#define BENCH_NWARMUP    3   /* Discarded samples before the reported ones */
+
+static void bench_print_escaped ( const char *str )
+{
+   for ( ; *str != '\0'; str++ ) {
+      if ( *str == '"' || *str == '\\' ) putchar( '\\' );
+      putchar( *str );
+   }
+}
+
+static int bench_compare_strings ( const void *a, const void *b )
+{
+   return strcmp( *(const char * const *) a, *(const char * const *) b );
+}
+
+static void bench_print_config ( void )
+{
+   const char *args = getenv( "NX_ARGS" );
+   const char *vars[64];
+   unsigned i, nvars = 0;
+   char **env;
+
+   if ( args != NULL ) bench_print_escaped( args );
+
+   /* Runtime options given through the environment, NX_TEST_* only drive the test generators */
+   for ( env = environ; *env != NULL && nvars < 64; env++ ) {
+      if ( strncmp( *env, "NX_", 3 ) != 0 || strncmp( *env, "NX_ARGS=", 8 ) == 0 || strncmp( *env, "NX_TEST_", 8 ) == 0 ) continue;
+      vars[nvars++] = *env;
+   }
+   qsort( vars, nvars, sizeof( const char * ), bench_compare_strings );
+   for ( i = 0; i < nvars; i++ ) {
+      putchar( ' ' );
+      bench_print_escaped( vars[i] );
+   }
+}
+
+static void bench_report ( const char *name, const char *unit, const double *values, unsigned size )
+{
+   double total = 0.0;
+   unsigned i;
+
+   for ( i = 0; i < size; i++ ) total += values[i];
+
+   printf( "#BENCH {\"name\":\"%s\",\"unit\":\"%s\",\"config\":\"", name, unit );
+   bench_print_config();
+   printf( "\",\"mean\":%.4f,\"samples\":[", size > 0 ? total / size : 0.0 );
+   for ( i = 0; i < size; i++ ) printf( "%s%.4f", i == 0 ? "" : ",", values[i] );
+   printf( "]}\n" );
+   fflush( stdout );
+}
+
+/*
+ * Runs sample() BENCH_NWARMUP + BENCH_NSAMPLES times and reports the value it
+ * returns for the non warm-up calls as metric name
+ */
+static void bench_run ( const char *name, const char *unit, double (*sample) ( void ) )
+{
+   double values[BENCH_NSAMPLES];
+   int i;
+
+   for ( i = 0; i < BENCH_NWARMUP; i++ ) sample();
+   for ( i = 0; i < BENCH_NSAMPLES; i++ ) values[i] = sample();
+
+   bench_report( name, unit, values, BENCH_NSAMPLES );
+}
@@ -23,6 +23,9 @@
 <testinfo>
 test_mode=performance
 test_generator=gens/mcc-openmp-generator
+exec_versions="wd_slab wd_malloc"
+
+declare test_ENV_wd_malloc="NX_WD_SLAB=no"
 </testinfo>
 */
 
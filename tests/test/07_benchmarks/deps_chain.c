@@ -0,0 +1,115 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_mode=performance
+test_generator="gens/api-generator -a \"--deps=plain|--deps=regions|--deps=intervals\""
+test_LDFLAGS="-lm"
+</testinfo>
+*/
+
+/*
+ * Benchmark description:
+ * Dependence tracking and release cost along a chain of tasks with an inout
+ * dependence on the same variable, so that only one task is ready at a time:
+ *  - deps_chain: time per link, from the first submission to the end of the chain
+ */
+
+#include <nanos.h>
+#include "common.h"
+
+#define CHAIN_LENGTH   512
+
+typedef struct {
+   int *value;
+} task_args_t;
+
+void link_task ( void *p_args );
+void link_task ( void *p_args )
+{
+   task_args_t *args = (task_args_t *) p_args;
+   ( *args->value )++;
+}
+
+nanos_smp_args_t link_task_device_args = { link_task };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 link_const_data =
+{
+   {
+     { .mandatory_creation = true, .tied = false},
+     __alignof__( task_args_t), 0, 1, 0, NULL
+   },
+   {
+      { nanos_smp_factory, &link_task_device_args }
+   }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+int value;
+
+static double chain_sample ( void )
+{
+   nanos_region_dimension_t dimension = { sizeof(int), 0, sizeof(int) };
+   double t0 = get_usecs();
+   int i;
+
+   for ( i = 0; i < CHAIN_LENGTH; i++ ) {
+      nanos_wd_t wd = NULL;
+      task_args_t *args = NULL;
+      nanos_data_access_t access;
+
+      NANOS_SAFE( nanos_create_wd_compact ( &wd, &link_const_data.base, &dyn_props, sizeof( task_args_t ),
+                                            (void **) &args, nanos_current_wd(), NULL, NULL ) );
+      args->value = &value;
+
+      access.address = &value;
+      access.flags.input = 1;
+      access.flags.output = 1;
+      access.flags.can_rename = 0;
+      access.flags.concurrent = 0;
+      access.flags.commutative = 0;
+      access.dimension_count = 1;
+      access.dimensions = &dimension;
+      access.offset = 0;
+
+      NANOS_SAFE( nanos_submit( wd, 1, &access, NULL ) );
+   }
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+
+   return ( get_usecs() - t0 ) / CHAIN_LENGTH;
+}
+
+int main ( int argc, char **argv )
+{
+   bench_run( "deps_chain", "us/task", chain_sample );
+
+   if ( value != ( BENCH_NWARMUP + BENCH_NSAMPLES ) * CHAIN_LENGTH ) {
+      fprintf( stderr, "%s : unsuccessful\n", argv[0] );
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,154 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_mode=performance
+test_generator="gens/api-generator -a \"--deps=plain|--deps=sharded|--deps=regions|--deps=intervals\""
+test_LDFLAGS="-lm"
+</testinfo>
+*/
+
+/*
+ * Benchmark description:
+ * Wide fan-out followed by a fan-in: a producer writes a seed, FAN_WIDTH tasks
+ * read it and write one partial result each, and a consumer reads all of them.
+ *  - deps_fan: time per task, from the first submission to the end of the consumer
+ */
+
+#include <nanos.h>
+#include "common.h"
+
+#define FAN_WIDTH   256
+
+typedef struct {
+   int index;
+} task_args_t;
+
+int seed;
+int partials[FAN_WIDTH];
+int result;
+
+void producer_task ( void *p_args );
+void producer_task ( void *p_args ) { seed++; }
+
+void worker_task ( void *p_args );
+void worker_task ( void *p_args )
+{
+   task_args_t *args = (task_args_t *) p_args;
+   partials[args->index] = seed + args->index;
+}
+
+void consumer_task ( void *p_args );
+void consumer_task ( void *p_args )
+{
+   int i;
+   result = 0;
+   for ( i = 0; i < FAN_WIDTH; i++ ) result += partials[i];
+}
+
+nanos_smp_args_t producer_device_args = { producer_task };
+nanos_smp_args_t worker_device_args = { worker_task };
+nanos_smp_args_t consumer_device_args = { consumer_task };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 producer_const_data =
+{
+   { { .mandatory_creation = true, .tied = false}, __alignof__( task_args_t), 0, 1, 0, NULL },
+   { { nanos_smp_factory, &producer_device_args } }
+};
+
+struct nanos_const_wd_definition_1 worker_const_data =
+{
+   { { .mandatory_creation = true, .tied = false}, __alignof__( task_args_t), 0, 1, 0, NULL },
+   { { nanos_smp_factory, &worker_device_args } }
+};
+
+struct nanos_const_wd_definition_1 consumer_const_data =
+{
+   { { .mandatory_creation = true, .tied = false}, __alignof__( task_args_t), 0, 1, 0, NULL },
+   { { nanos_smp_factory, &consumer_device_args } }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+static nanos_region_dimension_t dimension = { sizeof(int), 0, sizeof(int) };
+
+static void set_access ( nanos_data_access_t *access, void *address, int input, int output )
+{
+   access->address = address;
+   access->flags.input = input;
+   access->flags.output = output;
+   access->flags.can_rename = 0;
+   access->flags.concurrent = 0;
+   access->flags.commutative = 0;
+   access->dimension_count = 1;
+   access->dimensions = &dimension;
+   access->offset = 0;
+}
+
+static void submit ( struct nanos_const_wd_definition_1 *const_data, int index, int num_accesses, nanos_data_access_t *accesses )
+{
+   nanos_wd_t wd = NULL;
+   task_args_t *args = NULL;
+
+   NANOS_SAFE( nanos_create_wd_compact ( &wd, &const_data->base, &dyn_props, sizeof( task_args_t ),
+                                         (void **) &args, nanos_current_wd(), NULL, NULL ) );
+   args->index = index;
+   NANOS_SAFE( nanos_submit( wd, num_accesses, accesses, NULL ) );
+}
+
+static double fan_sample ( void )
+{
+   static nanos_data_access_t accesses[FAN_WIDTH];
+   double t0 = get_usecs();
+   int i;
+
+   set_access( &accesses[0], &seed, 1, 1 );
+   submit( &producer_const_data, 0, 1, accesses );
+
+   for ( i = 0; i < FAN_WIDTH; i++ ) {
+      set_access( &accesses[0], &seed, 1, 0 );
+      set_access( &accesses[1], &partials[i], 0, 1 );
+      submit( &worker_const_data, i, 2, accesses );
+   }
+
+   for ( i = 0; i < FAN_WIDTH; i++ ) set_access( &accesses[i], &partials[i], 1, 0 );
+   submit( &consumer_const_data, 0, FAN_WIDTH, accesses );
+
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+
+   return ( get_usecs() - t0 ) / ( FAN_WIDTH + 2 );
+}
+
+int main ( int argc, char **argv )
+{
+   bench_run( "deps_fan", "us/task", fan_sample );
+
+   if ( result != FAN_WIDTH * seed + FAN_WIDTH * ( FAN_WIDTH - 1 ) / 2 ) {
+      fprintf( stderr, "%s : unsuccessful\n", argv[0] );
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,155 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_mode=performance
+test_generator="gens/api-generator -a \"--deps=regions|--deps=intervals|--deps=perfect-regions\""
+test_LDFLAGS="-lm"
+</testinfo>
+*/
+
+/*
+ * Benchmark description:
+ * Blocked Gauss-Seidel sweeps over a 2D grid. Each task updates one block and
+ * reads the adjacent row or column of its four neighbour blocks, so every
+ * task has five two-dimensional region dependences that partially overlap the
+ * ones of other tasks.
+ *  - deps_stencil: time per task, from the first submission of a sweep set to its end
+ */
+
+#include <nanos.h>
+#include "common.h"
+
+#define N           512
+#define BS          64
+#define NB          ( N / BS )
+#define SWEEPS      4
+
+typedef struct {
+   int row, col;
+} task_args_t;
+
+/* Interior cells are [1, N], rows and columns 0 and N+1 are a fixed halo */
+double grid[N+2][N+2];
+
+void block_task ( void *p_args );
+void block_task ( void *p_args )
+{
+   task_args_t *args = (task_args_t *) p_args;
+   int i, j;
+
+   for ( i = args->row; i < args->row + BS; i++ ) {
+      for ( j = args->col; j < args->col + BS; j++ ) {
+         grid[i][j] = 0.2 * ( grid[i][j] + grid[i-1][j] + grid[i+1][j] + grid[i][j-1] + grid[i][j+1] );
+      }
+   }
+}
+
+nanos_smp_args_t block_task_device_args = { block_task };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 block_const_data =
+{
+   {
+     { .mandatory_creation = true, .tied = false},
+     __alignof__( task_args_t), 0, 1, 0, NULL
+   },
+   {
+      { nanos_smp_factory, &block_task_device_args }
+   }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+static void set_access ( nanos_data_access_t *access, nanos_region_dimension_t *dimensions,
+                         int row, int col, int height, int width, int output )
+{
+   /* First dimension in bytes */
+   dimensions[0].size = ( N + 2 ) * sizeof( double );
+   dimensions[0].lower_bound = col * sizeof( double );
+   dimensions[0].accessed_length = width * sizeof( double );
+   dimensions[1].size = N + 2;
+   dimensions[1].lower_bound = row;
+   dimensions[1].accessed_length = height;
+
+   access->address = grid;
+   access->flags.input = 1;
+   access->flags.output = output;
+   access->flags.can_rename = 0;
+   access->flags.concurrent = 0;
+   access->flags.commutative = 0;
+   access->dimension_count = 2;
+   access->dimensions = dimensions;
+   access->offset = ( row * ( N + 2 ) + col ) * sizeof( double );
+}
+
+static double stencil_sample ( void )
+{
+   double t0 = get_usecs();
+   int s, bi, bj;
+
+   for ( s = 0; s < SWEEPS; s++ ) {
+      for ( bi = 0; bi < NB; bi++ ) {
+         for ( bj = 0; bj < NB; bj++ ) {
+            nanos_wd_t wd = NULL;
+            task_args_t *args = NULL;
+            nanos_region_dimension_t dimensions[5][2];
+            nanos_data_access_t accesses[5];
+            int row = 1 + bi * BS, col = 1 + bj * BS;
+
+            NANOS_SAFE( nanos_create_wd_compact ( &wd, &block_const_data.base, &dyn_props, sizeof( task_args_t ),
+                                                  (void **) &args, nanos_current_wd(), NULL, NULL ) );
+            args->row = row;
+            args->col = col;
+
+            set_access( &accesses[0], dimensions[0], row, col, BS, BS, 1 );
+            set_access( &accesses[1], dimensions[1], row - 1, col, 1, BS, 0 );
+            set_access( &accesses[2], dimensions[2], row + BS, col, 1, BS, 0 );
+            set_access( &accesses[3], dimensions[3], row, col - 1, BS, 1, 0 );
+            set_access( &accesses[4], dimensions[4], row, col + BS, BS, 1, 0 );
+
+            NANOS_SAFE( nanos_submit( wd, 5, accesses, NULL ) );
+         }
+      }
+   }
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+
+   return ( get_usecs() - t0 ) / ( SWEEPS * NB * NB );
+}
+
+int main ( int argc, char **argv )
+{
+   int i, j;
+
+   for ( i = 0; i < N + 2; i++ ) {
+      for ( j = 0; j < N + 2; j++ ) {
+         grid[i][j] = ( i == 0 || j == 0 || i == N + 1 || j == N + 1 ) ? 1.0 : 0.0;
+      }
+   }
+
+   bench_run( "deps_stencil", "us/task", stencil_sample );
+
+   return 0;
+}
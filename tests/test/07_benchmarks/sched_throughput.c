@@ -0,0 +1,134 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_mode=performance
+test_generator="gens/api-generator -a \"--schedule=bf|--schedule=wf|--schedule=dbf|--schedule=socket|--schedule=affinity|--schedule=hws|--schedule=mpq\""
+test_LDFLAGS="-lm"
+</testinfo>
+*/
+
+/*
+ * Benchmark description:
+ * Scheduler throughput with independent tasks of a few microseconds:
+ *  - sched_flat:   the main task creates every task
+ *  - sched_nested: the main task creates a few parents that create the rest,
+ *                  so tasks are enqueued from several threads
+ */
+
+#include <nanos.h>
+#include "common.h"
+
+#define NUM_TASKS     4096
+#define NUM_PARENTS   16
+#define TASK_WORK     256
+
+typedef struct {
+   int index;
+} task_args_t;
+
+volatile int sink[NUM_TASKS];
+
+void leaf_task ( void *p_args );
+void leaf_task ( void *p_args )
+{
+   task_args_t *args = (task_args_t *) p_args;
+   int i, value = 0;
+
+   for ( i = 0; i < TASK_WORK; i++ ) value += i * args->index;
+   sink[args->index] = value;
+}
+
+void parent_task ( void *p_args );
+
+nanos_smp_args_t leaf_device_args = { leaf_task };
+nanos_smp_args_t parent_device_args = { parent_task };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 leaf_const_data =
+{
+   { { .mandatory_creation = true, .tied = false}, __alignof__( task_args_t), 0, 1, 0, NULL },
+   { { nanos_smp_factory, &leaf_device_args } }
+};
+
+struct nanos_const_wd_definition_1 parent_const_data =
+{
+   { { .mandatory_creation = true, .tied = false}, __alignof__( task_args_t), 0, 1, 0, NULL },
+   { { nanos_smp_factory, &parent_device_args } }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+static void submit ( struct nanos_const_wd_definition_1 *const_data, int index )
+{
+   nanos_wd_t wd = NULL;
+   task_args_t *args = NULL;
+
+   NANOS_SAFE( nanos_create_wd_compact ( &wd, &const_data->base, &dyn_props, sizeof( task_args_t ),
+                                         (void **) &args, nanos_current_wd(), NULL, NULL ) );
+   args->index = index;
+   NANOS_SAFE( nanos_submit( wd, 0, NULL, NULL ) );
+}
+
+void parent_task ( void *p_args )
+{
+   task_args_t *args = (task_args_t *) p_args;
+   int i;
+
+   for ( i = 0; i < NUM_TASKS / NUM_PARENTS; i++ ) {
+      submit( &leaf_const_data, args->index * ( NUM_TASKS / NUM_PARENTS ) + i );
+   }
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+}
+
+static double flat_sample ( void )
+{
+   double t0 = get_usecs();
+   int i;
+
+   for ( i = 0; i < NUM_TASKS; i++ ) submit( &leaf_const_data, i );
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+
+   return ( get_usecs() - t0 ) / NUM_TASKS;
+}
+
+static double nested_sample ( void )
+{
+   double t0 = get_usecs();
+   int i;
+
+   for ( i = 0; i < NUM_PARENTS; i++ ) submit( &parent_const_data, i );
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+
+   return ( get_usecs() - t0 ) / NUM_TASKS;
+}
+
+int main ( int argc, char **argv )
+{
+   bench_run( "sched_flat", "us/task", flat_sample );
+   bench_run( "sched_nested", "us/task", nested_sample );
+
+   return 0;
+}
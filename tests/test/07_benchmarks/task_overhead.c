@@ -0,0 +1,133 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_mode=performance
+test_generator=gens/api-generator
+exec_versions="wd_slab wd_malloc"
+test_LDFLAGS="-lm"
+
+declare test_ENV_wd_malloc="NX_WD_SLAB=no"
+</testinfo>
+*/
+
+/*
+ * Benchmark description:
+ * Per task cost of creating, submitting and running empty tasks:
+ *  - task_create:    nanos_create_wd_compact of a batch of tasks
+ *  - task_submit:    nanos_submit of the same batch
+ *  - task_execute:   waiting for the batch to be executed
+ *  - task_roundtrip: create, submit and wait for a single task
+ */
+
+#include <nanos.h>
+#include "common.h"
+
+#define BATCH_SIZE   256
+
+void empty_task ( void *args );
+void empty_task ( void *args ) {}
+
+nanos_smp_args_t empty_task_device_args = { empty_task };
+
+struct nanos_const_wd_definition_1
+{
+     nanos_const_wd_definition_t base;
+     nanos_device_t devices[1];
+};
+
+struct nanos_const_wd_definition_1 empty_const_data =
+{
+   {
+     { .mandatory_creation = true, .tied = false},
+     1, 0, 1, 0, NULL
+   },
+   {
+      { nanos_smp_factory, &empty_task_device_args }
+   }
+};
+
+nanos_wd_dyn_props_t dyn_props = {0};
+
+static double create_time, submit_time, execute_time;
+
+static void run_batch ( void )
+{
+   nanos_wd_t wds[BATCH_SIZE];
+   void *args;
+   double t0, t1, t2, t3;
+   int i;
+
+   t0 = get_usecs();
+   for ( i = 0; i < BATCH_SIZE; i++ ) {
+      wds[i] = NULL;
+      args = NULL;
+      NANOS_SAFE( nanos_create_wd_compact( &wds[i], &empty_const_data.base, &dyn_props, 0,
+                                           &args, nanos_current_wd(), NULL, NULL ) );
+   }
+   t1 = get_usecs();
+   for ( i = 0; i < BATCH_SIZE; i++ ) {
+      NANOS_SAFE( nanos_submit( wds[i], 0, NULL, NULL ) );
+   }
+   t2 = get_usecs();
+   NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+   t3 = get_usecs();
+
+   create_time = ( t1 - t0 ) / BATCH_SIZE;
+   submit_time = ( t2 - t1 ) / BATCH_SIZE;
+   execute_time = ( t3 - t2 ) / BATCH_SIZE;
+}
+
+static double roundtrip_sample ( void )
+{
+   double t0 = get_usecs();
+   int i;
+
+   for ( i = 0; i < BATCH_SIZE; i++ ) {
+      nanos_wd_t wd = NULL;
+      void *args = NULL;
+      NANOS_SAFE( nanos_create_wd_compact( &wd, &empty_const_data.base, &dyn_props, 0,
+                                           &args, nanos_current_wd(), NULL, NULL ) );
+      NANOS_SAFE( nanos_submit( wd, 0, NULL, NULL ) );
+      NANOS_SAFE( nanos_wg_wait_completion( nanos_current_wd(), false ) );
+   }
+   return ( get_usecs() - t0 ) / BATCH_SIZE;
+}
+
+int main ( int argc, char **argv )
+{
+   double create[BENCH_NSAMPLES], submit[BENCH_NSAMPLES], execute[BENCH_NSAMPLES];
+   int i;
+
+   for ( i = 0; i < BENCH_NWARMUP; i++ ) run_batch();
+   for ( i = 0; i < BENCH_NSAMPLES; i++ ) {
+      run_batch();
+      create[i] = create_time;
+      submit[i] = submit_time;
+      execute[i] = execute_time;
+   }
+   bench_report( "task_create", "us/task", create, BENCH_NSAMPLES );
+   bench_report( "task_submit", "us/task", submit, BENCH_NSAMPLES );
+   bench_report( "task_execute", "us/task", execute, BENCH_NSAMPLES );
+
+   bench_run( "task_roundtrip", "us/task", roundtrip_sample );
+
+   return 0;
+}
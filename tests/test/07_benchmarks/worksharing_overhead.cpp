@@ -0,0 +1,126 @@
+/*************************************************************************************/
+/*      Copyright 2015 Barcelona Supercomputing Center                               */
+/*                                                                                   */
+/*      This file is part of the NANOS++ library.                                    */
+/*                                                                                   */
+/*      NANOS++ is free software: you can redistribute it and/or modify              */
+/*      it under the terms of the GNU Lesser General Public License as published by  */
+/*      the Free Software Foundation, either version 3 of the License, or            */
+/*      (at your option) any later version.                                          */
+/*                                                                                   */
+/*      NANOS++ is distributed in the hope that it will be useful,                   */
+/*      but WITHOUT ANY WARRANTY; without even the implied warranty of               */
+/*      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                */
+/*      GNU Lesser General Public License for more details.                          */
+/*                                                                                   */
+/*      You should have received a copy of the GNU Lesser General Public License     */
+/*      along with NANOS++.  If not, see <http://www.gnu.org/licenses/>.             */
+/*************************************************************************************/
+
+/*
+<testinfo>
+test_mode=performance
+test_generator=gens/core-generator
+</testinfo>
+*/
+
+/*
+ * Benchmark description:
+ * Chunk distribution overhead of every worksharing plugin. All the threads of
+ * the team run loops with an empty body and a chunk size of one, followed by a
+ * team barrier:
+ *  - ws_<plugin>: time per iteration as seen by the master thread
+ */
+
+#include "config.hpp"
+#include "nanos.h"
+#include "smpprocessor.hpp"
+#include "system.hpp"
+#include "threadteam.hpp"
+#include "common.h"
+
+using namespace nanos;
+using namespace nanos::ext;
+
+#define LOOP_ITERS     4096
+#define NUM_WS         3
+
+static const char *ws_names[NUM_WS] = { "static_for", "dynamic_for", "guided_for" };
+static nanos_ws_t ws_plugins[NUM_WS];
+static nanos_ws_t current_ws;
+static volatile int sink;
+
+static void run_loop ( nanos_ws_t ws )
+{
+   nanos_ws_info_loop_t info;
+   nanos_ws_item_loop_t item;
+   nanos_ws_desc_t *wsd;
+   bool single_guard;
+
+   info.lower_bound = 0;
+   info.upper_bound = LOOP_ITERS - 1;
+   info.loop_step = 1;
+   info.chunk_size = 1;
+
+   NANOS_SAFE( nanos_worksharing_create( &wsd, ws, (nanos_ws_info_t *) &info, &single_guard ) );
+   NANOS_SAFE( nanos_worksharing_next_item( wsd, (nanos_ws_item_t *) &item ) );
+   while ( item.execute ) {
+      for ( int i = item.lower; i <= item.upper; i++ ) sink = i;
+      NANOS_SAFE( nanos_worksharing_next_item( wsd, (nanos_ws_item_t *) &item ) );
+   }
+   NANOS_SAFE( nanos_team_barrier() );
+}
+
+void loop_code ( void * );
+void loop_code ( void * )
+{
+   getMyThreadSafe()->getCurrentWD()->setImplicit( true );
+
+   for ( int w = 0; w < NUM_WS; w++ ) {
+      for ( int i = 0; i < BENCH_NWARMUP + BENCH_NSAMPLES; i++ ) {
+         run_loop( ws_plugins[w] );
+      }
+   }
+}
+
+static double loop_sample ( void )
+{
+   double t0 = get_usecs();
+
+   run_loop( current_ws );
+   return ( get_usecs() - t0 ) / LOOP_ITERS;
+}
+
+int main ( int argc, char **argv )
+{
+   ThreadTeam &team = *getMyThreadSafe()->getTeam();
+
+   for ( int w = 0; w < NUM_WS; w++ ) {
+      ws_plugins[w] = nanos_find_worksharing( ws_names[w] );
+      if ( ws_plugins[w] == NULL ) {
+         fprintf( stderr, "%s : unsuccessful, cannot find %s\n", argv[0], ws_names[w] );
+         return 1;
+      }
+   }
+
+   for ( unsigned i = 1; i < team.size(); i++ ) {
+      WD * wd = new WD( new SMPDD( loop_code ) );
+      wd->tieTo( team[i] );
+      sys.submit( *wd );
+   }
+
+   WD *wd = getMyThreadSafe()->getCurrentWD();
+   wd->tieTo( *getMyThreadSafe() );
+   wd->setImplicit( true );
+
+   for ( int w = 0; w < NUM_WS; w++ ) {
+      char name[64];
+      snprintf( name, sizeof( name ), "ws_%s", ws_names[w] );
+      current_ws = ws_plugins[w];
+      bench_run( name, "us/iteration", loop_sample );
+   }
+
+   wd->setImplicit( false );
+
+   return 0;
+}